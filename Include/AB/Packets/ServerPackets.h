@@ -539,6 +539,26 @@ struct ObjectPositionUpdate
     }
 };
 
+/// Units of ObjectPositionDelta per world unit, i.e. 1 cm
+inline constexpr float POSITION_DELTA_PRECISION = 100.0f;
+
+/// Change of the position since the last ObjectPositionUpdate or ObjectPositionDelta
+/// of this object. The client keeps the quantized position of the last update, i.e.
+/// round(pos * POSITION_DELTA_PRECISION), and adds delta to it.
+struct ObjectPositionDelta
+{
+    uint32_t id;
+    std::array<int16_t, 3> delta;
+    template<typename _Ar>
+    void Serialize(_Ar& ar)
+    {
+        ar.value(id);
+        ar.value(delta[0]);
+        ar.value(delta[1]);
+        ar.value(delta[2]);
+    }
+};
+
 struct ObjectForcePosition
 {
     uint32_t id;
@@ -27,7 +27,19 @@ namespace AB
 {
 
 /// Increase whenever the protocol changes
-static constexpr uint16_t PROTOCOL_VERSION = 1;
+static constexpr uint16_t PROTOCOL_VERSION = 3;
+
+/// Features a client supports, sent with the game login packet
+enum ClientCapabilities : uint32_t
+{
+    ClientCapabilityNone = 0,
+    /// The client can decompress LZ4 compressed messages
+    ClientCapabilityCompression = 1 << 0,
+};
+
+/// Set in the length header of a message when the body is LZ4 compressed.
+/// The body then starts with the compressed size (2 bytes) followed by the compressed data.
+static constexpr uint16_t MESSAGE_COMPRESSED_FLAG = 0x8000;
 
 static constexpr uint16_t CLIENT_OS_WIN = 1;
 static constexpr uint16_t CLIENT_OS_LINUX = 2;
@@ -197,7 +209,8 @@ const uint32_t ENC_KEY[4] = {
     ENUMERATE_SERVER_PACKET_CODE(ItemPrice)                   \
     ENUMERATE_SERVER_PACKET_CODE(CraftsmanItems)              \
     ENUMERATE_SERVER_PACKET_CODE(DropTargetChanged)           \
-    ENUMERATE_SERVER_PACKET_CODE(PositionPinged)
+    ENUMERATE_SERVER_PACKET_CODE(PositionPinged)              \
+    ENUMERATE_SERVER_PACKET_CODE(ObjectPositionDelta)
 
 #define ENUMERATE_CREATURE_STATES          \
     ENUMERATE_CREATURE_STATE(Unknown)      \
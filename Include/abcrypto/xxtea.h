@@ -4,6 +4,7 @@
 #define __ABCRYPT_XXTEA_H__
 
 #include <stdint.h>
+#include <stddef.h>
 
 void xxtea_enc(uint32_t* msg,
     const uint32_t n,
@@ -11,5 +12,12 @@ void xxtea_enc(uint32_t* msg,
 void xxtea_dec(uint32_t* msg,
     const uint32_t n,
     const uint32_t *const key);
+/* Encrypt count messages, the result is the same as calling xxtea_enc() for each
+   of them. With SSE2 or AVX2 messages of the same length are encrypted 4 or 8 at
+   a time. */
+void xxtea_enc_batch(uint32_t* const* msgs,
+    const uint32_t* n,
+    const uint32_t* const* keys,
+    const size_t count);
 
 #endif
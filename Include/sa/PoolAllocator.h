@@ -163,6 +163,19 @@ public:
         };
     }
 
+    /// Returns uninitialized memory for one object or nullptr when the pool is exhausted
+    void* AllocateChunk()
+    {
+        if (allocs_ - frees_ == size_ / ChunkSize)
+            return nullptr;
+        return Alloc(ChunkSize);
+    }
+    /// Returns memory from AllocateChunk() without calling the destructor
+    void DeallocateChunk(void* ptr)
+    {
+        Free(ptr);
+    }
+
     pointer allocate(size_type n, const void*)
     {
         void* resultMem = Alloc(sizeof(T));
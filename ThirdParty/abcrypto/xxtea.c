@@ -62,3 +62,183 @@ void xxtea_dec(uint32_t * msg,
         sum -= tea_delta;
     }
 }
+
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#   define XXTEA_LANES 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define XXTEA_LANES 4
+#endif
+
+#if defined(XXTEA_LANES)
+
+#include <stdlib.h>
+
+/* The words of the messages are interleaved in work, work[p] holds word p of all
+   messages. Since all messages have the same length, every lane does the same
+   steps as xxtea_enc(), only the key differs. */
+#if XXTEA_LANES == 8
+typedef __m256i xxtea_vec;
+#   define XXTEA_SET1(a) _mm256_set1_epi32((int)(a))
+#   define XXTEA_ADD(a, b) _mm256_add_epi32(a, b)
+#   define XXTEA_XOR(a, b) _mm256_xor_si256(a, b)
+#   define XXTEA_SRL(a, c) _mm256_srli_epi32(a, c)
+#   define XXTEA_SLL(a, c) _mm256_slli_epi32(a, c)
+#   define XXTEA_LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#   define XXTEA_STORE(p, a) _mm256_storeu_si256((__m256i*)(p), a)
+#else
+typedef __m128i xxtea_vec;
+#   define XXTEA_SET1(a) _mm_set1_epi32((int)(a))
+#   define XXTEA_ADD(a, b) _mm_add_epi32(a, b)
+#   define XXTEA_XOR(a, b) _mm_xor_si128(a, b)
+#   define XXTEA_SRL(a, c) _mm_srli_epi32(a, c)
+#   define XXTEA_SLL(a, c) _mm_slli_epi32(a, c)
+#   define XXTEA_LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#   define XXTEA_STORE(p, a) _mm_storeu_si128((__m128i*)(p), a)
+#endif
+
+static void xxtea_enc_lanes(uint32_t* const* msgs,
+    const uint32_t n,
+    const uint32_t* const* keys,
+    xxtea_vec* work)
+{
+    uint32_t lanes[XXTEA_LANES];
+    xxtea_vec k[4];
+    xxtea_vec y, z, s, mx;
+    uint32_t sum, e, p, q, i;
+
+    for (p = 0; p < 4; ++p)
+    {
+        for (i = 0; i < XXTEA_LANES; ++i)
+            lanes[i] = keys[i][p];
+        k[p] = XXTEA_LOAD(lanes);
+    }
+    for (p = 0; p < n; ++p)
+    {
+        for (i = 0; i < XXTEA_LANES; ++i)
+            lanes[i] = msgs[i][p];
+        work[p] = XXTEA_LOAD(lanes);
+    }
+
+    z = work[n - 1];
+    q = 6 + 52 / n;
+    sum = 0;
+
+    while (q--)
+    {
+        sum += tea_delta;
+        e = (sum >> 2) & 3;
+        s = XXTEA_SET1(sum);
+
+        for (p = 0; p < n; ++p)
+        {
+            y = work[p + 1 < n ? p + 1 : 0];
+            mx = XXTEA_ADD(
+                XXTEA_XOR(
+                    XXTEA_ADD(XXTEA_XOR(XXTEA_SRL(z, 5), XXTEA_SLL(y, 2)), XXTEA_XOR(XXTEA_SRL(y, 3), XXTEA_SLL(z, 4))),
+                    XXTEA_XOR(s, y)),
+                XXTEA_XOR(k[(p & 3) ^ e], z));
+            z = work[p] = XXTEA_ADD(work[p], mx);
+        }
+    }
+
+    for (p = 0; p < n; ++p)
+    {
+        XXTEA_STORE(lanes, work[p]);
+        for (i = 0; i < XXTEA_LANES; ++i)
+            msgs[i][p] = lanes[i];
+    }
+}
+
+typedef struct
+{
+    uint32_t n;
+    size_t index;
+} xxtea_batch_item;
+
+static int xxtea_compare_items(const void* a, const void* b)
+{
+    const xxtea_batch_item* ia = (const xxtea_batch_item*)a;
+    const xxtea_batch_item* ib = (const xxtea_batch_item*)b;
+    if (ia->n != ib->n)
+        return ia->n < ib->n ? -1 : 1;
+    return ia->index < ib->index ? -1 : (ia->index > ib->index);
+}
+
+void xxtea_enc_batch(uint32_t* const* msgs,
+    const uint32_t* n,
+    const uint32_t* const* keys,
+    const size_t count)
+{
+    uint32_t* laneMsgs[XXTEA_LANES];
+    const uint32_t* laneKeys[XXTEA_LANES];
+    xxtea_batch_item* items;
+    xxtea_vec* work;
+    size_t i, j, l;
+    uint32_t maxn = 0;
+
+    if (count < XXTEA_LANES)
+        goto scalar;
+
+    items = (xxtea_batch_item*)malloc(count * sizeof(xxtea_batch_item));
+    if (!items)
+        goto scalar;
+    for (i = 0; i < count; ++i)
+    {
+        items[i].n = n[i];
+        items[i].index = i;
+        if (n[i] > maxn)
+            maxn = n[i];
+    }
+    work = (xxtea_vec*)_mm_malloc(maxn * sizeof(xxtea_vec), sizeof(xxtea_vec));
+    if (!work)
+    {
+        free(items);
+        goto scalar;
+    }
+    /* Messages with the same length are next to each other */
+    qsort(items, count, sizeof(xxtea_batch_item), xxtea_compare_items);
+
+    i = 0;
+    while (i < count)
+    {
+        j = i;
+        while (j < count && items[j].n == items[i].n)
+            ++j;
+        while (j - i >= XXTEA_LANES && items[i].n > 1)
+        {
+            for (l = 0; l < XXTEA_LANES; ++l)
+            {
+                laneMsgs[l] = msgs[items[i + l].index];
+                laneKeys[l] = keys[items[i + l].index];
+            }
+            xxtea_enc_lanes(laneMsgs, items[i].n, laneKeys, work);
+            i += XXTEA_LANES;
+        }
+        for (; i < j; ++i)
+            xxtea_enc(msgs[items[i].index], items[i].n, keys[items[i].index]);
+    }
+
+    _mm_free(work);
+    free(items);
+    return;
+
+scalar:
+    for (i = 0; i < count; ++i)
+        xxtea_enc(msgs[i], n[i], keys[i]);
+}
+
+#else
+
+void xxtea_enc_batch(uint32_t* const* msgs,
+    const uint32_t* n,
+    const uint32_t* const* keys,
+    const size_t count)
+{
+    size_t i;
+    for (i = 0; i < count; ++i)
+        xxtea_enc(msgs[i], n[i], keys[i]);
+}
+
+#endif
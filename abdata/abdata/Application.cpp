@@ -29,6 +29,7 @@
 #include <abscommon/SimpleConfigManager.h>
 #include <abscommon/FileUtils.h>
 #include <abscommon/Scheduler.h>
+#include <abscommon/ThreadPool.h>
 #include <AB/Entities/Service.h>
 #include <AB/Entities/ServiceList.h>
 #include <abscommon/Utils.h>
@@ -45,7 +46,9 @@ Application::Application() :
     readonly_(false),
     ioService_(),
     flushInterval_(FLUSH_CACHE_MS),
-    cleanInterval_(CLEAN_CACHE_MS)
+    cleanInterval_(CLEAN_CACHE_MS),
+    flushBatchSize_(FLUSH_BATCH_SIZE),
+    dbWorkers_(DB_WORKERS)
 {
     programDescription_ = SERVER_PRODUCT_NAME;
     serverType_ = AB::Entities::ServiceTypeDataServer;
@@ -89,6 +92,8 @@ Application::~Application()
 {
     if (running_)
         Stop();
+    if (auto* pool = GetSubsystem<Asynch::ThreadPool>())
+        pool->Stop();
     GetSubsystem<Asynch::Scheduler>()->Stop();
     GetSubsystem<Asynch::Dispatcher>()->Stop();
 }
@@ -199,6 +204,8 @@ bool Application::LoadConfig()
 
     flushInterval_ = static_cast<uint32_t>(config->GetGlobalInt("flush_interval", flushInterval_));
     cleanInterval_ = static_cast<uint32_t>(config->GetGlobalInt("clean_interval", cleanInterval_));
+    flushBatchSize_ = static_cast<uint32_t>(config->GetGlobalInt("flush_batch_size", flushBatchSize_));
+    dbWorkers_ = static_cast<uint32_t>(config->GetGlobalInt("db_workers", dbWorkers_));
 
     if (serverPort_ == 0)
     {
@@ -223,6 +230,8 @@ void Application::PrintServerInfo()
     LOG_INFO << "  Config file: " << (configFile_.empty() ? "(empty)" : configFile_) << std::endl;
     LOG_INFO << "  Listening: " << Utils::ConvertIPToString(listenIp_) << ":" << serverPort_ << std::endl;
     LOG_INFO << "  Cache size: " << Utils::ConvertSize(maxSize_) << std::endl;
+    LOG_INFO << "  Flush batch size: " << flushBatchSize_ << std::endl;
+    LOG_INFO << "  DB workers: " << dbWorkers_ << std::endl;
     LOG_INFO << "  Log dir: " << (IO::Logger::logDir_.empty() ? "(empty)" : IO::Logger::logDir_) << std::endl;
     LOG_INFO << "  Readonly mode: " << (readonly_ ? "TRUE" : "false") << std::endl;
     LOG_INFO << "  Allowed IPs: ";
@@ -378,6 +387,9 @@ bool Application::Initialize(const std::vector<std::string>& args)
     }
     Subsystems::Instance.RegisterSubsystem<DB::Database>(db);
     LOG_INFO << "[done]" << std::endl;
+    // Without workers cache misses are loaded by the dispatcher
+    if (dbWorkers_ != 0)
+        Subsystems::Instance.CreateSubsystem<Asynch::ThreadPool>(static_cast<size_t>(dbWorkers_));
     if (!CheckDatabaseVersion())
         return false;
 
@@ -386,15 +398,70 @@ bool Application::Initialize(const std::vector<std::string>& args)
     return true;
 }
 
+void Application::HeartBeatTask()
+{
+    auto& provider = server_->GetStorageProvider();
+    const auto& flush = provider.GetFlushStats();
+    const auto cache = provider.GetCacheStats();
+    if (flush.flushes != lastFlushes_ || cache.evictions != lastEvictions_)
+    {
+        if (cache.evictionFailures != lastEvictionFailures_)
+            LOG_INFO << "Cache: ";
+        else
+            LOG_DEBUG << "Cache: ";
+        LOG_PLAIN << "records: " << cache.records << ", protected: " << cache.protectedRecords <<
+            ", size: " << Utils::ConvertSize(cache.size) << ", hits: " << cache.hits << ", misses: " << cache.misses <<
+            ", hit ratio: " << cache.GetHitRatio() << ", evictions: " << cache.evictions <<
+            ", eviction writes: " << cache.evictionWrites << ", eviction failures: " << cache.evictionFailures << std::endl;
+        lastEvictions_ = cache.evictions;
+        lastEvictionFailures_ = cache.evictionFailures;
+    }
+    if (flush.flushes != lastFlushes_)
+    {
+        // Records that could not be written are worth a line, successful flushes are not
+        if (flush.retries != lastRetries_)
+            LOG_INFO << "Flush: ";
+        else
+            LOG_DEBUG << "Flush: ";
+        LOG_PLAIN << "records: " << flush.lastRecords << ", transactions: " << flush.lastBatches <<
+            ", duration: " << flush.lastDuration <<
+            "ms, max: " << flush.maxDuration << "ms, retries: " << flush.retries <<
+            ", pending: " << flush.pendingRetries << std::endl;
+        lastFlushes_ = flush.flushes;
+        lastRetries_ = flush.retries;
+    }
+
+    AB::Entities::Service serv;
+    serv.uuid = GetServerId();
+    if (provider.EntityRead(serv))
+    {
+        serv.heartbeat = sa::time::tick();
+        if (!provider.EntityUpdate(serv))
+            LOG_ERROR << "Error updating service " << serv.uuid << std::endl;
+    }
+    else
+        LOG_ERROR << "Error reading service " << serv.uuid << std::endl;
+
+    if (running_)
+    {
+        GetSubsystem<Asynch::Scheduler>()->Add(
+            Asynch::CreateScheduledTask(AB::Entities::HEARTBEAT_INTERVAL, std::bind(&Application::HeartBeatTask, this))
+        );
+    }
+}
+
 void Application::Run()
 {
     GetSubsystem<Asynch::Dispatcher>()->Start();
     GetSubsystem<Asynch::Scheduler>()->Start();
+    if (auto* pool = GetSubsystem<Asynch::ThreadPool>())
+        pool->Start();
 
     server_ = ea::make_unique<Server>(ioService_, listenIp_, serverPort_, maxSize_, readonly_, whiteList_);
     auto& provider = server_->GetStorageProvider();
     provider.flushInterval_ = flushInterval_;
     provider.cleanInterval_ = cleanInterval_;
+    provider.flushBatchSize_ = flushBatchSize_;
 
     AB::Entities::Service serv;
     serv.uuid = GetServerId();
@@ -418,6 +485,9 @@ void Application::Run()
     provider.EntityInvalidate(sl);
 
     running_ = true;
+    GetSubsystem<Asynch::Scheduler>()->Add(
+        Asynch::CreateScheduledTask(AB::Entities::HEARTBEAT_INTERVAL, std::bind(&Application::HeartBeatTask, this))
+    );
     LOG_INFO << "Server is running" << std::endl;
     ioService_.run();
 }
@@ -38,8 +38,16 @@ private:
     ea::unique_ptr<Server> server_;
     uint32_t flushInterval_;
     uint32_t cleanInterval_;
+    uint32_t flushBatchSize_;
+    /// Number of threads loading records from DB, each with its own connection
+    uint32_t dbWorkers_;
     Net::IpList whiteList_;
+    uint64_t lastFlushes_{ 0 };
+    uint64_t lastRetries_{ 0 };
+    uint64_t lastEvictions_{ 0 };
+    uint64_t lastEvictionFailures_{ 0 };
     bool LoadConfig();
+    void HeartBeatTask();
     void PrintServerInfo();
     void ShowLogo();
     bool CheckDatabaseVersion();
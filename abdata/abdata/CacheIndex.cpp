@@ -21,41 +21,104 @@
 
 #include "CacheIndex.h"
 
-IO::DataKey CacheIndex::Next()
+void CacheIndex::Add(const IO::DataKey& key, size_t size)
 {
-    auto& rankIndex = dataItems_.get<1>();
-    auto first = rankIndex.begin();
-    const IO::DataKey retVal = first->key;
-    dataItems_.erase(retVal);
-    return retVal;
+    if (dataItems_.find(key) != dataItems_.end())
+    {
+        Resize(key, size);
+        Access(key);
+        return;
+    }
+    probation_.push_front({ key, size, Segment::Probation });
+    dataItems_.emplace(key, probation_.begin());
 }
 
-void CacheIndex::Add(const IO::DataKey& key)
+void CacheIndex::Access(const IO::DataKey& key)
 {
-    dataItems_.insert({ key, GetNextRank() });
+    auto keyItr = dataItems_.find(key);
+    if (keyItr == dataItems_.end())
+        return;
+
+    auto item = (*keyItr).second;
+    if ((*item).segment == Segment::Protected)
+    {
+        protected_.splice(protected_.begin(), protected_, item);
+        return;
+    }
+    if ((*item).size > maxProtectedItemSize_)
+    {
+        probation_.splice(probation_.begin(), probation_, item);
+        return;
+    }
+    Promote(item);
 }
 
-void CacheIndex::Refresh(const IO::DataKey& key)
+void CacheIndex::Promote(DataItemList::iterator item)
+{
+    (*item).segment = Segment::Protected;
+    protectedSize_ += (*item).size;
+    protected_.splice(protected_.begin(), probation_, item);
+    DemoteOverflow();
+}
+
+void CacheIndex::DemoteOverflow()
+{
+    // Keep at least the record just promoted
+    while (protectedSize_ > maxProtectedSize_ && protected_.size() > 1)
+    {
+        auto last = ea::prev(protected_.end());
+        (*last).segment = Segment::Probation;
+        protectedSize_ -= (*last).size;
+        // Demoted records are the most recently used in probation
+        probation_.splice(probation_.begin(), protected_, last);
+    }
+}
+
+void CacheIndex::Resize(const IO::DataKey& key, size_t size)
 {
-    uint64_t next = GetNextRank();
     auto keyItr = dataItems_.find(key);
-    dataItems_.modify(keyItr, [next](DataItem& d)
+    if (keyItr == dataItems_.end())
+        return;
+
+    auto item = (*keyItr).second;
+    if ((*item).segment == Segment::Protected)
     {
-        d.rank = next;
-    });
+        protectedSize_ = (protectedSize_ - (*item).size) + size;
+        (*item).size = size;
+        if (size > maxProtectedItemSize_)
+        {
+            (*item).segment = Segment::Probation;
+            protectedSize_ -= size;
+            probation_.splice(probation_.begin(), protected_, item);
+        }
+        else
+            DemoteOverflow();
+        return;
+    }
+    (*item).size = size;
 }
 
 void CacheIndex::Delete(const IO::DataKey& key)
 {
     auto keyItr = dataItems_.find(key);
-    if (keyItr != dataItems_.end())
+    if (keyItr == dataItems_.end())
+        return;
+
+    auto item = (*keyItr).second;
+    if ((*item).segment == Segment::Protected)
     {
-        dataItems_.erase(keyItr);
+        protectedSize_ -= (*item).size;
+        protected_.erase(item);
     }
+    else
+        probation_.erase(item);
+    dataItems_.erase(keyItr);
 }
 
 void CacheIndex::Clear()
 {
     dataItems_.clear();
-    currentRank_ = 0;
+    probation_.clear();
+    protected_.clear();
+    protectedSize_ = 0;
 }
@@ -21,49 +21,72 @@
 
 #pragma once
 
-#include <multi_index_container.hpp>
-#include <multi_index/hashed_index.hpp>
-#include <multi_index/member.hpp>
-#include <multi_index/identity.hpp>
-#include <multi_index/ordered_index.hpp>
+#include <cstring>
 #include <abscommon/DataKey.h>
+#include <eastl.hpp>
+#include <EASTL/list.h>
+#include <sa/Iteration.h>
 
+/// Segmented LRU. New records go to the probation segment, a record accessed
+/// again is moved to the protected segment. When the protected segment is full its
+/// least recently used records go back to probation. Eviction starts with the least
+/// recently used record in probation, so records used only once can not push out
+/// records used often. Records bigger than maxProtectedItemSize always stay in
+/// probation, a few huge lists won't push out many small hot records.
+/// All operations are O(1).
 class CacheIndex
 {
 private:
+    enum class Segment : uint8_t
+    {
+        Probation,
+        Protected
+    };
     struct DataItem
     {
         IO::DataKey key;
-        uint64_t rank;
-        bool operator<(const DataItem& e) const
-        {
-            return rank < e.rank;
-        }
+        size_t size;
+        Segment segment;
     };
-    using DataItemContainer = multi_index::multi_index_container
-    <
-        DataItem,
-        multi_index::indexed_by
-        <
-            multi_index::hashed_unique<multi_index::member<DataItem, IO::DataKey, &DataItem::key>>,
-            multi_index::ordered_unique<multi_index::member<DataItem, uint64_t, &DataItem::rank>>
-        >
-    >;
+    using DataItemList = ea::list<DataItem>;
+    /// Front is the most recently used
+    DataItemList probation_;
+    DataItemList protected_;
+    ea::unordered_map<IO::DataKey, DataItemList::iterator, std::hash<IO::DataKey>> dataItems_;
+    size_t protectedSize_{ 0 };
+    size_t maxProtectedSize_;
+    size_t maxProtectedItemSize_;
+    void Promote(DataItemList::iterator item);
+    void DemoteOverflow();
 public:
-    CacheIndex() :
-        currentRank_(0)
+    CacheIndex(size_t maxProtectedSize, size_t maxProtectedItemSize) :
+        maxProtectedSize_(maxProtectedSize),
+        maxProtectedItemSize_(maxProtectedItemSize)
     { }
-    IO::DataKey Next();
-    void Add(const IO::DataKey&);
-    void Refresh(const IO::DataKey&);
-    void Delete(const IO::DataKey&);
+    void Add(const IO::DataKey& key, size_t size);
+    /// The record was read or written
+    void Access(const IO::DataKey& key);
+    /// The record was replaced with data of a different size
+    void Resize(const IO::DataKey& key, size_t size);
+    void Delete(const IO::DataKey& key);
     void Clear();
-private:
-    uint64_t GetNextRank()
+    /// Visit the records in eviction order until the callback returns Iteration::Break.
+    /// The callback must not change the index.
+    template<typename Callback>
+    void VisitVictims(Callback&& callback) const
     {
-        // NOTE: Not thread safe
-        return currentRank_++;
+        for (auto it = probation_.rbegin(); it != probation_.rend(); ++it)
+        {
+            if (callback((*it).key) == Iteration::Break)
+                return;
+        }
+        for (auto it = protected_.rbegin(); it != protected_.rend(); ++it)
+        {
+            if (callback((*it).key) == Iteration::Break)
+                return;
+        }
     }
-    uint64_t currentRank_;
-    DataItemContainer dataItems_;
+    size_t GetCount() const { return dataItems_.size(); }
+    size_t GetProtectedCount() const { return protected_.size(); }
+    size_t GetProtectedSize() const { return protectedSize_; }
 };
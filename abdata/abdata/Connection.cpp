@@ -53,15 +53,17 @@ asio::ip::tcp::socket& Connection::GetSocket()
 void Connection::Start()
 {
     started_ = true;
-    data_.reset(new StorageData(3));
+    data_.reset(new StorageData(IO::REQUEST_HEADER_SIZE));
     auto self(shared_from_this());
-    asio::async_read(socket_, asio::buffer(*data_), asio::transfer_at_least(3),
+    asio::async_read(socket_, asio::buffer(*data_), asio::transfer_at_least(IO::REQUEST_HEADER_SIZE),
         [this, self](const asio::error_code& error, size_t /* bytes_transferred */)
     {
         if (!error)
         {
             opcode_ = static_cast<IO::OpCodes>(data_->at(0));
-            const uint16_t keySize = ToInt16(*data_, 1);
+            // The client matches the response by this ID
+            requestId_ = ToInt32(*data_, 1);
+            const uint16_t keySize = ToInt16(*data_, 5);
             if (keySize <= maxKeySize_)
                 StartReadKey(keySize);
             else
@@ -126,6 +128,8 @@ void Connection::StartCreateOperation()
             if (size == 0)
             {
                 LOG_ERROR << "Size = 0, bytes_transferred = " << bytes_transferred << std::endl;
+                // Other requests may be queued on this connection, so we must respond
+                AddTask(&Connection::SendStatusAndRestart, IO::ErrorCodes::OtherErrors, "No data");
                 return;
             }
             if (size <= maxDataSize_)
@@ -159,6 +163,8 @@ void Connection::StartUpdateDataOperation()
             if (size == 0)
             {
                 LOG_ERROR << "Size = 0, bytes_transferred = " << bytes_transferred << std::endl;
+                // Other requests may be queued on this connection, so we must respond
+                AddTask(&Connection::SendStatusAndRestart, IO::ErrorCodes::OtherErrors, "No data");
                 return;
             }
             if (size <= maxDataSize_)
@@ -192,6 +198,8 @@ void Connection::StartReadOperation()
             if (size == 0)
             {
                 LOG_ERROR << "Size = 0, bytes_transferred = " << bytes_transferred << std::endl;
+                // Other requests may be queued on this connection, so we must respond
+                AddTask(&Connection::SendStatusAndRestart, IO::ErrorCodes::OtherErrors, "No data");
                 return;
             }
             if (size <= maxDataSize_)
@@ -249,6 +257,8 @@ void Connection::StartExistsOperation()
             if (size == 0)
             {
                 LOG_ERROR << "Size = 0, bytes_transferred = " << bytes_transferred << std::endl;
+                // Other requests may be queued on this connection, so we must respond
+                AddTask(&Connection::SendStatusAndRestart, IO::ErrorCodes::OtherErrors, "No data");
                 return;
             }
             if (size <= maxDataSize_)
@@ -366,27 +376,23 @@ void Connection::HandleReadReadRawData(const asio::error_code& error, size_t byt
 
 void Connection::ReadDataTask()
 {
-    bool res = storageProvider_.Read(id_, key_, data_);
-
-    if (!res)
+    // A cache miss is loaded by a DB worker, the callback is called from the dispatcher thread
+    auto self = shared_from_this();
+    storageProvider_.ReadAsync(id_, key_, data_, [this, self](bool success)
     {
-        SendStatusAndRestart(IO::ErrorCodes::OtherErrors, "Error");
-        return;
-    }
-
-    uint8_t header[] = {
-        static_cast<uint8_t>(IO::OpCodes::Data),
-        static_cast<uint8_t>(data_->size()),
-        static_cast<uint8_t>(data_->size() >> 8),
-        static_cast<uint8_t>(data_->size() >> 16),
-        static_cast<uint8_t>(data_->size() >> 24)
-    };
+        if (!success)
+        {
+            SendStatusAndRestart(IO::ErrorCodes::OtherErrors, "Error");
+            return;
+        }
 
-    std::vector<asio::mutable_buffer> bufs = {
-        asio::buffer(header),
-        asio::buffer(*data_.get())
-    };
-    SendResponseAndStart(bufs, data_->size() + 4);
+        WriteResponseHeader(IO::OpCodes::Data, data_->size());
+        std::vector<asio::mutable_buffer> bufs = {
+            asio::buffer(responseHeader_),
+            asio::buffer(*data_.get())
+        };
+        SendResponseAndStart(bufs, data_->size() + IO::RESPONSE_HEADER_SIZE);
+    });
 }
 
 void Connection::HandleExistsReadRawData(const asio::error_code& error, size_t bytes_transferred, size_t expected)
@@ -479,28 +485,33 @@ void Connection::StartClientRequestedOp()
     }
 }
 
+void Connection::WriteResponseHeader(IO::OpCodes opCode, size_t size)
+{
+    responseHeader_[0] = static_cast<uint8_t>(opCode);
+    responseHeader_[1] = static_cast<uint8_t>(requestId_);
+    responseHeader_[2] = static_cast<uint8_t>(requestId_ >> 8);
+    responseHeader_[3] = static_cast<uint8_t>(requestId_ >> 16);
+    responseHeader_[4] = static_cast<uint8_t>(requestId_ >> 24);
+    responseHeader_[5] = static_cast<uint8_t>(size);
+    responseHeader_[6] = static_cast<uint8_t>(size >> 8);
+    responseHeader_[7] = static_cast<uint8_t>(size >> 16);
+    responseHeader_[8] = static_cast<uint8_t>(size >> 24);
+}
+
 void Connection::SendStatusAndRestart(IO::ErrorCodes code, const std::string& message)
 {
     data_.reset(new StorageData);
     size_t length = std::min((size_t)255, message.length());
-    data_->reserve(length + 5);
-    data_->push_back(static_cast<uint8_t>(IO::OpCodes::Status));
+    data_->reserve(length + 1);
     data_->push_back(static_cast<uint8_t>(code));
-    data_->push_back(0);
-    data_->push_back(0);
-    data_->push_back(0);
+    data_->insert(data_->end(), message.begin(), message.begin() + static_cast<std::ptrdiff_t>(length));
 
-    data_->push_back(static_cast<uint8_t>(length));
-    size_t len = 0;
-    for (const auto& letter : message)
-    {
-        data_->push_back(static_cast<uint8_t>(letter));
-        ++len;
-        if (len >= 255)
-            break;
-    }
-    std::vector<asio::mutable_buffer> bufs = { asio::buffer(*data_) };
-    SendResponseAndStart(bufs, data_->size());
+    WriteResponseHeader(IO::OpCodes::Status, data_->size());
+    std::vector<asio::mutable_buffer> bufs = {
+        asio::buffer(responseHeader_),
+        asio::buffer(*data_)
+    };
+    SendResponseAndStart(bufs, data_->size() + IO::RESPONSE_HEADER_SIZE);
 }
 
 void Connection::SendResponseAndStart(std::vector<asio::mutable_buffer>& resp, size_t size)
@@ -81,6 +81,7 @@ private:
     void StartReadKey(uint16_t keySize);
     void SendResponseAndStart(std::vector<asio::mutable_buffer>& resp, size_t size);
     void SendStatusAndRestart(IO::ErrorCodes code, const std::string& message);
+    void WriteResponseHeader(IO::OpCodes opCode, size_t size);
 
     static inline uint32_t ToInt32(const StorageData& intBytes, size_t start)
     {
@@ -99,6 +100,9 @@ private:
     ConnectionManager& connectionManager_;
     StorageProvider& storageProvider_;
     IO::OpCodes opcode_{ IO::OpCodes::None };
+    uint32_t requestId_{ 0 };
+    /// Must stay valid until the response was written
+    uint8_t responseHeader_[IO::RESPONSE_HEADER_SIZE];
     std::mutex lock_;
 
     IO::DataKey key_;
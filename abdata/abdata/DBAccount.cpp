@@ -20,77 +20,46 @@
  */
 
 #include "DBAccount.h"
-#include <sa/Assert.h>
-#include <sa/TemplateParser.h>
 #include <uuid.h>
 #include <abscommon/Profiler.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Account& account, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid" || token.value == "account_uuid")
-            return db->EscapeString(account.uuid);
-        if (token.value == "name")
-            return db->EscapeString(account.name);
-        if (token.value == "password")
-            return db->EscapeString(account.password);
-        if (token.value == "email")
-            return db->EscapeString(account.email);
-        if (token.value == "auth_token")
-            return db->EscapeString(account.authToken);
-        if (token.value == "auth_token_expiry")
-            return std::to_string(account.authTokenExpiry);
-        if (token.value == "type")
-            return std::to_string(static_cast<int>(account.type));
-        if (token.value == "status")
-            return std::to_string(static_cast<int>(account.status));
-        if (token.value == "creation")
-            return std::to_string(account.creation);
-        if (token.value == "char_slots")
-            return std::to_string(account.charSlots);
-        if (token.value == "current_character_uuid")
-            return db->EscapeString(account.currentCharacterUuid);
-        if (token.value == "current_server_uuid")
-            return db->EscapeString(account.currentServerUuid);
-        if (token.value == "online_status")
-            return std::to_string(static_cast<int>(account.onlineStatus));
-        if (token.value == "guild_uuid")
-            return db->EscapeString(account.guildUuid);
-        if (token.value == "chest_size")
-            return std::to_string(account.chest_size);
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBAccount::Create(AB::Entities::Account& account)
 {
-    static constexpr const char* SQL =
+    static constexpr DBStatement SQL(
         "INSERT INTO accounts ("
             "uuid, name, password, email, type, status, creation, "
             "char_slots, current_server_uuid, online_status, guild_uuid, chest_size "
         ") VALUES ( "
             "${uuid}, ${name}, ${password}, ${email}, ${type}, ${status}, ${creation}, "
             "${char_slots}, ${current_server_uuid}, ${online_status}, ${guild_uuid}, ${chest_size}"
-        ")";
+        ")");
     if (Utils::Uuid::IsEmpty(account.uuid))
     {
         LOG_ERROR << "UUID is empty" << std::endl;
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, account, std::placeholders::_1))))
+    DBParams params;
+    params.Add(account.uuid)
+        .Add(account.name)
+        .Add(account.password)
+        .Add(account.email)
+        .Add(account.type)
+        .Add(account.status)
+        .Add(account.creation)
+        .Add(account.charSlots)
+        .Add(account.currentServerUuid)
+        .Add(account.onlineStatus)
+        .Add(account.guildUuid)
+        .Add(account.chest_size);
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     if (!transaction.Commit())
@@ -101,28 +70,24 @@ bool DBAccount::Create(AB::Entities::Account& account)
 
 bool DBAccount::Load(AB::Entities::Account& account)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL_UUID = "SELECT * FROM accounts WHERE uuid = ${uuid}";
-    static constexpr const char* SQL_NAME = "SELECT * FROM accounts WHERE name = ${name}";
+    static constexpr DBStatement SQL_UUID("SELECT * FROM accounts WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_NAME("SELECT * FROM accounts WHERE name = ${name}");
 
-    const char* sql = nullptr;
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(account.uuid))
-        sql = SQL_UUID;
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(account.uuid));
     else if (!account.name.empty())
-        sql = SQL_NAME;
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(account.name));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-    ASSERT(sql);
-
-    const std::string query = sa::templ::Parser::Evaluate(sql, std::bind(&PlaceholderCallback, db, account, std::placeholders::_1));
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
     {
-        LOG_ERROR << "No record found for " << query << std::endl;
+        LOG_ERROR << "No record found for account " << account.uuid << " " << account.name << std::endl;
         return false;
     }
 
@@ -149,11 +114,11 @@ bool DBAccount::Load(AB::Entities::Account& account)
 
 void DBAccount::LoadCharacters(AB::Entities::Account& account)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
     account.characterUuids.clear();
-    static constexpr const char* SQL = "SELECT uuid, name FROM players WHERE account_uuid = ${account_uuid} ORDER BY name";
+    static constexpr DBStatement SQL("SELECT uuid, name FROM players WHERE account_uuid = ${account_uuid} ORDER BY name");
 
-    for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, account, std::placeholders::_1))); result; result = result->Next())
+    for (std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(account.uuid)); result; result = result->Next())
     {
         account.characterUuids.push_back(result->GetString("uuid"));
     }
@@ -167,7 +132,7 @@ bool DBAccount::Save(const AB::Entities::Account& account)
         return false;
     }
 
-    static constexpr const char* SQL = "UPDATE accounts SET "
+    static constexpr DBStatement SQL("UPDATE accounts SET "
         "password = ${password}, "
         "email = ${email}, "
         "auth_token = ${auth_token}, "
@@ -180,14 +145,28 @@ bool DBAccount::Save(const AB::Entities::Account& account)
         "online_status = ${online_status}, "
         "guild_uuid = ${guild_uuid}, "
         "chest_size = ${chest_size} "
-        "WHERE uuid = ${uuid}";
+        "WHERE uuid = ${uuid}");
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, account, std::placeholders::_1))))
+    DBParams params;
+    params.Add(account.password)
+        .Add(account.email)
+        .Add(account.authToken)
+        .Add(account.authTokenExpiry)
+        .Add(account.type)
+        .Add(account.status)
+        .Add(account.charSlots)
+        .Add(account.currentCharacterUuid)
+        .Add(account.currentServerUuid)
+        .Add(account.onlineStatus)
+        .Add(account.guildUuid)
+        .Add(account.chest_size)
+        .Add(account.uuid);
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -201,16 +180,15 @@ bool DBAccount::Delete(const AB::Entities::Account& account)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "DELETE FROM accounts WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, account, std::placeholders::_1));
+    static constexpr DBStatement SQL("DELETE FROM accounts WHERE uuid = ${uuid}");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(account.uuid)))
         return false;
 
     return transaction.Commit();
@@ -218,26 +196,21 @@ bool DBAccount::Delete(const AB::Entities::Account& account)
 
 bool DBAccount::Exists(const AB::Entities::Account& account)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL_UUID = "SELECT COUNT(*) AS count FROM accounts WHERE uuid = ${uuid}";
-    static constexpr const char* SQL_NAME = "SELECT COUNT(*) AS count FROM accounts WHERE name = ${name}";
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM accounts WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_NAME("SELECT COUNT(*) AS count FROM accounts WHERE name = ${name}");
 
-    const char* sql = nullptr;
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(account.uuid))
-        sql = SQL_UUID;
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(account.uuid));
     else if (!account.name.empty())
-        sql = SQL_NAME;
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(account.name));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-    ASSERT(sql);
-
-    const std::string query = sa::templ::Parser::Evaluate(sql, std::bind(&PlaceholderCallback, db, account, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -245,7 +218,7 @@ bool DBAccount::Exists(const AB::Entities::Account& account)
 
 bool DBAccount::LogoutAll()
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
     static const std::string query = "UPDATE accounts SET online_status = 0";
     DBTransaction transaction(db);
     if (!transaction.Begin())
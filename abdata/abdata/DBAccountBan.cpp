@@ -20,28 +20,9 @@
  */
 
 #include "DBAccountBan.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::AccountBan& ban, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(ban.uuid);
-        if (token.value == "ban_uuid")
-            return db->EscapeString(ban.banUuid);
-        if (token.value == "account_uuid")
-            return db->EscapeString(ban.accountUuid);
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBAccountBan::Create(AB::Entities::AccountBan& ban)
 {
     if (Utils::Uuid::IsEmpty(ban.uuid))
@@ -50,20 +31,18 @@ bool DBAccountBan::Create(AB::Entities::AccountBan& ban)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    static constexpr const char* SQL = "INSERT INTO account_bans ("
+    static constexpr DBStatement SQL("INSERT INTO account_bans ("
                 "uuid, ban_uuid, account_uuid"
             ") VALUES ("
                 "${uuid}, ${ban_uuid}, ${account_uuid}"
-            ")";
+            ")");
 
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
-
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(ban.uuid).Add(ban.banUuid).Add(ban.accountUuid)))
         return false;
 
     return transaction.Commit();
@@ -71,24 +50,21 @@ bool DBAccountBan::Create(AB::Entities::AccountBan& ban)
 
 bool DBAccountBan::Load(AB::Entities::AccountBan& ban)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL_UUID = "SELECT * FROM account_bans WHERE uuid = ${uuid}";
-    static constexpr const char* SQL_ACCOUNT = "SELECT * FROM account_bans WHERE account_uuid = ${account_uuid}";
+    static constexpr DBStatement SQL_UUID("SELECT * FROM account_bans WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_ACCOUNT("SELECT * FROM account_bans WHERE account_uuid = ${account_uuid}");
 
-    const char* sql = nullptr;
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(ban.uuid))
-        sql = SQL_UUID;
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(ban.uuid));
     else if (!ban.accountUuid.empty())
-        sql = SQL_ACCOUNT;
+        result = db->StorePrepared(SQL_ACCOUNT, DBParams().Add(ban.accountUuid));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-    const std::string query = sa::templ::Parser::Evaluate(sql, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -107,18 +83,18 @@ bool DBAccountBan::Save(const AB::Entities::AccountBan& ban)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "UPDATE account_bans SET "
+    static constexpr DBStatement SQL("UPDATE account_bans SET "
         "ban_uuid = ${ban_uuid}, "
-        "account_uuid = ${account_uuid}, "
-        "WHERE uuid = ${uuid}";
+        "account_uuid = ${account_uuid} "
+        "WHERE uuid = ${uuid}");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1))))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(ban.banUuid).Add(ban.accountUuid).Add(ban.uuid)))
         return false;
 
     return transaction.Commit();
@@ -132,15 +108,14 @@ bool DBAccountBan::Delete(const AB::Entities::AccountBan& ban)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "DELETE FROM account_bans WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("DELETE FROM account_bans WHERE uuid = ${uuid}");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(ban.uuid)))
         return false;
 
     return transaction.Commit();
@@ -148,25 +123,21 @@ bool DBAccountBan::Delete(const AB::Entities::AccountBan& ban)
 
 bool DBAccountBan::Exists(const AB::Entities::AccountBan& ban)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL_UUID = "SELECT COUNT(*) AS count FROM account_bans WHERE uuid = ${uuid}";
-    static constexpr const char* SQL_ACCOUNT = "SELECT COUNT(*) AS count FROM account_bans WHERE account_uuid = ${account_uuid}";
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM account_bans WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_ACCOUNT("SELECT COUNT(*) AS count FROM account_bans WHERE account_uuid = ${account_uuid}");
 
-    const char* sql = nullptr;
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(ban.uuid))
-        sql = SQL_UUID;
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(ban.uuid));
     else if (!ban.accountUuid.empty())
-        sql = SQL_ACCOUNT;
+        result = db->StorePrepared(SQL_ACCOUNT, DBParams().Add(ban.accountUuid));
     else
     {
         LOG_ERROR << "UUID and Account UUID are empty" << std::endl;
         return false;
     }
-
-    const std::string query = sa::templ::Parser::Evaluate(sql, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -20,7 +20,6 @@
  */
 
 #include "DBAccountBanList.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
@@ -43,24 +42,11 @@ bool DBAccountBanList::Load(AB::Entities::AccountBanList& il)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT ban_uuid FROM account_bans WHERE account_uuid = ${account_uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, [db, &il](const sa::templ::Token& token) -> std::string
-    {
-        switch (token.type)
-        {
-        case sa::templ::Token::Type::Variable:
-            if (token.value == "account_uuid")
-                return db->EscapeString(il.uuid);
-            LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-            return "";
-        default:
-            return token.value;
-        }
-    });
+    static constexpr DBStatement SQL("SELECT ban_uuid FROM account_bans WHERE account_uuid = ${account_uuid}");
 
-    for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
+    for (std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(il.uuid)); result; result = result->Next())
     {
         il.uuids.push_back(result->GetString("ban_uuid"));
     }
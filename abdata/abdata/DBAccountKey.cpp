@@ -20,35 +20,26 @@
  */
 
 #include "DBAccountKey.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::AccountKey& ak, const sa::templ::Token& token)
+// Status and key type are optional filters, index 1 = status, 2 = key type, 3 = both
+static std::shared_ptr<DB::DBResult> SelectKey(Database* db, const AB::Entities::AccountKey& ak, const DBStatement (&statements)[4])
 {
-    switch (token.type)
+    size_t index = 0;
+    DBParams params;
+    params.Add(ak.uuid);
+    if (ak.status != AB::Entities::AccountKeyStatus::KeyStatusUnknown)
+    {
+        params.Add(ak.status);
+        index |= 1;
+    }
+    if (ak.type != AB::Entities::AccountKeyType::KeyTypeUnknown)
     {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(ak.uuid);
-        if (token.value == "used")
-            return std::to_string(ak.used);
-        if (token.value == "total")
-            return std::to_string(ak.total);
-        if (token.value == "description")
-            return db->EscapeString(ak.description);
-        if (token.value == "status")
-            return std::to_string(static_cast<int>(ak.status));
-        if (token.value == "key_type")
-            return std::to_string(static_cast<int>(ak.type));
-        if (token.value == "email")
-            return db->EscapeString(ak.email);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
+        params.Add(ak.type);
+        index |= 2;
     }
+    return db->StorePrepared(statements[index], params);
 }
 
 bool DBAccountKey::Create(AB::Entities::AccountKey& ak)
@@ -59,19 +50,26 @@ bool DBAccountKey::Create(AB::Entities::AccountKey& ak)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "INSERT INTO account_keys ("
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("INSERT INTO account_keys ("
             "uuid, used, total, description, status, key_type, email"
         ") VALUES ( "
             "${uuid}, ${used}, ${total}, ${description}, ${status}, ${key_type}, ${email}"
-        ")";
+        ")");
 
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ak, std::placeholders::_1));
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    DBParams params;
+    params.Add(ak.uuid)
+        .Add(ak.used)
+        .Add(ak.total)
+        .Add(ak.description)
+        .Add(ak.status)
+        .Add(ak.type)
+        .Add(ak.email);
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     // End transaction
@@ -89,18 +87,16 @@ bool DBAccountKey::Load(AB::Entities::AccountKey& ak)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT * FROM account_keys WHERE uuid = ${uuid}");
-    if (ak.status != AB::Entities::AccountKeyStatus::KeyStatusUnknown)
-        parser.Append(" AND status = ${status}", tokens);
-    if (ak.type != AB::Entities::AccountKeyType::KeyTypeUnknown)
-        parser.Append(" AND key_type = ${key_type}", tokens);
+    static constexpr DBStatement SQL[] = {
+        DBStatement("SELECT * FROM account_keys WHERE uuid = ${uuid}"),
+        DBStatement("SELECT * FROM account_keys WHERE uuid = ${uuid} AND status = ${status}"),
+        DBStatement("SELECT * FROM account_keys WHERE uuid = ${uuid} AND key_type = ${key_type}"),
+        DBStatement("SELECT * FROM account_keys WHERE uuid = ${uuid} AND status = ${status} AND key_type = ${key_type}")
+    };
 
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, ak, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = SelectKey(db, ak, SQL);
     if (!result)
         return false;
 
@@ -122,24 +118,30 @@ bool DBAccountKey::Save(const AB::Entities::AccountKey& ak)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "UPDATE account_keys SET "
+    static constexpr DBStatement SQL("UPDATE account_keys SET "
         "used = ${used}, "
         "total = ${total}, "
         "description = ${description}, "
         "status = ${status}, "
         "key_type = ${key_type}, "
         "email = ${email} "
-        "WHERE uuid = ${uuid}";
-
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ak, std::placeholders::_1));
+        "WHERE uuid = ${uuid}");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    DBParams params;
+    params.Add(ak.used)
+        .Add(ak.total)
+        .Add(ak.description)
+        .Add(ak.status)
+        .Add(ak.type)
+        .Add(ak.email)
+        .Add(ak.uuid);
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -159,18 +161,16 @@ bool DBAccountKey::Exists(const AB::Entities::AccountKey& ak)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT COUNT(*) AS count FROM account_keys WHERE uuid = ${uuid}");
-    if (ak.status != AB::Entities::AccountKeyStatus::KeyStatusUnknown)
-        parser.Append(" AND status = ${status}", tokens);
-    if (ak.type != AB::Entities::AccountKeyType::KeyTypeUnknown)
-        parser.Append(" AND key_type = ${key_type}", tokens);
+    Database* db = Database::Get();
 
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, ak, std::placeholders::_1));
+    static constexpr DBStatement SQL[] = {
+        DBStatement("SELECT COUNT(*) AS count FROM account_keys WHERE uuid = ${uuid}"),
+        DBStatement("SELECT COUNT(*) AS count FROM account_keys WHERE uuid = ${uuid} AND status = ${status}"),
+        DBStatement("SELECT COUNT(*) AS count FROM account_keys WHERE uuid = ${uuid} AND key_type = ${key_type}"),
+        DBStatement("SELECT COUNT(*) AS count FROM account_keys WHERE uuid = ${uuid} AND status = ${status} AND key_type = ${key_type}")
+    };
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = SelectKey(db, ak, SQL);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
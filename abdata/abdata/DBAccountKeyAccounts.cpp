@@ -20,27 +20,9 @@
  */
 
 #include "DBAccountKeyAccounts.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::AccountKeyAccounts& ak, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "account_uuid")
-            return db->EscapeString(ak.accountUuid);
-        if (token.value == "account_key_uuid")
-            return db->EscapeString(ak.uuid);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBAccountKeyAccounts::Create(AB::Entities::AccountKeyAccounts& ak)
 {
     if (Utils::Uuid::IsEmpty(ak.uuid) || Utils::Uuid::IsEmpty(ak.accountUuid))
@@ -49,20 +31,19 @@ bool DBAccountKeyAccounts::Create(AB::Entities::AccountKeyAccounts& ak)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "INSERT INTO account_account_keys ("
+    static constexpr DBStatement SQL("INSERT INTO account_account_keys ("
             "account_uuid, account_key_uuid"
         ") VALUES ( "
             "${account_uuid}, ${account_key_uuid}"
-        ")";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ak, std::placeholders::_1));
+        ")");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(ak.accountUuid).Add(ak.uuid)))
         return false;
 
     // End transaction
@@ -80,14 +61,13 @@ bool DBAccountKeyAccounts::Load(AB::Entities::AccountKeyAccounts& ak)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT * FROM account_account_keys WHERE "
+    static constexpr DBStatement SQL("SELECT * FROM account_account_keys WHERE "
         "account_uuid = ${account_uuid} "
-        "AND account_key_uuid = ${account_key_uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ak, std::placeholders::_1));
+        "AND account_key_uuid = ${account_key_uuid}");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(ak.accountUuid).Add(ak.uuid));
     if (!result)
         return false;
 
@@ -116,14 +96,13 @@ bool DBAccountKeyAccounts::Exists(const AB::Entities::AccountKeyAccounts& ak)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT COUNT(*) AS count FROM account_account_keys WHERE "
+    static constexpr DBStatement SQL("SELECT COUNT(*) AS count FROM account_account_keys WHERE "
         "account_uuid = ${account_uuid} "
-        "AND account_key_uuid = ${account_key_uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ak, std::placeholders::_1));
+        "AND account_key_uuid = ${account_key_uuid}");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(ak.accountUuid).Add(ak.uuid));
     if (!result)
         return false;
 
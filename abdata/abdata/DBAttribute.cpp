@@ -20,33 +20,9 @@
  */
 
 #include "DBAttribute.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Attribute& attr, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(attr.uuid);
-        if (token.value == "idk")
-            return std::to_string(attr.index);
-        if (token.value == "profession_uuid")
-            return db->EscapeString(attr.professionUuid);
-        if (token.value == "name")
-            return db->EscapeString(attr.name);
-        if (token.value == "is_primary")
-            return std::to_string(attr.isPrimary ? 1 : 0);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBAttribute::Create(AB::Entities::Attribute&)
 {
     // Do nothing
@@ -55,23 +31,21 @@ bool DBAttribute::Create(AB::Entities::Attribute&)
 
 bool DBAttribute::Load(AB::Entities::Attribute& attr)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT * FROM game_attributes WHERE ");
+    static constexpr DBStatement SQL_UUID("SELECT * FROM game_attributes WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_INDEX("SELECT * FROM game_attributes WHERE idx = ${idx}");
 
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(attr.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(attr.uuid));
     else if (attr.index != AB::Entities::INVALID_INDEX)
-        parser.Append("idx = ${idx}", tokens);
+        result = db->StorePrepared(SQL_INDEX, DBParams().Add(attr.index));
     else
     {
         LOG_ERROR << "UUID and index are empty" << std::endl;
         return false;
     }
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, attr, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -98,23 +72,21 @@ bool DBAttribute::Delete(const AB::Entities::Attribute&)
 
 bool DBAttribute::Exists(const AB::Entities::Attribute& attr)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT COUNT(*) AS count FROM game_attributes WHERE ");
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM game_attributes WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_INDEX("SELECT COUNT(*) AS count FROM game_attributes WHERE idx = ${idx}");
 
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(attr.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(attr.uuid));
     else if (attr.index != AB::Entities::INVALID_INDEX)
-        parser.Append("idx = ${idx}", tokens);
+        result = db->StorePrepared(SQL_INDEX, DBParams().Add(attr.index));
     else
     {
         LOG_ERROR << "UUID and index are empty" << std::endl;
         return false;
     }
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, attr, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -20,39 +20,9 @@
  */
 
 #include "DBBan.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Ban& ban, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(ban.uuid);
-        if (token.value == "expires")
-            return std::to_string(ban.expires);
-        if (token.value == "added")
-            return std::to_string(ban.added);
-        if (token.value == "reason")
-            return std::to_string(static_cast<int>(ban.reason));
-        if (token.value == "active")
-            return std::to_string(ban.active ? 1 : 0);
-        if (token.value == "admin_uuid")
-            return db->EscapeString(ban.adminUuid);
-        if (token.value == "comment")
-            return db->EscapeString(ban.comment);
-        if (token.value == "hits")
-            return std::to_string(ban.hits);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBBan::Create(AB::Entities::Ban& ban)
 {
     if (Utils::Uuid::IsEmpty(ban.uuid))
@@ -61,21 +31,29 @@ bool DBBan::Create(AB::Entities::Ban& ban)
         return false;
     }
 
-    static constexpr const char* SQL = "INSERT INTO bans ("
+    static constexpr DBStatement SQL("INSERT INTO bans ("
             "uuid, expires, added, reason, active, admin_uuid, comment, hits"
         ") VALUES ("
             "${uuid}, ${expires}, ${added}, ${reason}, ${active}, ${admin_uuid}, ${comment}, ${hits}"
-        ")";
+        ")");
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
+    DBParams params;
+    params.Add(ban.uuid)
+        .Add(ban.expires)
+        .Add(ban.added)
+        .Add(ban.reason)
+        .Add(ban.active)
+        .Add(ban.adminUuid)
+        .Add(ban.comment)
+        .Add(ban.hits);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -89,12 +67,11 @@ bool DBBan::Load(AB::Entities::Ban& ban)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT * FROM bans WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
+    static constexpr DBStatement SQL("SELECT * FROM bans WHERE uuid = ${uuid}");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(ban.uuid));
     if (!result)
         return false;
 
@@ -118,7 +95,7 @@ bool DBBan::Save(const AB::Entities::Ban& ban)
         return false;
     }
 
-    static constexpr const char* SQL = "UPDATE bans SET "
+    static constexpr DBStatement SQL("UPDATE bans SET "
         "expires = ${expires}, "
         "added = ${added}, "
         "reason = ${reason}, "
@@ -126,16 +103,24 @@ bool DBBan::Save(const AB::Entities::Ban& ban)
         "admin_uuid = ${admin_uuid}, "
         "comment = ${comment}, "
         "hits = ${hits} "
-        "WHERE uuid = ${uuid}";
-
-    Database* db = GetSubsystem<Database>();
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
+        "WHERE uuid = ${uuid}");
+
+    Database* db = Database::Get();
+    DBParams params;
+    params.Add(ban.expires)
+        .Add(ban.added)
+        .Add(ban.reason)
+        .Add(ban.active)
+        .Add(ban.adminUuid)
+        .Add(ban.comment)
+        .Add(ban.hits)
+        .Add(ban.uuid);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -149,16 +134,15 @@ bool DBBan::Delete(const AB::Entities::Ban& ban)
         return false;
     }
 
-    static constexpr const char* SQL = "DELETE FROM bans WHERE uuid = ${uuid}";
+    static constexpr DBStatement SQL("DELETE FROM bans WHERE uuid = ${uuid}");
 
-    Database* db = GetSubsystem<Database>();
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
+    Database* db = Database::Get();
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(ban.uuid)))
         return false;
 
     return transaction.Commit();
@@ -172,12 +156,11 @@ bool DBBan::Exists(const AB::Entities::Ban& ban)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT COUNT(*) AS count FROM bans WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
+    static constexpr DBStatement SQL("SELECT COUNT(*) AS count FROM bans WHERE uuid = ${uuid}");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(ban.uuid));
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -20,69 +20,9 @@
  */
 
 #include "DBCharacter.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Character& character, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(character.uuid);
-        if (token.value == "profession")
-            return db->EscapeString(character.profession);
-        if (token.value == "profession2")
-            return db->EscapeString(character.profession2);
-        if (token.value == "profession_uuid")
-            return db->EscapeString(character.professionUuid);
-        if (token.value == "profession2_uuid")
-            return db->EscapeString(character.profession2Uuid);
-        if (token.value == "skills")
-            return db->EscapeString(character.skillTemplate);
-        if (token.value == "name")
-            return db->EscapeString(character.name);
-        if (token.value == "pvp")
-            return std::to_string(character.pvp ? 1 : 0);
-        if (token.value == "account_uuid")
-            return db->EscapeString(character.accountUuid);
-        if (token.value == "level")
-            return std::to_string(character.level);
-        if (token.value == "experience")
-            return std::to_string(character.xp);
-        if (token.value == "skillpoints")
-            return std::to_string(character.skillPoints);
-        if (token.value == "sex")
-            return std::to_string(static_cast<uint32_t>(character.sex));
-        if (token.value == "model_index")
-            return std::to_string(character.modelIndex);
-        if (token.value == "creation")
-            return std::to_string(character.creation);
-        if (token.value == "inventory_size")
-            return std::to_string(character.inventorySize);
-        if (token.value == "lastlogin")
-            return std::to_string(character.lastLogin);
-        if (token.value == "lastlogout")
-            return std::to_string(character.lastLogout);
-        if (token.value == "onlinetime")
-            return std::to_string(character.onlineTime);
-        if (token.value == "deleted")
-            return std::to_string(character.deletedTime);
-        if (token.value == "current_map_uuid")
-            return db->EscapeString(character.currentMapUuid);
-        if (token.value == "last_outpost_uuid")
-            return db->EscapeString(character.lastOutpostUuid);
-        if (token.value == "death_stats")
-            return db->EscapeBlob(character.deathStats.data(), character.deathStats.length());
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 // Player names are case insensitive. The DB needs a proper index for that:
 // CREATE INDEX players_name_ci_index ON players USING btree (lower(name))
 
@@ -94,20 +34,36 @@ bool DBCharacter::Create(AB::Entities::Character& character)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    static constexpr const char* SQL = "INSERT INTO players ("
+    static constexpr DBStatement SQL("INSERT INTO players ("
             "uuid, profession, profession2, profession_uuid, profession2_uuid, name, pvp, "
             "account_uuid, level, experience, skillpoints, sex, model_index, creation, inventory_size"
         ") VALUES ("
             "${uuid}, ${profession}, ${profession2}, ${profession_uuid}, ${profession2_uuid}, ${name}, ${pvp}, "
             "${account_uuid}, ${level}, ${experience}, ${skillpoints}, ${sex}, ${model_index}, ${creation}, ${inventory_size}"
-        ")";
-
-    if (!db->ExecuteQuery(sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, character, std::placeholders::_1))))
+        ")");
+
+    DBParams params;
+    params.Add(character.uuid)
+        .Add(character.profession)
+        .Add(character.profession2)
+        .Add(character.professionUuid)
+        .Add(character.profession2Uuid)
+        .Add(character.name)
+        .Add(character.pvp)
+        .Add(character.accountUuid)
+        .Add(character.level)
+        .Add(character.xp)
+        .Add(character.skillPoints)
+        .Add(character.sex)
+        .Add(character.modelIndex)
+        .Add(character.creation)
+        .Add(character.inventorySize);
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -115,25 +71,21 @@ bool DBCharacter::Create(AB::Entities::Character& character)
 
 bool DBCharacter::Load(AB::Entities::Character& character)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL_UUID = "SELECT * FROM players WHERE uuid= ${uuid}";
-    static constexpr const char* SQL_NAME = "SELECT * FROM players WHERE LOWER(name) = LOWER(${name})";
+    static constexpr DBStatement SQL_UUID("SELECT * FROM players WHERE uuid= ${uuid}");
+    static constexpr DBStatement SQL_NAME("SELECT * FROM players WHERE LOWER(name) = LOWER(${name})");
 
-    const char* sql = nullptr;
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(character.uuid))
-        sql = SQL_UUID;
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(character.uuid));
     else if (!character.name.empty())
-        sql = SQL_NAME;
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(character.name));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-
-    const std::string query = sa::templ::Parser::Evaluate(sql, std::bind(&PlaceholderCallback, db, character, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -172,12 +124,12 @@ bool DBCharacter::Save(const AB::Entities::Character& character)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    static constexpr const char* SQL = "UPDATE players SET "
+    static constexpr DBStatement SQL("UPDATE players SET "
         "profession2 = ${profession2}, "
         "profession2_uuid = ${profession2_uuid}, "
         "skills = ${skills}, "
@@ -192,9 +144,25 @@ bool DBCharacter::Save(const AB::Entities::Character& character)
         "last_outpost_uuid = ${last_outpost_uuid}, "
         "inventory_size = ${inventory_size}, "
         "death_stats = ${death_stats} "
-        "WHERE uuid = ${uuid}";
-
-    if (!db->ExecuteQuery(sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, character, std::placeholders::_1))))
+        "WHERE uuid = ${uuid}");
+
+    DBParams params;
+    params.Add(character.profession2)
+        .Add(character.profession2Uuid)
+        .Add(character.skillTemplate)
+        .Add(character.level)
+        .Add(character.xp)
+        .Add(character.skillPoints)
+        .Add(character.lastLogin)
+        .Add(character.lastLogout)
+        .Add(character.onlineTime)
+        .Add(character.deletedTime)
+        .Add(character.currentMapUuid)
+        .Add(character.lastOutpostUuid)
+        .Add(character.inventorySize)
+        .AddBlob(character.deathStats)
+        .Add(character.uuid);
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -208,15 +176,13 @@ bool DBCharacter::Delete(const AB::Entities::Character& character)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    static constexpr const char* SQL = "DELETE FROM players WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, character, std::placeholders::_1));
-
-    if (!db->ExecuteQuery(query))
+    static constexpr DBStatement SQL("DELETE FROM players WHERE uuid = ${uuid}");
+    if (!db->ExecutePrepared(SQL, DBParams().Add(character.uuid)))
         return false;
 
     return transaction.Commit();
@@ -224,25 +190,21 @@ bool DBCharacter::Delete(const AB::Entities::Character& character)
 
 bool DBCharacter::Exists(const AB::Entities::Character& character)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL_UUID = "SELECT COUNT(*) AS count FROM players WHERE uuid= ${uuid}";
-    static constexpr const char* SQL_NAME = "SELECT COUNT(*) AS count FROM players WHERE LOWER(name) = LOWER(${name})";
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM players WHERE uuid= ${uuid}");
+    static constexpr DBStatement SQL_NAME("SELECT COUNT(*) AS count FROM players WHERE LOWER(name) = LOWER(${name})");
 
-    const char* sql = nullptr;
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(character.uuid))
-        sql = SQL_UUID;
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(character.uuid));
     else if (!character.name.empty())
-        sql = SQL_NAME;
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(character.name));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-
-    const std::string query = sa::templ::Parser::Evaluate(sql, std::bind(&PlaceholderCallback, db, character, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -23,60 +23,10 @@
 #include "StorageProvider.h"
 #include <AB/Entities/GameInstance.h>
 #include <abscommon/Utils.h>
-#include <sa/TemplateParser.h>
 #include <sa/time.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::ConcreteItem& item, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(item.uuid);
-        if (token.value == "player_uuid")
-            return db->EscapeString(item.playerUuid);
-        if (token.value == "storage_place")
-            return std::to_string(static_cast<int>(item.storagePlace));
-        if (token.value == "storage_pos")
-            return std::to_string(item.storagePos);
-        if (token.value == "upgrade_1")
-            return db->EscapeString(item.upgrade1Uuid);
-        if (token.value == "upgrade_2")
-            return db->EscapeString(item.upgrade2Uuid);
-        if (token.value == "upgrade_3")
-            return db->EscapeString(item.upgrade3Uuid);
-        if (token.value == "account_uuid")
-            return db->EscapeString(item.accountUuid);
-        if (token.value == "item_uuid")
-            return db->EscapeString(item.itemUuid);
-        if (token.value == "stats")
-            return db->EscapeBlob(item.itemStats.data(), item.itemStats.length());
-        if (token.value == "count")
-            return std::to_string(item.count);
-        if (token.value == "creation")
-            return std::to_string(item.creation);
-        if (token.value == "deleted")
-            return std::to_string(item.deleted);
-        if (token.value == "value")
-            return std::to_string(item.value);
-        if (token.value == "instance_uuid")
-            return db->EscapeString(item.instanceUuid);
-        if (token.value == "map_uuid")
-            return db->EscapeString(item.mapUuid);
-        if (token.value == "flags")
-            return std::to_string(item.flags);
-        if (token.value == "sold")
-            return std::to_string(item.sold);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBConcreteItem::Create(AB::Entities::ConcreteItem& item)
 {
     if (Utils::Uuid::IsEmpty(item.uuid))
@@ -85,7 +35,7 @@ bool DBConcreteItem::Create(AB::Entities::ConcreteItem& item)
         return false;
     }
 
-    static constexpr const char* SQL = "INSERT INTO concrete_items ("
+    static constexpr DBStatement SQL("INSERT INTO concrete_items ("
             "uuid, player_uuid, storage_place, storage_pos, upgrade_1, upgrade_2, upgrade_3, "
             "account_uuid, item_uuid, stats, count, creation, deleted, value, instance_uuid, "
             "map_uuid, flags, sold"
@@ -93,17 +43,35 @@ bool DBConcreteItem::Create(AB::Entities::ConcreteItem& item)
             "${uuid}, ${player_uuid}, ${storage_place}, ${storage_pos}, ${upgrade_1}, ${upgrade_2}, ${upgrade_3}, "
             "${account_uuid}, ${item_uuid}, ${stats}, ${count}, ${creation}, ${deleted}, ${value}, ${instance_uuid}, "
             "${map_uuid}, ${flags}, ${sold}"
-        ")";
-
-    Database* db = GetSubsystem<Database>();
-
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, item, std::placeholders::_1));
+        ")");
+
+    Database* db = Database::Get();
+
+    DBParams params;
+    params.Add(item.uuid)
+        .Add(item.playerUuid)
+        .Add(item.storagePlace)
+        .Add(item.storagePos)
+        .Add(item.upgrade1Uuid)
+        .Add(item.upgrade2Uuid)
+        .Add(item.upgrade3Uuid)
+        .Add(item.accountUuid)
+        .Add(item.itemUuid)
+        .AddBlob(item.itemStats)
+        .Add(item.count)
+        .Add(item.creation)
+        .Add(item.deleted)
+        .Add(item.value)
+        .Add(item.instanceUuid)
+        .Add(item.mapUuid)
+        .Add(item.flags)
+        .Add(item.sold);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     if (!transaction.Commit())
@@ -120,12 +88,11 @@ bool DBConcreteItem::Load(AB::Entities::ConcreteItem& item)
         return false;
     }
 
-    static constexpr const char* SQL = "SELECT * FROM concrete_items WHERE uuid = ${uuid}";
+    static constexpr DBStatement SQL("SELECT * FROM concrete_items WHERE uuid = ${uuid}");
 
-    Database* db = GetSubsystem<Database>();
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, item, std::placeholders::_1));
+    Database* db = Database::Get();
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(item.uuid));
     if (!result)
         return false;
 
@@ -159,7 +126,7 @@ bool DBConcreteItem::Save(const AB::Entities::ConcreteItem& item)
         return false;
     }
 
-    static constexpr const char* SQL = "UPDATE concrete_items SET "
+    static constexpr DBStatement SQL("UPDATE concrete_items SET "
         "player_uuid = ${player_uuid}, "
         "storage_place = ${storage_place}, "
         "storage_pos = ${storage_pos}, "
@@ -177,15 +144,33 @@ bool DBConcreteItem::Save(const AB::Entities::ConcreteItem& item)
         "map_uuid = ${map_uuid}, "
         "flags = ${flags}, "
         "sold = ${sold} "
-        "WHERE uuid = ${uuid}";
+        "WHERE uuid = ${uuid}");
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, item, std::placeholders::_1));
-    if (!db->ExecuteQuery(query))
+    DBParams params;
+    params.Add(item.playerUuid)
+        .Add(item.storagePlace)
+        .Add(item.storagePos)
+        .Add(item.upgrade1Uuid)
+        .Add(item.upgrade2Uuid)
+        .Add(item.upgrade3Uuid)
+        .Add(item.accountUuid)
+        .Add(item.itemUuid)
+        .AddBlob(item.itemStats)
+        .Add(item.count)
+        .Add(item.creation)
+        .Add(item.deleted)
+        .Add(item.value)
+        .Add(item.instanceUuid)
+        .Add(item.mapUuid)
+        .Add(item.flags)
+        .Add(item.sold)
+        .Add(item.uuid);
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -199,16 +184,14 @@ bool DBConcreteItem::Delete(const AB::Entities::ConcreteItem& item)
         return false;
     }
 
-    static constexpr const char* SQL = "DELETE FROM concrete_items WHERE uuid = ${uuid}";
+    static constexpr DBStatement SQL("DELETE FROM concrete_items WHERE uuid = ${uuid}");
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, item, std::placeholders::_1));
-
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(item.uuid)))
         return false;
 
     return transaction.Commit();
@@ -222,14 +205,12 @@ bool DBConcreteItem::Exists(const AB::Entities::ConcreteItem& item)
         return false;
     }
 
-    static constexpr const char* SQL = "SELECT COUNT(*) AS count FROM concrete_items WHERE uuid = ${uuid}"
-        " AND deleted = 0";
-
-    Database* db = GetSubsystem<Database>();
+    static constexpr DBStatement SQL("SELECT COUNT(*) AS count FROM concrete_items WHERE uuid = ${uuid}"
+        " AND deleted = 0");
 
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, item, std::placeholders::_1));
+    Database* db = Database::Get();
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(item.uuid));
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -238,21 +219,18 @@ bool DBConcreteItem::Exists(const AB::Entities::ConcreteItem& item)
 void DBConcreteItem::Clean(StorageProvider* sp)
 {
     LOG_INFO << "Cleaning concrete items" << std::endl;
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT uuid, instance_uuid FROM concrete_items WHERE "
+    static constexpr DBStatement SQL("SELECT uuid, instance_uuid FROM concrete_items WHERE "
         "storage_place = ${storage_place} "
-        "AND deleted = 0";
-    AB::Entities::ConcreteItem dummyItem;
-    dummyItem.storagePlace = AB::Entities::StoragePlace::Scene;
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, dummyItem, std::placeholders::_1));
+        "AND deleted = 0");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(AB::Entities::StoragePlace::Scene));
     if (!result)
         return;
 
     std::vector<std::string> uuids;
-    for (result = db->StoreQuery(query); result; result = result->Next())
+    for (; result; result = result->Next())
     {
         AB::Entities::GameInstance instance;
         instance.uuid = result->GetString("instance_uuid");
@@ -20,27 +20,9 @@
  */
 
 #include "DBEffect.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Effect& effect, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(effect.uuid);
-        if (token.value == "idx")
-            return std::to_string(effect.index);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBEffect::Create(AB::Entities::Effect& effect)
 {
     // Do nothing
@@ -54,23 +36,21 @@ bool DBEffect::Create(AB::Entities::Effect& effect)
 
 bool DBEffect::Load(AB::Entities::Effect& effect)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT * FROM game_effects WHERE ");
+    static constexpr DBStatement SQL_UUID("SELECT * FROM game_effects WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_INDEX("SELECT * FROM game_effects WHERE idx = ${idx}");
+
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(effect.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(effect.uuid));
     else if (effect.index != 0)
-        parser.Append("idx = ${idx}", tokens);
+        result = db->StorePrepared(SQL_INDEX, DBParams().Add(effect.index));
     else
     {
         LOG_ERROR << "UUID and index are empty" << std::endl;
         return false;
     }
-
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, effect, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -110,23 +90,21 @@ bool DBEffect::Delete(const AB::Entities::Effect& effect)
 
 bool DBEffect::Exists(const AB::Entities::Effect& effect)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT COUNT(*) AS count FROM game_effects WHERE ");
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM game_effects WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_INDEX("SELECT COUNT(*) AS count FROM game_effects WHERE idx = ${idx}");
+
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(effect.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(effect.uuid));
     else if (effect.index != 0)
-        parser.Append("idx = ${idx}", tokens);
+        result = db->StorePrepared(SQL_INDEX, DBParams().Add(effect.index));
     else
     {
         LOG_ERROR << "UUID and index are empty" << std::endl;
         return false;
     }
-
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, effect, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
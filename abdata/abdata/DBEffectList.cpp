@@ -30,7 +30,7 @@ bool DBEffectList::Create(AB::Entities::EffectList&)
 
 bool DBEffectList::Load(AB::Entities::EffectList& el)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     static const std::string query = "SELECT uuid FROM game_effects";
     for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
@@ -20,47 +20,9 @@
  */
 
 #include "DBFriendList.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::FriendList& fl, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "account_uuid")
-            return db->EscapeString(fl.uuid);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
-static std::string PlaceholderCallbackFriend(Database* db, const AB::Entities::FriendList& fl, const AB::Entities::Friend& fr, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "account_uuid")
-            return db->EscapeString(fl.uuid);
-        if (token.value == "friend_uuid")
-            return db->EscapeString(fr.friendUuid);
-        if (token.value == "friend_name")
-            return db->EscapeString(fr.friendName);
-        if (token.value == "relation")
-            return std::to_string(static_cast<int>(fr.relation));
-        if (token.value == "creation")
-            return std::to_string(fr.creation);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
 
 bool DBFriendList::Create(AB::Entities::FriendList& fl)
 {
@@ -81,21 +43,17 @@ bool DBFriendList::Load(AB::Entities::FriendList& fl)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT * FROM friend_list WHERE account_uuid = ${account_uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, fl, std::placeholders::_1));
+    static constexpr DBStatement SQL("SELECT * FROM friend_list WHERE account_uuid = ${account_uuid}");
+    static constexpr DBRowMapping MAPPING(
+        DBField("friend_uuid", &AB::Entities::Friend::friendUuid),
+        DBField("friend_name", &AB::Entities::Friend::friendName),
+        DBField("relation", &AB::Entities::Friend::relation),
+        DBField("creation", &AB::Entities::Friend::creation));
 
     fl.friends.clear();
-    for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
-    {
-        fl.friends.push_back({
-            result->GetString("friend_uuid"),
-            result->GetString("friend_name"),
-            static_cast<AB::Entities::FriendRelation>(result->GetUInt("relation")),
-            result->GetLong("creation")
-        });
-    }
+    MAPPING.Load(db->StorePrepared(SQL, DBParams().Add(fl.uuid)), fl.friends);
     return true;
 }
 
@@ -107,32 +65,34 @@ bool DBFriendList::Save(const AB::Entities::FriendList& fl)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
     // First delete all
-    static constexpr const char* SQL_DELETE = "DELETE FROM friend_list WHERE account_uuid = ${account_uuid}";
-    const std::string deleteQuery = sa::templ::Parser::Evaluate(SQL_DELETE, std::bind(&PlaceholderCallback, db, fl, std::placeholders::_1));
-    if (!db->ExecuteQuery(deleteQuery))
+    static constexpr DBStatement SQL_DELETE("DELETE FROM friend_list WHERE account_uuid = ${account_uuid}");
+    if (!db->ExecutePrepared(SQL_DELETE, DBParams().Add(fl.uuid)))
         return false;
 
     if (fl.friends.size() > 0)
     {
-        static constexpr const char* SQL_INSERT = "INSERT INTO friend_list ("
+        static constexpr DBStatement SQL_INSERT("INSERT INTO friend_list ("
                 "account_uuid, friend_uuid, friend_name, relation, creation"
             ") VALUES ("
                 "${account_uuid}, ${friend_uuid}, ${friend_name}, ${relation}, ${creation}"
-            ")";
-        sa::templ::Parser parser;
-        const sa::templ::Tokens tokens = parser.Parse(SQL_INSERT);
+            ")");
 
         // Then add all
         for (const auto& f : fl.friends)
         {
-            const std::string insertQuery = tokens.ToString(std::bind(&PlaceholderCallbackFriend, db, fl, f, std::placeholders::_1));
-            if (!db->ExecuteQuery(insertQuery))
+            DBParams params;
+            params.Add(fl.uuid)
+                .Add(f.friendUuid)
+                .Add(f.friendName)
+                .Add(f.relation)
+                .Add(f.creation);
+            if (!db->ExecutePrepared(SQL_INSERT, params))
                 return false;
         }
     }
@@ -148,15 +108,14 @@ bool DBFriendList::Delete(const AB::Entities::FriendList& fl)
     }
 
     // Delete all friends of this account
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "DELETE FROM friend_list WHERE account_uuid = ${account_uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, fl, std::placeholders::_1));
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("DELETE FROM friend_list WHERE account_uuid = ${account_uuid}");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(fl.uuid)))
         return false;
 
     return transaction.Commit();
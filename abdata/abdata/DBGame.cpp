@@ -20,27 +20,9 @@
  */
 
 #include "DBGame.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Game& game, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(game.uuid);
-        if (token.value == "name")
-            return db->EscapeString(game.name);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBGame::Create(AB::Entities::Game&)
 {
     // Do nothing
@@ -49,23 +31,21 @@ bool DBGame::Create(AB::Entities::Game&)
 
 bool DBGame::Load(AB::Entities::Game& game)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT * FROM game_maps WHERE ");
+    static constexpr DBStatement SQL_UUID("SELECT * FROM game_maps WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_NAME("SELECT * FROM game_maps WHERE name = ${name}");
+
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(game.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(game.uuid));
     else if (!game.name.empty())
-        parser.Append("name = ${name}", tokens);
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(game.name));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, game, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -101,23 +81,21 @@ bool DBGame::Delete(const AB::Entities::Game&)
 
 bool DBGame::Exists(const AB::Entities::Game& game)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT COUNT(*) AS count FROM game_maps WHERE ");
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM game_maps WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_NAME("SELECT COUNT(*) AS count FROM game_maps WHERE name = ${name}");
+
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(game.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(game.uuid));
     else if (!game.name.empty())
-        parser.Append("name = ${name}", tokens);
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(game.name));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, game, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
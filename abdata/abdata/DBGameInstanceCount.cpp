@@ -30,7 +30,7 @@ bool DBGameInstanceCount::Create(AB::Entities::GameInstanceCount&)
 
 bool DBGameInstanceCount::Load(AB::Entities::GameInstanceCount& count)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     static const std::string query = "SELECT COUNT(*) AS count FROM instances";
     std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
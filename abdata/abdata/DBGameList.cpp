@@ -30,7 +30,7 @@ bool DBGameList::Create(AB::Entities::GameList&)
 
 bool DBGameList::Load(AB::Entities::GameList& game)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     static const std::string query = "SELECT uuid FROM game_maps";
     for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
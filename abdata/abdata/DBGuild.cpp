@@ -20,43 +20,9 @@
  */
 
 #include "DBGuild.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Guild& g, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(g.uuid);
-        if (token.value == "name")
-            return db->EscapeString(g.name);
-        if (token.value == "tag")
-            return db->EscapeString(g.tag);
-        if (token.value == "creator_account_uuid")
-            return db->EscapeString(g.creatorAccountUuid);
-        if (token.value == "creation")
-            return std::to_string(g.creation);
-        if (token.value == "guild_hall_uuid")
-            return db->EscapeString(g.guildHall);
-        if (token.value == "creator_name")
-            return db->EscapeString(g.creatorName);
-        if (token.value == "creator_player_uuid")
-            return db->EscapeString(g.creatorPlayerUuid);
-        if (token.value == "guild_hall_instance_uuid")
-            return db->EscapeString(g.guildHallInstanceUuid);
-        if (token.value == "guild_hall_server_uuid")
-            return db->EscapeString(g.guildHallServerUuid);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBGuild::Create(AB::Entities::Guild& g)
 {
     if (Utils::Uuid::IsEmpty(g.uuid))
@@ -65,22 +31,32 @@ bool DBGuild::Create(AB::Entities::Guild& g)
         return false;
     }
 
-    static constexpr const char* SQL = "INSERT INTO guilds ("
+    static constexpr DBStatement SQL("INSERT INTO guilds ("
             "uuid, name, tag, creator_account_uuid, creation, guild_hall_uuid, "
             "creator_name, creator_player_uuid, guild_hall_instance_uuid, guild_hall_server_uuid"
         ") VALUES ("
             "${uuid}, ${name}, ${tag}, ${creator_account_uuid}, ${creation}, ${guild_hall_uuid}, "
             "${creator_name}, ${creator_player_uuid}, ${guild_hall_instance_uuid}, ${guild_hall_server_uuid}"
-        ")";
+        ")");
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, g, std::placeholders::_1));
-    if (!db->ExecuteQuery(query))
+    DBParams params;
+    params.Add(g.uuid)
+        .Add(g.name)
+        .Add(g.tag)
+        .Add(g.creatorAccountUuid)
+        .Add(g.creation)
+        .Add(g.guildHall)
+        .Add(g.creatorName)
+        .Add(g.creatorPlayerUuid)
+        .Add(g.guildHallInstanceUuid)
+        .Add(g.guildHallServerUuid);
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -88,24 +64,21 @@ bool DBGuild::Create(AB::Entities::Guild& g)
 
 bool DBGuild::Load(AB::Entities::Guild& g)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL_UUID = "SELECT * FROM guilds WHERE uuid= ${uuid}";
-    static constexpr const char* SQL_NAME = "SELECT * FROM guilds WHERE LOWER(name) = LOWER(${name})";
+    static constexpr DBStatement SQL_UUID("SELECT * FROM guilds WHERE uuid= ${uuid}");
+    static constexpr DBStatement SQL_NAME("SELECT * FROM guilds WHERE LOWER(name) = LOWER(${name})");
 
-    const char* sql = nullptr;
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(g.uuid))
-        sql = SQL_UUID;
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(g.uuid));
     else if (!g.name.empty())
-        sql = SQL_NAME;
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(g.name));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-
-    const std::string query = sa::templ::Parser::Evaluate(sql, std::bind(&PlaceholderCallback, db, g, std::placeholders::_1));
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -131,9 +104,9 @@ bool DBGuild::Save(const AB::Entities::Guild& g)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "UPDATE guilds SET "
+    static constexpr DBStatement SQL("UPDATE guilds SET "
         "name = ${name}, "
         "tag = ${tag}, "
         "creator_account_uuid = ${creator_account_uuid}, "
@@ -143,15 +116,25 @@ bool DBGuild::Save(const AB::Entities::Guild& g)
         "creator_player_uuid = ${creator_player_uuid}, "
         "guild_hall_instance_uuid = ${guild_hall_instance_uuid}, "
         "guild_hall_server_uuid = ${guild_hall_server_uuid} "
-        "WHERE uuid = ${uuid}";
-
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, g, std::placeholders::_1));
+        "WHERE uuid = ${uuid}");
+
+    DBParams params;
+    params.Add(g.name)
+        .Add(g.tag)
+        .Add(g.creatorAccountUuid)
+        .Add(g.creation)
+        .Add(g.guildHall)
+        .Add(g.creatorName)
+        .Add(g.creatorPlayerUuid)
+        .Add(g.guildHallInstanceUuid)
+        .Add(g.guildHallServerUuid)
+        .Add(g.uuid);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -165,16 +148,15 @@ bool DBGuild::Delete(const AB::Entities::Guild& g)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "DELETE FROM guilds WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, g, std::placeholders::_1));
+    static constexpr DBStatement SQL("DELETE FROM guilds WHERE uuid = ${uuid}");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(g.uuid)))
         return false;
 
     return transaction.Commit();
@@ -182,25 +164,21 @@ bool DBGuild::Delete(const AB::Entities::Guild& g)
 
 bool DBGuild::Exists(const AB::Entities::Guild& g)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL_UUID = "SELECT COUNT(*) AS count FROM guilds WHERE uuid= ${uuid}";
-    static constexpr const char* SQL_NAME = "SELECT COUNT(*) AS count FROM guilds WHERE LOWER(name) = LOWER(${name})";
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM guilds WHERE uuid= ${uuid}");
+    static constexpr DBStatement SQL_NAME("SELECT COUNT(*) AS count FROM guilds WHERE LOWER(name) = LOWER(${name})");
 
-    const char* sql = nullptr;
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(g.uuid))
-        sql = SQL_UUID;
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(g.uuid));
     else if (!g.name.empty())
-        sql = SQL_NAME;
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(g.name));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-
-    const std::string query = sa::templ::Parser::Evaluate(sql, std::bind(&PlaceholderCallback, db, g, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
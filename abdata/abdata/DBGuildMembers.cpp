@@ -21,28 +21,10 @@
 
 #include "DBGuildMembers.h"
 #include "StorageProvider.h"
-#include <sa/TemplateParser.h>
 #include <sa/time.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::GuildMembers& g, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "guild_uuid")
-            return db->EscapeString(g.uuid);
-        if (token.value == "expires")
-            return std::to_string(sa::time::tick());
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBGuildMembers::Create(AB::Entities::GuildMembers& g)
 {
     if (Utils::Uuid::IsEmpty(g.uuid))
@@ -62,26 +44,23 @@ bool DBGuildMembers::Load(AB::Entities::GuildMembers& g)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT * FROM guild_members WHERE "
+    static constexpr DBStatement SQL("SELECT * FROM guild_members WHERE "
         "guild_uuid = ${guild_uuid} "
-        "AND (expires = 0 OR expires > ${expires})";
+        "AND (expires = 0 OR expires > ${expires})");
+
+    static constexpr DBRowMapping MAPPING(
+        DBField("account_uuid", &AB::Entities::GuildMember::accountUuid),
+        DBField("invite_name", &AB::Entities::GuildMember::inviteName),
+        DBField("role", &AB::Entities::GuildMember::role),
+        DBField("invited", &AB::Entities::GuildMember::invited),
+        DBField("joined", &AB::Entities::GuildMember::joined),
+        DBField("expires", &AB::Entities::GuildMember::expires));
 
     g.members.clear();
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, g, std::placeholders::_1));
 
-    for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
-    {
-        AB::Entities::GuildMember gm;
-        gm.accountUuid = result->GetString("account_uuid");
-        gm.inviteName = result->GetString("invite_name");
-        gm.role = static_cast<AB::Entities::GuildRole>(result->GetUInt("role"));
-        gm.invited = result->GetLong("invited");
-        gm.joined = result->GetLong("joined");
-        gm.expires = result->GetLong("expires");
-        g.members.push_back(gm);
-    }
+    MAPPING.Load(db->StorePrepared(SQL, DBParams().Add(g.uuid).Add(sa::time::tick())), g.members);
 
     return true;
 }
@@ -121,28 +100,13 @@ bool DBGuildMembers::Exists(const AB::Entities::GuildMembers& g)
 
 void DBGuildMembers::DeleteExpired(StorageProvider* sp)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     auto expires = sa::time::tick();
-    auto callback = [expires](const sa::templ::Token& token) -> std::string
-    {
-        switch (token.type)
-        {
-        case sa::templ::Token::Type::Variable:
-            if (token.value == "expires")
-                return std::to_string(expires);
-
-            LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-            return "";
-        default:
-            return token.value;
-        }
-    };
-    static constexpr const char* SQL_SELECT = "SELECT guild_uuid FROM guild_members WHERE "
-        "(expires <> 0 AND expires < ${expires})";
-    const std::string selectQuery = sa::templ::Parser::Evaluate(SQL_SELECT, callback);
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(selectQuery);
+    static constexpr DBStatement SQL_SELECT("SELECT guild_uuid FROM guild_members WHERE "
+        "(expires <> 0 AND expires < ${expires})");
+
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL_SELECT, DBParams().Add(expires));
     if (!result)
         // No members
         return;
@@ -153,15 +117,14 @@ void DBGuildMembers::DeleteExpired(StorageProvider* sp)
         guilds.push_back(result->GetString("guild_uuid"));
     }
 
-    static constexpr const char* SQL_DELETE = "DELETE FROM guild_members WHERE "
-        "(expires <> 0 AND expires < ${expires})";
-    const std::string deleteQuery = sa::templ::Parser::Evaluate(SQL_SELECT, callback);
+    static constexpr DBStatement SQL_DELETE("DELETE FROM guild_members WHERE "
+        "(expires <> 0 AND expires < ${expires})");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return;
 
-    if (!db->ExecuteQuery(deleteQuery))
+    if (!db->ExecutePrepared(SQL_DELETE, DBParams().Add(expires)))
         return;
 
     // End transaction
@@ -20,43 +20,9 @@
  */
 
 #include "DBInstance.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::GameInstance& inst, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(inst.uuid);
-        if (token.value == "game_uuid")
-            return db->EscapeString(inst.gameUuid);
-        if (token.value == "server_uuid")
-            return db->EscapeString(inst.serverUuid);
-        if (token.value == "name")
-            return db->EscapeString(inst.name);
-        if (token.value == "recording")
-            return db->EscapeString(inst.recording);
-        if (token.value == "start_time")
-            return std::to_string(inst.startTime);
-        if (token.value == "stop_time")
-            return std::to_string(inst.stopTime);
-        if (token.value == "number")
-            return std::to_string(inst.number);
-        if (token.value == "is_running")
-            return std::to_string(inst.running ? 1 : 0);
-        if (token.value == "players")
-            return std::to_string(inst.players);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBInstance::Create(AB::Entities::GameInstance& inst)
 {
     if (Utils::Uuid::IsEmpty(inst.uuid))
@@ -65,21 +31,31 @@ bool DBInstance::Create(AB::Entities::GameInstance& inst)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "INSERT INTO instances ("
+    static constexpr DBStatement SQL("INSERT INTO instances ("
             "uuid, game_uuid, server_uuid, name, recording, start_time, stop_time, number, is_running, players"
         ") VALUES ("
             "${uuid}, ${game_uuid}, ${server_uuid}, ${name}, ${recording}, ${start_time}, ${stop_time}, ${number}, ${is_running}, ${players}"
-        ")";
-
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, inst, std::placeholders::_1));
+        ")");
+
+    DBParams params;
+    params.Add(inst.uuid)
+        .Add(inst.gameUuid)
+        .Add(inst.serverUuid)
+        .Add(inst.name)
+        .Add(inst.recording)
+        .Add(inst.startTime)
+        .Add(inst.stopTime)
+        .Add(inst.number)
+        .Add(inst.running)
+        .Add(inst.players);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -87,22 +63,21 @@ bool DBInstance::Create(AB::Entities::GameInstance& inst)
 
 bool DBInstance::Load(AB::Entities::GameInstance& inst)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
+
+    static constexpr DBStatement SQL_UUID("SELECT * FROM instances WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_RECORDING("SELECT * FROM instances WHERE recording = ${recording}");
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT * FROM instances WHERE ");
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(inst.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(inst.uuid));
     else if (!inst.recording.empty())
-        parser.Append("recording = ${recording}", tokens);
+        result = db->StorePrepared(SQL_RECORDING, DBParams().Add(inst.recording));
     else
     {
         LOG_ERROR << "UUID and recording are empty" << std::endl;
         return false;
     }
-
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, inst, std::placeholders::_1));
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -128,9 +103,9 @@ bool DBInstance::Save(const AB::Entities::GameInstance& inst)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "UPDATE instances SET "
+    static constexpr DBStatement SQL("UPDATE instances SET "
         "game_uuid = ${game_uuid}, "
         "server_uuid = ${server_uuid}, "
         "name = ${name}, "
@@ -140,15 +115,25 @@ bool DBInstance::Save(const AB::Entities::GameInstance& inst)
         "number = ${number}, "
         "is_running = ${is_running}, "
         "players = ${players} "
-        "WHERE uuid = ${uuid}";
-
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, inst, std::placeholders::_1));
+        "WHERE uuid = ${uuid}");
+
+    DBParams params;
+    params.Add(inst.gameUuid)
+        .Add(inst.serverUuid)
+        .Add(inst.name)
+        .Add(inst.recording)
+        .Add(inst.startTime)
+        .Add(inst.stopTime)
+        .Add(inst.number)
+        .Add(inst.running)
+        .Add(inst.players)
+        .Add(inst.uuid);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -162,14 +147,13 @@ bool DBInstance::Delete(const AB::Entities::GameInstance& inst)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "DELETE FROM instances WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, inst, std::placeholders::_1));
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("DELETE FROM instances WHERE uuid = ${uuid}");
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(inst.uuid)))
         return false;
 
     return transaction.Commit();
@@ -177,23 +161,21 @@ bool DBInstance::Delete(const AB::Entities::GameInstance& inst)
 
 bool DBInstance::Exists(const AB::Entities::GameInstance& inst)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
+
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM instances WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_RECORDING("SELECT COUNT(*) AS count FROM instances WHERE recording = ${recording}");
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT COUNT(*) AS count FROM instances WHERE ");
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(inst.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(inst.uuid));
     else if (!inst.recording.empty())
-        parser.Append("recording = ${recording}", tokens);
+        result = db->StorePrepared(SQL_RECORDING, DBParams().Add(inst.recording));
     else
     {
         LOG_ERROR << "UUID and recording are empty" << std::endl;
         return false;
     }
-
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, inst, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -201,28 +183,13 @@ bool DBInstance::Exists(const AB::Entities::GameInstance& inst)
 
 bool DBInstance::StopAll()
 {
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "UPDATE instances SET is_running = 0, stop_time = ${stop_time} WHERE is_running = 1";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, [](const sa::templ::Token& token) -> std::string
-    {
-        switch (token.type)
-        {
-        case sa::templ::Token::Type::Variable:
-            if (token.value == "stop_time")
-                return std::to_string(sa::time::tick());
-            LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-
-            return "";
-        default:
-            return token.value;
-        }
-
-    });
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("UPDATE instances SET is_running = 0, stop_time = ${stop_time} WHERE is_running = 1");
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(sa::time::tick())))
         return false;
 
     return transaction.Commit();
@@ -20,31 +20,9 @@
  */
 
 #include "DBIpBan.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::IpBan& ban, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "ip")
-            return std::to_string(ban.ip);
-        if (token.value == "mask")
-            return std::to_string(ban.mask);
-        if (token.value == "uuid")
-            return db->EscapeString(ban.uuid);
-        if (token.value == "ban_uuid")
-            return db->EscapeString(ban.banUuid);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBIpBan::Create(AB::Entities::IpBan& ban)
 {
     if (Utils::Uuid::IsEmpty(ban.uuid))
@@ -53,31 +31,34 @@ bool DBIpBan::Create(AB::Entities::IpBan& ban)
         return false;
     }
 
-    static constexpr const char* SQL_SELECT = "SELECT COUNT(*) as count FROM ip_bans WHERE "
-        "((${ip} & ${mask} & mask) = (ip & mask & ${mask}))";
+    static constexpr DBStatement SQL_SELECT("SELECT COUNT(*) as count FROM ip_bans WHERE "
+        "((mask & ${ip} & ${mask}) = (ip & mask & ${mask}))");
 
-    Database* db = GetSubsystem<Database>();
-    const std::string selectQuery = sa::templ::Parser::Evaluate(SQL_SELECT, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(selectQuery);
+    Database* db = Database::Get();
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL_SELECT, DBParams().Add(ban.ip).Add(ban.mask).Add(ban.mask));
     if (result && result->GetInt("count") != 0)
     {
         LOG_ERROR << "There is already a record matching this IP and mask" << std::endl;
         return false;
     }
 
-    static constexpr const char* SQL_INSERT = "INSERT INTO ip_bans ("
+    static constexpr DBStatement SQL_INSERT("INSERT INTO ip_bans ("
             "uuid, ban_uuid, ip, mask"
         ") VALUES ("
             "${uuid}, ${ban_uuid}, ${ip}, ${mask}"
-        ")";
+        ")");
 
-    const std::string query = sa::templ::Parser::Evaluate(SQL_INSERT, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
+    DBParams params;
+    params.Add(ban.uuid)
+        .Add(ban.banUuid)
+        .Add(ban.ip)
+        .Add(ban.mask);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL_INSERT, params))
         return false;
 
     return transaction.Commit();
@@ -85,12 +66,14 @@ bool DBIpBan::Create(AB::Entities::IpBan& ban)
 
 bool DBIpBan::Load(AB::Entities::IpBan& ban)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT * FROM ip_bans WHERE ");
+    static constexpr DBStatement SQL_UUID("SELECT * FROM ip_bans WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_IP("SELECT * FROM ip_bans WHERE ((mask & ${ip} & ${mask}) = (ip & mask & ${mask}))");
+
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(ban.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(ban.uuid));
     else if (ban.ip != 0)
     {
         if (ban.mask == 0)
@@ -98,16 +81,13 @@ bool DBIpBan::Load(AB::Entities::IpBan& ban)
             LOG_ERROR << "IP mask is 0 it would match all IPs" << std::endl;
             return false;
         }
-        parser.Append("((${ip} & ${mask} & mask) = (ip & mask & ${mask}))", tokens);
+        result = db->StorePrepared(SQL_IP, DBParams().Add(ban.ip).Add(ban.mask).Add(ban.mask));
     }
     else
     {
         LOG_ERROR << "UUID and IP are empty" << std::endl;
         return false;
     }
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -127,20 +107,19 @@ bool DBIpBan::Save(const AB::Entities::IpBan& ban)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "UPDATE ip_bans SET "
+    static constexpr DBStatement SQL("UPDATE ip_bans SET "
         "ban_uuid = ${ban_uuid}, "
         "ip = ${ip}, "
-        "mask = ${mask}, "
-        "WHERE uuid = $[uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
+        "mask = ${mask} "
+        "WHERE uuid = ${uuid}");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(ban.banUuid).Add(ban.ip).Add(ban.mask).Add(ban.uuid)))
         return false;
 
     return transaction.Commit();
@@ -154,15 +133,14 @@ bool DBIpBan::Delete(const AB::Entities::IpBan& ban)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "DELETE FROM ip_bans WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("DELETE FROM ip_bans WHERE uuid = ${uuid}");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(ban.uuid)))
         return false;
 
     return transaction.Commit();
@@ -170,12 +148,14 @@ bool DBIpBan::Delete(const AB::Entities::IpBan& ban)
 
 bool DBIpBan::Exists(const AB::Entities::IpBan& ban)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT COUNT(*) AS count FROM ip_bans WHERE ");
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM ip_bans WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_IP("SELECT COUNT(*) AS count FROM ip_bans WHERE ((mask & ${ip} & ${mask}) = (ip & mask & ${mask}))");
+
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(ban.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(ban.uuid));
     else if (ban.ip != 0)
     {
         if (ban.mask == 0)
@@ -183,16 +163,13 @@ bool DBIpBan::Exists(const AB::Entities::IpBan& ban)
             LOG_ERROR << "IP mask is 0 it would match all IPs" << std::endl;
             return false;
         }
-        parser.Append("((${ip} & ${mask} & mask) = (ip & mask & ${mask}))", tokens);
+        result = db->StorePrepared(SQL_IP, DBParams().Add(ban.ip).Add(ban.mask).Add(ban.mask));
     }
     else
     {
         LOG_ERROR << "UUID and IP are empty" << std::endl;
         return false;
     }
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, ban, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
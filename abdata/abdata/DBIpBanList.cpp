@@ -30,7 +30,7 @@ bool DBIpBanList::Create(AB::Entities::IpBanList&)
 
 bool DBIpBanList::Load(AB::Entities::IpBanList& il)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     static const std::string query = "SELECT uuid FROM ip_bans";
 
@@ -20,27 +20,9 @@
  */
 
 #include "DBItem.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Item& item, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(item.uuid);
-        if (token.value == "idx")
-            return std::to_string(item.index);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBItem::Create(AB::Entities::Item& item)
 {
     // Do nothing
@@ -54,25 +36,21 @@ bool DBItem::Create(AB::Entities::Item& item)
 
 bool DBItem::Load(AB::Entities::Item& item)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL_UUID = "SELECT * FROM game_items WHERE uuid= ${uuid}";
-    static constexpr const char* SQL_INDEX = "SELECT * FROM game_items WHERE idx = ${index}";
+    static constexpr DBStatement SQL_UUID("SELECT * FROM game_items WHERE uuid= ${uuid}");
+    static constexpr DBStatement SQL_INDEX("SELECT * FROM game_items WHERE idx = ${idx}");
 
-    const char* sql = nullptr;
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(item.uuid))
-        sql = SQL_UUID;
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(item.uuid));
     else if (!item.index != 0)
-        sql = SQL_INDEX;
+        result = db->StorePrepared(SQL_INDEX, DBParams().Add(item.index));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-
-    const std::string query = sa::templ::Parser::Evaluate(sql, std::bind(&PlaceholderCallback, db, item, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -117,25 +95,21 @@ bool DBItem::Delete(const AB::Entities::Item& item)
 
 bool DBItem::Exists(const AB::Entities::Item& item)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL_UUID = "SELECT COUNT(*) AS count FROM game_items WHERE uuid= ${uuid}";
-    static constexpr const char* SQL_INDEX = "SELECT COUNT(*) AS count FROM game_items WHERE idx = ${index}";
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM game_items WHERE uuid= ${uuid}");
+    static constexpr DBStatement SQL_INDEX("SELECT COUNT(*) AS count FROM game_items WHERE idx = ${idx}");
 
-    const char* sql = nullptr;
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(item.uuid))
-        sql = SQL_UUID;
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(item.uuid));
     else if (!item.index != 0)
-        sql = SQL_INDEX;
+        result = db->StorePrepared(SQL_INDEX, DBParams().Add(item.index));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-
-    const std::string query = sa::templ::Parser::Evaluate(sql, std::bind(&PlaceholderCallback, db, item, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
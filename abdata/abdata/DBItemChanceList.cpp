@@ -20,27 +20,9 @@
  */
 
 #include "DBItemChanceList.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::ItemChanceList& il, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "map_uuid")
-            return db->EscapeString(il.uuid);
-        if (token.value == "empty_map_uuid")
-            return db->EscapeString(Utils::Uuid::EMPTY_UUID);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBItemChanceList::Create(AB::Entities::ItemChanceList& il)
 {
     if (Utils::Uuid::IsEmpty(il.uuid))
@@ -60,13 +42,13 @@ bool DBItemChanceList::Load(AB::Entities::ItemChanceList& il)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT item_uuid, chance, can_drop FROM game_item_chances WHERE "
-        "map_uuid = ${map_uuid} OR map_uuid = ${empty_map_uuid}";
+    static constexpr DBStatement SQL("SELECT item_uuid, chance, can_drop FROM game_item_chances WHERE "
+        "map_uuid = ${map_uuid} OR map_uuid = ${empty_map_uuid}");
 
-    static const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, il, std::placeholders::_1));
-    for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
+    for (std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(il.uuid).Add(Utils::Uuid::EMPTY_UUID));
+        result; result = result->Next())
     {
         il.items.push_back({
             result->GetString("item_uuid"),
@@ -22,7 +22,6 @@
 #include "DBItemPrice.h"
 #include <AB/Entities/ConcreteItem.h>
 #include <AB/Entities/Item.h>
-#include <sa/TemplateParser.h>
 #include <sa/time.h>
 
 namespace DB {
@@ -34,25 +33,12 @@ bool DBItemPrice::Create(AB::Entities::ItemPrice&)
 
 uint32_t DBItemPrice::GetDropChance(const std::string& itemUuid)
 {
-    static constexpr const char* SQL = "SELECT AVG(chance) AS avg_chance FROM game_item_chances WHERE item_uuid = ${item_uuid}"
-        " GROUP BY item_uuid";
+    static constexpr DBStatement SQL("SELECT AVG(chance) AS avg_chance FROM game_item_chances WHERE item_uuid = ${item_uuid}"
+        " GROUP BY item_uuid");
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    const std::string query = sa::templ::Parser::Evaluate(SQL, [db, &itemUuid](const sa::templ::Token& token) -> std::string
-    {
-        switch (token.type)
-        {
-        case sa::templ::Token::Type::Variable:
-            if (token.value == "item_uuid")
-                return db->EscapeString(itemUuid);
-            ASSERT_FALSE();
-        default:
-            return token.value;
-        }
-    });
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(itemUuid));
     if (!result)
         return 0;
     return result->GetUInt("avg_chance");
@@ -60,23 +46,11 @@ uint32_t DBItemPrice::GetDropChance(const std::string& itemUuid)
 
 uint32_t DBItemPrice::GetAvgValue(const std::string& itemUuid)
 {
-    static constexpr const char* SQL = "SELECT AVG(value) as avg_value FROM concrete_items WHERE deleted = 0 "
-        "AND item_uuid = ${item_uuid} GROUP BY item_uuid";
+    static constexpr DBStatement SQL("SELECT AVG(value) as avg_value FROM concrete_items WHERE deleted = 0 "
+        "AND item_uuid = ${item_uuid} GROUP BY item_uuid");
 
-    Database* db = GetSubsystem<Database>();
-    const std::string query = sa::templ::Parser::Evaluate(SQL, [db, &itemUuid](const sa::templ::Token& token) -> std::string
-    {
-        switch (token.type)
-        {
-        case sa::templ::Token::Type::Variable:
-            if (token.value == "item_uuid")
-                return db->EscapeString(itemUuid);
-            ASSERT_FALSE();
-        default:
-            return token.value;
-        }
-    });
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    Database* db = Database::Get();
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(itemUuid));
     if (result)
         return result->GetUInt("avg_value");
     return 0;
@@ -86,36 +60,22 @@ uint32_t DBItemPrice::GetAvailable(const std::string& itemUuid)
 {
     // How many of that belongs to the merchant. Since sold non-stackable items are no longer available after some time,
     // we must filter them out.
-    static constexpr const char* SQL = "SELECT SUM(count) AS available FROM concrete_items "
+    static constexpr DBStatement SQL("SELECT SUM(count) AS available FROM concrete_items "
         "LEFT JOIN game_items on game_items.uuid = concrete_items.item_uuid "
         "WHERE deleted = 0 AND storage_place = ${storage_place} "
         "AND ((sold + ${keep_time} > ${current_time}) OR (item_flags & ${stackable_flag} != 0)) "
         "AND item_uuid = ${item_uuid} "
-        "GROUP BY item_uuid";
-
-    Database* db = GetSubsystem<Database>();
-    const std::string query = sa::templ::Parser::Evaluate(SQL, [db, &itemUuid](const sa::templ::Token& token) -> std::string
-    {
-        using namespace sa::time::literals;
-        switch (token.type)
-        {
-        case sa::templ::Token::Type::Variable:
-            if (token.value == "item_uuid")
-                return db->EscapeString(itemUuid);
-            if (token.value == "storage_place")
-                return std::to_string(static_cast<int>(AB::Entities::StoragePlace::Merchant));
-            if (token.value == "keep_time")
-                return std::to_string(1_W);
-            if (token.value == "current_time")
-                return std::to_string(sa::time::tick());
-            if (token.value == "stackable_flag")
-                return std::to_string(AB::Entities::ItemFlagStackable);
-            ASSERT_FALSE();
-        default:
-            return token.value;
-        }
-    });
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+        "GROUP BY item_uuid");
+
+    Database* db = Database::Get();
+    using namespace sa::time::literals;
+    DBParams params;
+    params.Add(AB::Entities::StoragePlace::Merchant)
+        .Add(1_W)
+        .Add(sa::time::tick())
+        .Add(AB::Entities::ItemFlagStackable)
+        .Add(itemUuid);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, params);
     if (result)
         return result->GetUInt("available");
     return 0;
@@ -130,23 +90,10 @@ bool DBItemPrice::Load(AB::Entities::ItemPrice& item)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT type, item_flags, value FROM game_items WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, [db, &item](const sa::templ::Token& token) -> std::string
-    {
-        switch (token.type)
-        {
-        case sa::templ::Token::Type::Variable:
-            if (token.value == "uuid")
-                return db->EscapeString(item.uuid);
-            ASSERT_FALSE();
-        default:
-            return token.value;
-        }
-    });
-
-    std::shared_ptr<DB::DBResult> itemResult = db->StoreQuery(query);
+    static constexpr DBStatement SQL("SELECT type, item_flags, value FROM game_items WHERE uuid = ${uuid}");
+    std::shared_ptr<DB::DBResult> itemResult = db->StorePrepared(SQL, DBParams().Add(item.uuid));
     if (!itemResult)
         return false;
     AB::Entities::ItemType type = static_cast<AB::Entities::ItemType>(itemResult->GetUInt("type"));
@@ -213,26 +160,11 @@ bool DBItemPrice::Exists(const AB::Entities::ItemPrice& item)
         return false;
     }
 
-    static constexpr const char* SQL = "SELECT COUNT(*) AS count FROM concrete_items WHERE "
-        "deleted = 0 AND item_uuid = ${item_uuid} AND storage_place = ${storage_place}";
-    Database* db = GetSubsystem<Database>();
+    static constexpr DBStatement SQL("SELECT COUNT(*) AS count FROM concrete_items WHERE "
+        "deleted = 0 AND item_uuid = ${item_uuid} AND storage_place = ${storage_place}");
+    Database* db = Database::Get();
 
-    const std::string query = sa::templ::Parser::Evaluate(SQL, [db, &item](const sa::templ::Token& token) -> std::string
-    {
-        switch (token.type)
-        {
-        case sa::templ::Token::Type::Variable:
-            if (token.value == "item_uuid")
-                return db->EscapeString(item.uuid);
-            if (token.value == "storage_place")
-                return std::to_string(static_cast<int>(AB::Entities::StoragePlace::Merchant));
-            ASSERT_FALSE();
-        default:
-            return token.value;
-        }
-    });
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(item.uuid).Add(AB::Entities::StoragePlace::Merchant));
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
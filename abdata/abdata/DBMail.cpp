@@ -20,48 +20,15 @@
  */
 
 #include "DBMail.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Mail& mail, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(mail.uuid);
-        if (token.value == "from_account_uuid")
-            return db->EscapeString(mail.fromAccountUuid);
-        if (token.value == "to_account_uuid")
-            return db->EscapeString(mail.toAccountUuid);
-        if (token.value == "from_name")
-            return db->EscapeString(mail.fromName);
-        if (token.value == "to_name")
-            return db->EscapeString(mail.toName);
-        if (token.value == "subject")
-            return db->EscapeString(mail.subject);
-        if (token.value == "message")
-            return db->EscapeString(mail.message);
-        if (token.value == "created")
-            return std::to_string(mail.created);
-        if (token.value == "is_read")
-            return std::to_string((mail.isRead ? 1 : 0));
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 uint32_t DBMail::GetMailCount(AB::Entities::Mail& mail)
 {
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "SELECT COUNT(*) AS count FROM mails WHERE to_account_uuid = ${to_account_uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, mail, std::placeholders::_1));
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("SELECT COUNT(*) AS count FROM mails WHERE to_account_uuid = ${to_account_uuid}");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(mail.toAccountUuid));
     if (!result)
         // Something is wrong!
         return std::numeric_limits<uint32_t>::max();
@@ -80,20 +47,29 @@ bool DBMail::Create(AB::Entities::Mail& mail)
     if (GetMailCount(mail) >= AB::Entities::Limits::MAX_MAIL_COUNT)
         return false;
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "INSERT INTO mails ("
+    static constexpr DBStatement SQL("INSERT INTO mails ("
         "uuid, from_account_uuid, to_account_uuid, from_name, to_name, subject, message, created, is_read"
         ") VALUES ("
         "${uuid}, ${from_account_uuid}, ${to_account_uuid}, ${from_name}, ${to_name}, ${subject}, ${message}, ${created}, ${is_read}"
-        ")";
-
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, mail, std::placeholders::_1));
+        ")");
+
+    DBParams params;
+    params.Add(mail.uuid)
+        .Add(mail.fromAccountUuid)
+        .Add(mail.toAccountUuid)
+        .Add(mail.fromName)
+        .Add(mail.toName)
+        .Add(mail.subject)
+        .Add(mail.message)
+        .Add(mail.created)
+        .Add(mail.isRead);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return  transaction.Commit();
@@ -107,12 +83,11 @@ bool DBMail::Load(AB::Entities::Mail& mail)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT * FROM mails WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, mail, std::placeholders::_1));
+    static constexpr DBStatement SQL("SELECT * FROM mails WHERE uuid = ${uuid}");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(mail.uuid));
     if (!result)
         return false;
 
@@ -136,9 +111,9 @@ bool DBMail::Save(const AB::Entities::Mail& mail)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "UPDATE mails SET "
+    static constexpr DBStatement SQL("UPDATE mails SET "
         "from_account_uuid = ${from_account_uuid}, "
         "to_account_uuid = ${to_account_uuid}, "
         "from_name = ${from_name}, "
@@ -147,13 +122,23 @@ bool DBMail::Save(const AB::Entities::Mail& mail)
         "message = ${message}, "
         "created = ${created}, "
         "is_read = ${is_read} "
-        "WHERE uuid = ${uuid}";
+        "WHERE uuid = ${uuid}");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, mail, std::placeholders::_1))))
+    DBParams params;
+    params.Add(mail.fromAccountUuid)
+        .Add(mail.toAccountUuid)
+        .Add(mail.fromName)
+        .Add(mail.toName)
+        .Add(mail.subject)
+        .Add(mail.message)
+        .Add(mail.created)
+        .Add(mail.isRead)
+        .Add(mail.uuid);
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -167,15 +152,14 @@ bool DBMail::Delete(const AB::Entities::Mail& mail)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "DELETE FROM mails WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, mail, std::placeholders::_1));
+    static constexpr DBStatement SQL("DELETE FROM mails WHERE uuid = ${uuid}");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(mail.uuid)))
         return false;
 
     return transaction.Commit();
@@ -189,11 +173,10 @@ bool DBMail::Exists(const AB::Entities::Mail& mail)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "SELECT COUNT(*) AS count FROM mails WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, mail, std::placeholders::_1));
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("SELECT COUNT(*) AS count FROM mails WHERE uuid = ${uuid}");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(mail.uuid));
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
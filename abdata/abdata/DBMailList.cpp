@@ -20,7 +20,6 @@
  */
 
 #include "DBMailList.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
@@ -43,34 +42,18 @@ bool DBMailList::Load(AB::Entities::MailList& ml)
     }
 
     // Oldest first because the chat window scrolls down
-    static constexpr const char* SQL = "SELECT uuid, from_name, subject, created, is_read FROM mails "
-        "WHERE to_account_uuid = ${to_account_uuid} ORDER BY created ASC";
-    Database* db = GetSubsystem<Database>();
-
-    const std::string query = sa::templ::Parser::Evaluate(SQL, [db, &ml](const sa::templ::Token& token) -> std::string
-    {
-        switch (token.type)
-        {
-        case sa::templ::Token::Type::Variable:
-            if (token.value == "to_account_uuid")
-                return db->EscapeString(ml.uuid);
-            ASSERT_FALSE();
-        default:
-            return token.value;
-        }
-    });
+    static constexpr DBStatement SQL("SELECT uuid, from_name, subject, created, is_read FROM mails "
+        "WHERE to_account_uuid = ${to_account_uuid} ORDER BY created ASC");
+    static constexpr DBRowMapping MAPPING(
+        DBField("uuid", &AB::Entities::MailHeader::uuid),
+        DBField("from_name", &AB::Entities::MailHeader::fromName),
+        DBField("subject", &AB::Entities::MailHeader::subject),
+        DBField("created", &AB::Entities::MailHeader::created),
+        DBField("is_read", &AB::Entities::MailHeader::isRead));
+    Database* db = Database::Get();
     ml.mails.clear();
 
-    for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
-    {
-        ml.mails.push_back({
-            result->GetString("uuid"),
-            result->GetString("from_name"),
-            result->GetString("subject"),
-            result->GetLong("created"),
-            result->GetUInt("is_read") != 0
-        });
-    }
+    MAPPING.Load(db->StorePrepared(SQL, DBParams().Add(ml.uuid)), ml.mails);
 
     return true;
 }
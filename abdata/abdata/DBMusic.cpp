@@ -20,35 +20,9 @@
  */
 
 #include "DBMusic.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Music& item, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(item.uuid);
-        if (token.value == "map_uuid")
-            return db->EscapeString(item.mapUuid);
-        if (token.value == "local_file")
-            return db->EscapeString(item.localFile);
-        if (token.value == "remote_file")
-            return db->EscapeString(item.remoteFile);
-        if (token.value == "sorting")
-            return std::to_string(item.sorting);
-        if (token.value == "style")
-            return std::to_string(item.style);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBMusic::Create(AB::Entities::Music& item)
 {
     if (Utils::Uuid::IsEmpty(item.uuid))
@@ -57,21 +31,27 @@ bool DBMusic::Create(AB::Entities::Music& item)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "INSERT INTO game_music ("
+    static constexpr DBStatement SQL("INSERT INTO game_music ("
             "uuid, map_uuid, local_file, remote_file, sorting, style"
         ") VALUES ("
             "${uuid}, ${map_uuid}, ${local_file}, ${remote_file}, ${sorting}, ${style}"
-        ")";
+        ")");
 
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, item, std::placeholders::_1));
+    DBParams params;
+    params.Add(item.uuid)
+        .Add(item.mapUuid)
+        .Add(item.localFile)
+        .Add(item.remoteFile)
+        .Add(item.sorting)
+        .Add(item.style);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -85,12 +65,11 @@ bool DBMusic::Load(AB::Entities::Music& item)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT * FROM game_music WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, item, std::placeholders::_1));
+    static constexpr DBStatement SQL("SELECT * FROM game_music WHERE uuid = ${uuid}");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(item.uuid));
     if (!result)
         return false;
 
@@ -112,22 +91,28 @@ bool DBMusic::Save(const AB::Entities::Music& item)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "UPDATE game_music SET "
+    static constexpr DBStatement SQL("UPDATE game_music SET "
         "map_uuid = ${map_uuid}, "
         "local_file = ${local_file}, "
         "remote_file = ${remote_file}, "
         "sorting = ${sorting}, "
         "style = ${style} "
-        "WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, item, std::placeholders::_1));
+        "WHERE uuid = ${uuid}");
+    DBParams params;
+    params.Add(item.mapUuid)
+        .Add(item.localFile)
+        .Add(item.remoteFile)
+        .Add(item.sorting)
+        .Add(item.style)
+        .Add(item.uuid);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -141,14 +126,13 @@ bool DBMusic::Delete(const AB::Entities::Music& item)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "DELETE FROM game_music WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, item, std::placeholders::_1));
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("DELETE FROM game_music WHERE uuid = ${uuid}");
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(item.uuid)))
         return false;
 
     return transaction.Commit();
@@ -162,12 +146,11 @@ bool DBMusic::Exists(const AB::Entities::Music& item)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT COUNT(*) AS count FROM game_music WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, item, std::placeholders::_1));
+    static constexpr DBStatement SQL("SELECT COUNT(*) AS count FROM game_music WHERE uuid = ${uuid}");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(item.uuid));
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -20,29 +20,9 @@
  */
 
 #include "DBNews.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::News& v, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(v.uuid);
-        if (token.value == "created")
-            return std::to_string(v.created);
-        if (token.value == "body")
-            return db->EscapeString(v.body);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBNews::Create(AB::Entities::News& v)
 {
     if (Utils::Uuid::IsEmpty(v.uuid))
@@ -51,21 +31,19 @@ bool DBNews::Create(AB::Entities::News& v)
         return false;
     }
 
-    static constexpr const char* SQL = "INSERT INTO news ("
+    static constexpr DBStatement SQL("INSERT INTO news ("
         "uuid, created, body"
         ") VALUES ("
         "${uuid}, ${created}, ${body}"
-        ")";
-
-    Database* db = GetSubsystem<Database>();
+        ")");
 
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, v, std::placeholders::_1));
+    Database* db = Database::Get();
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(v.uuid).Add(v.created).Add(v.body)))
         return false;
 
     return transaction.Commit();
@@ -79,13 +57,11 @@ bool DBNews::Load(AB::Entities::News& v)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT * FROM news WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL("SELECT * FROM news WHERE uuid = ${uuid}");
 
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, v, std::placeholders::_1));
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(v.uuid));
     if (!result)
         return false;
 
@@ -104,19 +80,18 @@ bool DBNews::Save(const AB::Entities::News& v)
         return false;
     }
 
-    static constexpr const char* SQL = "UPDATE news SET "
+    static constexpr DBStatement SQL("UPDATE news SET "
         "created = ${created}, "
         "body = ${body} "
-        "WHERE uuid = ${uuid}";
+        "WHERE uuid = ${uuid}");
 
-    Database* db = GetSubsystem<Database>();
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, v, std::placeholders::_1));
+    Database* db = Database::Get();
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(v.created).Add(v.body).Add(v.uuid)))
         return false;
 
     return transaction.Commit();
@@ -130,16 +105,15 @@ bool DBNews::Delete(const AB::Entities::News& v)
         return false;
     }
 
-    static constexpr const char* SQL = "DELETE FROM news WHERE uuid = ${uuid}";
+    static constexpr DBStatement SQL("DELETE FROM news WHERE uuid = ${uuid}");
 
-    Database* db = GetSubsystem<Database>();
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, v, std::placeholders::_1));
+    Database* db = Database::Get();
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(v.uuid)))
         return false;
 
     return transaction.Commit();
@@ -153,14 +127,11 @@ bool DBNews::Exists(const AB::Entities::News& v)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT COUNT(*) FROM news WHERE uuid = ${uuid}");
+    Database* db = Database::Get();
 
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, v, std::placeholders::_1));
+    static constexpr DBStatement SQL("SELECT COUNT(*) FROM news WHERE uuid = ${uuid}");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(v.uuid));
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
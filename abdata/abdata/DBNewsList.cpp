@@ -26,7 +26,7 @@ namespace DB {
 template <size_t _Limit>
 static bool LoadNews(AB::Entities::NewsList<_Limit>& pl)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     std::string query;
     if constexpr (_Limit == 0)
@@ -20,7 +20,6 @@
  */
 
 #include "DBPlayerItemList.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
@@ -33,27 +32,17 @@ static bool LoadList(AB::Entities::_PlayerItemList<_Place>& il)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT uuid FROM concrete_items WHERE player_uuid = ${player_uuid} AND deleted = 0");
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL_ALL("SELECT uuid FROM concrete_items WHERE player_uuid = ${player_uuid} AND deleted = 0");
+    static constexpr DBStatement SQL_PLACE("SELECT uuid FROM concrete_items WHERE player_uuid = ${player_uuid} AND deleted = 0 "
+        "AND storage_place = ${storage_place}");
+
+    std::shared_ptr<DB::DBResult> result;
     if (il.storagePlace != AB::Entities::StoragePlace::None)
-        parser.Append(" AND storage_place = ${storage_place}", tokens);
-    const std::string query = tokens.ToString([db, &il](const sa::templ::Token& token) -> std::string
-    {
-        switch (token.type)
-        {
-        case sa::templ::Token::Type::Variable:
-            if (token.value == "player_uuid")
-                return db->EscapeString(il.uuid);
-            if (token.value == "storage_place")
-                return std::to_string(static_cast<int>(il.storagePlace));
-            ASSERT_FALSE();
-        default:
-            return token.value;
-        }
-    });
-
-    for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
+        result = db->StorePrepared(SQL_PLACE, DBParams().Add(il.uuid).Add(il.storagePlace));
+    else
+        result = db->StorePrepared(SQL_ALL, DBParams().Add(il.uuid));
+    for (; result; result = result->Next())
     {
         il.itemUuids.push_back(result->GetString("uuid"));
     }
@@ -20,43 +20,9 @@
  */
 
 #include "DBPlayerQuest.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::PlayerQuest& q, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(q.uuid);
-        if (token.value == "quests_uuid")
-            return db->EscapeString(q.questUuid);
-        if (token.value == "player_uuid")
-            return db->EscapeString(q.playerUuid);
-        if (token.value == "completed")
-            return std::to_string(q.completed ? 1 : 0);
-        if (token.value == "rewarded")
-            return std::to_string(q.rewarded ? 1 : 0);
-        if (token.value == "progress")
-            return db->EscapeBlob(q.progress.data(), q.progress.size());
-        if (token.value == "picked_up_times")
-            return std::to_string(q.pickupTime);
-        if (token.value == "completed_time")
-            return std::to_string(q.completeTime);
-        if (token.value == "rewarded_time")
-            return std::to_string(q.rewardTime);
-        if (token.value == "deleted")
-            return std::to_string(q.deleted ? 1 : 0);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBPlayerQuest::Create(AB::Entities::PlayerQuest& g)
 {
     if (Utils::Uuid::IsEmpty(g.uuid))
@@ -65,20 +31,30 @@ bool DBPlayerQuest::Create(AB::Entities::PlayerQuest& g)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "INSERT INTO player_quests ("
+    static constexpr DBStatement SQL("INSERT INTO player_quests ("
             "uuid, quests_uuid, player_uuid, completed, rewarded, progress, picked_up_times, completed_time, rewarded_time, deleted"
         ") VALUES ("
-            "${uuid, ${quests_uuid}, ${player_uuid}, ${completed}, ${rewarded}, ${progress}, ${picked_up_times}, ${completed_time}, ${rewarded_time}, ${deleted}"
-        ")";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, g, std::placeholders::_1));
+            "${uuid}, ${quests_uuid}, ${player_uuid}, ${completed}, ${rewarded}, ${progress}, ${picked_up_times}, ${completed_time}, ${rewarded_time}, ${deleted}"
+        ")");
+    DBParams params;
+    params.Add(g.uuid)
+        .Add(g.questUuid)
+        .Add(g.playerUuid)
+        .Add(g.completed)
+        .Add(g.rewarded)
+        .AddBlob(g.progress)
+        .Add(g.pickupTime)
+        .Add(g.completeTime)
+        .Add(g.rewardTime)
+        .Add(g.deleted);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -92,12 +68,11 @@ bool DBPlayerQuest::Load(AB::Entities::PlayerQuest& g)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "SELECT * FROM player_quests WHERE "
-        "uuid = ${uuid} AND deleted = 0";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, g, std::placeholders::_1));
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("SELECT * FROM player_quests WHERE "
+        "uuid = ${uuid} AND deleted = 0");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(g.uuid));
     if (!result)
         return false;
 
@@ -123,10 +98,10 @@ bool DBPlayerQuest::Save(const AB::Entities::PlayerQuest& g)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     // Only these may be changed
-    static constexpr const char* SQL = "UPDATE player_quests SET "
+    static constexpr DBStatement SQL("UPDATE player_quests SET "
         "completed = ${completed}, "
         "rewarded = ${rewarded}, "
         "progress = ${progress}, "
@@ -134,14 +109,22 @@ bool DBPlayerQuest::Save(const AB::Entities::PlayerQuest& g)
         "completed_time = ${completed_time}, "
         "rewarded_time = ${rewarded_time}, "
         "deleted = ${deleted} "
-        "WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, g, std::placeholders::_1));
+        "WHERE uuid = ${uuid}");
+    DBParams params;
+    params.Add(g.completed)
+        .Add(g.rewarded)
+        .AddBlob(g.progress)
+        .Add(g.pickupTime)
+        .Add(g.completeTime)
+        .Add(g.rewardTime)
+        .Add(g.deleted)
+        .Add(g.uuid);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -155,14 +138,13 @@ bool DBPlayerQuest::Delete(const AB::Entities::PlayerQuest& g)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "DELETE FROM player_quests WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, g, std::placeholders::_1));
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("DELETE FROM player_quests WHERE uuid = ${uuid}");
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(g.uuid)))
         return false;
 
     return transaction.Commit();
@@ -175,12 +157,11 @@ bool DBPlayerQuest::Exists(const AB::Entities::PlayerQuest& g)
         LOG_ERROR << "UUID required" << std::endl;
         return false;
     }
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "SELECT COUNT(*) AS count FROM player_quests WHERE "
-        "uuid = ${uuid} AND deleted = 0";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, g, std::placeholders::_1));
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("SELECT COUNT(*) AS count FROM player_quests WHERE "
+        "uuid = ${uuid} AND deleted = 0");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(g.uuid));
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -20,25 +20,9 @@
  */
 
 #include "DBPlayerQuestList.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::PlayerQuestList& q, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "player_uuid")
-            return db->EscapeString(q.uuid);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBPlayerQuestList::Create(AB::Entities::PlayerQuestList& g)
 {
     if (Utils::Uuid::IsEmpty(g.uuid))
@@ -57,13 +41,12 @@ bool DBPlayerQuestList::Load(AB::Entities::PlayerQuestList& g)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT quests_uuid FROM player_quests WHERE "
-        "player_uuid = ${player_uuid} AND rewarded = 0";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, g, std::placeholders::_1));
+    static constexpr DBStatement SQL("SELECT quests_uuid FROM player_quests WHERE "
+        "player_uuid = ${player_uuid} AND rewarded = 0");
 
-    for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
+    for (std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(g.uuid)); result; result = result->Next())
     {
         g.questUuids.push_back(
             result->GetString("quests_uuid")
@@ -100,13 +83,12 @@ bool DBPlayerQuestList::Exists(const AB::Entities::PlayerQuestList& g)
         LOG_ERROR << "UUID is empty" << std::endl;
         return false;
     }
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT COUNT(*) AS count FROM player_quests WHERE "
-        "player_uuid = ${player_uuid} AND rewarded = 0";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, g, std::placeholders::_1));
+    static constexpr DBStatement SQL("SELECT COUNT(*) AS count FROM player_quests WHERE "
+        "player_uuid = ${player_uuid} AND rewarded = 0");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(g.uuid));
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
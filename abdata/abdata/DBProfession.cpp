@@ -20,31 +20,9 @@
  */
 
 #include "DBProfession.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallbackProfession(Database* db, const AB::Entities::Profession& prof, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid" || token.value == "profession_uuid")
-            return db->EscapeString(prof.uuid);
-        if (token.value == "idx")
-            return std::to_string(prof.index);
-        if (token.value == "name")
-            return db->EscapeString(prof.name);
-        if (token.value == "abbr")
-            return db->EscapeString(prof.abbr);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBProfession::Create(AB::Entities::Profession& prof)
 {
     // Do nothing
@@ -58,26 +36,27 @@ bool DBProfession::Create(AB::Entities::Profession& prof)
 
 bool DBProfession::Load(AB::Entities::Profession& prof)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
+
+    static constexpr DBStatement SQL_UUID("SELECT * FROM game_professions WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_INDEX("SELECT * FROM game_professions WHERE idx = ${idx}");
+    static constexpr DBStatement SQL_NAME("SELECT * FROM game_professions WHERE name = ${name}");
+    static constexpr DBStatement SQL_ABBR("SELECT * FROM game_professions WHERE abbr = ${abbr}");
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT * FROM game_professions WHERE ");
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(prof.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(prof.uuid));
     else if (prof.index != 0)
-        parser.Append("idx = ${idx}", tokens);
+        result = db->StorePrepared(SQL_INDEX, DBParams().Add(prof.index));
     else if (!prof.name.empty())
-        parser.Append("name = ${name}", tokens);
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(prof.name));
     else if (!prof.abbr.empty())
-        parser.Append("abbr = ${abbr}", tokens);
+        result = db->StorePrepared(SQL_ABBR, DBParams().Add(prof.abbr));
     else
     {
         LOG_ERROR << "UUID, name, abbr and index are empty" << std::endl;
         return false;
     }
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallbackProfession, db, prof, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -90,9 +69,8 @@ bool DBProfession::Load(AB::Entities::Profession& prof)
     prof.position = static_cast<AB::Entities::ProfessionPosition>(result->GetUInt("position"));
 
     // Get attributes
-    static constexpr const char* SQL_ATTR = "SELECT uuid, idx, is_primary FROM game_attributes WHERE profession_uuid = ${profession_uuid} ORDER BY idx";
-    const std::string queryAttr = sa::templ::Parser::Evaluate(SQL_ATTR, std::bind(&PlaceholderCallbackProfession, db, prof, std::placeholders::_1));
-    std::shared_ptr<DB::DBResult> resAttrib = db->StoreQuery(queryAttr);
+    static constexpr DBStatement SQL_ATTR("SELECT uuid, idx, is_primary FROM game_attributes WHERE profession_uuid = ${profession_uuid} ORDER BY idx");
+    std::shared_ptr<DB::DBResult> resAttrib = db->StorePrepared(SQL_ATTR, DBParams().Add(prof.uuid));
     prof.attributeCount= 0;
     prof.attributes.clear();
     if (resAttrib)
@@ -134,26 +112,27 @@ bool DBProfession::Delete(const AB::Entities::Profession& prof)
 
 bool DBProfession::Exists(const AB::Entities::Profession& prof)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT COUNT(*) AS count FROM game_professions WHERE ");
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM game_professions WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_INDEX("SELECT COUNT(*) AS count FROM game_professions WHERE idx = ${idx}");
+    static constexpr DBStatement SQL_NAME("SELECT COUNT(*) AS count FROM game_professions WHERE name = ${name}");
+    static constexpr DBStatement SQL_ABBR("SELECT COUNT(*) AS count FROM game_professions WHERE abbr = ${abbr}");
+
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(prof.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(prof.uuid));
     else if (prof.index != 0)
-        parser.Append("idx = ${idx}", tokens);
+        result = db->StorePrepared(SQL_INDEX, DBParams().Add(prof.index));
     else if (!prof.name.empty())
-        parser.Append("name = ${name}", tokens);
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(prof.name));
     else if (!prof.abbr.empty())
-        parser.Append("abbr = ${abbr}", tokens);
+        result = db->StorePrepared(SQL_ABBR, DBParams().Add(prof.abbr));
     else
     {
         LOG_ERROR << "UUID, name, abbr and index are empty" << std::endl;
         return false;
     }
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallbackProfession, db, prof, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -30,7 +30,7 @@ bool DBProfessionList::Create(AB::Entities::ProfessionList&)
 
 bool DBProfessionList::Load(AB::Entities::ProfessionList& pl)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     static const std::string query = "SELECT uuid FROM game_professions";
     for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
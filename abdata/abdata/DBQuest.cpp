@@ -21,43 +21,9 @@
 
 #include "DBQuest.h"
 #include <sa/StringTempl.h>
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Quest& q, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(q.uuid);
-        if (token.value == "idx")
-            return std::to_string(q.index);
-        if (token.value == "name")
-            return db->EscapeString(q.name);
-        if (token.value == "script")
-            return db->EscapeString(q.script);
-        if (token.value == "repeatable")
-            return std::to_string(q.repeatable ? 1 : 0);
-        if (token.value == "description")
-            return db->EscapeString(q.description);
-        if (token.value == "depends_on_uuid")
-            return db->EscapeString(q.dependsOn);
-        if (token.value == "reward_xp")
-            return std::to_string(q.rewardXp);
-        if (token.value == "reward_money")
-            return std::to_string(q.rewardMoney);
-        if (token.value == "reward_items")
-            return db->EscapeString(sa::CombineString<char>(q.rewardItems, std::string(";")));
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBQuest::Create(AB::Entities::Quest& v)
 {
     if (Utils::Uuid::IsEmpty(v.uuid))
@@ -66,20 +32,30 @@ bool DBQuest::Create(AB::Entities::Quest& v)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "INSERT INTO game_quests ("
+    static constexpr DBStatement SQL("INSERT INTO game_quests ("
             "uuid, idx, name, script, repeatable, description, depends_on_uuid, reward_xp, reward_money, reward_items"
         ") VALUES ("
             "${uuid}, ${idx}, ${name}, ${script}, ${repeatable}, ${description}, ${depends_on_uuid}, ${reward_xp}, ${reward_money}, ${reward_items}"
-        ")";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, v, std::placeholders::_1));
+        ")");
+    DBParams params;
+    params.Add(v.uuid)
+        .Add(v.index)
+        .Add(v.name)
+        .Add(v.script)
+        .Add(v.repeatable)
+        .Add(v.description)
+        .Add(v.dependsOn)
+        .Add(v.rewardXp)
+        .Add(v.rewardMoney)
+        .Add(sa::CombineString<char>(v.rewardItems, std::string(";")));
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -87,24 +63,21 @@ bool DBQuest::Create(AB::Entities::Quest& v)
 
 bool DBQuest::Load(AB::Entities::Quest& v)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL_UUID = "SELECT * FROM game_quests WHERE uuid= ${uuid}";
-    static constexpr const char* SQL_INDEX = "SELECT * FROM game_quests WHERE idx = ${index}";
+    static constexpr DBStatement SQL_UUID("SELECT * FROM game_quests WHERE uuid= ${uuid}");
+    static constexpr DBStatement SQL_INDEX("SELECT * FROM game_quests WHERE idx = ${idx}");
 
-    const char* sql = nullptr;
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(v.uuid))
-        sql = SQL_UUID;
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(v.uuid));
     else if (!v.index != 0)
-        sql = SQL_INDEX;
+        result = db->StorePrepared(SQL_INDEX, DBParams().Add(v.index));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-    const std::string query = sa::templ::Parser::Evaluate(sql, std::bind(&PlaceholderCallback, db, v, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -130,10 +103,10 @@ bool DBQuest::Save(const AB::Entities::Quest& v)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     // Only these may be changed
-    static constexpr const char* SQL = "UPDATE game_quests SET "
+    static constexpr DBStatement SQL("UPDATE game_quests SET "
         "name = ${name}, "
         "script = ${script}, "
         "repeatable = ${repeatable}, "
@@ -142,14 +115,23 @@ bool DBQuest::Save(const AB::Entities::Quest& v)
         "reward_xp = ${reward_xp}, "
         "reward_money = ${reward_money}, "
         "reward_items = ${reward_items} "
-        "WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, v, std::placeholders::_1));
+        "WHERE uuid = ${uuid}");
+    DBParams params;
+    params.Add(v.name)
+        .Add(v.script)
+        .Add(v.repeatable)
+        .Add(v.description)
+        .Add(v.dependsOn)
+        .Add(v.rewardXp)
+        .Add(v.rewardMoney)
+        .Add(sa::CombineString<char>(v.rewardItems, std::string(";")))
+        .Add(v.uuid);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -163,24 +145,21 @@ bool DBQuest::Delete(const AB::Entities::Quest&)
 
 bool DBQuest::Exists(const AB::Entities::Quest& v)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL_UUID = "SELECT COUNT(*) AS count FROM game_quests WHERE uuid= ${uuid}";
-    static constexpr const char* SQL_INDEX = "SELECT COUNT(*) AS count FROM game_quests WHERE idx = ${index}";
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM game_quests WHERE uuid= ${uuid}");
+    static constexpr DBStatement SQL_INDEX("SELECT COUNT(*) AS count FROM game_quests WHERE idx = ${idx}");
 
-    const char* sql = nullptr;
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(v.uuid))
-        sql = SQL_UUID;
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(v.uuid));
     else if (!v.index != 0)
-        sql = SQL_INDEX;
+        result = db->StorePrepared(SQL_INDEX, DBParams().Add(v.index));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-    const std::string query = sa::templ::Parser::Evaluate(sql, std::bind(&PlaceholderCallback, db, v, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -21,34 +21,10 @@
 
 #include "DBReservedName.h"
 #include "StorageProvider.h"
-#include <sa/TemplateParser.h>
 #include <sa/time.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::ReservedName& rn, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(rn.uuid);
-        if (token.value == "name")
-            return db->EscapeString(rn.name);
-        if (token.value == "is_reserved")
-            return std::to_string(rn.isReserved ? 1 : 0);
-        if (token.value == "reserved_for_account_uuid")
-            return db->EscapeString(rn.reservedForAccountUuid);
-        if (token.value == "expires")
-            return std::to_string(rn.expires);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 // Player names are case insensitive. The DB needs a proper index for that:
 // CREATE INDEX reserved_names_name_ci_index ON reserved_names USING btree (lower(name))
 
@@ -60,19 +36,24 @@ bool DBReservedName::Create(AB::Entities::ReservedName& rn)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "INSERT INTO reserved_names ("
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("INSERT INTO reserved_names ("
             "uuid, name, is_reserved, reserved_for_account_uuid, expires"
         ") VALUES ("
             "${uuid}, ${name}, ${is_reserved}, ${reserved_for_account_uuid}, ${expires}"
-        ")";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, rn, std::placeholders::_1));
+        ")");
+    DBParams params;
+    params.Add(rn.uuid)
+        .Add(rn.name)
+        .Add(rn.isReserved)
+        .Add(rn.reservedForAccountUuid)
+        .Add(rn.expires);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -80,21 +61,21 @@ bool DBReservedName::Create(AB::Entities::ReservedName& rn)
 
 bool DBReservedName::Load(AB::Entities::ReservedName& n)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
+
+    static constexpr DBStatement SQL_UUID("SELECT * FROM reserved_names WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_NAME("SELECT * FROM reserved_names WHERE LOWER(name) = LOWER(${name})");
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT * FROM reserved_names WHERE ");
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(n.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(n.uuid));
     else if (!n.name.empty())
-        parser.Append("LOWER(name) = LOWER(${name})", tokens);
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(n.name));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, n, std::placeholders::_1));
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -115,20 +96,19 @@ bool DBReservedName::Save(const AB::Entities::ReservedName& rn)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     // Only these may be changed
-    static constexpr const char* SQL = "UPDATE reserved_names SET "
+    static constexpr DBStatement SQL("UPDATE reserved_names SET "
         "is_reserved = ${is_reserved}, "
         "expires = ${expires} "
-        "WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, rn, std::placeholders::_1));
+        "WHERE uuid = ${uuid}");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(rn.isReserved).Add(rn.expires).Add(rn.uuid)))
         return false;
 
     return transaction.Commit();
@@ -142,15 +122,14 @@ bool DBReservedName::Delete(const AB::Entities::ReservedName& rn)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "DELETE FROM reserved_names WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, rn, std::placeholders::_1));
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("DELETE FROM reserved_names WHERE uuid = ${uuid}");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(rn.uuid)))
         return false;
 
     return transaction.Commit();
@@ -158,22 +137,21 @@ bool DBReservedName::Delete(const AB::Entities::ReservedName& rn)
 
 bool DBReservedName::Exists(const AB::Entities::ReservedName& n)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT COUNT(*) AS count FROM reserved_names WHERE ");
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM reserved_names WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_NAME("SELECT COUNT(*) AS count FROM reserved_names WHERE LOWER(name) = LOWER(${name})");
+
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(n.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(n.uuid));
     else if (!n.name.empty())
-        parser.Append("LOWER(name) = LOWER(${name})", tokens);
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(n.name));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, n, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -182,14 +160,12 @@ bool DBReservedName::Exists(const AB::Entities::ReservedName& n)
 void DBReservedName::DeleteExpired(StorageProvider* sp)
 {
     // When expires == 0 it does not expire, otherwise it's the time stamp
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT uuid FROM reserved_names WHERE (expires <> 0 AND expires < ${expires})";
-    AB::Entities::ReservedName n;
-    n.expires = sa::time::tick();
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, n, std::placeholders::_1));
+    static constexpr DBStatement SQL("SELECT uuid FROM reserved_names WHERE (expires <> 0 AND expires < ${expires})");
+    const int64_t expires = sa::time::tick();
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(expires));
     if (!result)
         // No matches
         return;
@@ -209,14 +185,13 @@ void DBReservedName::DeleteExpired(StorageProvider* sp)
     }
 
     // Then delete from DB
-    static constexpr const char* SQL_DELETE =  "DELETE FROM reserved_names WHERE (expires <> 0 AND expires < ${expires})";
-    const std::string deleteQuery = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, n, std::placeholders::_1));
+    static constexpr DBStatement SQL_DELETE("DELETE FROM reserved_names WHERE (expires <> 0 AND expires < ${expires})");
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return;
 
-    if (!db->ExecuteQuery(deleteQuery))
+    if (!db->ExecutePrepared(SQL_DELETE, DBParams().Add(expires)))
         return;
 
     transaction.Commit();
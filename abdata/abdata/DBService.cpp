@@ -20,53 +20,9 @@
  */
 
 #include "DBService.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Service& s, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(s.uuid);
-        if (token.value == "name")
-            return db->EscapeString(s.name);
-        if (token.value == "type")
-            return std::to_string(static_cast<int>(s.type));
-        if (token.value == "location")
-            return db->EscapeString(s.location);
-        if (token.value == "host")
-            return db->EscapeString(s.host);
-        if (token.value == "port")
-            return std::to_string(s.port);
-        if (token.value == "status")
-            return std::to_string(static_cast<int>(s.status));
-        if (token.value == "start_time")
-            return std::to_string(s.startTime);
-        if (token.value == "stop_time")
-            return std::to_string(s.stopTime);
-        if (token.value == "run_time")
-            return std::to_string(s.runTime);
-        if (token.value == "machine")
-            return db->EscapeString(s.machine);
-        if (token.value == "file")
-            return db->EscapeString(s.file);
-        if (token.value == "path")
-            return db->EscapeString(s.path);
-        if (token.value == "arguments")
-            return db->EscapeString(s.arguments);
-        if (token.value == "version")
-            return std::to_string(s.version);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBService::Create(AB::Entities::Service& s)
 {
     if (Utils::Uuid::IsEmpty(s.uuid))
@@ -75,20 +31,35 @@ bool DBService::Create(AB::Entities::Service& s)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "INSERT INTO services ("
+    static constexpr DBStatement SQL("INSERT INTO services ("
             "uuid, name, type, location, host, port, status, start_time, stop_time, run_time, machine, file, path, arguments, version"
         ") VALUES ("
             "${uuid}, ${name}, ${type}, ${location}, ${host}, ${port}, ${status}, ${start_time}, ${stop_time}, ${run_time}, ${machine}, ${file}, ${path}, ${arguments}, ${version}"
-        ")";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, s, std::placeholders::_1));
+        ")");
+    DBParams params;
+    params.Add(s.uuid)
+        .Add(s.name)
+        .Add(s.type)
+        .Add(s.location)
+        .Add(s.host)
+        .Add(s.port)
+        .Add(s.status)
+        .Add(s.startTime)
+        .Add(s.stopTime)
+        .Add(s.runTime)
+        .Add(s.machine)
+        .Add(s.file)
+        .Add(s.path)
+        .Add(s.arguments)
+        .Add(s.version);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -102,12 +73,11 @@ bool DBService::Load(AB::Entities::Service& s)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT * FROM services WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, s, std::placeholders::_1));
+    static constexpr DBStatement SQL("SELECT * FROM services WHERE uuid = ${uuid}");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(s.uuid));
     if (!result)
         return false;
 
@@ -138,9 +108,9 @@ bool DBService::Save(const AB::Entities::Service& s)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "UPDATE services SET "
+    static constexpr DBStatement SQL("UPDATE services SET "
         "name = ${name}, "
         "type = ${type}, "
         "location = ${location}, "
@@ -155,15 +125,30 @@ bool DBService::Save(const AB::Entities::Service& s)
         "path = ${path}, "
         "arguments = ${arguments}, "
         "version = ${version} "
-        "WHERE uuid = ${uuid}";
-
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, s, std::placeholders::_1));
+        "WHERE uuid = ${uuid}");
+
+    DBParams params;
+    params.Add(s.name)
+        .Add(s.type)
+        .Add(s.location)
+        .Add(s.host)
+        .Add(s.port)
+        .Add(s.status)
+        .Add(s.startTime)
+        .Add(s.stopTime)
+        .Add(s.runTime)
+        .Add(s.machine)
+        .Add(s.file)
+        .Add(s.path)
+        .Add(s.arguments)
+        .Add(s.version)
+        .Add(s.uuid);
 
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
@@ -177,14 +162,13 @@ bool DBService::Delete(const AB::Entities::Service& s)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "DELETE FROM services WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, s, std::placeholders::_1));
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("DELETE FROM services WHERE uuid = ${uuid}");
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, DBParams().Add(s.uuid)))
         return false;
 
     return transaction.Commit();
@@ -198,12 +182,11 @@ bool DBService::Exists(const AB::Entities::Service& s)
         return false;
     }
 
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    static constexpr const char* SQL = "SELECT COUNT(*) AS count FROM services WHERE uuid = ${uuid}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, std::bind(&PlaceholderCallback, db, s, std::placeholders::_1));
+    static constexpr DBStatement SQL("SELECT COUNT(*) AS count FROM services WHERE uuid = ${uuid}");
 
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+    std::shared_ptr<DB::DBResult> result = db->StorePrepared(SQL, DBParams().Add(s.uuid));
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -211,32 +194,17 @@ bool DBService::Exists(const AB::Entities::Service& s)
 
 bool DBService::StopAll()
 {
-    Database* db = GetSubsystem<Database>();
-    static constexpr const char* SQL = "UPDATE services SET status = ${status}, stop_time = ${stop_time} WHERE status = ${run_status}";
-    const std::string query = sa::templ::Parser::Evaluate(SQL, [](const sa::templ::Token& token) -> std::string
-    {
-        switch (token.type)
-        {
-        case sa::templ::Token::Type::Variable:
-            if (token.value == "status")
-                return std::to_string(static_cast<int>(AB::Entities::ServiceStatusOffline));
-            if (token.value == "run_status")
-                return std::to_string(static_cast<int>(AB::Entities::ServiceStatusOnline));
-            if (token.value == "stop_time")
-                return std::to_string(sa::time::tick());
-            LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-
-            return "";
-        default:
-            return token.value;
-        }
-
-    });
+    Database* db = Database::Get();
+    static constexpr DBStatement SQL("UPDATE services SET status = ${status}, stop_time = ${stop_time} WHERE status = ${run_status}");
+    DBParams params;
+    params.Add(AB::Entities::ServiceStatusOffline)
+        .Add(sa::time::tick())
+        .Add(AB::Entities::ServiceStatusOnline);
     DBTransaction transaction(db);
     if (!transaction.Begin())
         return false;
 
-    if (!db->ExecuteQuery(query))
+    if (!db->ExecutePrepared(SQL, params))
         return false;
 
     return transaction.Commit();
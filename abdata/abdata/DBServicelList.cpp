@@ -30,7 +30,7 @@ bool DBServicelList::Create(AB::Entities::ServiceList&)
 
 bool DBServicelList::Load(AB::Entities::ServiceList& sl)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     static const std::string query = "SELECT uuid FROM services ORDER BY type";
     for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
@@ -20,27 +20,9 @@
  */
 
 #include "DBSkill.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Skill& skill, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(skill.uuid);
-        if (token.value == "idx")
-            return std::to_string(skill.index);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBSkill::Create(AB::Entities::Skill& skill)
 {
     // Do nothing
@@ -54,18 +36,17 @@ bool DBSkill::Create(AB::Entities::Skill& skill)
 
 bool DBSkill::Load(AB::Entities::Skill& skill)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
+
+    static constexpr DBStatement SQL_UUID("SELECT * FROM game_skills WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_INDEX("SELECT * FROM game_skills WHERE idx = ${idx}");
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT * FROM game_skills WHERE ");
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(skill.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(skill.uuid));
     else
         // 0 is a valid index, it is the None skill
-        parser.Append("idx = ${idx}", tokens);
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, skill, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+        result = db->StorePrepared(SQL_INDEX, DBParams().Add(skill.index));
     if (!result)
         return false;
 
@@ -118,18 +99,17 @@ bool DBSkill::Delete(const AB::Entities::Skill& skill)
 
 bool DBSkill::Exists(const AB::Entities::Skill& skill)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT COUNT(*) AS count FROM game_skills WHERE ");
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM game_skills WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_INDEX("SELECT COUNT(*) AS count FROM game_skills WHERE idx = ${idx}");
+
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(skill.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(skill.uuid));
     else
         // 0 is a valid index, it is the None skill
-        parser.Append("idx = ${idx}", tokens);
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, skill, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
+        result = db->StorePrepared(SQL_INDEX, DBParams().Add(skill.index));
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -30,7 +30,7 @@ bool DBSkillList::Create(AB::Entities::SkillList&)
 
 bool DBSkillList::Load(AB::Entities::SkillList& sl)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     static const std::string query = "SELECT uuid FROM game_skills";
     for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
@@ -21,7 +21,6 @@
 
 #include "DBTypedItemList.h"
 #include <abscommon/Profiler.h>
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
@@ -32,38 +31,28 @@ bool DBTypedItemList::Create(AB::Entities::TypedItemList&)
 
 bool DBTypedItemList::Load(AB::Entities::TypedItemList& il)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT game_item_chances.chance AS chance, game_items.type AS type, game_items.belongs_to AS belongs_to, game_items.uuid AS uuid, "
+    static constexpr DBStatement SQL_ALL("SELECT game_item_chances.chance AS chance, game_items.type AS type, game_items.belongs_to AS belongs_to, game_items.uuid AS uuid, "
         "game_item_chances.map_uuid AS map_uuid "
         "FROM game_item_chances LEFT JOIN game_items ON game_items.uuid = game_item_chances.item_uuid "
-        "WHERE (map_uuid = ${map_uuid}");
-    if (!Utils::Uuid::IsEmpty(il.uuid))
-        parser.Append(" OR map_uuid = ${empty_map_uuid}", tokens);
-    parser.Append(")", tokens);
-    if (il.type != AB::Entities::ItemType::Unknown)
-        parser.Append(" AND type = ${type}", tokens);
+        "WHERE (map_uuid = ${map_uuid} OR map_uuid = ${empty_map_uuid})");
+    static constexpr DBStatement SQL_TYPE("SELECT game_item_chances.chance AS chance, game_items.type AS type, game_items.belongs_to AS belongs_to, game_items.uuid AS uuid, "
+        "game_item_chances.map_uuid AS map_uuid "
+        "FROM game_item_chances LEFT JOIN game_items ON game_items.uuid = game_item_chances.item_uuid "
+        "WHERE (map_uuid = ${map_uuid} OR map_uuid = ${empty_map_uuid}) AND type = ${type}");
 
-    auto callback = [db, &il](const sa::templ::Token& token) -> std::string
-    {
-        switch (token.type)
-        {
-        case sa::templ::Token::Type::Variable:
-            if (token.value == "map_uuid")
-                return db->EscapeString(il.uuid);
-            if (token.value == "empty_map_uuid")
-                return db->EscapeString(Utils::Uuid::EMPTY_UUID);
-            if (token.value == "type")
-                return std::to_string(static_cast<int>(il.type));
-            ASSERT_FALSE();
-        default:
-            return token.value;
-        }
-    };
-    const std::string query = tokens.ToString(callback);
+    DBParams params;
+    // Items of the map and items that drop everywhere. Without a map only the latter.
+    params.Add(il.uuid)
+        .Add(Utils::Uuid::IsEmpty(il.uuid) ? il.uuid : std::string(Utils::Uuid::EMPTY_UUID));
+    std::shared_ptr<DB::DBResult> result;
+    if (il.type != AB::Entities::ItemType::Unknown)
+        result = db->StorePrepared(SQL_TYPE, params.Add(il.type));
+    else
+        result = db->StorePrepared(SQL_ALL, params);
 
-    for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
+    for (; result; result = result->Next())
     {
         AB::Entities::TypedListItem c;
         c.uuid = result->GetString("uuid");
@@ -20,27 +20,9 @@
  */
 
 #include "DBVersion.h"
-#include <sa/TemplateParser.h>
 
 namespace DB {
 
-static std::string PlaceholderCallback(Database* db, const AB::Entities::Version& v, const sa::templ::Token& token)
-{
-    switch (token.type)
-    {
-    case sa::templ::Token::Type::Variable:
-        if (token.value == "uuid")
-            return db->EscapeString(v.uuid);
-        if (token.value == "name")
-            return db->EscapeString(v.name);
-
-        LOG_WARNING << "Unhandled placeholder " << token.value << std::endl;
-        return "";
-    default:
-        return token.value;
-    }
-}
-
 bool DBVersion::Create(AB::Entities::Version&)
 {
     // Do nothing
@@ -49,23 +31,21 @@ bool DBVersion::Create(AB::Entities::Version&)
 
 bool DBVersion::Load(AB::Entities::Version& v)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT * FROM versions WHERE ");
+    static constexpr DBStatement SQL_UUID("SELECT * FROM versions WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_NAME("SELECT * FROM versions WHERE name = ${name}");
 
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(v.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(v.uuid));
     else if (!v.name.empty())
-        parser.Append("name = ${name}", tokens);
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(v.name));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, v, std::placeholders::_1));
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
 
@@ -91,24 +71,21 @@ bool DBVersion::Delete(const AB::Entities::Version&)
 
 bool DBVersion::Exists(const AB::Entities::Version& v)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
-    sa::templ::Parser parser;
-    sa::templ::Tokens tokens = parser.Parse("SELECT COUNT(*) AS count FROM versions WHERE ");
+    static constexpr DBStatement SQL_UUID("SELECT COUNT(*) AS count FROM versions WHERE uuid = ${uuid}");
+    static constexpr DBStatement SQL_NAME("SELECT COUNT(*) AS count FROM versions WHERE name = ${name}");
 
+    std::shared_ptr<DB::DBResult> result;
     if (!Utils::Uuid::IsEmpty(v.uuid))
-        parser.Append("uuid = ${uuid}", tokens);
+        result = db->StorePrepared(SQL_UUID, DBParams().Add(v.uuid));
     else if (!v.name.empty())
-        parser.Append("name = ${name}", tokens);
+        result = db->StorePrepared(SQL_NAME, DBParams().Add(v.name));
     else
     {
         LOG_ERROR << "UUID and name are empty" << std::endl;
         return false;
     }
-
-    const std::string query = tokens.ToString(std::bind(&PlaceholderCallback, db, v, std::placeholders::_1));
-
-    std::shared_ptr<DB::DBResult> result = db->StoreQuery(query);
     if (!result)
         return false;
     return result->GetUInt("count") != 0;
@@ -30,7 +30,7 @@ bool DBVersionList::Create(AB::Entities::VersionList&)
 
 bool DBVersionList::Load(AB::Entities::VersionList& vl)
 {
-    Database* db = GetSubsystem<Database>();
+    Database* db = Database::Get();
 
     static const std::string query = "SELECT * FROM versions WHERE internal = 0";
     for (std::shared_ptr<DB::DBResult> result = db->StoreQuery(query); result; result = result->Next())
@@ -27,6 +27,8 @@
 #include <abscommon/Profiler.h>
 #include <abscommon/Scheduler.h>
 #include <abscommon/ThreadPool.h>
+#include <sa/time.h>
+#include <algorithm>
 #include <sstream>
 
 inline constexpr size_t KEY_CHARACTERS_HASH = sa::StringHash(AB::Entities::Character::KEY());
@@ -41,14 +43,48 @@ inline constexpr size_t KEY_EQUIPPEDITEMLIST_HASH = sa::StringHash(AB::Entities:
 inline constexpr size_t KEY_TYPEDITEMLIST_HASH = sa::StringHash(AB::Entities::TypedItemList::KEY());
 inline constexpr size_t KEY_ITEMPRICE_HASH = sa::StringHash(AB::Entities::ItemPrice::KEY());
 
+/// DB worker threads can not share the connection, each one opens its own.
+/// After a failed connect the worker waits some time before it tries again,
+/// meanwhile its loads fail.
+static bool UseWorkerConnection()
+{
+    static constexpr int64_t MIN_RETRY_MS = 500;
+    static constexpr int64_t MAX_RETRY_MS = 1000 * 30;
+    thread_local std::unique_ptr<DB::Database> db;
+    thread_local int64_t retryTime = 0;
+    thread_local int64_t retryDelay = 0;
+    if (db)
+        return true;
+
+    const int64_t now = sa::time::tick();
+    if (now < retryTime)
+        return false;
+
+    db.reset(DB::Database::CreateConnection());
+    if (!db || !db->IsConnected())
+    {
+        retryDelay = std::clamp(retryDelay * 2, MIN_RETRY_MS, MAX_RETRY_MS);
+        retryTime = now + retryDelay;
+        LOG_ERROR << "DB worker failed to connect to the database, retrying in " << retryDelay << "ms" << std::endl;
+        db.reset();
+        return false;
+    }
+    retryDelay = 0;
+    DB::Database::SetThreadInstance(db.get());
+    return true;
+}
+
 StorageProvider::StorageProvider(size_t maxSize, bool readonly) :
     flushInterval_(FLUSH_CACHE_MS),
     cleanInterval_(CLEAN_CACHE_MS),
+    flushBatchSize_(FLUSH_BATCH_SIZE),
     readonly_(readonly),
     running_(true),
     maxSize_(maxSize),
     currentSize_(0),
-    cache_()
+    cache_(),
+    index_(maxSize / 100 * CACHE_PROTECTED_PERCENT,
+        maxSize / 100 * CACHE_PROTECTED_PERCENT / CACHE_PROTECTED_ITEM_RATIO)
 {
     InitEnitityClasses();
     auto sched = GetSubsystem<Asynch::Scheduler>();
@@ -266,12 +302,13 @@ void StorageProvider::CacheData(const std::string& table, const uuids::uuid& id,
     const auto itemIt = cache_.find(key);
     if (itemIt == cache_.end())
     {
-        index_.Add(key);
+        index_.Add(key, data->size());
         currentSize_ += data->size();
     }
     else
     {
-        index_.Refresh(key);
+        index_.Resize(key, data->size());
+        index_.Access(key);
         currentSize_ = (currentSize_ - itemIt->second.data->size()) + data->size();
         locker = itemIt->second.locker;
     }
@@ -288,17 +325,70 @@ void StorageProvider::CacheData(const std::string& table, const uuids::uuid& id,
     }
 }
 
-bool StorageProvider::Read(uint32_t, const IO::DataKey& key, ea::shared_ptr<StorageData> data)
+bool StorageProvider::ReadCached(const IO::DataKey& key, StorageData& data, bool& result)
 {
     auto _data = cache_.find(key);
-    if (_data != cache_.end())
+    if (_data == cache_.end())
     {
-        if (IsDeleted((*_data).second.flags))
+        std::string table;
+        uuids::uuid _id;
+        if (!key.decode(table, _id))
+            return false;
+
+        // Maybe in player names cache
+        // Special case for player names
+        size_t tableHash = sa::StringHashRt(table.data());
+        if (tableHash != KEY_CHARACTERS_HASH)
+            return false;
+        AB::Entities::Character ch;
+        if (!GetEntity(data, ch) || ch.name.empty())
+            return false;
+        auto* nameKey = namesCache_.LookupName(KEY_CHARACTERS_HASH, ch.name);
+        if (nameKey == nullptr)
+            return false;
+        _data = cache_.find(*nameKey);
+        if (_data == cache_.end())
+            return false;
+    }
+
+    ++cacheStats_.hits;
+    index_.Access((*_data).first);
+    // Don't return deleted items that are in cache
+    result = !IsDeleted((*_data).second.flags);
+    if (result)
+        data.assign((*_data).second.data->begin(), (*_data).second.data->end());
+    return true;
+}
+
+bool StorageProvider::CacheLoaded(const std::string& table, uuids::uuid id, ea::shared_ptr<StorageData> data)
+{
+    if (id.nil())
+        // If no UUID given in key (e.g. when reading by name) cache with the proper key
+        id = GetUuid(*data);
+    const IO::DataKey newKey(table, id);
+    auto _newdata = cache_.find(newKey);
+    if (_newdata == cache_.end())
+    {
+        CacheData(table, id, data, CacheFlag::Created);
+    }
+    else
+    {
+        // Was already cached
+        if (IsDeleted((*_newdata).second.flags))
             // Don't return deleted items that are in cache
             return false;
-        data->assign((*_data).second.data->begin(), (*_data).second.data->end());
-        return true;
+        // Return the cached object, it may have changed
+        data->assign((*_newdata).second.data->begin(), (*_newdata).second.data->end());
     }
+    return true;
+}
+
+bool StorageProvider::Read(uint32_t, const IO::DataKey& key, ea::shared_ptr<StorageData> data)
+{
+    bool result = false;
+    if (ReadCached(key, *data, result))
+        return result;
+    ++cacheStats_.misses;
 
     std::string table;
     uuids::uuid _id;
@@ -308,54 +398,103 @@ bool StorageProvider::Read(uint32_t, const IO::DataKey& key, ea::shared_ptr<Stor
         return false;
     }
 
-    // Maybe in player names cache
-    // Special case for player names
-    size_t tableHash = sa::StringHashRt(table.data());
-    if (tableHash == KEY_CHARACTERS_HASH)
+    // Really not in cache
+    if (!LoadData(key, data))
+        return false;
+
+    return CacheLoaded(table, _id, data);
+}
+
+void StorageProvider::ReadAsync(uint32_t, const IO::DataKey& key, ea::shared_ptr<StorageData> data,
+    ReadCallback&& callback)
+{
+    // Dispatcher thread
+    bool result = false;
+    if (ReadCached(key, *data, result))
     {
-        AB::Entities::Character ch;
-        if (GetEntity(*data, ch) && !ch.name.empty())
+        callback(result);
+        return;
+    }
+    ++cacheStats_.misses;
+
+    std::string table;
+    uuids::uuid _id;
+    if (!key.decode(table, _id))
+    {
+        LOG_ERROR << "Unable to decode key" << std::endl;
+        callback(false);
+        return;
+    }
+
+    if (!_id.nil())
+    {
+        // Someone else is already loading it, wait for this load
+        const auto it = pendingLoads_.find(key);
+        if (it != pendingLoads_.end())
         {
-            auto* nameKey = namesCache_.LookupName(KEY_CHARACTERS_HASH, ch.name);
-            if (nameKey != nullptr)
-            {
-                _data = cache_.find(*nameKey);
-                if (_data != cache_.end())
-                {
-                    if (IsDeleted((*_data).second.flags))
-                        // Don't return deleted items that are in cache
-                        return false;
-                    data->assign((*_data).second.data->begin(), (*_data).second.data->end());
-                    return true;
-                }
-            }
+            it->second->waiters.push_back({ data, std::move(callback) });
+            return;
         }
     }
 
-    // Really not in cache
-    if (!LoadData(key, data))
-        return false;
+    auto load = ea::make_shared<PendingLoad>();
+    load->key = key;
+    load->table = table;
+    load->id = _id;
+    load->request = *data;
+    load->waiters.push_back({ data, std::move(callback) });
+    // Loads by name can not be shared, the key is the same for all names
+    if (!_id.nil())
+        pendingLoads_.emplace(key, load);
+    StartLoad(load);
+}
 
-    if (_id.nil())
-        // If no UUID given in key (e.g. when reading by name) cache with the proper key
-        _id = GetUuid(*data);
-    const IO::DataKey newKey(table, _id);
-    auto _newdata = cache_.find(newKey);
-    if (_newdata == cache_.end())
+void StorageProvider::StartLoad(ea::shared_ptr<PendingLoad> load)
+{
+    auto* pool = GetSubsystem<Asynch::ThreadPool>();
+    if (!pool)
     {
-        CacheData(table, _id, data, CacheFlag::Created);
+        // No workers, load it in the dispatcher thread
+        auto data = ea::make_shared<StorageData>(load->request);
+        const bool success = LoadData(load->key, data);
+        FinishLoad(load, data, success);
+        return;
     }
-    else
+    pool->Enqueue(&StorageProvider::LoadTask, this, load);
+}
+
+void StorageProvider::LoadTask(ea::shared_ptr<PendingLoad> load)
+{
+    // DB worker thread
+    auto data = ea::make_shared<StorageData>(load->request);
+    const bool success = UseWorkerConnection() && LoadData(load->key, data);
+    GetSubsystem<Asynch::Dispatcher>()->Add(
+        Asynch::CreateTask(std::bind(&StorageProvider::FinishLoad, this, load, data, success))
+    );
+}
+
+void StorageProvider::FinishLoad(ea::shared_ptr<PendingLoad> load, ea::shared_ptr<StorageData> data, bool success)
+{
+    // Dispatcher thread
+    if (load->stale)
     {
-        // Was already cached
-        if (IsDeleted((*_newdata).second.flags))
-            // Don't return deleted items that are in cache
-            return false;
-        // Return the cached object, it may have changed
-        data->assign((*_newdata).second.data->begin(), (*_newdata).second.data->end());
+        // It was flushed while we were loading, what we have may be outdated
+        load->stale = false;
+        StartLoad(load);
+        return;
     }
-    return true;
 
+    if (!load->id.nil())
+        pendingLoads_.erase(load->key);
+
+    if (success)
+        success = CacheLoaded(load->table, load->id, data);
+    for (auto& waiter : load->waiters)
+    {
+        if (success)
+            waiter.first->assign(data->begin(), data->end());
+        waiter.second(success);
+    }
 }
 
 bool StorageProvider::Delete(uint32_t clientId, const IO::DataKey& key)
@@ -375,6 +514,10 @@ bool StorageProvider::Delete(uint32_t clientId, const IO::DataKey& key)
 
 bool StorageProvider::Invalidate(uint32_t clientId, const IO::DataKey& key)
 {
+    const auto pending = pendingLoads_.find(key);
+    if (pending != pendingLoads_.end())
+        pending->second->stale = true;
+
     if (!FlushData(clientId, key))
     {
         LOG_ERROR << "Error flushing " << key.format() << std::endl;
@@ -465,6 +608,8 @@ bool StorageProvider::Clear(uint32_t clientId, const IO::DataKey&)
         index_.Delete(k);
     }
     namesCache_.Clear();
+    for (auto& pending : pendingLoads_)
+        pending.second->stale = true;
     LOG_INFO << "Cleared cache, removed " << toDelete.size() << " items" << std::endl;
     return true;
 }
@@ -573,27 +718,129 @@ void StorageProvider::FlushCache()
     if (cache_.size() == 0)
         return;
 
-    auto i = cache_.begin();
-    while ((i = ea::find_if(i, cache_.end(), [](const auto& current) -> bool
+    const int64_t start = sa::time::tick();
+    // Group dirty records by table, so a batch writes to few tables
+    ea::unordered_map<size_t, ea::vector<IO::DataKey>> tables;
+    size_t count = 0;
+    for (const auto& current : cache_)
     {
-        // Don't return deleted, these are flushed in CleanCache()
-        if ((IsModified(current.second.flags) || !IsCreated(current.second.flags)) &&
-            !IsDeleted(current.second.flags))
-            return true;
+        // Don't flush deleted, these are flushed in CleanCache()
+        if (IsDirty(current.second.flags) && !IsDeleted(current.second.flags))
+        {
+            std::string table;
+            uuids::uuid id;
+            current.first.decode(table, id);
+            tables[sa::StringHashRt(table.c_str())].push_back(current.first);
+            ++count;
+        }
+    }
+    // Forget retries of records that are no longer in cache
+    for (auto it = flushRetries_.begin(); it != flushRetries_.end(); )
+    {
+        if (cache_.find((*it).first) == cache_.end())
+            it = flushRetries_.erase(it);
+        else
+            ++it;
+    }
+    if (count == 0)
+        return;
 
-        return false;
-    })) != cache_.end())
+    size_t written = 0;
+    size_t batches = 0;
+    for (const auto& table : tables)
+        written += WriteRecords(table.second, batches);
+
+    ++flushStats_.flushes;
+    flushStats_.lastDuration = sa::time::tick() - start;
+    flushStats_.maxDuration = std::max(flushStats_.maxDuration, flushStats_.lastDuration);
+    flushStats_.lastRecords = written;
+    flushStats_.lastBatches = batches;
+    flushStats_.pendingRetries = flushRetries_.size();
+    if (written != count || flushStats_.pendingRetries != 0)
     {
-        const IO::DataKey& key = (*i).first;
-        bool res = FlushData(MY_CLIENT_ID, key);
-        if (!res)
+        LOG_INFO << "Flushed " << written << " of " << count << " record(s) in " << batches <<
+            " transaction(s), " << flushStats_.lastDuration << "ms, " <<
+            flushStats_.pendingRetries << " to retry" << std::endl;
+    }
+    else
+    {
+        LOG_DEBUG << "Flushed " << written << " record(s) in " << batches << " transaction(s), " <<
+            flushStats_.lastDuration << "ms" << std::endl;
+    }
+}
+
+size_t StorageProvider::WriteRecords(const ea::vector<IO::DataKey>& keys, size_t& batches)
+{
+    const size_t batchSize = std::max(flushBatchSize_, 1u);
+    size_t written = 0;
+    ea::vector<IO::DataKey> batch;
+    batch.reserve(batchSize);
+    for (size_t i = 0; i < keys.size(); i += batchSize)
+    {
+        batch.assign(keys.begin() + i, keys.begin() + std::min(i + batchSize, keys.size()));
+        ++batches;
+        if (FlushBatch(batch))
         {
-            LOG_WARNING << "Error flushing " << key.format() << std::endl;
-            // Error, break for now and try  the next time.
-            // In case of lost connection it would try forever.
-            break;
+            written += batch.size();
+            for (const auto& key : batch)
+                flushRetries_.erase(key);
+            continue;
+        }
+
+        // The batch was rolled back. Write them one by one so only the bad records wait for the next flush.
+        for (const auto& key : batch)
+        {
+            if (FlushData(MY_CLIENT_ID, key))
+            {
+                ++written;
+                flushRetries_.erase(key);
+                continue;
+            }
+            const uint32_t attempts = ++flushRetries_[key];
+            ++flushStats_.retries;
+            LOG_WARNING << "Error flushing " << key.format() << ", attempt " << attempts << std::endl;
+        }
+    }
+    return written;
+}
+
+bool StorageProvider::FlushBatch(const ea::vector<IO::DataKey>& keys)
+{
+    // Flags are changed by a successful write, restore them when the transaction is rolled back
+    ea::vector<CacheFlags> flags;
+    flags.reserve(keys.size());
+    for (const auto& key : keys)
+    {
+        auto it = cache_.find(key);
+        flags.push_back(it != cache_.end() ? (*it).second.flags : 0);
+    }
+
+    {
+        DB::Database* db = DB::Database::Get();
+        DB::DBTransaction transaction(db);
+        if (transaction.Begin())
+        {
+            bool succ = true;
+            for (const auto& key : keys)
+            {
+                if (!FlushData(MY_CLIENT_ID, key))
+                {
+                    succ = false;
+                    break;
+                }
+            }
+            if (succ && transaction.Commit())
+                return true;
         }
     }
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        auto it = cache_.find(keys[i]);
+        if (it != cache_.end())
+            (*it).second.flags = flags[i];
+    }
+    return false;
 }
 
 void StorageProvider::ClearPricesTask()
@@ -609,7 +856,7 @@ void StorageProvider::ClearPricesTask()
 
 void StorageProvider::FlushCacheTask()
 {
-    DB::Database* db = GetSubsystem<DB::Database>();
+    DB::Database* db = DB::Database::Get();
     db->CheckConnection();
     FlushCache();
     if (running_)
@@ -637,14 +884,52 @@ void StorageProvider::CreateSpace(size_t size)
 {
     // Create more than required space
     const size_t sizeNeeded = size * 2;
-    while ((currentSize_ + sizeNeeded) > maxSize_)
+    if ((currentSize_ + sizeNeeded) <= maxSize_)
+        return;
+    const size_t toFree = (currentSize_ + sizeNeeded) - maxSize_;
+
+    ea::vector<IO::DataKey> victims;
+    ea::vector<IO::DataKey> dirty;
+    size_t freed = 0;
+    index_.VisitVictims([&](const IO::DataKey& key) -> Iteration
     {
-        const IO::DataKey key = index_.Next();
-        if (FlushData(MY_CLIENT_ID, key))
-            RemoveData(MY_CLIENT_ID, key);
-        else
-            break;
+        const auto it = cache_.find(key);
+        if (it == cache_.end())
+            return Iteration::Continue;
+        const CacheItem& item = (*it).second;
+        // Locked records are in use, deleted records are removed by CleanCache()
+        if (item.locker != 0 || IsDeleted(item.flags))
+            return Iteration::Continue;
+        victims.push_back(key);
+        if (IsDirty(item.flags))
+            dirty.push_back(key);
+        freed += item.data->size();
+        return freed >= toFree ? Iteration::Break : Iteration::Continue;
+    });
+
+    // Write modified records in batches before they are removed
+    size_t batches = 0;
+    const size_t written = readonly_ ? 0 : WriteRecords(dirty, batches);
+    cacheStats_.evictionWrites += written;
+
+    size_t evicted = 0;
+    for (const auto& key : victims)
+    {
+        const auto it = cache_.find(key);
+        if (it == cache_.end())
+            continue;
+        if (!readonly_ && IsDirty((*it).second.flags))
+        {
+            // Keep it until it's written
+            ++cacheStats_.evictionFailures;
+            continue;
+        }
+        if (RemoveData(MY_CLIENT_ID, key))
+            ++evicted;
     }
+    cacheStats_.evictions += evicted;
+    LOG_DEBUG << "Evicted " << evicted << " record(s), wrote " << written << " record(s) in " <<
+        batches << " transaction(s), current size " << Utils::ConvertSize(currentSize_) << std::endl;
 }
 
 bool StorageProvider::RemoveData(uint32_t clientId, const IO::DataKey& key)
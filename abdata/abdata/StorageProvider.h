@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <functional>
 #include <mutex>
 #include <vector>
 #include <sa/Compiler.h>
@@ -47,8 +48,16 @@ PRAGMA_WARNING_POP
 #define CLEAN_CACHE_MS (1000 * 60 * 10)
 // Flush cache every minute
 #define FLUSH_CACHE_MS (1000 * 60)
+// Max records written in one transaction
+#define FLUSH_BATCH_SIZE 100
+// Threads loading records from the DB
+#define DB_WORKERS 4
 // Clear prices all 1 minute, is this a good value?
 #define CLEAR_PRICES_MS (1000 * 60)
+// Percent of the cache for records that were used more than once
+#define CACHE_PROTECTED_PERCENT 80
+// Records bigger than 1/n of the protected part are never protected
+#define CACHE_PROTECTED_ITEM_RATIO 16
 
 struct CacheFlag
 {
@@ -74,12 +83,19 @@ inline bool IsDeleted(CacheFlags flags)
 {
     return sa::bits::is_set(flags, CacheFlag::Deleted);
 }
+/// Must be written to the DB
+inline bool IsDirty(CacheFlags flags)
+{
+    return IsModified(flags) || !IsCreated(flags);
+}
 
 using StorageData = std::vector<uint8_t>;
 
 class StorageProvider
 {
 public:
+    /// Called from the dispatcher thread when an asynchronous read finished
+    using ReadCallback = std::function<void(bool success)>;
     StorageProvider(size_t maxSize, bool readonly);
 
     bool Lock(uint32_t clientId, const IO::DataKey& key);
@@ -87,6 +103,10 @@ public:
     bool Create(uint32_t clientId, const IO::DataKey& key, ea::shared_ptr<StorageData> data);
     bool Update(uint32_t clientId, const IO::DataKey& key, ea::shared_ptr<StorageData> data);
     bool Read(uint32_t clientId, const IO::DataKey& key, ea::shared_ptr<StorageData> data);
+    /// Like Read() but a cache miss doesn't block the dispatcher, the record is loaded
+    /// by the DB worker pool. Concurrent misses on the same key share one load.
+    void ReadAsync(uint32_t clientId, const IO::DataKey& key, ea::shared_ptr<StorageData> data,
+        ReadCallback&& callback);
     bool Delete(uint32_t clientId, const IO::DataKey& key);
     bool Invalidate(uint32_t clientId, const IO::DataKey& key);
     bool Preload(uint32_t clientId, const IO::DataKey& key);
@@ -159,10 +179,57 @@ public:
         const IO::DataKey aKey(E::KEY(), uuids::uuid(entity.uuid));
         return Invalidate(MY_CLIENT_ID, aKey);
     }
+    struct FlushStats
+    {
+        /// Number of flushes that wrote something
+        uint64_t flushes{ 0 };
+        /// Duration of the last flush in ms
+        int64_t lastDuration{ 0 };
+        int64_t maxDuration{ 0 };
+        /// Records written by the last flush
+        size_t lastRecords{ 0 };
+        /// Transactions used by the last flush
+        size_t lastBatches{ 0 };
+        /// Total number of records that failed and are retried with the next flush
+        uint64_t retries{ 0 };
+        /// Records currently waiting for a retry
+        size_t pendingRetries{ 0 };
+    };
+    struct CacheStats
+    {
+        uint64_t hits{ 0 };
+        uint64_t misses{ 0 };
+        /// Records removed to make space
+        uint64_t evictions{ 0 };
+        /// Modified records written before they were evicted
+        uint64_t evictionWrites{ 0 };
+        /// Modified records that could not be written and stay in cache
+        uint64_t evictionFailures{ 0 };
+        size_t records{ 0 };
+        size_t protectedRecords{ 0 };
+        size_t size{ 0 };
+        float GetHitRatio() const
+        {
+            const uint64_t total = hits + misses;
+            if (total == 0)
+                return 0.0f;
+            return static_cast<float>(hits) / static_cast<float>(total);
+        }
+    };
     void Shutdown();
     void UnlockAll(uint32_t clientId);
+    const FlushStats& GetFlushStats() const { return flushStats_; }
+    CacheStats GetCacheStats() const
+    {
+        CacheStats result = cacheStats_;
+        result.records = cache_.size();
+        result.protectedRecords = index_.GetProtectedCount();
+        result.size = currentSize_;
+        return result;
+    }
     uint32_t flushInterval_;
     uint32_t cleanInterval_;
+    uint32_t flushBatchSize_;
 private:
     static constexpr uint32_t MY_CLIENT_ID = std::numeric_limits<uint32_t>::max();
     struct CacheItem
@@ -171,6 +238,19 @@ private:
         uint32_t locker{ 0 };
         ea::shared_ptr<StorageData> data;
     };
+    /// A record being loaded by a DB worker
+    struct PendingLoad
+    {
+        IO::DataKey key;
+        std::string table;
+        uuids::uuid id;
+        /// Copy of the request data, needed to load records by name
+        StorageData request;
+        /// Data buffer and callback of each waiting client
+        ea::vector<ea::pair<ea::shared_ptr<StorageData>, ReadCallback>> waiters;
+        /// The record was flushed while loading, the loaded data may be outdated
+        bool stale{ false };
+    };
     sa::CallableTable<size_t, bool, StorageData&> exitsCallables_;
     sa::CallableTable<size_t, bool, CacheItem&> flushCallables_;
     sa::CallableTable<size_t, bool, const uuids::uuid&, StorageData&> loadCallables_;
@@ -207,6 +287,14 @@ private:
         ea::shared_ptr<StorageData> data,
         CacheFlags flags);
     bool RemoveData(uint32_t clientId, const IO::DataKey& key);
+    /// Lookup the key in cache and in the names cache. Returns false when it's not cached,
+    /// otherwise result is the result of the read.
+    bool ReadCached(const IO::DataKey& key, StorageData& data, bool& result);
+    /// Add data loaded from DB to the cache, when it was cached meanwhile data is set to the cached data
+    bool CacheLoaded(const std::string& table, uuids::uuid id, ea::shared_ptr<StorageData> data);
+    void StartLoad(ea::shared_ptr<PendingLoad> load);
+    void LoadTask(ea::shared_ptr<PendingLoad> load);
+    void FinishLoad(ea::shared_ptr<PendingLoad> load, ea::shared_ptr<StorageData> data, bool success);
     void PreloadTask(IO::DataKey key);
     bool ExistsData(const IO::DataKey& key, StorageData& data);
     /// If the data is a player and it's in playerNames_ remove it from playerNames_
@@ -215,6 +303,12 @@ private:
     void CleanCache();
     void CleanTask();
     void FlushCache();
+    /// Flush some records in one transaction. If one fails, all are rolled back.
+    bool FlushBatch(const ea::vector<IO::DataKey>& keys);
+    /// Flush the records in batches. When a batch fails its records are written one by one,
+    /// the records that still fail are retried with the next flush. Returns the number of
+    /// records written.
+    size_t WriteRecords(const ea::vector<IO::DataKey>& keys, size_t& batches);
     void FlushCacheTask();
     void ClearPrices();
     void ClearPricesTask();
@@ -328,6 +422,12 @@ private:
     size_t currentSize_;
 
     ea::unordered_map<IO::DataKey, CacheItem, std::hash<IO::DataKey>> cache_;
+    /// Records that failed to flush -> number of failed attempts
+    ea::unordered_map<IO::DataKey, uint32_t, std::hash<IO::DataKey>> flushRetries_;
+    FlushStats flushStats_;
+    CacheStats cacheStats_;
+    /// Records currently loaded by a DB worker. Only loads with an UUID are shared.
+    ea::unordered_map<IO::DataKey, ea::shared_ptr<PendingLoad>, std::hash<IO::DataKey>> pendingLoads_;
     /// Name (Playername, Guildname etc.) -> Cache Key
     NameIndex namesCache_;
     CacheIndex index_;
@@ -34,6 +34,8 @@
 #include "DatabaseSqlite.h"
 #endif
 #include <abscommon/Logger.h>
+#include <sa/Assert.h>
+#include <abscommon/Subsystems.h>
 
 namespace DB {
 
@@ -43,6 +45,7 @@ std::string Database::dbName_ = "";
 std::string Database::dbUser_ = "";
 std::string Database::dbPass_ = "";
 uint16_t Database::dbPort_ = 0;
+thread_local Database* Database::threadInstance_ = nullptr;
 
 Database* Database::CreateInstance(const std::string& driver,
     const std::string& host, uint16_t port,
@@ -55,26 +58,43 @@ Database* Database::CreateInstance(const std::string& driver,
     Database::dbUser_ = user;
     Database::dbPass_ = pass;
     Database::dbPort_ = port;
+    return CreateConnection();
+}
+
+Database* Database::CreateConnection()
+{
 #ifdef USE_MYSQL
-    if (driver.compare("mysql") == 0)
+    if (driver_.compare("mysql") == 0)
         return new DatabaseMysql();
 #endif
 #ifdef USE_PGSQL
-    if (driver.compare("pgsql") == 0)
+    if (driver_.compare("pgsql") == 0)
         return new DatabasePgsql();
 #endif
 #ifdef USE_ODBC
-    if (driver.compare("odbc") == 0)
+    if (driver_.compare("odbc") == 0)
         return new DatabaseOdbc();
 #endif
 #ifdef USE_SQLITE
-    if (driver.compare("sqlite") == 0)
+    if (driver_.compare("sqlite") == 0)
         return new DatabaseSqlite(Database::dbName_);
 #endif
-    LOG_ERROR << "Unknown/unsupported database driver " << driver << std::endl;
+    LOG_ERROR << "Unknown/unsupported database driver " << driver_ << std::endl;
     return nullptr;
 }
 
+Database* Database::Get()
+{
+    if (threadInstance_)
+        return threadInstance_;
+    return GetSubsystem<Database>();
+}
+
+void Database::SetThreadInstance(Database* db)
+{
+    threadInstance_ = db;
+}
+
 bool Database::ExecuteQuery(const std::string& query)
 {
     return InternalQuery(query);
@@ -85,6 +105,94 @@ std::shared_ptr<DBResult> Database::StoreQuery(const std::string& query)
     return InternalSelectQuery(query);
 }
 
+bool Database::ExecutePrepared(const DBStatement& statement, const DBParams& params)
+{
+    ASSERT(params.Size() == statement.GetParamCount());
+    return InternalExecutePrepared(statement, params);
+}
+
+std::shared_ptr<DBResult> Database::StorePrepared(const DBStatement& statement, const DBParams& params)
+{
+    ASSERT(params.Size() == statement.GetParamCount());
+    return InternalSelectPrepared(statement, params);
+}
+
+bool Database::InternalExecutePrepared(const DBStatement& statement, const DBParams& params)
+{
+    return InternalQuery(ExpandStatement(statement, params));
+}
+
+std::shared_ptr<DBResult> Database::InternalSelectPrepared(const DBStatement& statement, const DBParams& params)
+{
+    return InternalSelectQuery(ExpandStatement(statement, params));
+}
+
+std::string Database::ExpandStatement(const DBStatement& statement, const DBParams& params)
+{
+    const std::string_view sql(statement.GetSql());
+    std::string result;
+    result.reserve(sql.size());
+    size_t param = 0;
+    size_t pos = 0;
+    while (pos < sql.size())
+    {
+        const size_t start = sql.find("${", pos);
+        if (start == std::string_view::npos)
+        {
+            result.append(sql.substr(pos));
+            break;
+        }
+        result.append(sql.substr(pos, start - pos));
+        const size_t end = sql.find('}', start);
+        pos = (end == std::string_view::npos) ? sql.size() : end + 1;
+
+        const auto& value = params[param++];
+        switch (value.type)
+        {
+        case DBParams::Type::Null:
+            result.append("NULL");
+            break;
+        case DBParams::Type::Int:
+            result.append(std::to_string(value.intValue));
+            break;
+        case DBParams::Type::String:
+            result.append(EscapeString(value.stringValue));
+            break;
+        case DBParams::Type::Blob:
+            result.append(EscapeBlob(value.stringValue.data(), value.stringValue.length()));
+            break;
+        }
+    }
+    return result;
+}
+
+std::string DBStatement::Convert(bool numbered) const
+{
+    const std::string_view sql(sql_);
+    std::string result;
+    result.reserve(sql.size());
+    size_t param = 0;
+    size_t pos = 0;
+    while (pos < sql.size())
+    {
+        const size_t start = sql.find("${", pos);
+        if (start == std::string_view::npos)
+        {
+            result.append(sql.substr(pos));
+            break;
+        }
+        result.append(sql.substr(pos, start - pos));
+        const size_t end = sql.find('}', start);
+        pos = (end == std::string_view::npos) ? sql.size() : end + 1;
+        ++param;
+        if (numbered)
+            result.append("$" + std::to_string(param));
+        else
+            result.push_back('?');
+    }
+    return result;
+}
+
 std::shared_ptr<DBResult> Database::VerifyResult(std::shared_ptr<DBResult> result)
 {
     if (!result->Next())
@@ -99,4 +207,95 @@ void Database::FreeResult(DBResult*)
 
 DBResult::~DBResult() = default;
 
+void DBResult::AddColumn(std::string_view name, int index)
+{
+    columns_.push_back({ sa::StringHash(name), index, std::string(name) });
+}
+
+int DBResult::GetColumnIndex(size_t hash, std::string_view name) const
+{
+    // Results have few columns, a linear search over the hashes is fast enough
+    for (const auto& column : columns_)
+    {
+        if (column.hash == hash && column.name == name)
+            return column.index;
+    }
+    return InvalidColumn;
+}
+
+int32_t DBResult::GetInt(const std::string& col)
+{
+    const int column = GetColumnIndex(col);
+    if (column != InvalidColumn)
+        return GetInt(column);
+
+    LOG_ERROR << "Error during GetInt(" << col << ")." << std::endl;
+    return 0;
+}
+
+uint32_t DBResult::GetUInt(const std::string& col)
+{
+    const int column = GetColumnIndex(col);
+    if (column != InvalidColumn)
+        return GetUInt(column);
+
+    LOG_ERROR << "Error during GetUInt(" << col << ")." << std::endl;
+    return 0;
+}
+
+int64_t DBResult::GetLong(const std::string& col)
+{
+    const int column = GetColumnIndex(col);
+    if (column != InvalidColumn)
+        return GetLong(column);
+
+    LOG_ERROR << "Error during GetLong(" << col << ")." << std::endl;
+    return 0;
+}
+
+uint64_t DBResult::GetULong(const std::string& col)
+{
+    const int column = GetColumnIndex(col);
+    if (column != InvalidColumn)
+        return GetULong(column);
+
+    LOG_ERROR << "Error during GetULong(" << col << ")." << std::endl;
+    return 0;
+}
+
+time_t DBResult::GetTime(const std::string& col)
+{
+    return static_cast<time_t>(GetLong(col));
+}
+
+std::string DBResult::GetString(const std::string& col)
+{
+    const int column = GetColumnIndex(col);
+    if (column != InvalidColumn)
+        return GetString(column);
+
+    LOG_ERROR << "Error during GetString(" << col << ")." << std::endl;
+    return std::string("");
+}
+
+std::string DBResult::GetStream(const std::string& col)
+{
+    const int column = GetColumnIndex(col);
+    if (column != InvalidColumn)
+        return GetStream(column);
+
+    LOG_ERROR << "Error during GetStream(" << col << ")." << std::endl;
+    return std::string("");
+}
+
+bool DBResult::IsNull(const std::string& col)
+{
+    const int column = GetColumnIndex(col);
+    if (column != InvalidColumn)
+        return IsNull(column);
+
+    LOG_ERROR << "Error during IsNull(" << col << ")." << std::endl;
+    return true;
+}
+
 }
@@ -21,10 +21,17 @@
 
 #pragma once
 
+#include <array>
 #include <mutex>
 #include <sstream>
 #include <memory>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 #include <sa/Compiler.h>
+#include <sa/StringHash.h>
+#include <abscommon/Logger.h>
 
 namespace DB {
 
@@ -37,6 +44,95 @@ enum DBParam
     DBPARAM_MULTIINSERT = 1
 };
 
+/// A SQL statement with ${name} placeholders, e.g.
+///   static constexpr DBStatement SQL("SELECT * FROM players WHERE uuid = ${uuid}");
+/// Parameters are bound in the order of the placeholders, the names just document
+/// the statement. The ID and the number of parameters are computed at compile time.
+class DBStatement
+{
+private:
+    const char* sql_;
+    size_t id_;
+    size_t paramCount_;
+    static constexpr size_t CountParams(std::string_view sql)
+    {
+        size_t result = 0;
+        for (size_t i = 0; i + 1 < sql.size(); ++i)
+        {
+            if (sql[i] == '$' && sql[i + 1] == '{')
+                ++result;
+        }
+        return result;
+    }
+public:
+    constexpr explicit DBStatement(const char* sql) :
+        sql_(sql),
+        id_(sa::StringHash(std::string_view(sql))),
+        paramCount_(CountParams(sql))
+    { }
+    constexpr const char* GetSql() const { return sql_; }
+    constexpr size_t GetId() const { return id_; }
+    constexpr size_t GetParamCount() const { return paramCount_; }
+    /// Replace the placeholders with $1, $2... when numbered is true, otherwise with ?
+    std::string Convert(bool numbered) const;
+};
+
+/// Typed parameters for a DBStatement
+class DBParams
+{
+public:
+    enum class Type : uint8_t
+    {
+        Null,
+        Int,
+        String,
+        Blob
+    };
+    struct Value
+    {
+        Type type;
+        int64_t intValue;
+        std::string stringValue;
+    };
+private:
+    std::vector<Value> values_;
+public:
+    DBParams() = default;
+    template<typename T, typename = std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>>>
+    DBParams& Add(T value)
+    {
+        values_.push_back({ Type::Int, static_cast<int64_t>(value), {} });
+        return *this;
+    }
+    DBParams& Add(bool value)
+    {
+        values_.push_back({ Type::Int, value ? 1 : 0, {} });
+        return *this;
+    }
+    DBParams& Add(const std::string& value)
+    {
+        values_.push_back({ Type::String, 0, value });
+        return *this;
+    }
+    /// Without this a string literal would bind to Add(bool)
+    DBParams& Add(const char* value)
+    {
+        return Add(std::string(value));
+    }
+    DBParams& AddBlob(const std::string& value)
+    {
+        values_.push_back({ Type::Blob, 0, value });
+        return *this;
+    }
+    DBParams& AddNull()
+    {
+        values_.push_back({ Type::Null, 0, {} });
+        return *this;
+    }
+    size_t Size() const { return values_.size(); }
+    const Value& operator[](size_t index) const { return values_[index]; }
+};
+
 class SA_NOVTABLE Database
 {
 protected:
@@ -51,8 +147,18 @@ protected:
 
     virtual bool InternalQuery(const std::string& query) = 0;
     virtual std::shared_ptr<DBResult> InternalSelectQuery(const std::string& query) = 0;
+    /// Drivers without prepared statements send the statement with escaped values
+    virtual bool InternalExecutePrepared(const DBStatement& statement, const DBParams& params);
+    virtual std::shared_ptr<DBResult> InternalSelectPrepared(const DBStatement& statement, const DBParams& params);
+    std::string ExpandStatement(const DBStatement& statement, const DBParams& params);
     std::shared_ptr<DBResult> VerifyResult(std::shared_ptr<DBResult> result);
     bool connected_;
+    /// Connection used by the calling thread instead of the Database subsystem
+    static thread_local Database* threadInstance_;
+    /// Number of open DBTransactions, only the outermost really begins and commits
+    unsigned transactionDepth_{ 0 };
+    /// A nested transaction failed, the outermost must roll back
+    bool rollbackOnly_{ false };
 public:
     static std::string driver_;
     static std::string dbHost_;
@@ -67,12 +173,23 @@ public:
         const std::string& host, uint16_t port,
         const std::string& user, const std::string& pass,
         const std::string& name);
+    /// Create a new connection with the current configuration
+    static Database* CreateConnection();
+    /// Returns the connection of the calling thread. Worker threads which query the
+    /// database concurrently have their own connection, all others use the subsystem.
+    static Database* Get();
+    /// Make db the connection of the calling thread, nullptr to use the subsystem again
+    static void SetThreadInstance(Database* db);
 
     virtual bool GetParam(DBParam) { return false; }
     bool IsConnected() const { return connected_; }
 
     bool ExecuteQuery(const std::string& query);
     std::shared_ptr<DBResult> StoreQuery(const std::string& query);
+    /// Execute a statement with bound parameters. It is prepared on the first use
+    /// and the prepared statement is cached by the connection.
+    bool ExecutePrepared(const DBStatement& statement, const DBParams& params);
+    std::shared_ptr<DBResult> StorePrepared(const DBStatement& statement, const DBParams& params);
     virtual void FreeResult(DBResult* res);
     virtual uint64_t GetLastInsertId() = 0;
     virtual std::string EscapeString(const std::string& s) = 0;
@@ -80,42 +197,227 @@ public:
     virtual bool CheckConnection() { return false; }
 };
 
+/// Column names of a result set known at compile time, e.g.
+///   static constexpr DBColumns COLUMNS("uuid", "name");
+///   const auto columns = result->Resolve(COLUMNS);
+///   result->GetString(columns[0]);
+/// The hashes of the names are computed at compile time, Resolve() looks them up
+/// once per result set.
+template<size_t Count>
+class DBColumns
+{
+private:
+    std::array<std::string_view, Count> names_;
+    std::array<size_t, Count> hashes_;
+public:
+    template<typename... Names>
+    constexpr explicit DBColumns(Names... names) :
+        names_{ std::string_view(names)... },
+        hashes_{ sa::StringHash(std::string_view(names))... }
+    {
+        static_assert(sizeof...(Names) == Count);
+    }
+    constexpr std::string_view GetName(size_t index) const { return names_[index]; }
+    constexpr size_t GetHash(size_t index) const { return hashes_[index]; }
+};
+
+template<typename... Names>
+DBColumns(Names...) -> DBColumns<sizeof...(Names)>;
+
 class DBResult : public std::enable_shared_from_this<DBResult>
 {
+private:
+    struct Column
+    {
+        size_t hash;
+        int index;
+        std::string name;
+    };
+    std::vector<Column> columns_;
 protected:
     DBResult() = default;
     virtual ~DBResult();
+    /// Drivers add the columns of the result set once when the result is created.
+    /// index is what the driver uses to address the column.
+    void AddColumn(std::string_view name, int index);
 public:
-    virtual int32_t GetInt(const std::string&) {
+    static constexpr int InvalidColumn = -1;
+
+    /// Returns the index of the column or InvalidColumn
+    int GetColumnIndex(size_t hash, std::string_view name) const;
+    int GetColumnIndex(std::string_view name) const
+    {
+        return GetColumnIndex(sa::StringHash(name), name);
+    }
+    template<size_t Count>
+    std::array<int, Count> Resolve(const DBColumns<Count>& columns) const
+    {
+        std::array<int, Count> result;
+        for (size_t i = 0; i < Count; ++i)
+            result[i] = GetColumnIndex(columns.GetHash(i), columns.GetName(i));
+        return result;
+    }
+
+    // Get values by column index. The index must be valid.
+    virtual int32_t GetInt(int) {
         return 0;
     }
-    virtual uint32_t GetUInt(const std::string&) {
+    virtual uint32_t GetUInt(int) {
         return 0;
     }
-    virtual int64_t GetLong(const std::string&) {
+    virtual int64_t GetLong(int) {
         return 0;
     }
-    virtual uint64_t GetULong(const std::string&) {
+    virtual uint64_t GetULong(int) {
         return 0;
     }
-    virtual time_t GetTime(const std::string&) {
+    time_t GetTime(int column) {
         // time_t = int64_t = BIGINT(20)
-        return 0;
+        return static_cast<time_t>(GetLong(column));
     }
-    virtual std::string GetString(const std::string&) {
-        return "''";
+    virtual std::string GetString(int) {
+        return std::string("");
     }
-    virtual std::string GetStream(const std::string&) {
+    virtual std::string GetStream(int) {
         return std::string("");
     }
-    virtual bool IsNull(const std::string&) {
+    virtual bool IsNull(int) {
         return true;
     }
 
+    // Get values by column name. Each call looks up the column, for many rows
+    // resolve the columns once with GetColumnIndex() or Resolve().
+    int32_t GetInt(const std::string& col);
+    uint32_t GetUInt(const std::string& col);
+    int64_t GetLong(const std::string& col);
+    uint64_t GetULong(const std::string& col);
+    time_t GetTime(const std::string& col);
+    std::string GetString(const std::string& col);
+    std::string GetStream(const std::string& col);
+    bool IsNull(const std::string& col);
+
     virtual std::shared_ptr<DBResult> Next() { return std::shared_ptr<DBResult>(); }
     virtual bool Empty() const { return true; }
 };
 
+/// A member of an entity stored in a column. Blobs set stream to true.
+template<typename T, typename V>
+struct DBField
+{
+    const char* name;
+    V T::*member;
+    bool stream;
+    constexpr DBField(const char* _name, V T::*_member, bool _stream = false) :
+        name(_name),
+        member(_member),
+        stream(_stream)
+    { }
+};
+
+/// Decodes the rows of a result set into entities, e.g.
+///   static constexpr DBRowMapping MAPPING(
+///       DBField("uuid", &AB::Entities::MailHeader::uuid),
+///       DBField("created", &AB::Entities::MailHeader::created));
+///   MAPPING.Load(db->StorePrepared(SQL, params), ml.mails);
+/// The column indices are resolved once per result set.
+template<typename T, typename... Fields>
+class DBRowMapping
+{
+private:
+    static constexpr size_t Count = sizeof...(Fields);
+    std::tuple<Fields...> fields_;
+    DBColumns<Count> columns_;
+
+    template<typename V>
+    static void Decode(DBResult& result, int column, bool stream, V& value)
+    {
+        if constexpr (std::is_same_v<V, std::string>)
+            value = stream ? result.GetStream(column) : result.GetString(column);
+        else if constexpr (std::is_same_v<V, bool>)
+            value = result.GetInt(column) != 0;
+        else if constexpr (std::is_enum_v<V>)
+        {
+            std::underlying_type_t<V> v;
+            Decode(result, column, stream, v);
+            value = static_cast<V>(v);
+        }
+        else if constexpr (std::is_integral_v<V> && sizeof(V) > sizeof(uint32_t))
+        {
+            if constexpr (std::is_signed_v<V>)
+                value = static_cast<V>(result.GetLong(column));
+            else
+                value = static_cast<V>(result.GetULong(column));
+        }
+        else if constexpr (std::is_integral_v<V>)
+        {
+            if constexpr (std::is_signed_v<V>)
+                value = static_cast<V>(result.GetInt(column));
+            else
+                value = static_cast<V>(result.GetUInt(column));
+        }
+        else
+            static_assert(!std::is_same_v<V, V>, "Unsupported field type");
+    }
+    template<size_t I>
+    void ReadField(DBResult& result, int column, T& entity) const
+    {
+        // A missing column leaves the member as it is
+        if (column == DBResult::InvalidColumn)
+            return;
+        const auto& field = std::get<I>(fields_);
+        Decode(result, column, field.stream, entity.*(field.member));
+    }
+    template<size_t... I>
+    void ReadFields(DBResult& result, const std::array<int, Count>& columns, T& entity, std::index_sequence<I...>) const
+    {
+        (ReadField<I>(result, columns[I], entity), ...);
+    }
+public:
+    constexpr explicit DBRowMapping(Fields... fields) :
+        fields_(fields...),
+        columns_(fields.name...)
+    { }
+    /// Columns which are not in the result set are logged and skipped by Read()
+    std::array<int, Count> Resolve(const DBResult& result) const
+    {
+        const auto columns = result.Resolve(columns_);
+        for (size_t i = 0; i < Count; ++i)
+        {
+            if (columns[i] == DBResult::InvalidColumn)
+                LOG_ERROR << "Column " << columns_.GetName(i) << " is not in the result set" << std::endl;
+        }
+        return columns;
+    }
+    /// Read the current row with the columns returned by Resolve()
+    void Read(DBResult& result, const std::array<int, Count>& columns, T& entity) const
+    {
+        ReadFields(result, columns, entity, std::make_index_sequence<Count>());
+    }
+    /// Append all rows to container, returns the number of rows read
+    template<typename Container>
+    size_t Load(std::shared_ptr<DBResult> result, Container& container) const
+    {
+        if (!result)
+            return 0;
+        const auto columns = Resolve(*result);
+        size_t count = 0;
+        for (; result; result = result->Next())
+        {
+            T& entity = container.emplace_back();
+            Read(*result, columns, entity);
+            ++count;
+        }
+        return count;
+    }
+};
+
+template<typename T, typename V, typename... Fields>
+DBRowMapping(DBField<T, V>, Fields...) -> DBRowMapping<T, DBField<T, V>, Fields...>;
+
+/// Transactions can be nested, e.g. to write many records in one transaction
+/// while each record uses its own DBTransaction. Only the outermost transaction
+/// talks to the database. When a nested transaction is not committed, the whole
+/// transaction is rolled back.
 class DBTransaction
 {
 private:
@@ -127,6 +429,18 @@ private:
     };
     Database* db_;
     State state_;
+    bool nested_{ false };
+    void Finish(bool success)
+    {
+        --db_->transactionDepth_;
+        if (nested_)
+        {
+            if (!success)
+                db_->rollbackOnly_ = true;
+            return;
+        }
+        db_->rollbackOnly_ = false;
+    }
 public:
     explicit DBTransaction(Database* db) :
         db_(db),
@@ -136,12 +450,18 @@ public:
     {
         if (state_ == State::Started)
         {
-            db_->Rollback();
+            if (!nested_)
+                db_->Rollback();
+            Finish(false);
         }
     }
     bool Begin()
     {
         state_ = State::Started;
+        nested_ = db_->transactionDepth_ != 0;
+        ++db_->transactionDepth_;
+        if (nested_)
+            return true;
         return db_->BeginTransaction();
     }
     bool Commit()
@@ -149,7 +469,21 @@ public:
         if (state_ == State::Started)
         {
             state_ = State::Committed;
-            return db_->Commit();
+            if (nested_)
+            {
+                Finish(true);
+                return true;
+            }
+            bool result;
+            if (db_->rollbackOnly_)
+            {
+                db_->Rollback();
+                result = false;
+            }
+            else
+                result = db_->Commit();
+            Finish(result);
+            return result;
         }
         return false;
     }
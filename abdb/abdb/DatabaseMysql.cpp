@@ -230,13 +230,12 @@ std::shared_ptr<DBResult> DatabaseMysql::InternalSelectQuery(const std::string&
 MysqlResult::MysqlResult(MYSQL_RES* res)
 {
     handle_ = res;
-    listNames_.clear();
 
     MYSQL_FIELD* field;
     int i = 0;
     while ((field = mysql_fetch_field(handle_)) != NULL)
     {
-        listNames_[field->name] = i;
+        AddColumn(field->name, i);
         ++i;
     }
 }
@@ -246,105 +245,54 @@ MysqlResult::~MysqlResult()
     mysql_free_result(handle_);
 }
 
-int32_t MysqlResult::GetInt(const std::string& col)
+int32_t MysqlResult::GetInt(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        if (row_[it->second])
-            return atoi(row_[it->second]);
-        return 0;
-    }
-
-    LOG_ERROR << "Error in GetInt(" << col << ")" << std::endl;
-    return 0; // Failed
-}
-
-uint32_t MysqlResult::GetUInt(const std::string& col)
-{
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        if (row_[it->second])
-            return strtoul(row_[it->second], nullptr, 0);
-        return 0;
-    }
-
-    LOG_ERROR << "Error in GetUInt(" << col << ")" << std::endl;
-    return 0; // Failed
+    if (row_[column])
+        return atoi(row_[column]);
+    return 0;
 }
 
-int64_t MysqlResult::GetLong(const std::string& col)
+uint32_t MysqlResult::GetUInt(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        if (row_[it->second])
-            return atoll(row_[it->second]);
-        return 0;
-    }
-
-    LOG_ERROR << "Error in GetLong(" << col << ")" << std::endl;
-    return 0; // Failed
+    if (row_[column])
+        return strtoul(row_[column], nullptr, 0);
+    return 0;
 }
 
-uint64_t MysqlResult::GetULong(const std::string& col)
+int64_t MysqlResult::GetLong(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        if (row_[it->second])
-            return strtoull(row_[it->second], nullptr, 0);
-        return 0;
-    }
-
-    LOG_ERROR << "Error in GetULong(" << col << ")" << std::endl;
-    return 0; // Failed
+    if (row_[column])
+        return atoll(row_[column]);
+    return 0;
 }
 
-time_t MysqlResult::GetTime(const std::string& col)
+uint64_t MysqlResult::GetULong(int column)
 {
-    return static_cast<time_t>(GetLong(col));
+    if (row_[column])
+        return strtoull(row_[column], nullptr, 0);
+    return 0;
 }
 
-std::string MysqlResult::GetString(const std::string& col)
+std::string MysqlResult::GetString(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        if (row_[it->second])
-            return std::string(row_[it->second]);
-        return std::string("");
-    }
-
-    LOG_ERROR << "Error in GetString(" << col << ")" << std::endl;
-    return std::string(""); // Failed
+    if (row_[column])
+        return std::string(row_[column]);
+    return std::string("");
 }
 
-std::string MysqlResult::GetStream(const std::string& col)
+std::string MysqlResult::GetStream(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
+    if (row_[column])
     {
-        if (row_[it->second])
-        {
-            unsigned long size = mysql_fetch_lengths(handle_)[it->second];
-            return std::string(row_[it->second], size);
-        }
+        unsigned long size = mysql_fetch_lengths(handle_)[column];
+        return std::string(row_[column], size);
     }
-
-    LOG_ERROR << "Error in GetStream(" << col << ")" << std::endl;
     return std::string("");
 }
 
-bool MysqlResult::IsNull(const std::string& col)
+bool MysqlResult::IsNull(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        return (row_[it->second] == nullptr);
-    }
-    return true;
+    return (row_[column] == nullptr);
 }
 
 std::shared_ptr<DBResult> MysqlResult::Next()
@@ -297,11 +297,12 @@ OdbcResult::OdbcResult(SQLHSTMT stmt)
     int16_t numCols;
     SQLNumResultCols(handle_, &numCols);
 
+    char name[129];
     for (int32_t i = 1; i <= numCols; i++)
     {
-        char* name = new char[129];
         SQLDescribeColA(handle_, (SQLUSMALLINT)i, (SQLCHAR*)name, (SQLUSMALLINT)129, NULL, NULL, NULL, NULL, NULL);
-        listNames_[name] = i;
+        // ODBC columns start at 1
+        AddColumn(name, i);
     }
 }
 
@@ -310,128 +311,90 @@ OdbcResult::~OdbcResult()
     SQLFreeHandle(SQL_HANDLE_STMT, handle_);
 }
 
-int32_t OdbcResult::GetInt(const std::string& col)
+int32_t OdbcResult::GetInt(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        int32_t value;
-        SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)it->second, SQL_C_SLONG, &value, 0, NULL);
+    int32_t value;
+    SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)column, SQL_C_SLONG, &value, 0, NULL);
 
-        if (RETURN_SUCCESS(ret))
-            return value;
-    }
+    if (RETURN_SUCCESS(ret))
+        return value;
 
-    LOG_ERROR << "Error during GetInt(" << col << ")." << std::endl;
-    return 0; // Failed}
+    LOG_ERROR << "Error during GetInt(" << column << ")." << std::endl;
+    return 0; // Failed
 }
 
-uint32_t OdbcResult::GetUInt(const std::string& col)
+uint32_t OdbcResult::GetUInt(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        uint32_t value;
-        SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)it->second, SQL_C_ULONG, &value, 0, NULL);
+    uint32_t value;
+    SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)column, SQL_C_ULONG, &value, 0, NULL);
 
-        if (RETURN_SUCCESS(ret))
-            return value;
-    }
+    if (RETURN_SUCCESS(ret))
+        return value;
 
-    LOG_ERROR << "Error during GetUInt(" << col << ")." << std::endl;
-    return 0; // Failed}
+    LOG_ERROR << "Error during GetUInt(" << column << ")." << std::endl;
+    return 0; // Failed
 }
 
-int64_t OdbcResult::GetLong(const std::string& col)
+int64_t OdbcResult::GetLong(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        int64_t value;
-        SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)it->second, SQL_C_SBIGINT, &value, 0, NULL);
+    int64_t value;
+    SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)column, SQL_C_SBIGINT, &value, 0, NULL);
 
-        if (RETURN_SUCCESS(ret))
-            return value;
-    }
+    if (RETURN_SUCCESS(ret))
+        return value;
 
-    LOG_ERROR << "Error during GetLong(" << col << ")." << std::endl;
+    LOG_ERROR << "Error during GetLong(" << column << ")." << std::endl;
     return 0; // Failed
 }
 
-uint64_t OdbcResult::GetULong(const std::string& col)
+uint64_t OdbcResult::GetULong(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        uint64_t value;
-        SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)it->second, SQL_C_UBIGINT, &value, 0, NULL);
+    uint64_t value;
+    SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)column, SQL_C_UBIGINT, &value, 0, NULL);
 
-        if (RETURN_SUCCESS(ret))
-            return value;
-    }
+    if (RETURN_SUCCESS(ret))
+        return value;
 
-    LOG_ERROR << "Error during GetULong(" << col << ")." << std::endl;
+    LOG_ERROR << "Error during GetULong(" << column << ")." << std::endl;
     return 0; // Failed
 }
 
-time_t OdbcResult::GetTime(const std::string& col)
+std::string OdbcResult::GetString(int column)
 {
-    return static_cast<time_t>(GetLong(col));
-}
+    char value[1024];
+    SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)column, SQL_C_CHAR, value, 1024, NULL);
 
-std::string OdbcResult::GetString(const std::string& col)
-{
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        char* value = new char[1024];
-
-        SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)it->second, SQL_C_CHAR, value, 1024, NULL);
-
-        if (RETURN_SUCCESS(ret))
-        {
-            std::string buff = std::string(value);
-            delete value;
-            return buff;
-        }
-    }
+    if (RETURN_SUCCESS(ret))
+        return std::string(value);
 
-    LOG_ERROR << "Error during GetString(" << col << ")." << std::endl;
+    LOG_ERROR << "Error during GetString(" << column << ")." << std::endl;
     return std::string(""); // Failed
 }
 
-std::string OdbcResult::GetStream(const std::string& col)
+std::string OdbcResult::GetStream(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        std::string result;
-        result.resize(1024);
-        unsigned long size;
-        SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)it->second, SQL_C_BINARY,
-            &result[0], 1024, (SQLLEN*)&size);
-
-        if (RETURN_SUCCESS(ret))
-            return result;
-    }
+    std::string result;
+    result.resize(1024);
+    unsigned long size;
+    SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)column, SQL_C_BINARY,
+        &result[0], 1024, (SQLLEN*)&size);
+
+    if (RETURN_SUCCESS(ret))
+        return result;
 
-    LOG_ERROR << "Error during GetStream(" << col << ")." << std::endl;
+    LOG_ERROR << "Error during GetStream(" << column << ")." << std::endl;
     return std::string(""); // Failed
 }
 
-bool OdbcResult::IsNull(const std::string& col)
+bool OdbcResult::IsNull(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        uint16_t value;
-        SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)it->second, SQL_C_SSHORT, &value, 0, NULL);
+    uint16_t value;
+    SQLRETURN ret = SQLGetData(handle_, (SQLUSMALLINT)column, SQL_C_SSHORT, &value, 0, NULL);
 
-        if (RETURN_SUCCESS(ret))
-            return value == SQL_NULL_DATA;
-    }
+    if (RETURN_SUCCESS(ret))
+        return value == SQL_NULL_DATA;
 
-    LOG_ERROR << "Error during IsNull(" << col << ")." << std::endl;
+    LOG_ERROR << "Error during IsNull(" << column << ")." << std::endl;
     return true; // Failed
 }
 
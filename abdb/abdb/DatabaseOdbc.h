@@ -67,21 +67,18 @@ class OdbcResult : public DBResult
 protected:
     OdbcResult(SQLHSTMT stmt);
 
-    typedef std::map<const std::string, uint32_t> ListNames;
-    ListNames listNames_;
     bool rowAvailable_;
 
     SQLHSTMT handle_;
 public:
     ~OdbcResult() override;
-    int32_t GetInt(const std::string& col) override;
-    uint32_t GetUInt(const std::string& col) override;
-    int64_t GetLong(const std::string& col) override;
-    uint64_t GetULong(const std::string& col) override;
-    time_t GetTime(const std::string& col) override;
-    std::string GetString(const std::string& col) override;
-    std::string GetStream(const std::string& col) override;
-    bool IsNull(const std::string& col) override;
+    int32_t GetInt(int column) override;
+    uint32_t GetUInt(int column) override;
+    int64_t GetLong(int column) override;
+    uint64_t GetULong(int column) override;
+    std::string GetString(int column) override;
+    std::string GetStream(int column) override;
+    bool IsNull(int column) override;
 
     bool Empty() const override { return !rowAvailable_; }
     std::shared_ptr<DBResult> Next() override;
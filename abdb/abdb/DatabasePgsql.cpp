@@ -87,6 +87,8 @@ bool DatabasePgsql::Connect(int numTries /* = 1 */)
             // When ping OK then try to connect
             handle_ = PQconnectdb(dns_.c_str());
             connected_ = PQstatus(handle_) == CONNECTION_OK;
+            // Prepared statements belong to the connection
+            prepared_.clear();
         }
         ++tr;
         if (!connected_ && remaingTries > 0)
@@ -278,11 +280,143 @@ TryAgain:
     return VerifyResult(results);
 }
 
+const std::string* DatabasePgsql::Prepare(const DBStatement& statement)
+{
+    const auto it = prepared_.find(statement.GetId());
+    if (it != prepared_.end())
+        return &it->second;
+
+    const std::string name = "s" + std::to_string(statement.GetId());
+    const std::string sql = statement.Convert(true);
+#ifdef DEBUG_SQL
+    LOG_DEBUG << "PGSQL PREPARE: " << name << ": " << sql << std::endl;
+#endif
+    PGresult* res = PQprepare(handle_, name.c_str(), sql.c_str(), static_cast<int>(statement.GetParamCount()), nullptr);
+    ExecStatusType stat = PQresultStatus(res);
+    sa::ScopeGuard deleteGguard([res]()
+    {
+        PQclear(res);
+    });
+    if (!PG_OK(stat))
+    {
+        LOG_ERROR << "PQprepare(): " << sql << ": " << PQresultErrorMessage(res) << std::endl;
+        return nullptr;
+    }
+    const auto inserted = prepared_.emplace(statement.GetId(), name);
+    return &inserted.first->second;
+}
+
+PGresult* DatabasePgsql::ExecPrepared(const DBStatement& statement, const DBParams& params)
+{
+    const std::string* name = Prepare(statement);
+    if (!name)
+        return nullptr;
+
+    // Numbers are sent in text format, so they work with any integer column type.
+    // Values are not escaped, the server never parses them as SQL.
+    const size_t count = params.Size();
+    std::vector<std::string> buffers(count);
+    std::vector<const char*> values(count, nullptr);
+    std::vector<int> lengths(count, 0);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& value = params[i];
+        switch (value.type)
+        {
+        case DBParams::Type::Null:
+            continue;
+        case DBParams::Type::Int:
+            buffers[i] = std::to_string(value.intValue);
+            values[i] = buffers[i].c_str();
+            break;
+        case DBParams::Type::String:
+            values[i] = value.stringValue.c_str();
+            break;
+        case DBParams::Type::Blob:
+            // Same encoding as EscapeBlob()
+            buffers[i] = base64::encode((const unsigned char*)value.stringValue.data(), value.stringValue.length());
+            values[i] = buffers[i].c_str();
+            break;
+        }
+        lengths[i] = static_cast<int>(strlen(values[i]));
+    }
+
+    return PQexecPrepared(handle_, name->c_str(), static_cast<int>(count),
+        values.data(), lengths.data(), nullptr, 0);
+}
+
+bool DatabasePgsql::InternalExecutePrepared(const DBStatement& statement, const DBParams& params)
+{
+    if (!connected_)
+        return false;
+
+    int numTries = 0;
+TryAgain:
+
+    ++numTries;
+    PGresult* res = ExecPrepared(statement, params);
+    ExecStatusType stat = PQresultStatus(res);
+
+    if (!PG_OK(stat))
+    {
+        LOG_ERROR << "PQexecPrepared(): " << statement.GetSql() << ": " << PQresultErrorMessage(res) << std::endl;
+        PQclear(res);
+
+        if (CheckConnection())
+        {
+            if (numTries < 3)
+            {
+                LOG_INFO << "Reconnected to database, trying again" << std::endl;
+                goto TryAgain;
+            }
+        }
+        return false;
+    }
+
+    PQclear(res);
+    return true;
+}
+
+std::shared_ptr<DBResult> DatabasePgsql::InternalSelectPrepared(const DBStatement& statement, const DBParams& params)
+{
+    if (!connected_)
+        return std::shared_ptr<DBResult>();
+
+    int numTries = 0;
+TryAgain:
+
+    ++numTries;
+    PGresult* res = ExecPrepared(statement, params);
+    ExecStatusType stat = PQresultStatus(res);
+
+    if (!PG_OK(stat))
+    {
+        LOG_ERROR << "PQexecPrepared(): " << statement.GetSql() << ": " << PQresultErrorMessage(res) << std::endl;
+        PQclear(res);
+        if (CheckConnection())
+        {
+            if (numTries < 3)
+            {
+                LOG_INFO << "Reconnected to database, trying again" << std::endl;
+                goto TryAgain;
+            }
+        }
+
+        return std::shared_ptr<DBResult>();
+    }
+
+    std::shared_ptr<DBResult> results(new PgsqlResult(res), std::bind(&Database::FreeResult, this, std::placeholders::_1));
+    return VerifyResult(results);
+}
+
 PgsqlResult::PgsqlResult(PGresult* res) :
     cursor_(-1),
     handle_(res)
 {
     rows_ = PQntuples(handle_) - 1;
+    const int fields = PQnfields(handle_);
+    for (int i = 0; i < fields; ++i)
+        AddColumn(PQfname(handle_, i), i);
 }
 
 PgsqlResult::~PgsqlResult()
@@ -290,59 +424,47 @@ PgsqlResult::~PgsqlResult()
     PQclear(handle_);
 }
 
-int32_t PgsqlResult::GetInt(const std::string& col)
+int32_t PgsqlResult::GetInt(int column)
 {
-    const int column = PQfnumber(handle_, col.c_str());
     ASSERT(column >= 0);
     return strtol(PQgetvalue(handle_, cursor_, column), nullptr, 10);
 }
 
-uint32_t PgsqlResult::GetUInt(const std::string& col)
+uint32_t PgsqlResult::GetUInt(int column)
 {
-    const int column = PQfnumber(handle_, col.c_str());
     ASSERT(column >= 0);
     return strtoul(PQgetvalue(handle_, cursor_, column), nullptr, 10);
 }
 
-int64_t PgsqlResult::GetLong(const std::string& col)
+int64_t PgsqlResult::GetLong(int column)
 {
-    const int column = PQfnumber(handle_, col.c_str());
     ASSERT(column >= 0);
     return strtoll(PQgetvalue(handle_, cursor_, column), nullptr, 10);
 }
 
-uint64_t PgsqlResult::GetULong(const std::string& col)
+uint64_t PgsqlResult::GetULong(int column)
 {
-    const int column = PQfnumber(handle_, col.c_str());
     ASSERT(column >= 0);
     return strtoull(PQgetvalue(handle_, cursor_, column), nullptr, 10);
 }
 
-time_t PgsqlResult::GetTime(const std::string& col)
-{
-    return static_cast<time_t>(GetLong(col));
-}
-
-std::string PgsqlResult::GetString(const std::string& col)
+std::string PgsqlResult::GetString(int column)
 {
-    const int column = PQfnumber(handle_, col.c_str());
     ASSERT(column >= 0);
     size_t size = PQgetlength(handle_, cursor_, column);
     return std::string(PQgetvalue(handle_, cursor_, column), size);
 }
 
-std::string PgsqlResult::GetStream(const std::string& col)
+std::string PgsqlResult::GetStream(int column)
 {
-    const int column = PQfnumber(handle_, col.c_str());
     ASSERT(column >= 0);
     size_t size = PQgetlength(handle_, cursor_, column);
     char* buf = PQgetvalue(handle_, cursor_, column);
     return base64::decode(buf, size);
 }
 
-bool PgsqlResult::IsNull(const std::string& col)
+bool PgsqlResult::IsNull(int column)
 {
-    const int column = PQfnumber(handle_, col.c_str());
     ASSERT(column >= 0);
     return PQgetisnull(handle_, cursor_, column) != 0;
 }
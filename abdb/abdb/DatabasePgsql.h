@@ -25,6 +25,7 @@
 
 #include "Database.h"
 #include <libpq-fe.h>
+#include <unordered_map>
 
 namespace DB {
 
@@ -33,9 +34,15 @@ class DatabasePgsql final : public Database
 protected:
     PGconn* handle_;
     std::string dns_;
+    /// Statement ID -> name of the prepared statement on this connection
+    std::unordered_map<size_t, std::string> prepared_;
     bool Connect(int numTries = 1);
     bool InternalQuery(const std::string& query) override;
     std::shared_ptr<DBResult> InternalSelectQuery(const std::string& query) override;
+    bool InternalExecutePrepared(const DBStatement& statement, const DBParams& params) override;
+    std::shared_ptr<DBResult> InternalSelectPrepared(const DBStatement& statement, const DBParams& params) override;
+    const std::string* Prepare(const DBStatement& statement);
+    PGresult* ExecPrepared(const DBStatement& statement, const DBParams& params);
 public:
     DatabasePgsql();
     ~DatabasePgsql() override;
@@ -62,14 +69,13 @@ protected:
     PGresult* handle_;
 public:
     ~PgsqlResult() override;
-    int32_t GetInt(const std::string& col) override;
-    uint32_t GetUInt(const std::string& col) override;
-    int64_t GetLong(const std::string& col) override;
-    uint64_t GetULong(const std::string& col) override;
-    time_t GetTime(const std::string& col) override;
-    std::string GetString(const std::string& col) override;
-    std::string GetStream(const std::string& col) override;
-    bool IsNull(const std::string& col) override;
+    int32_t GetInt(int column) override;
+    uint32_t GetUInt(int column) override;
+    int64_t GetLong(int column) override;
+    uint64_t GetULong(int column) override;
+    std::string GetString(int column) override;
+    std::string GetStream(int column) override;
+    bool IsNull(int column) override;
 
     bool Empty() const override { return cursor_ >= rows_; }
     std::shared_ptr<DBResult> Next() override;
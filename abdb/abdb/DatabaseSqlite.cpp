@@ -22,22 +22,28 @@
 #ifdef USE_SQLITE
 
 #include "DatabaseSqlite.h"
-#include "Logger.h"
+#include <abscommon/Logger.h>
+#include <sa/Assert.h>
 
 namespace DB {
 
 DatabaseSqlite::DatabaseSqlite(const std::string& file) :
-    Database()
+    Database(),
+    handle_(nullptr)
 {
     connected_ = false;
 
-    std::fstream fin(file.c_str(), std::ios::in | std::ios::binary);
-    if (fin.fail()) {
-        LOG_ERROR << "Failed to initialize SQLite connection. File " << file <<
-            " does not exist." << std::endl;
-        return;
+    // An in-memory database has no file
+    if (file != ":memory:")
+    {
+        std::fstream fin(file.c_str(), std::ios::in | std::ios::binary);
+        if (fin.fail()) {
+            LOG_ERROR << "Failed to initialize SQLite connection. File " << file <<
+                " does not exist." << std::endl;
+            return;
+        }
+        fin.close();
     }
-    fin.close();
 
     if (sqlite3_open(file.c_str(), &handle_) != SQLITE_OK)
     {
@@ -50,6 +56,8 @@ DatabaseSqlite::DatabaseSqlite(const std::string& file) :
 
 DatabaseSqlite::~DatabaseSqlite()
 {
+    for (const auto& stmt : prepared_)
+        sqlite3_finalize(stmt.second.stmt);
     sqlite3_close(handle_);
 }
 
@@ -135,6 +143,137 @@ std::shared_ptr<DBResult> DatabaseSqlite::InternalSelectQuery(const std::string
     return VerifyResult(results);
 }
 
+DatabaseSqlite::PreparedStatement* DatabaseSqlite::Prepare(const DBStatement& statement, sqlite3_stmt*& temp)
+{
+    temp = nullptr;
+    auto it = prepared_.find(statement.GetId());
+    if (it != prepared_.end() && !it->second.inUse)
+        return &it->second;
+
+    const std::string sql = statement.Convert(false);
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(handle_, sql.c_str(), (int)sql.length(), &stmt, NULL) != SQLITE_OK)
+    {
+        sqlite3_finalize(stmt);
+        LOG_ERROR << "sqlite3_prepare_v2(): SQLITE ERROR: " << sqlite3_errmsg(handle_) << " (" << sql << ")" << std::endl;
+        return nullptr;
+    }
+    if (it != prepared_.end())
+    {
+        // The cached one is still used by a result
+        temp = stmt;
+        return nullptr;
+    }
+    auto& result = prepared_[statement.GetId()];
+    result.stmt = stmt;
+    return &result;
+}
+
+bool DatabaseSqlite::Bind(sqlite3_stmt* stmt, const DBParams& params)
+{
+    for (size_t i = 0; i < params.Size(); ++i)
+    {
+        const auto& value = params[i];
+        const int index = static_cast<int>(i) + 1;
+        int ret = SQLITE_OK;
+        switch (value.type)
+        {
+        case DBParams::Type::Null:
+            ret = sqlite3_bind_null(stmt, index);
+            break;
+        case DBParams::Type::Int:
+            ret = sqlite3_bind_int64(stmt, index, value.intValue);
+            break;
+        case DBParams::Type::String:
+            ret = sqlite3_bind_text(stmt, index, value.stringValue.c_str(), (int)value.stringValue.length(), SQLITE_TRANSIENT);
+            break;
+        case DBParams::Type::Blob:
+        {
+            // Same encoding as EscapeBlob()
+            const std::string encoded = base64::encode((const unsigned char*)value.stringValue.data(), value.stringValue.length());
+            ret = sqlite3_bind_text(stmt, index, encoded.c_str(), (int)encoded.length(), SQLITE_TRANSIENT);
+            break;
+        }
+        }
+        if (ret != SQLITE_OK)
+        {
+            LOG_ERROR << "sqlite3_bind(): SQLITE ERROR: " << sqlite3_errmsg(handle_) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DatabaseSqlite::InternalExecutePrepared(const DBStatement& statement, const DBParams& params)
+{
+    std::lock_guard<std::recursive_mutex> lockClass(lock_);
+
+    if (!connected_)
+        return false;
+
+    sqlite3_stmt* temp = nullptr;
+    PreparedStatement* prepared = Prepare(statement, temp);
+    sqlite3_stmt* stmt = prepared ? prepared->stmt : temp;
+    if (!stmt)
+        return false;
+
+    bool result = Bind(stmt, params);
+    if (result)
+    {
+        int ret = sqlite3_step(stmt);
+        if (ret != SQLITE_OK && ret != SQLITE_DONE && ret != SQLITE_ROW)
+        {
+            LOG_ERROR << "sqlite3_step(): SQLITE ERROR: " << sqlite3_errmsg(handle_) << " (" << statement.GetSql() << ")" << std::endl;
+            result = false;
+        }
+    }
+
+    if (prepared)
+    {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+    else
+        sqlite3_finalize(stmt);
+    return result;
+}
+
+std::shared_ptr<DBResult> DatabaseSqlite::InternalSelectPrepared(const DBStatement& statement, const DBParams& params)
+{
+    std::lock_guard<std::recursive_mutex> lockClass(lock_);
+
+    if (!connected_)
+        return std::shared_ptr<DBResult>();
+
+    sqlite3_stmt* temp = nullptr;
+    PreparedStatement* prepared = Prepare(statement, temp);
+    sqlite3_stmt* stmt = prepared ? prepared->stmt : temp;
+    if (!stmt)
+        return std::shared_ptr<DBResult>();
+
+    if (!Bind(stmt, params))
+    {
+        if (prepared)
+        {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        }
+        else
+            sqlite3_finalize(stmt);
+        return std::shared_ptr<DBResult>();
+    }
+
+    bool* inUse = nullptr;
+    if (prepared)
+    {
+        prepared->inUse = true;
+        inUse = &prepared->inUse;
+    }
+    std::shared_ptr<DBResult> results(new SqliteResult(stmt, inUse),
+        std::bind(&Database::FreeResult, this, std::placeholders::_1));
+    return VerifyResult(results);
+}
+
 uint64_t DatabaseSqlite::GetLastInsertId()
 {
     return (uint64_t)sqlite3_last_insert_rowid(handle_);
@@ -164,102 +303,75 @@ void DatabaseSqlite::FreeResult(DBResult* res)
     delete (SqliteResult*)res;
 }
 
-SqliteResult::SqliteResult(sqlite3_stmt* res) :
+SqliteResult::SqliteResult(sqlite3_stmt* res, bool* inUse) :
     handle_(res),
+    inUse_(inUse),
     rowAvailable_(false)
 {
-    listNames_.clear();
     int32_t fields = sqlite3_column_count(handle_);
     for (int32_t i = 0; i < fields; i++)
     {
-        listNames_[sqlite3_column_name(handle_, i)] = i;
+        AddColumn(sqlite3_column_name(handle_, i), i);
     }
 }
 
 SqliteResult::~SqliteResult()
 {
-    sqlite3_finalize(handle_);
+    if (inUse_)
+    {
+        sqlite3_reset(handle_);
+        sqlite3_clear_bindings(handle_);
+        *inUse_ = false;
+    }
+    else
+        sqlite3_finalize(handle_);
 }
 
-int32_t SqliteResult::GetInt(const std::string& col)
+int32_t SqliteResult::GetInt(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-        return sqlite3_column_int(handle_, it->second);
-
-    LOG_ERROR << "Error during GetInt(" << col << ")." << std::endl;
-    return 0; // Failed
+    ASSERT(column >= 0);
+    return sqlite3_column_int(handle_, column);
 }
 
-uint32_t SqliteResult::GetUInt(const std::string& col)
+uint32_t SqliteResult::GetUInt(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-        return static_cast<uint32_t>(sqlite3_column_int(handle_, it->second));
-
-    LOG_ERROR << "Error during GetUInt(" << col << ")." << std::endl;
-    return 0; // Failed
+    ASSERT(column >= 0);
+    return static_cast<uint32_t>(sqlite3_column_int64(handle_, column));
 }
 
-int64_t SqliteResult::GetLong(const std::string& col)
+int64_t SqliteResult::GetLong(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-        return sqlite3_column_int64(handle_, it->second);
-
-    LOG_ERROR << "Error during GetLong(" << col << ")." << std::endl;
-    return 0; // Failed
+    ASSERT(column >= 0);
+    return sqlite3_column_int64(handle_, column);
 }
 
-uint64_t SqliteResult::GetULong(const std::string& col)
+uint64_t SqliteResult::GetULong(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-        return static_cast<uint64_t>(sqlite3_column_int64(handle_, it->second));
-
-    LOG_ERROR << "Error during GetULong(" << col << ")." << std::endl;
-    return 0; // Failed
+    ASSERT(column >= 0);
+    return static_cast<uint64_t>(sqlite3_column_int64(handle_, column));
 }
 
-time_t SqliteResult::GetTime(const std::string& col)
+std::string SqliteResult::GetString(int column)
 {
-    return static_cast<time_t>(GetLong(col));
+    ASSERT(column >= 0);
+    const char* value = reinterpret_cast<const char*>(sqlite3_column_text(handle_, column));
+    if (!value)
+        return std::string("");
+    return std::string(value, static_cast<size_t>(sqlite3_column_bytes(handle_, column)));
 }
 
-std::string SqliteResult::GetString(const std::string& col)
+std::string SqliteResult::GetStream(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        return std::string((const char*)sqlite3_column_text(handle_, it->second));
-    }
-
-    LOG_ERROR << "Error during GetString(" << col << ")." << std::endl;
-    return std::string(""); // Failed
-}
-
-std::string SqliteResult::GetStream(const std::string& col)
-{
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-    {
-        const char* value = (const char*)sqlite3_column_blob(handle_, it->second);
-        int size = sqlite3_column_bytes(handle_, it->second);
-        return base64::decode(value, size);
-    }
-
-    LOG_ERROR << "Error during GetStream(" << col << ")." << std::endl;
-    return std::string(""); // Failed
+    ASSERT(column >= 0);
+    const char* value = (const char*)sqlite3_column_blob(handle_, column);
+    int size = sqlite3_column_bytes(handle_, column);
+    return base64::decode(value, size);
 }
 
-bool SqliteResult::IsNull(const std::string& col)
+bool SqliteResult::IsNull(int column)
 {
-    ListNames::iterator it = listNames_.find(col);
-    if (it != listNames_.end())
-        return sqlite3_column_type(handle_, it->second) == SQLITE_NULL;
-
-    LOG_ERROR << "Error during IsNull(" << col << ")." << std::endl;
-    return true; // Failed
+    ASSERT(column >= 0);
+    return sqlite3_column_type(handle_, column) == SQLITE_NULL;
 }
 
 std::shared_ptr<DBResult> SqliteResult::Next()
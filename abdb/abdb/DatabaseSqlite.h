@@ -26,16 +26,30 @@
 #include "Database.h"
 #include <sqlite3.h>
 #include <map>
+#include <unordered_map>
 
 namespace DB {
 
 class DatabaseSqlite final : public Database
 {
 protected:
+    struct PreparedStatement
+    {
+        sqlite3_stmt* stmt{ nullptr };
+        /// A result is still reading from it
+        bool inUse{ false };
+    };
     sqlite3* handle_;
     std::recursive_mutex lock_;
+    /// Statement ID -> prepared statement
+    std::unordered_map<size_t, PreparedStatement> prepared_;
     bool InternalQuery(const std::string& query) override;
     std::shared_ptr<DBResult> InternalSelectQuery(const std::string& query) override;
+    bool InternalExecutePrepared(const DBStatement& statement, const DBParams& params) override;
+    std::shared_ptr<DBResult> InternalSelectPrepared(const DBStatement& statement, const DBParams& params) override;
+    /// Returns a cached statement, or a new one which must be finalized when the cached one is in use
+    PreparedStatement* Prepare(const DBStatement& statement, sqlite3_stmt*& temp);
+    bool Bind(sqlite3_stmt* stmt, const DBParams& params);
 public:
     DatabaseSqlite(const std::string& file);
     ~DatabaseSqlite() override;
@@ -55,22 +69,21 @@ class SqliteResult final : public DBResult
 {
     friend class DatabaseSqlite;
 protected:
-    explicit SqliteResult(sqlite3_stmt* res);
+    /// When inUse is not null the statement is cached and reset instead of finalized
+    explicit SqliteResult(sqlite3_stmt* res, bool* inUse = nullptr);
 
-    typedef std::map<const std::string, uint32_t> ListNames;
-    ListNames listNames_;
     sqlite3_stmt* handle_;
+    bool* inUse_;
     bool rowAvailable_;
 public:
     ~SqliteResult() override;
-    int32_t GetInt(const std::string& col) override;
-    uint32_t GetUInt(const std::string& col) override;
-    int64_t GetLong(const std::string& col) override;
-    uint64_t GetULong(const std::string& col) override;
-    time_t GetTime(const std::string& col) override;
-    std::string GetString(const std::string& col) override;
-    std::string GetStream(const std::string& col) override;
-    bool IsNull(const std::string& col) override;
+    int32_t GetInt(int column) override;
+    uint32_t GetUInt(int column) override;
+    int64_t GetLong(int column) override;
+    uint64_t GetULong(int column) override;
+    std::string GetString(int column) override;
+    std::string GetStream(int column) override;
+    bool IsNull(int column) override;
 
     bool Empty() const override { return !rowAvailable_; }
     std::shared_ptr<DBResult> Next() override;
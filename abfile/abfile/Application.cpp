@@ -64,6 +64,8 @@
 #include <abscommon/Xml.h>
 #include <fstream>
 #include <sstream>
+#define SA_ZLIB_SUPPORT
+#include <sa/compress.h>
 
 Application::Application() :
     ServerApp::ServerApp(),
@@ -81,10 +83,13 @@ Application::Application() :
     Subsystems::Instance.CreateSubsystem<Asynch::Dispatcher>();
     Subsystems::Instance.CreateSubsystem<Asynch::Scheduler>();
     Subsystems::Instance.CreateSubsystem<IO::SimpleConfigManager>();
-    Subsystems::Instance.CreateSubsystem<IO::DataClient>(*ioService_);
+    Subsystems::Instance.CreateSubsystem<IO::DataClient>();
     Subsystems::Instance.CreateSubsystem<Auth::BanManager>();
     Subsystems::Instance.CreateSubsystem<Net::MessageClient>(*ioService_);
     cli_.push_back({ "temp", { "-temp", "--temporary" }, "Temporary application", false, false, sa::arg_parser::option_type::none });
+    for (const char* name : { "game_maps", "game_skills", "game_professions", "game_attributes",
+        "game_effects", "game_items", "game_quests", "game_music" })
+        catalogs_[name];
 }
 
 Application::~Application()
@@ -260,6 +265,7 @@ bool Application::Initialize(const std::vector<std::string>& args)
     dataPort_ = static_cast<uint16_t>(config->GetGlobalInt("data_port", 0ll));
     requireAuth_ = config->GetGlobalBool("require_auth", false);
     maxThroughput_ = static_cast<uint64_t>(config->GetGlobalInt("max_throughput", 0ll));
+    throttle_.SetRate(maxThroughput_, FILE_CHUNK_SIZE);
 
     Auth::BanManager::LoginTries = static_cast<uint32_t>(config->GetGlobalInt("login_tries", 5ll));
     Auth::BanManager::LoginRetryTimeout = static_cast<uint32_t>(config->GetGlobalInt("login_retrytimeout", 5000ll));
@@ -532,22 +538,18 @@ SimpleWeb::CaseInsensitiveMultimap Application::GetDefaultHeader()
 }
 
 void Application::SendFileRange(std::shared_ptr<HttpsServer::Response> response,
-    const std::string& path,
+    std::shared_ptr<const CachedFile> file,
     const sa::http::range& range,
     bool multipart, const std::string& boundary)
 {
-    auto ifs = std::make_shared<std::ifstream>();
-    ifs->open(path, std::ifstream::in | std::ios::binary);
-    ASSERT(ifs);
-
-    ifs->seekg(0, std::ios::end);
-    auto fileSize = (long)ifs->tellg();
+    const size_t fileSize = file->GetSize();
+    if (fileSize == 0)
+        return;
     size_t start = range.start;
-    size_t end = (range.end != 0) ? range.end : (size_t)fileSize;
+    size_t end = (range.end != 0) ? range.end : fileSize;
     ASSERT(end > start);
     size_t length = end - start;
 
-    ifs->seekg(start, std::ios::beg);
     UpdateBytesSent(static_cast<size_t>(length));
 
     if (multipart)
@@ -559,53 +561,63 @@ void Application::SendFileRange(std::shared_ptr<HttpsServer::Response> response,
         response->write("\n");
     }
 
-    struct FileServer
+    SendFileChunk(std::move(response), std::move(file), start, length);
+}
+
+void Application::SendFileChunk(std::shared_ptr<HttpsServer::Response> response,
+    std::shared_ptr<const CachedFile> file, size_t offset, size_t remaining)
+{
+    const size_t chunkSize = std::min<size_t>(FILE_CHUNK_SIZE, remaining);
+    auto send = [this, response, file, offset, remaining, chunkSize]()
     {
-        static void ReadAndSend(uint64_t maxBytePerMSec, const std::shared_ptr<HttpsServer::Response>& response,
-            const std::shared_ptr<std::ifstream>& ifs, size_t remaining)
+        if (const uint8_t* data = file->GetData())
+        {
+            response->write(reinterpret_cast<const char*>(data + offset),
+                static_cast<std::streamsize>(chunkSize));
+        }
+        else
         {
-            size_t chunkSize = std::min<size_t>(131072u, remaining);
-            std::vector<char> buffer;
-            buffer.resize(chunkSize);
-            std::streamsize read_length;
-            sa::time::timer timer;
-            if ((read_length = ifs->read(&buffer[0], static_cast<std::streamsize>(buffer.size())).gcount()) > 0)
+            // The response copies the data, so one buffer per worker thread is enough
+            static thread_local std::vector<uint8_t> buffer(FILE_CHUNK_SIZE);
+            const size_t read = file->Read(offset, buffer.data(), chunkSize);
+            if (read != chunkSize)
             {
-                response->write(&buffer[0], read_length);
-                if (read_length == static_cast<std::streamsize>(buffer.size()))
-                {
-                    response->send([maxBytePerMSec, response, ifs, remaining, read_length](const SimpleWeb::error_code& ec)
-                    {
-                        if (!ec)
-                        {
-                            if ((long)remaining > read_length)
-                                ReadAndSend(maxBytePerMSec, response, ifs, remaining - read_length);
-                        }
-                        else
-                            LOG_ERROR << "Connection interrupted " << ec.default_error_condition().value() << " " <<
-                            ec.default_error_condition().message() << std::endl;
-                    });
-                }
-
-                if (maxBytePerMSec > 0)
-                {
-                    int64_t time = timer.elapsed_millis();
-                    if (time == 0)
-                        time = 1;
-                    uint64_t bytePerMs = (uint64_t)read_length / (uint64_t)time;
-                    if (maxBytePerMSec < bytePerMs)
-                    {
-                        uint64_t diff = bytePerMs - maxBytePerMSec;
-                        auto sleepMs = std::clamp<unsigned>(static_cast<unsigned>(((float)diff / (float)(1000 - time))) / 12,
-                            1u, 100u);
-                        // Throttle to meet max throughput
-                        std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
-                    }
-                }
+                LOG_ERROR << "File was truncated while sending it, closing connection" << std::endl;
+                // We can't send the promised Content-Length anymore
+                response->close_connection_after_response = true;
+                return;
             }
+            response->write(reinterpret_cast<const char*>(buffer.data()),
+                static_cast<std::streamsize>(chunkSize));
         }
+        if (remaining == chunkSize)
+            // Last chunk is sent when the response is destroyed
+            return;
+        response->send([self = shared_from_this(), response, file, offset, remaining, chunkSize](const SimpleWeb::error_code& ec)
+        {
+            if (ec)
+            {
+                LOG_ERROR << "Connection interrupted " << ec.default_error_condition().value() << " " <<
+                    ec.default_error_condition().message() << std::endl;
+                return;
+            }
+            self->SendFileChunk(response, file, offset + chunkSize, remaining - chunkSize);
+        });
     };
-    FileServer::ReadAndSend(maxThroughput_ / 1000, response, ifs, length);
+
+    const auto delay = throttle_.Reserve(chunkSize);
+    if (delay.count() == 0)
+    {
+        send();
+        return;
+    }
+    // Over the max throughput, continue later without blocking a worker thread
+    auto timer = std::make_shared<asio::steady_timer>(*ioService_, delay);
+    timer->async_wait([self = shared_from_this(), timer, send = std::move(send)](const std::error_code& ec)
+    {
+        if (!ec)
+            send();
+    });
 }
 
 void Application::GetHandlerDefault(std::shared_ptr<HttpsServer::Response> response,
@@ -642,11 +654,11 @@ void Application::GetHandlerDefault(std::shared_ptr<HttpsServer::Response> respo
             throw std::invalid_argument("hidden file");
         }
 
-        std::ifstream ifs(path.string(), std::ifstream::in | std::ios::binary | std::ios::ate);
-        if (!ifs)
+        auto file = fileCache_.Get(path.string());
+        if (!file)
             throw std::invalid_argument("could not read file");
 
-        auto fileSize = ifs.tellg();
+        const size_t fileSize = file->GetSize();
 
         const auto rangeHeaderIt = request->header.find("Range");
         sa::http::ranges ranges;
@@ -704,7 +716,7 @@ void Application::GetHandlerDefault(std::shared_ptr<HttpsServer::Response> respo
             response->write(header);
         }
 
-        SendFileRange(response, path.string(), ranges[0], multipart, boundary);
+        SendFileRange(response, std::move(file), ranges[0], multipart, boundary);
 
 #if 0
         if (multipart)
@@ -815,11 +827,10 @@ void Application::GetHandlerFiles(std::shared_ptr<HttpsServer::Response> respons
     response->write(stream, header);
 }
 
-void Application::GetHandlerGames(std::shared_ptr<HttpsServer::Response> response,
-    std::shared_ptr<HttpsServer::Request> request)
+void Application::SendCatalog(std::shared_ptr<HttpsServer::Response> response,
+    std::shared_ptr<HttpsServer::Request> request,
+    const std::string& versionName, RenderCatalog render)
 {
-    AB_PROFILE;
-
     if (!IsAllowed(request))
     {
         response->write(SimpleWeb::StatusCode::client_error_forbidden,
@@ -828,29 +839,99 @@ void Application::GetHandlerGames(std::shared_ptr<HttpsServer::Response> respons
     }
 
     auto* dataClient = GetSubsystem<IO::DataClient>();
-    AB::Entities::GameList gl;
-    if (!dataClient->Read(gl))
+    AB::Entities::Version v;
+    v.name = versionName;
+    if (!dataClient->Read(v))
     {
-        LOG_ERROR << "Error reading game list" << std::endl;
+        LOG_ERROR << "Error reading version " << versionName << std::endl;
         response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
         return;
     }
 
-    AB::Entities::Version gamesVersion;
-    gamesVersion.name = "game_maps";
-    if (!dataClient->Read(gamesVersion))
+    auto it = catalogs_.find(versionName);
+    ASSERT(it != catalogs_.end());
+    Catalog& catalog = it->second;
+    std::shared_ptr<const CatalogData> data;
     {
-        LOG_ERROR << "Error reading game version" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
+        std::lock_guard<std::mutex> lock(catalog.mutex);
+        if (!catalog.data || catalog.data->version != v.value)
+        {
+            pugi::xml_document doc;
+            if (!(this->*render)(v.value, doc))
+            {
+                response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
+                return;
+            }
+            auto newData = std::make_shared<CatalogData>();
+            newData->version = v.value;
+            newData->etag = "\"" + versionName + "-" + std::to_string(v.value) + "\"";
+            std::stringstream stream;
+            doc.save(stream);
+            newData->content = stream.str();
+
+            sa::zlib_compress compress;
+            newData->gzipContent.resize(newData->content.length() + 1024);
+            size_t compressedSize = newData->gzipContent.length();
+            if (compress(newData->content.data(), newData->content.length(), newData->gzipContent.data(), compressedSize))
+                newData->gzipContent.resize(compressedSize);
+            else
+            {
+                LOG_ERROR << "Compression Error" << std::endl;
+                newData->gzipContent.clear();
+            }
+            catalog.data = std::move(newData);
+        }
+        data = catalog.data;
+    }
+
+    SimpleWeb::CaseInsensitiveMultimap header = GetDefaultHeader();
+    header.emplace("Content-Type", "text/xml");
+    header.emplace("ETag", data->etag);
+    // The body depends on Accept-Encoding, caches must not mix them up
+    header.emplace("Vary", "Accept-Encoding");
+    const auto etagIt = request->header.find("If-None-Match");
+    if (etagIt != request->header.end() && etagIt->second == data->etag)
+    {
+        response->write(SimpleWeb::StatusCode::redirection_not_modified, header);
         return;
     }
-    pugi::xml_document doc;
+
+    const auto acceptIt = request->header.find("Accept-Encoding");
+    if (acceptIt != request->header.end() && acceptIt->second.find("gzip") != std::string::npos &&
+        !data->gzipContent.empty())
+    {
+        header.emplace("Content-Encoding", "gzip");
+        UpdateBytesSent(data->gzipContent.length());
+        response->write(data->gzipContent, header);
+        return;
+    }
+    UpdateBytesSent(data->content.length());
+    response->write(data->content, header);
+}
+
+void Application::GetHandlerGames(std::shared_ptr<HttpsServer::Response> response,
+    std::shared_ptr<HttpsServer::Request> request)
+{
+    AB_PROFILE;
+    SendCatalog(response, request, "game_maps", &Application::RenderGames);
+}
+
+bool Application::RenderGames(uint32_t version, pugi::xml_document& doc)
+{
+    auto* dataClient = GetSubsystem<IO::DataClient>();
+    AB::Entities::GameList gl;
+    if (!dataClient->Read(gl))
+    {
+        LOG_ERROR << "Error reading game list" << std::endl;
+        return false;
+    }
+
     auto declarationNode = doc.append_child(pugi::node_declaration);
     declarationNode.append_attribute("version").set_value("1.0");
     declarationNode.append_attribute("encoding").set_value("UTF-8");
     declarationNode.append_attribute("standalone").set_value("yes");
     auto root = doc.append_child("games");
-    root.append_attribute("version").set_value(gamesVersion.value);
+    root.append_attribute("version").set_value(version);
 
     for (const std::string& uuid : gl.gameUuids)
     {
@@ -870,50 +951,32 @@ void Application::GetHandlerGames(std::shared_ptr<HttpsServer::Response> respons
         // The rest is not interesting for the player, so skip it
     }
 
-    std::stringstream stream;
-    doc.save(stream);
-    SimpleWeb::CaseInsensitiveMultimap header = GetDefaultHeader();
-    header.emplace("Content-Type", "text/xml");
-    UpdateBytesSent(stream_size(stream));
-    response->write(stream, header);
+    return true;
 }
 
 void Application::GetHandlerSkills(std::shared_ptr<HttpsServer::Response> response,
     std::shared_ptr<HttpsServer::Request> request)
 {
     AB_PROFILE;
+    SendCatalog(response, request, "game_skills", &Application::RenderSkills);
+}
 
-    if (!IsAllowed(request))
-    {
-        response->write(SimpleWeb::StatusCode::client_error_forbidden,
-            "Forbidden");
-        return;
-    }
-
+bool Application::RenderSkills(uint32_t version, pugi::xml_document& doc)
+{
     auto* dataClient = GetSubsystem<IO::DataClient>();
     AB::Entities::SkillList sl;
     if (!dataClient->Read(sl))
     {
         LOG_ERROR << "Error reading skill list" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
-    }
-    AB::Entities::Version v;
-    v.name = "game_skills";
-    if (!dataClient->Read(v))
-    {
-        LOG_ERROR << "Error reading skill version" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
+        return false;
     }
 
-    pugi::xml_document doc;
     auto declarationNode = doc.append_child(pugi::node_declaration);
     declarationNode.append_attribute("version").set_value("1.0");
     declarationNode.append_attribute("encoding").set_value("UTF-8");
     declarationNode.append_attribute("standalone").set_value("yes");
     auto root = doc.append_child("skills");
-    root.append_attribute("version").set_value(v.value);
+    root.append_attribute("version").set_value(version);
 
     for (const std::string& uuid : sl.skillUuids)
     {
@@ -944,50 +1007,32 @@ void Application::GetHandlerSkills(std::shared_ptr<HttpsServer::Response> respon
         gNd.append_attribute("const_hp").set_value(s.costHp);
     }
 
-    std::stringstream stream;
-    doc.save(stream);
-    SimpleWeb::CaseInsensitiveMultimap header = GetDefaultHeader();
-    header.emplace("Content-Type", "text/xml");
-    UpdateBytesSent(stream_size(stream));
-    response->write(stream, header);
+    return true;
 }
 
 void Application::GetHandlerProfessions(std::shared_ptr<HttpsServer::Response> response,
     std::shared_ptr<HttpsServer::Request> request)
 {
     AB_PROFILE;
+    SendCatalog(response, request, "game_professions", &Application::RenderProfessions);
+}
 
-    if (!IsAllowed(request))
-    {
-        response->write(SimpleWeb::StatusCode::client_error_forbidden,
-            "Forbidden");
-        return;
-    }
-
+bool Application::RenderProfessions(uint32_t version, pugi::xml_document& doc)
+{
     auto* dataClient = GetSubsystem<IO::DataClient>();
     AB::Entities::ProfessionList pl;
     if (!dataClient->Read(pl))
     {
         LOG_ERROR << "Error reading profession list" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
-    }
-    AB::Entities::Version v;
-    v.name = "game_professions";
-    if (!dataClient->Read(v))
-    {
-        LOG_ERROR << "Error reading profession version" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
+        return false;
     }
 
-    pugi::xml_document doc;
     auto declarationNode = doc.append_child(pugi::node_declaration);
     declarationNode.append_attribute("version").set_value("1.0");
     declarationNode.append_attribute("encoding").set_value("UTF-8");
     declarationNode.append_attribute("standalone").set_value("yes");
     auto root = doc.append_child("professions");
-    root.append_attribute("version").set_value(v.value);
+    root.append_attribute("version").set_value(version);
 
     for (const std::string& uuid : pl.profUuids)
     {
@@ -1010,50 +1055,32 @@ void Application::GetHandlerProfessions(std::shared_ptr<HttpsServer::Response> r
         }
     }
 
-    std::stringstream stream;
-    doc.save(stream);
-    SimpleWeb::CaseInsensitiveMultimap header = GetDefaultHeader();
-    header.emplace("Content-Type", "text/xml");
-    UpdateBytesSent(stream_size(stream));
-    response->write(stream, header);
+    return true;
 }
 
 void Application::GetHandlerAttributes(std::shared_ptr<HttpsServer::Response> response,
     std::shared_ptr<HttpsServer::Request> request)
 {
     AB_PROFILE;
+    SendCatalog(response, request, "game_attributes", &Application::RenderAttributes);
+}
 
-    if (!IsAllowed(request))
-    {
-        response->write(SimpleWeb::StatusCode::client_error_forbidden,
-            "Forbidden");
-        return;
-    }
-
+bool Application::RenderAttributes(uint32_t version, pugi::xml_document& doc)
+{
     auto* dataClient = GetSubsystem<IO::DataClient>();
     AB::Entities::AttributeList pl;
     if (!dataClient->Read(pl))
     {
         LOG_ERROR << "Error reading attribute list" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
-    }
-    AB::Entities::Version v;
-    v.name = "game_attributes";
-    if (!dataClient->Read(v))
-    {
-        LOG_ERROR << "Error reading attribute version" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
+        return false;
     }
 
-    pugi::xml_document doc;
     auto declarationNode = doc.append_child(pugi::node_declaration);
     declarationNode.append_attribute("version").set_value("1.0");
     declarationNode.append_attribute("encoding").set_value("UTF-8");
     declarationNode.append_attribute("standalone").set_value("yes");
     auto root = doc.append_child("attributes");
-    root.append_attribute("version").set_value(v.value);
+    root.append_attribute("version").set_value(version);
 
     for (const std::string& uuid : pl.uuids)
     {
@@ -1069,50 +1096,32 @@ void Application::GetHandlerAttributes(std::shared_ptr<HttpsServer::Response> re
         gNd.append_attribute("primary").set_value(s.isPrimary);
     }
 
-    std::stringstream stream;
-    doc.save(stream);
-    SimpleWeb::CaseInsensitiveMultimap header = GetDefaultHeader();
-    header.emplace("Content-Type", "text/xml");
-    UpdateBytesSent(stream_size(stream));
-    response->write(stream, header);
+    return true;
 }
 
 void Application::GetHandlerEffects(std::shared_ptr<HttpsServer::Response> response,
     std::shared_ptr<HttpsServer::Request> request)
 {
     AB_PROFILE;
+    SendCatalog(response, request, "game_effects", &Application::RenderEffects);
+}
 
-    if (!IsAllowed(request))
-    {
-        response->write(SimpleWeb::StatusCode::client_error_forbidden,
-            "Forbidden");
-        return;
-    }
-
+bool Application::RenderEffects(uint32_t version, pugi::xml_document& doc)
+{
     auto* dataClient = GetSubsystem<IO::DataClient>();
     AB::Entities::EffectList pl;
     if (!dataClient->Read(pl))
     {
         LOG_ERROR << "Error reading effect list" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
-    }
-    AB::Entities::Version v;
-    v.name = "game_effects";
-    if (!dataClient->Read(v))
-    {
-        LOG_ERROR << "Error reading effect version" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
+        return false;
     }
 
-    pugi::xml_document doc;
     auto declarationNode = doc.append_child(pugi::node_declaration);
     declarationNode.append_attribute("version").set_value("1.0");
     declarationNode.append_attribute("encoding").set_value("UTF-8");
     declarationNode.append_attribute("standalone").set_value("yes");
     auto root = doc.append_child("effects");
-    root.append_attribute("version").set_value(v.value);
+    root.append_attribute("version").set_value(version);
 
     for (const std::string& uuid : pl.effectUuids)
     {
@@ -1130,50 +1139,32 @@ void Application::GetHandlerEffects(std::shared_ptr<HttpsServer::Response> respo
         gNd.append_attribute("particle_effect").set_value(s.particleEffect.c_str());
     }
 
-    std::stringstream stream;
-    doc.save(stream);
-    SimpleWeb::CaseInsensitiveMultimap header = GetDefaultHeader();
-    header.emplace("Content-Type", "text/xml");
-    UpdateBytesSent(stream_size(stream));
-    response->write(stream, header);
+    return true;
 }
 
 void Application::GetHandlerItems(std::shared_ptr<HttpsServer::Response> response,
     std::shared_ptr<HttpsServer::Request> request)
 {
     AB_PROFILE;
+    SendCatalog(response, request, "game_items", &Application::RenderItems);
+}
 
-    if (!IsAllowed(request))
-    {
-        response->write(SimpleWeb::StatusCode::client_error_forbidden,
-            "Forbidden");
-        return;
-    }
-
+bool Application::RenderItems(uint32_t version, pugi::xml_document& doc)
+{
     auto* dataClient = GetSubsystem<IO::DataClient>();
     AB::Entities::ItemList pl;
     if (!dataClient->Read(pl))
     {
         LOG_ERROR << "Error reading item list" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
-    }
-    AB::Entities::Version v;
-    v.name = "game_items";
-    if (!dataClient->Read(v))
-    {
-        LOG_ERROR << "Error reading items version" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
+        return false;
     }
 
-    pugi::xml_document doc;
     auto declarationNode = doc.append_child(pugi::node_declaration);
     declarationNode.append_attribute("version").set_value("1.0");
     declarationNode.append_attribute("encoding").set_value("UTF-8");
     declarationNode.append_attribute("standalone").set_value("yes");
     auto root = doc.append_child("items");
-    root.append_attribute("version").set_value(v.value);
+    root.append_attribute("version").set_value(version);
 
     for (const std::string& uuid : pl.itemUuids)
     {
@@ -1192,50 +1183,32 @@ void Application::GetHandlerItems(std::shared_ptr<HttpsServer::Response> respons
         gNd.append_attribute("item_flags").set_value(s.itemFlags);
     }
 
-    std::stringstream stream;
-    doc.save(stream);
-    SimpleWeb::CaseInsensitiveMultimap header = GetDefaultHeader();
-    header.emplace("Content-Type", "text/xml");
-    UpdateBytesSent(stream_size(stream));
-    response->write(stream, header);
+    return true;
 }
 
 void Application::GetHandlerQuests(std::shared_ptr<HttpsServer::Response> response,
     std::shared_ptr<HttpsServer::Request> request)
 {
     AB_PROFILE;
+    SendCatalog(response, request, "game_quests", &Application::RenderQuests);
+}
 
-    if (!IsAllowed(request))
-    {
-        response->write(SimpleWeb::StatusCode::client_error_forbidden,
-            "Forbidden");
-        return;
-    }
-
+bool Application::RenderQuests(uint32_t version, pugi::xml_document& doc)
+{
     auto* dataClient = GetSubsystem<IO::DataClient>();
     AB::Entities::QuestList gl;
     if (!dataClient->Read(gl))
     {
         LOG_ERROR << "Error reading game list" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
+        return false;
     }
 
-    AB::Entities::Version gamesVersion;
-    gamesVersion.name = "game_quests";
-    if (!dataClient->Read(gamesVersion))
-    {
-        LOG_ERROR << "Error reading game version" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
-    }
-    pugi::xml_document doc;
     auto declarationNode = doc.append_child(pugi::node_declaration);
     declarationNode.append_attribute("version").set_value("1.0");
     declarationNode.append_attribute("encoding").set_value("UTF-8");
     declarationNode.append_attribute("standalone").set_value("yes");
     auto root = doc.append_child("quests");
-    root.append_attribute("version").set_value(gamesVersion.value);
+    root.append_attribute("version").set_value(version);
 
     for (const std::string& uuid : gl.questUuids)
     {
@@ -1253,50 +1226,32 @@ void Application::GetHandlerQuests(std::shared_ptr<HttpsServer::Response> respon
         gNd.append_attribute("reward_items").set_value(sa::CombineString(g.rewardItems, std::string(";")).c_str());
     }
 
-    std::stringstream stream;
-    doc.save(stream);
-    SimpleWeb::CaseInsensitiveMultimap header = GetDefaultHeader();
-    header.emplace("Content-Type", "text/xml");
-    UpdateBytesSent(stream_size(stream));
-    response->write(stream, header);
+    return true;
 }
 
 void Application::GetHandlerMusic(std::shared_ptr<HttpsServer::Response> response,
     std::shared_ptr<HttpsServer::Request> request)
 {
     AB_PROFILE;
+    SendCatalog(response, request, "game_music", &Application::RenderMusic);
+}
 
-    if (!IsAllowed(request))
-    {
-        response->write(SimpleWeb::StatusCode::client_error_forbidden,
-            "Forbidden");
-        return;
-    }
-
+bool Application::RenderMusic(uint32_t version, pugi::xml_document& doc)
+{
     auto* dataClient = GetSubsystem<IO::DataClient>();
     AB::Entities::MusicList pl;
     if (!dataClient->Read(pl))
     {
         LOG_ERROR << "Error reading music list" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
-    }
-    AB::Entities::Version v;
-    v.name = "game_music";
-    if (!dataClient->Read(v))
-    {
-        LOG_ERROR << "Error reading music version" << std::endl;
-        response->write(SimpleWeb::StatusCode::client_error_not_found, "Not found");
-        return;
+        return false;
     }
 
-    pugi::xml_document doc;
     auto declarationNode = doc.append_child(pugi::node_declaration);
     declarationNode.append_attribute("version").set_value("1.0");
     declarationNode.append_attribute("encoding").set_value("UTF-8");
     declarationNode.append_attribute("standalone").set_value("yes");
     auto root = doc.append_child("music_list");
-    root.append_attribute("version").set_value(v.value);
+    root.append_attribute("version").set_value(version);
 
     for (const std::string& uuid : pl.musicUuids)
     {
@@ -1313,12 +1268,7 @@ void Application::GetHandlerMusic(std::shared_ptr<HttpsServer::Response> respons
         gNd.append_attribute("style").set_value(static_cast<uint32_t>(s.style));
     }
 
-    std::stringstream stream;
-    doc.save(stream);
-    SimpleWeb::CaseInsensitiveMultimap header = GetDefaultHeader();
-    header.emplace("Content-Type", "text/xml");
-    UpdateBytesSent(stream_size(stream));
-    response->write(stream, header);
+    return true;
 }
 
 void Application::GetHandlerVersion(std::shared_ptr<HttpsServer::Response> response,
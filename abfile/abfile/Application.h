@@ -34,9 +34,13 @@
 #endif
 #include <abscommon/MessageClient.h>
 #include "Servers.h"
+#include "FileCache.h"
+#include "TokenBucket.h"
 #include <numeric>
 #include <sa/CircularQueue.h>
 #include <sa/http_range.h>
+#include <map>
+#include <pugixml.hpp>
 
 #if __cplusplus < 201703L
 // C++14
@@ -64,6 +68,23 @@ inline size_t stream_size(T& s)
 class Application final : public ServerApp, public std::enable_shared_from_this<Application>
 {
 private:
+    static constexpr size_t FILE_CHUNK_SIZE = 128 * 1024;
+    /// A game data catalog rendered for one version
+    struct CatalogData
+    {
+        uint32_t version{ 0 };
+        std::string etag;
+        std::string content;
+        /// Empty if compression failed
+        std::string gzipContent;
+    };
+    struct Catalog
+    {
+        /// Held while rendering, so concurrent requests wait for one render
+        std::mutex mutex;
+        std::shared_ptr<const CatalogData> data;
+    };
+    using RenderCatalog = bool (Application::*)(uint32_t version, pugi::xml_document& doc);
     bool requireAuth_;
     std::shared_ptr<asio::io_service> ioService_;
     int64_t startTime_;
@@ -79,21 +100,40 @@ private:
     uint16_t dataPort_;
     /// Byte/sec
     uint64_t maxThroughput_;
+    /// Limits file downloads to maxThroughput_
+    TokenBucket throttle_;
+    FileCache fileCache_;
     sa::CircularQueue<unsigned, 10> loads_;
     std::mutex mutex_;
+    /// Version name -> Catalog. The keys are added in the constructor and never change.
+    std::map<std::string, Catalog> catalogs_;
     void HandleMessage(const Net::MessageMsg& msg);
     void UpdateBytesSent(size_t bytes);
     void HeartBeatTask();
     bool IsAllowed(std::shared_ptr<HttpsServer::Request> request);
     static SimpleWeb::CaseInsensitiveMultimap GetDefaultHeader();
     void SendFileRange(std::shared_ptr<HttpsServer::Response> response,
-        const std::string& path,
+        std::shared_ptr<const CachedFile> file,
         const sa::http::range& range,
         bool multipart, const std::string& boundary);
+    void SendFileChunk(std::shared_ptr<HttpsServer::Response> response,
+        std::shared_ptr<const CachedFile> file, size_t offset, size_t remaining);
     void GetHandlerDefault(std::shared_ptr<HttpsServer::Response> response,
         std::shared_ptr<HttpsServer::Request> request);
     void GetHandlerFiles(std::shared_ptr<HttpsServer::Response> response,
         std::shared_ptr<HttpsServer::Request> request);
+    /// Send the catalog of the current version of versionName, renders it when the version changed.
+    void SendCatalog(std::shared_ptr<HttpsServer::Response> response,
+        std::shared_ptr<HttpsServer::Request> request,
+        const std::string& versionName, RenderCatalog render);
+    bool RenderGames(uint32_t version, pugi::xml_document& doc);
+    bool RenderSkills(uint32_t version, pugi::xml_document& doc);
+    bool RenderProfessions(uint32_t version, pugi::xml_document& doc);
+    bool RenderAttributes(uint32_t version, pugi::xml_document& doc);
+    bool RenderEffects(uint32_t version, pugi::xml_document& doc);
+    bool RenderItems(uint32_t version, pugi::xml_document& doc);
+    bool RenderQuests(uint32_t version, pugi::xml_document& doc);
+    bool RenderMusic(uint32_t version, pugi::xml_document& doc);
     void GetHandlerGames(std::shared_ptr<HttpsServer::Response> response,
         std::shared_ptr<HttpsServer::Request> request);
     void GetHandlerSkills(std::shared_ptr<HttpsServer::Response> response,
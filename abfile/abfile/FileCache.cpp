@@ -0,0 +1,204 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "FileCache.h"
+#include <sa/Compiler.h>
+#include <algorithm>
+#include <cstring>
+#if __cplusplus < 201703L
+#   if !defined(__clang__) && !defined(__GNUC__)
+#       include <filesystem>
+#   else
+#       include <experimental/filesystem>
+#   endif
+#else
+#   include <filesystem>
+#endif
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#if __cplusplus < 201703L
+namespace fs = std::experimental::filesystem;
+#else
+namespace fs = std::filesystem;
+#endif
+
+CachedFile::~CachedFile()
+{
+#ifdef _WIN32
+    if (file_)
+        CloseHandle(file_);
+#else
+    if (fd_ != -1)
+        close(fd_);
+#endif
+}
+
+bool CachedFile::Open(const std::string& path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    file_ = file;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+        return false;
+    size_ = static_cast<size_t>(size.QuadPart);
+#else
+    fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ == -1)
+        return false;
+    struct stat st;
+    if (fstat(fd_, &st) != 0)
+        return false;
+    size_ = static_cast<size_t>(st.st_size);
+#endif
+    if (size_ == 0 || size_ > MAX_MEMORY_SIZE)
+        return true;
+
+    std::vector<uint8_t> data(size_);
+    // If the file shrinks meanwhile we serve what we got
+    data.resize(Read(0, data.data(), size_));
+    data_ = std::move(data);
+    size_ = data_.size();
+#ifdef _WIN32
+    CloseHandle(file_);
+    file_ = nullptr;
+#else
+    close(fd_);
+    fd_ = -1;
+#endif
+    return true;
+}
+
+size_t CachedFile::Read(size_t offset, uint8_t* buffer, size_t size) const
+{
+    if (!data_.empty())
+    {
+        if (offset >= data_.size())
+            return 0;
+        const size_t count = std::min<size_t>(size, data_.size() - offset);
+        memcpy(buffer, data_.data() + offset, count);
+        return count;
+    }
+
+    size_t result = 0;
+    while (result < size)
+    {
+#ifdef _WIN32
+        OVERLAPPED ov = {};
+        const uint64_t pos = offset + result;
+        ov.Offset = static_cast<DWORD>(pos & 0xFFFFFFFF);
+        ov.OffsetHigh = static_cast<DWORD>(pos >> 32);
+        DWORD count = 0;
+        if (!ReadFile(file_, buffer + result, static_cast<DWORD>(size - result), &count, &ov))
+            break;
+#else
+        const ssize_t count = pread(fd_, buffer + result, size - result, static_cast<off_t>(offset + result));
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            break;
+#endif
+        if (count == 0)
+            // EOF, the file was truncated
+            break;
+        result += static_cast<size_t>(count);
+    }
+    return result;
+}
+
+std::shared_ptr<const CachedFile> FileCache::Get(const std::string& path)
+{
+    const auto now = std::chrono::steady_clock::now();
+    std::scoped_lock lock(mutex_);
+    auto it = entries_.find(path);
+    if (it != entries_.end())
+    {
+        Entry& entry = it->second;
+        entry.used = now;
+        if (now - entry.checked < METADATA_TTL)
+            return entry.file;
+
+        std::error_code ec;
+        const auto writeTime = fs::last_write_time(path, ec);
+        if (!ec && writeTime.time_since_epoch().count() == entry.writeTime)
+        {
+            entry.checked = now;
+            return entry.file;
+        }
+        Remove(it);
+    }
+
+    std::error_code ec;
+    const auto writeTime = fs::last_write_time(path, ec);
+    if (ec)
+        return {};
+    auto file = std::make_shared<CachedFile>();
+    if (!file->Open(path))
+        return {};
+
+    const size_t size = file->GetMemorySize();
+    while (!entries_.empty() && (entries_.size() >= maxEntries_ || bytes_ + size > maxBytes_))
+        Evict();
+    bytes_ += size;
+    Entry& entry = entries_[path];
+    entry.file = std::move(file);
+    entry.checked = now;
+    entry.used = now;
+    entry.writeTime = writeTime.time_since_epoch().count();
+    return entry.file;
+}
+
+void FileCache::Evict()
+{
+    // Remove the least recently used file. Files still being sent stay open
+    // until the last response releases them.
+    auto oldest = entries_.begin();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it)
+    {
+        if (it->second.used < oldest->second.used)
+            oldest = it;
+    }
+    if (oldest != entries_.end())
+        Remove(oldest);
+}
+
+void FileCache::Remove(std::map<std::string, Entry>::iterator it)
+{
+    bytes_ -= it->second.file->GetMemorySize();
+    entries_.erase(it);
+}
+
+void FileCache::Clear()
+{
+    std::scoped_lock lock(mutex_);
+    entries_.clear();
+    bytes_ = 0;
+}
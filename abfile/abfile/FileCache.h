@@ -0,0 +1,96 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <sa/Noncopyable.h>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// A read only file. Small files are copied into memory, larger files are read
+/// with pread() when a chunk is sent. A file may be truncated while it is served,
+/// Read() returns less than requested then.
+class CachedFile
+{
+    NON_COPYABLE(CachedFile)
+    NON_MOVEABLE(CachedFile)
+private:
+    std::vector<uint8_t> data_;
+    size_t size_{ 0 };
+#ifdef _WIN32
+    void* file_{ nullptr };
+#else
+    int fd_{ -1 };
+#endif
+public:
+    /// Files up to this size are kept in memory
+    static constexpr size_t MAX_MEMORY_SIZE = 1024 * 1024;
+
+    CachedFile() = default;
+    ~CachedFile();
+    bool Open(const std::string& path);
+    /// Returns nullptr if the file is not kept in memory
+    const uint8_t* GetData() const { return data_.empty() ? nullptr : data_.data(); }
+    size_t GetSize() const { return size_; }
+    /// Bytes kept in memory
+    size_t GetMemorySize() const { return data_.size(); }
+    /// Returns the number of bytes read
+    size_t Read(size_t offset, uint8_t* buffer, size_t size) const;
+};
+
+/// Keeps served files open. The metadata of a file is checked again when it was
+/// not checked for METADATA_TTL, a changed file is opened again. The number of
+/// files and the memory used by them are limited, the least recently used files
+/// are removed first.
+class FileCache
+{
+    NON_COPYABLE(FileCache)
+private:
+    struct Entry
+    {
+        std::shared_ptr<const CachedFile> file;
+        std::chrono::steady_clock::time_point checked;
+        std::chrono::steady_clock::time_point used;
+        int64_t writeTime{ 0 };
+    };
+    std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+    size_t maxEntries_;
+    size_t maxBytes_;
+    /// Memory used by all files
+    size_t bytes_{ 0 };
+    void Evict();
+    void Remove(std::map<std::string, Entry>::iterator it);
+public:
+    static constexpr std::chrono::seconds METADATA_TTL{ 2 };
+
+    explicit FileCache(size_t maxEntries = 1024, size_t maxBytes = 64 * 1024 * 1024) :
+        maxEntries_(maxEntries),
+        maxBytes_(maxBytes)
+    { }
+    /// Returns nullptr if the file can not be opened
+    std::shared_ptr<const CachedFile> Get(const std::string& path);
+    void Clear();
+};
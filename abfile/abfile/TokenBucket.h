@@ -0,0 +1,73 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+/// Rate limiter shared by all downloads. Instead of waiting, callers reserve the
+/// bytes they are going to send and get the time after which they may send them.
+class TokenBucket
+{
+private:
+    using clock = std::chrono::steady_clock;
+    std::mutex mutex_;
+    /// Bytes/sec, 0 = unlimited. Atomic for the unlimited check without the lock.
+    std::atomic<uint64_t> rate_{ 0 };
+    /// Max burst in bytes
+    double capacity_{ 0.0 };
+    /// May be negative when more was reserved than available
+    double tokens_{ 0.0 };
+    clock::time_point last_;
+public:
+    void SetRate(uint64_t bytesPerSec, uint64_t burst)
+    {
+        std::scoped_lock lock(mutex_);
+        rate_ = bytesPerSec;
+        capacity_ = static_cast<double>(std::max(burst, bytesPerSec / 10));
+        tokens_ = capacity_;
+        last_ = clock::now();
+    }
+    uint64_t GetRate() const { return rate_; }
+    /// Take bytes from the bucket, returns how long to wait before they may be sent
+    std::chrono::microseconds Reserve(size_t bytes)
+    {
+        if (rate_ == 0)
+            return std::chrono::microseconds(0);
+
+        std::scoped_lock lock(mutex_);
+        // SetRate() may have been called meanwhile
+        const uint64_t rate = rate_;
+        if (rate == 0)
+            return std::chrono::microseconds(0);
+        const auto now = clock::now();
+        const double elapsed = std::chrono::duration<double>(now - last_).count();
+        last_ = now;
+        tokens_ = std::min(capacity_, tokens_ + elapsed * static_cast<double>(rate));
+        tokens_ -= static_cast<double>(bytes);
+        if (tokens_ >= 0.0)
+            return std::chrono::microseconds(0);
+        return std::chrono::microseconds(static_cast<int64_t>(-tokens_ * 1000000.0 / static_cast<double>(rate)));
+    }
+};
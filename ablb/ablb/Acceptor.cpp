@@ -38,9 +38,8 @@ void Acceptor::HandleAccept(const std::error_code& error)
         }
         else
         {
-            AB::Entities::Service svc;
-            if (getServiceCallback_(svc))
-                session_->Start(svc.host, svc.port);
+            if (auto backend = getServiceCallback_())
+                session_->Start(std::move(backend));
         }
 
         // Accept more connections
@@ -22,12 +22,12 @@
 #pragma once
 
 #include "Bridge.h"
-#include <AB/Entities/Service.h>
 
 class Acceptor
 {
 public:
-    typedef std::function<bool(AB::Entities::Service& svc)> GetServiceCallback;
+    /// Select the upstream for a new connection, returns nullptr when there is none
+    typedef std::function<std::shared_ptr<Backend>()> GetServiceCallback;
 private:
     asio::io_service& ioService_;
     asio::ip::address_v4 localhostAddress;
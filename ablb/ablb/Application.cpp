@@ -36,13 +36,14 @@
 Application::Application() :
     ServerApp::ServerApp(),
     ioService_(),
-    lbType_(AB::Entities::ServiceTypeUnknown)
+    lbType_(AB::Entities::ServiceTypeUnknown),
+    statsTimer_(ioService_)
 {
     programDescription_ = SERVER_PRODUCT_NAME;
     serverType_ = AB::Entities::ServiceTypeLoadBalancer;
     Subsystems::Instance.CreateSubsystem<IO::SimpleConfigManager>();
     Subsystems::Instance.CreateSubsystem<Auth::BanManager>();
-    dataClient_ = std::make_unique<IO::DataClient>(ioService_);
+    dataClient_ = std::make_unique<IO::DataClient>();
 }
 
 Application::~Application() = default;
@@ -67,6 +68,26 @@ void Application::PrintServerInfo()
         }
         LOG_INFO << std::endl;
     }
+    LOG_INFO << "  Strategy: ";
+    switch (strategy_)
+    {
+    case Strategy::Random:
+        LOG_INFO << "random";
+        break;
+    case Strategy::LeastConnections:
+        LOG_INFO << "least connections";
+        break;
+    case Strategy::Load:
+        LOG_INFO << "load";
+        break;
+    }
+    LOG_INFO << std::endl;
+#if defined(AB_LB_SPLICE)
+    LOG_INFO << "  Bridge: splice" << std::endl;
+#else
+    LOG_INFO << "  Bridge: buffered" << std::endl;
+#endif
+    LOG_INFO << "  Stats interval: " << statsInterval_ << "s" << std::endl;
 }
 
 bool Application::LoadMain()
@@ -138,26 +159,91 @@ bool Application::LoadMain()
         // Default is login server
         config->GetGlobalInt("lb_type", static_cast<int64_t>(AB::Entities::ServiceTypeLoginServer))
     );
+    const std::string strategy = config->GetGlobalString("lb_strategy", "least_connections");
+    if (strategy == "random")
+        strategy_ = Strategy::Random;
+    else if (strategy == "load")
+    {
+        if (dataPort != 0)
+            strategy_ = Strategy::Load;
+        else
+            LOG_WARNING << "Strategy load requires a data server, using least_connections" << std::endl;
+    }
+    else if (strategy != "least_connections")
+        LOG_WARNING << "Unknown strategy " << strategy << ", using least_connections" << std::endl;
+    statsInterval_ = static_cast<uint32_t>(config->GetGlobalInt("stats_interval", 60));
+
     if (dataPort != 0)
         // We have a data port so we can query the data server
         acceptor_ = std::make_unique<Acceptor>(ioService_, serverHost_, serverPort_,
-            std::bind(&Application::GetServiceCallback, this, std::placeholders::_1));
+            std::bind(&Application::GetServiceCallback, this));
     else
         // Get service list from config file
         acceptor_ = std::make_unique<Acceptor>(ioService_, serverHost_, serverPort_,
-            std::bind(&Application::GetServiceCallbackList, this, std::placeholders::_1));
+            std::bind(&Application::GetServiceCallbackList, this));
 
     PrintServerInfo();
     return true;
 }
 
-bool Application::GetServiceCallback(AB::Entities::Service& svc)
+std::shared_ptr<Backend> Application::GetBackend(const std::string& host, uint16_t port)
+{
+    const std::string key = host + ":" + std::to_string(port);
+    auto it = backends_.find(key);
+    if (it != backends_.end())
+        return it->second;
+    auto backend = std::make_shared<Backend>();
+    backend->host = host;
+    backend->port = port;
+    backends_.emplace(key, backend);
+    return backend;
+}
+
+std::shared_ptr<Backend> Application::SelectBackend(std::vector<Candidate>& candidates) const
+{
+    if (candidates.size() == 0)
+        return {};
+
+    switch (strategy_)
+    {
+    case Strategy::Random:
+        return sa::SelectRandomly(candidates.begin(), candidates.end())->backend;
+    case Strategy::LeastConnections:
+        // The reported load only changes with the heart beat, the connection count
+        // changes immediately, so it is only a tie breaker
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)
+        {
+            if (a.backend->connections == b.backend->connections)
+                return a.load < b.load;
+            return a.backend->connections < b.backend->connections;
+        });
+        break;
+    case Strategy::Load:
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)
+        {
+            if (a.load == b.load)
+                return a.backend->connections < b.backend->connections;
+            return a.load < b.load;
+        });
+        break;
+    }
+
+    // Spread connections over equally good backends
+    auto end = std::find_if(candidates.begin(), candidates.end(), [&candidates](const Candidate& current)
+    {
+        return current.load != candidates.front().load ||
+            current.backend->connections != candidates.front().backend->connections;
+    });
+    return sa::SelectRandomly(candidates.begin(), end)->backend;
+}
+
+std::shared_ptr<Backend> Application::GetServiceCallback()
 {
     AB::Entities::ServiceList sl;
     if (!dataClient_->Read(sl))
-        return false;
+        return {};
 
-    std::vector<AB::Entities::Service> services;
+    std::vector<Candidate> candidates;
 
     for (const std::string& uuid : sl.uuids)
     {
@@ -175,42 +261,63 @@ bool Application::GetServiceCallback(AB::Entities::Service& svc)
                 // Maybe dead
                 continue;
         }
-        if (s.type == lbType_)
-        {
-            services.push_back(s);
-        }
+        if (s.type != lbType_)
+            continue;
+        if (s.type != AB::Entities::ServiceTypeFileServer && s.load >= 100)
+            // Full
+            continue;
+        candidates.push_back({ GetBackend(s.host, s.port), s.load });
     }
 
-    if (services.size() != 0)
-    {
-        std::sort(services.begin(), services.end(),
-            [](AB::Entities::Service const& a, AB::Entities::Service const& b)
-        {
-            return a.load < b.load;
-        });
-        if (services[0].type == AB::Entities::ServiceTypeFileServer || services[0].load < 100)
-        {
-            svc = services[0];
-            return true;
-        }
-    }
+    if (auto backend = SelectBackend(candidates))
+        return backend;
 
     LOG_WARNING << "No server of type " << static_cast<int>(lbType_) << " online" << std::endl;
-    return false;
+    return {};
 }
 
-bool Application::GetServiceCallbackList(AB::Entities::Service& svc)
+std::shared_ptr<Backend> Application::GetServiceCallbackList()
 {
     if (serviceList_.size() == 0)
     {
         LOG_WARNING << "Service list is empty" << std::endl;
-        return false;
+        return {};
     }
 
-    const auto item = sa::SelectRandomly(serviceList_.begin(), serviceList_.end());
-    svc.host = (*item).first;
-    svc.port = (*item).second;
-    return true;
+    std::vector<Candidate> candidates;
+    candidates.reserve(serviceList_.size());
+    for (const auto& item : serviceList_)
+        candidates.push_back({ GetBackend(item.first, item.second), 0 });
+    return SelectBackend(candidates);
+}
+
+void Application::ScheduleStats()
+{
+    if (statsInterval_ == 0)
+        return;
+    statsTimer_.expires_after(std::chrono::seconds(statsInterval_));
+    statsTimer_.async_wait([this](const std::error_code& error)
+    {
+        if (error)
+            return;
+        PrintStats();
+        ScheduleStats();
+    });
+}
+
+void Application::PrintStats()
+{
+    for (auto& item : backends_)
+    {
+        Backend& backend = *item.second;
+        const uint64_t up = backend.bytesUp - backend.reportedBytesUp;
+        const uint64_t down = backend.bytesDown - backend.reportedBytesDown;
+        backend.reportedBytesUp = backend.bytesUp;
+        backend.reportedBytesDown = backend.bytesDown;
+        LOG_INFO << "Backend " << item.first << ": " << backend.connections << " connections (" <<
+            backend.totalConnections << " total), up " << Utils::ConvertSize(up / statsInterval_) << "/s, down " <<
+            Utils::ConvertSize(down / statsInterval_) << "/s" << std::endl;
+    }
 }
 
 bool Application::ParseServerList(const std::string& fileName)
@@ -317,6 +424,7 @@ void Application::Run()
     LOG_INFO << "Server is running" << std::endl;
 
     acceptor_->AcceptConnections();
+    ScheduleStats();
 
     running_ = true;
     ioService_.run();
@@ -345,5 +453,6 @@ void Application::Stop()
     }
     else
         LOG_ERROR << "Unable to read service" << std::endl;
+    statsTimer_.cancel();
     ioService_.stop();
 }
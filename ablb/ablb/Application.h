@@ -25,21 +25,43 @@
 #include <AB/Entities/Service.h>
 #include <abscommon/DataClient.h>
 #include <abscommon/ServerApp.h>
+#include <map>
 
 class Application final : public ServerApp
 {
 private:
+    enum class Strategy
+    {
+        Random,
+        LeastConnections,
+        // Lowest load reported by the service, requires a data server
+        Load
+    };
+    struct Candidate
+    {
+        std::shared_ptr<Backend> backend;
+        uint8_t load;
+    };
     typedef std::pair<std::string, uint16_t> ServiceItem;
     std::vector<ServiceItem> serviceList_;
     asio::io_service ioService_;
     AB::Entities::ServiceType lbType_;
+    Strategy strategy_{ Strategy::LeastConnections };
     std::unique_ptr<IO::DataClient> dataClient_;
     std::unique_ptr<Acceptor> acceptor_;
+    /// host:port -> Backend
+    std::map<std::string, std::shared_ptr<Backend>> backends_;
+    asio::steady_timer statsTimer_;
+    uint32_t statsInterval_{ 0 };
     void PrintServerInfo();
     bool LoadMain();
-    bool GetServiceCallback(AB::Entities::Service& svc);
-    bool GetServiceCallbackList(AB::Entities::Service& svc);
+    std::shared_ptr<Backend> GetBackend(const std::string& host, uint16_t port);
+    std::shared_ptr<Backend> SelectBackend(std::vector<Candidate>& candidates) const;
+    std::shared_ptr<Backend> GetServiceCallback();
+    std::shared_ptr<Backend> GetServiceCallbackList();
     bool ParseServerList(const std::string& fileName);
+    void ScheduleStats();
+    void PrintStats();
     void ShowLogo();
 protected:
     void ShowVersion() override;
@@ -21,6 +21,149 @@
 
 #include "Bridge.h"
 #include <functional>
+#if defined(AB_LB_SPLICE)
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+#if defined(AB_LB_SPLICE)
+// Max bytes moved with one splice() call, the default capacity of a pipe
+static constexpr size_t SPLICE_SIZE = 64 * 1024;
+#endif
+
+Bridge::~Bridge()
+{
+    if (backend_)
+        --backend_->connections;
+#if defined(AB_LB_SPLICE)
+    for (auto& pipe : pipes_)
+    {
+        if (pipe.readFd != -1)
+            close(pipe.readFd);
+        if (pipe.writeFd != -1)
+            close(pipe.writeFd);
+    }
+#endif
+}
+
+#if defined(AB_LB_SPLICE)
+
+void Bridge::HandleUpstreamConnect(const std::error_code& error)
+{
+    if (error)
+    {
+        Close();
+        return;
+    }
+
+    for (auto& pipe : pipes_)
+    {
+        int fds[2];
+        if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0)
+        {
+            LOG_ERROR << "Unable to create pipe: " << strerror(errno) << std::endl;
+            Close();
+            return;
+        }
+        pipe.readFd = fds[0];
+        pipe.writeFd = fds[1];
+    }
+    std::error_code ec;
+    downstreamSocket_.native_non_blocking(true, ec);
+    if (!ec)
+        upstreamSocket_.native_non_blocking(true, ec);
+    if (ec)
+    {
+        Close();
+        return;
+    }
+
+    WaitReadable(Down);
+    WaitReadable(Up);
+}
+
+void Bridge::WaitReadable(Direction dir)
+{
+    GetSource(dir).async_wait(socket_type::wait_read,
+        [self = shared_from_this(), dir](const std::error_code& error)
+    {
+        if (error)
+        {
+            self->Close();
+            return;
+        }
+        self->SpliceIn(dir);
+    });
+}
+
+void Bridge::WaitWritable(Direction dir)
+{
+    GetSink(dir).async_wait(socket_type::wait_write,
+        [self = shared_from_this(), dir](const std::error_code& error)
+    {
+        if (error)
+        {
+            self->Close();
+            return;
+        }
+        self->SpliceOut(dir);
+    });
+}
+
+void Bridge::SpliceIn(Direction dir)
+{
+    Pipe& pipe = pipes_[dir];
+    const ssize_t result = splice(GetSource(dir).native_handle(), nullptr, pipe.writeFd, nullptr,
+        SPLICE_SIZE, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (result < 0)
+    {
+        if (errno == EAGAIN || errno == EINTR)
+            WaitReadable(dir);
+        else
+            Close();
+        return;
+    }
+    if (result == 0)
+    {
+        // Peer closed the connection
+        Close();
+        return;
+    }
+    pipe.pending = static_cast<size_t>(result);
+    SpliceOut(dir);
+}
+
+void Bridge::SpliceOut(Direction dir)
+{
+    Pipe& pipe = pipes_[dir];
+    while (pipe.pending != 0)
+    {
+        const ssize_t result = splice(pipe.readFd, nullptr, GetSink(dir).native_handle(), nullptr,
+            pipe.pending, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (result < 0)
+        {
+            if (errno == EAGAIN || errno == EINTR)
+                WaitWritable(dir);
+            else
+                Close();
+            return;
+        }
+        pipe.pending -= static_cast<size_t>(result);
+        if (backend_)
+        {
+            if (dir == Up)
+                backend_->bytesUp += static_cast<uint64_t>(result);
+            else
+                backend_->bytesDown += static_cast<uint64_t>(result);
+        }
+    }
+
+    WaitReadable(dir);
+}
+
+#else
 
 void Bridge::HandleUpstreamConnect(const std::error_code& error)
 {
@@ -39,7 +182,7 @@ void Bridge::HandleUpstreamConnect(const std::error_code& error)
             std::placeholders::_2));
 
     // Setup async read from client (downstream)
-    upstreamSocket_.async_read_some(
+    downstreamSocket_.async_read_some(
         asio::buffer(downstreamData_, max_data_length),
         std::bind(&Bridge::HandleDownstreamRead,
             shared_from_this(),
@@ -55,6 +198,8 @@ void Bridge::HandleUpstreamRead(const std::error_code& error, const size_t& byte
         return;
     }
 
+    if (backend_)
+        backend_->bytesDown += bytes_transferred;
     asio::async_write(downstreamSocket_,
         asio::buffer(upstreamData_, bytes_transferred),
         std::bind(&Bridge::HandleDownstreamWrite,
@@ -86,6 +231,8 @@ void Bridge::HandleDownstreamRead(const std::error_code& error, const size_t& by
         return;
     }
 
+    if (backend_)
+        backend_->bytesUp += bytes_transferred;
     asio::async_write(upstreamSocket_,
         asio::buffer(downstreamData_, bytes_transferred),
         std::bind(&Bridge::HandleUpstreamWrite,
@@ -109,6 +256,8 @@ void Bridge::HandleUpstreamWrite(const std::error_code& error)
             std::placeholders::_2));
 }
 
+#endif
+
 void Bridge::Close()
 {
     std::unique_lock<std::mutex> lock(mutex_);
@@ -118,13 +267,16 @@ void Bridge::Close()
         upstreamSocket_.close();
 }
 
-void Bridge::Start(const std::string& upstreamHost, uint16_t unstreamPort)
+void Bridge::Start(std::shared_ptr<Backend> backend)
 {
+    backend_ = std::move(backend);
+    ++backend_->connections;
+    ++backend_->totalConnections;
     // Connect to remote server, upstream
     upstreamSocket_.async_connect(
         asio::ip::tcp::endpoint(
-            asio::ip::address::from_string(upstreamHost),
-            unstreamPort
+            asio::ip::address::from_string(backend_->host),
+            backend_->port
         ),
         std::bind(&Bridge::HandleUpstreamConnect, shared_from_this(), std::placeholders::_1)
     );
@@ -21,10 +21,17 @@
 
 #pragma once
 
+#include "Backend.h"
 #include <mutex>
 #include <memory>
 #include <asio.hpp>
 
+#if defined(__linux__)
+// Move the data between the sockets with splice() through a pipe, so it never
+// gets copied to user space.
+#define AB_LB_SPLICE
+#endif
+
 class Bridge : public std::enable_shared_from_this<Bridge>
 {
 public:
@@ -33,6 +40,31 @@ private:
     std::mutex mutex_;
     socket_type downstreamSocket_;
     socket_type upstreamSocket_;
+    std::shared_ptr<Backend> backend_;
+#if defined(AB_LB_SPLICE)
+    enum Direction
+    {
+        // Client -> server
+        Up = 0,
+        // Server -> client
+        Down = 1
+    };
+    struct Pipe
+    {
+        int readFd{ -1 };
+        int writeFd{ -1 };
+        // Bytes in the pipe not yet written to the sink
+        size_t pending{ 0 };
+    };
+    Pipe pipes_[2];
+
+    socket_type& GetSource(Direction dir) { return dir == Up ? downstreamSocket_ : upstreamSocket_; }
+    socket_type& GetSink(Direction dir) { return dir == Up ? upstreamSocket_ : downstreamSocket_; }
+    void WaitReadable(Direction dir);
+    void WaitWritable(Direction dir);
+    void SpliceIn(Direction dir);
+    void SpliceOut(Direction dir);
+#else
     enum
     {
         max_data_length = 8192
@@ -40,20 +72,22 @@ private:
     uint8_t downstreamData_[max_data_length];
     uint8_t upstreamData_[max_data_length];
 
-    void HandleUpstreamConnect(const std::error_code& error);
     void HandleUpstreamRead(const std::error_code& error,
         const size_t& bytes_transferred);
     void HandleDownstreamWrite(const std::error_code& error);
     void HandleDownstreamRead(const std::error_code& error,
         const size_t& bytes_transferred);
     void HandleUpstreamWrite(const std::error_code& error);
+#endif
+
+    void HandleUpstreamConnect(const std::error_code& error);
     void Close();
 public:
     explicit Bridge(asio::io_service& ioService) :
         downstreamSocket_(ioService),
         upstreamSocket_(ioService)
     { }
-    ~Bridge() = default;
+    ~Bridge();
 
     socket_type& GetDownstreamSocket()
     {
@@ -63,6 +97,5 @@ public:
     {
         return upstreamSocket_;
     }
-    void Start(const std::string& upstreamHost, uint16_t unstreamPort);
+    void Start(std::shared_ptr<Backend> backend);
 };
-
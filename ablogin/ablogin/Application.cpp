@@ -20,6 +20,7 @@
  */
 
 #include "Application.h"
+#include "PasswordHasher.h"
 #include "ProtocolLogin.h"
 #include "Version.h"
 #include <AB/DHKeys.hpp>
@@ -62,12 +63,13 @@ Application::Application() :
     Subsystems::Instance.CreateSubsystem<Asynch::Scheduler>();
     Subsystems::Instance.CreateSubsystem<Net::ConnectionManager>();
     Subsystems::Instance.CreateSubsystem<IO::SimpleConfigManager>();
-    Subsystems::Instance.CreateSubsystem<IO::DataClient>(*ioService_);
+    Subsystems::Instance.CreateSubsystem<IO::DataClient>();
     Subsystems::Instance.CreateSubsystem<Net::MessageClient>(*ioService_);
     Subsystems::Instance.CreateSubsystem<Auth::BanManager>();
     Subsystems::Instance.CreateSubsystem<Crypto::Random>();
     Subsystems::Instance.CreateSubsystem<Crypto::DHKeys>();
     Subsystems::Instance.CreateSubsystem<Net::PingServer>();
+    Subsystems::Instance.CreateSubsystem<Auth::PasswordHasher>();
 
     serviceManager_ = std::make_unique<Net::ServiceManager>(*ioService_);
 }
@@ -75,6 +77,8 @@ Application::Application() :
 Application::~Application()
 {
     serviceManager_->Stop();
+    // Stop it before the Dispatcher, it posts the results to the Dispatcher
+    GetSubsystem<Auth::PasswordHasher>()->Stop();
     GetSubsystem<Asynch::Scheduler>()->Stop();
     GetSubsystem<Asynch::Dispatcher>()->Stop();
     GetSubsystem<Net::ConnectionManager>()->CloseAll();
@@ -114,6 +118,10 @@ bool Application::LoadMain()
     Net::ConnectionManager::maxPacketsPerSec = static_cast<uint32_t>(config->GetGlobalInt("max_packets_per_second", 0ll));
     Auth::BanManager::LoginTries = static_cast<uint32_t>(config->GetGlobalInt("login_tries", 5ll));
     Auth::BanManager::LoginRetryTimeout = static_cast<uint32_t>(config->GetGlobalInt("login_retrytimeout", 5000ll));
+    auto* hasher = GetSubsystem<Auth::PasswordHasher>();
+    hasher->SetThreads(static_cast<size_t>(config->GetGlobalInt("hash_threads", 0ll)));
+    hasher->SetMaxQueued(static_cast<size_t>(config->GetGlobalInt("hash_queue_size",
+        static_cast<int64_t>(Auth::PasswordHasher::DEFAULT_QUEUE_SIZE))));
 
     LOG_INFO << "Initializing RNG...";
     GetSubsystem<Crypto::Random>()->Initialize();
@@ -229,6 +237,8 @@ void Application::PrintServerInfo()
 
     LOG_INFO << "  Data Server: " << dataClient->GetHost() << ":" << dataClient->GetPort() << std::endl;
     LOG_INFO << "  Message Server: " << msgClient->GetHost() << ":" << msgClient->GetPort() << std::endl;
+    auto* hasher = GetSubsystem<Auth::PasswordHasher>();
+    LOG_INFO << "  Password hash threads: " << hasher->GetThreads() << ", queue size: " << hasher->GetMaxQueued() << std::endl;
 }
 
 void Application::HeartBeatTask()
@@ -241,6 +251,17 @@ void Application::HeartBeatTask()
         ", used: " << info.used << ", avail: " << info.avail << std::endl;
 #endif
 
+    auto* hasher = GetSubsystem<Auth::PasswordHasher>();
+    const Auth::PasswordHasherStats hstats = hasher->GetStats();
+    if (hstats.hashed != lastHashed_ || hstats.queueDepth != 0)
+    {
+        LOG_INFO << "Password hasher: hashed: " << hstats.hashed << ", queue depth: " << hstats.queueDepth <<
+            "/" << hstats.capacity << ", max queue depth: " << hstats.maxQueueDepth <<
+            ", rejected: " << hstats.rejected << ", hash time avg: " << hstats.avgHashTime <<
+            "us, max: " << hstats.maxHashTime << "us" << std::endl;
+        lastHashed_ = hstats.hashed;
+    }
+
     auto* dataClient = GetSubsystem<IO::DataClient>();
     if (dataClient->IsConnected())
     {
@@ -249,6 +270,8 @@ void Application::HeartBeatTask()
         if (dataClient->Read(serv))
         {
             serv.heartbeat = sa::time::tick();
+            // The login server is busy when it can't keep up hashing passwords
+            serv.load = static_cast<uint8_t>(hasher->GetLoad());
             if (!dataClient->Update(serv))
                 LOG_ERROR << "Error updating service " << serverId_ << std::endl;
         }
@@ -316,6 +339,7 @@ bool Application::Initialize(const std::vector<std::string>& args)
 
     GetSubsystem<Asynch::Dispatcher>()->Start();
     GetSubsystem<Asynch::Scheduler>()->Start();
+    GetSubsystem<Auth::PasswordHasher>()->Start();
 
     if (!serviceManager_->IsRunning())
         LOG_ERROR << "No services running" << std::endl;
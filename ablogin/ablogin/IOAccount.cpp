@@ -28,7 +28,6 @@
 #include <AB/Entities/PlayerItemList.h>
 #include <AB/Entities/Profession.h>
 #include <AB/Entities/ReservedName.h>
-#include <abcrypto.hpp>
 #include <abscommon/DataClient.h>
 #include <abscommon/Profiler.h>
 #include <abscommon/Subsystems.h>
@@ -39,41 +38,59 @@
 
 namespace IO {
 
-IOAccount::CreateAccountResult IOAccount::CreateAccount(const std::string& name, const std::string& pass,
-    const std::string& email, const std::string& accKey)
+static IOAccount::CreateAccountResult CheckNewAccount(IO::DataClient& client,
+    const std::string& name, const std::string& pass,
+    const std::string& email, AB::Entities::AccountKey& akey)
 {
-    AB_PROFILE;
-    IO::DataClient* client = GetSubsystem<IO::DataClient>();
-    AB::Entities::Account acc;
     if (name.empty())
-        return CreateAccountResult::NameExists;
+        return IOAccount::CreateAccountResult::NameExists;
     if (pass.empty())
-        return CreateAccountResult::PasswordError;
+        return IOAccount::CreateAccountResult::PasswordError;
 #if defined(EMAIL_MANDATORY)
     if (email.empty())
-        return Result::EmailError;
+        return IOAccount::CreateAccountResult::EmailError;
+#else
+    AB_UNUSED(email);
 #endif
+    AB::Entities::Account acc;
     acc.name = name;
-    if (client->Exists(acc))
-        return CreateAccountResult::NameExists;
+    if (client.Exists(acc))
+        return IOAccount::CreateAccountResult::NameExists;
 
-    AB::Entities::AccountKey akey;
-    akey.uuid = accKey;
     akey.status = AB::Entities::AccountKeyStatus::KeryStatusReadyForUse;
     akey.type = AB::Entities::AccountKeyType::KeyTypeAccount;
-    if (!client->Read(akey))
-        return CreateAccountResult::InvalidAccountKey;
+    if (!client.Read(akey))
+        return IOAccount::CreateAccountResult::InvalidAccountKey;
     if (akey.used + 1 > akey.total)
-        return CreateAccountResult::InvalidAccountKey;
+        return IOAccount::CreateAccountResult::InvalidAccountKey;
+    return IOAccount::CreateAccountResult::OK;
+}
+
+IOAccount::CreateAccountResult IOAccount::CanCreateAccount(const std::string& name, const std::string& pass,
+    const std::string& email, const std::string& accKey)
+{
+    AB_PROFILE;
+    IO::DataClient* client = GetSubsystem<IO::DataClient>();
+    AB::Entities::AccountKey akey;
+    akey.uuid = accKey;
+    return CheckNewAccount(*client, name, pass, email, akey);
+}
+
+IOAccount::CreateAccountResult IOAccount::CreateAccount(const std::string& name, const std::string& passwordHash,
+    const std::string& email, const std::string& accKey)
+{
+    AB_PROFILE;
+    IO::DataClient* client = GetSubsystem<IO::DataClient>();
+    // Check again, things may have changed while the password was hashed
+    AB::Entities::AccountKey akey;
+    akey.uuid = accKey;
+    const CreateAccountResult checkRes = CheckNewAccount(*client, name, passwordHash, email, akey);
+    if (checkRes != CreateAccountResult::OK)
+        return checkRes;
 
     // Create the account
-    char pwhash[61];
-    if (bcrypt_newhash(pass.c_str(), 10, pwhash, 61) != 0)
-    {
-        LOG_ERROR << "bcrypt_newhash() failed" << std::endl;
-        return CreateAccountResult::InternalError;
-    }
-    std::string passwordHash(pwhash, 61);
+    AB::Entities::Account acc;
+    acc.name = name;
     acc.uuid = Utils::Uuid::New();
     acc.password = passwordHash;
     acc.email = email;
@@ -176,7 +193,29 @@ IOAccount::CreateAccountResult IOAccount::AddAccountKey(AB::Entities::Account& a
     return CreateAccountResult::OK;
 }
 
-IOAccount::PasswordAuthResult IOAccount::PasswordAuth(const std::string& pass,
+IOAccount::PasswordAuthResult IOAccount::PreparePasswordAuth(AB::Entities::Account& account)
+{
+    AB_PROFILE;
+    IO::DataClient* client = GetSubsystem<IO::DataClient>();
+    if (!client->Read(account))
+    {
+        LOG_ERROR << "Unable to read account UUID " << account.uuid << " name " << account.name << std::endl;
+        return PasswordAuthResult::InvalidAccount;
+    }
+    if (account.status != AB::Entities::AccountStatusActivated)
+    {
+        LOG_ERROR << "Account not activated UUID " << account.uuid << std::endl;
+        return PasswordAuthResult::InvalidAccount;
+    }
+
+    auto* banMan = GetSubsystem<Auth::BanManager>();
+    if (banMan->IsAccountBanned(uuids::uuid(account.uuid)))
+        return PasswordAuthResult::AccountBanned;
+
+    return PasswordAuthResult::OK;
+}
+
+IOAccount::PasswordAuthResult IOAccount::PasswordAuth(bool passwordMatches, const std::string& passwordHash,
     AB::Entities::Account& account)
 {
     AB_PROFILE;
@@ -207,7 +246,7 @@ IOAccount::PasswordAuthResult IOAccount::PasswordAuth(const std::string& pass,
     if (banMan->IsAccountBanned(uuids::uuid(account.uuid)))
         return PasswordAuthResult::AccountBanned;
 
-    if (bcrypt_checkpass(pass.c_str(), account.password.c_str()) != 0)
+    if (!passwordMatches || account.password != passwordHash)
         return PasswordAuthResult::PasswordMismatch;
 
     if (account.onlineStatus != AB::Entities::OnlineStatusOffline)
@@ -71,11 +71,22 @@ public:
         InvalidName
     };
     IOAccount() = delete;
-    static CreateAccountResult CreateAccount(const std::string& name, const std::string& pass,
+    /// Checks if an account can be created, before the password is hashed.
+    static CreateAccountResult CanCreateAccount(const std::string& name, const std::string& pass,
+        const std::string& email, const std::string& accKey);
+    /// Create the account with the bcrypt hash of the password
+    static CreateAccountResult CreateAccount(const std::string& name, const std::string& passwordHash,
         const std::string& email, const std::string& accKey);
     static CreateAccountResult AddAccountKey(AB::Entities::Account& account,
         const std::string& accKey);
-    static IOAccount::PasswordAuthResult PasswordAuth(const std::string& pass,
+    /// First step of the password authentication. Reads the account and checks
+    /// if it may login at all, the password hash is then checked by the PasswordHasher.
+    static IOAccount::PasswordAuthResult PreparePasswordAuth(AB::Entities::Account& account);
+    /// Completes the password authentication.
+    /// @param passwordMatches Result of checking the password against passwordHash
+    /// @param passwordHash The hash the password was checked against. If the password
+    ///   of the account was changed in the meantime, the authentication fails.
+    static IOAccount::PasswordAuthResult PasswordAuth(bool passwordMatches, const std::string& passwordHash,
         AB::Entities::Account& account);
     static bool TokenAuth(const std::string& token,
         AB::Entities::Account& account);
@@ -0,0 +1,196 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PasswordHasher.h"
+#include <algorithm>
+#include <abcrypto.hpp>
+#include <abscommon/Dispatcher.h>
+#include <abscommon/Logger.h>
+#include <abscommon/Subsystems.h>
+
+namespace Auth {
+
+PasswordHasher::PasswordHasher(size_t threads /* = 0 */, size_t maxQueued /* = DEFAULT_QUEUE_SIZE */) :
+    threads_(0),
+    maxQueued_(maxQueued)
+{
+    SetThreads(threads);
+}
+
+PasswordHasher::~PasswordHasher()
+{
+    Stop();
+}
+
+void PasswordHasher::SetThreads(size_t value)
+{
+    if (running_)
+        return;
+    if (value == 0)
+        value = std::thread::hardware_concurrency();
+    threads_ = std::max<size_t>(value, 1);
+}
+
+void PasswordHasher::Start()
+{
+    if (running_)
+        return;
+    running_ = true;
+    for (size_t i = 0; i < threads_; ++i)
+        workers_.push_back(std::thread(&PasswordHasher::WorkerThread, this));
+}
+
+void PasswordHasher::Stop()
+{
+    {
+        std::scoped_lock lock(lock_);
+        if (!running_)
+            return;
+        running_ = false;
+    }
+    signal_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+    workers_.clear();
+    // Requests not yet started are dropped
+    clients_.clear();
+    ready_.clear();
+    queued_ = 0;
+}
+
+bool PasswordHasher::Enqueue(uint32_t ip, Job&& job)
+{
+    {
+        std::scoped_lock lock(lock_);
+        if (!running_)
+            return false;
+        if (queued_ >= maxQueued_)
+        {
+            ++rejected_;
+            return false;
+        }
+        ClientQueue& client = clients_[ip];
+        if (client.jobs.size() + client.running >= MAX_PENDING_PER_IP)
+        {
+            ++rejected_;
+            return false;
+        }
+        // The client gets back in line when it has nothing queued
+        if (client.jobs.empty())
+            ready_.push_back(ip);
+        client.jobs.push_back(std::move(job));
+        ++queued_;
+        if (queued_ > maxQueueDepth_)
+            maxQueueDepth_ = queued_;
+    }
+    signal_.notify_one();
+    return true;
+}
+
+bool PasswordHasher::CheckPassword(uint32_t ip, std::string pass, std::string hash, CheckCallback&& callback)
+{
+    return Enqueue(ip, [pass = std::move(pass), hash = std::move(hash), callback = std::move(callback)]()
+    {
+        const bool matches = bcrypt_checkpass(pass.c_str(), hash.c_str()) == 0;
+        GetSubsystem<Asynch::Dispatcher>()->Add(Asynch::CreateTask(std::bind(callback, matches)));
+    });
+}
+
+bool PasswordHasher::HashPassword(uint32_t ip, std::string pass, HashCallback&& callback)
+{
+    return Enqueue(ip, [pass = std::move(pass), callback = std::move(callback)]()
+    {
+        char pwhash[61];
+        std::string hash;
+        if (bcrypt_newhash(pass.c_str(), BCRYPT_COST, pwhash, 61) == 0)
+            hash.assign(pwhash, 61);
+        else
+            LOG_ERROR << "bcrypt_newhash() failed" << std::endl;
+        GetSubsystem<Asynch::Dispatcher>()->Add(Asynch::CreateTask(std::bind(callback, std::move(hash))));
+    });
+}
+
+void PasswordHasher::WorkerThread()
+{
+    while (true)
+    {
+        Job job;
+        uint32_t ip = 0;
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+            signal_.wait(lock, [this]() { return !running_ || !ready_.empty(); });
+            if (!running_)
+                return;
+            ip = ready_.front();
+            ready_.pop_front();
+            ClientQueue& client = clients_[ip];
+            job = std::move(client.jobs.front());
+            client.jobs.pop_front();
+            ++client.running;
+            --queued_;
+            if (!client.jobs.empty())
+                ready_.push_back(ip);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        job();
+        const int64_t time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        std::scoped_lock lock(lock_);
+        ++hashed_;
+        hashTime_ += time;
+        if (time > maxHashTime_)
+            maxHashTime_ = time;
+        auto it = clients_.find(ip);
+        if (it != clients_.end())
+        {
+            --it->second.running;
+            if (it->second.running == 0 && it->second.jobs.empty())
+                clients_.erase(it);
+        }
+    }
+}
+
+PasswordHasherStats PasswordHasher::GetStats() const
+{
+    PasswordHasherStats result;
+    std::scoped_lock lock(lock_);
+    result.queueDepth = queued_;
+    result.maxQueueDepth = maxQueueDepth_;
+    result.capacity = maxQueued_;
+    result.rejected = rejected_;
+    result.hashed = hashed_;
+    result.avgHashTime = hashed_ != 0 ? hashTime_ / static_cast<int64_t>(hashed_) : 0;
+    result.maxHashTime = maxHashTime_;
+    return result;
+}
+
+unsigned PasswordHasher::GetLoad() const
+{
+    const size_t max = maxQueued_;
+    if (max == 0)
+        return 100;
+    std::scoped_lock lock(lock_);
+    return static_cast<unsigned>(std::min<size_t>(queued_ * 100 / max, 100));
+}
+
+}
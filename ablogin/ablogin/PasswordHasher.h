@@ -0,0 +1,114 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Auth {
+
+struct PasswordHasherStats
+{
+    /// Requests waiting for a worker
+    size_t queueDepth{ 0 };
+    size_t maxQueueDepth{ 0 };
+    size_t capacity{ 0 };
+    /// Requests rejected because the queue was full
+    uint64_t rejected{ 0 };
+    uint64_t hashed{ 0 };
+    /// Average and maximum time of a single bcrypt call in us
+    int64_t avgHashTime{ 0 };
+    int64_t maxHashTime{ 0 };
+};
+
+/// Runs the bcrypt calls of the login server on a worker pool, so the Dispatcher
+/// does not block while hashing passwords. Requests are queued per client IP
+/// and the IPs are served round robin, so a single client can not starve the others.
+/// The callbacks are executed by the Dispatcher.
+class PasswordHasher
+{
+public:
+    using Job = std::function<void()>;
+    using CheckCallback = std::function<void(bool matches)>;
+    /// hash is empty when hashing failed
+    using HashCallback = std::function<void(const std::string& hash)>;
+    /// Maximum number of requests of a single IP, including the running ones
+    static constexpr size_t MAX_PENDING_PER_IP = 4;
+    static constexpr size_t DEFAULT_QUEUE_SIZE = 256;
+    static constexpr int BCRYPT_COST = 10;
+
+    /// threads = 0 uses one worker per core
+    explicit PasswordHasher(size_t threads = 0, size_t maxQueued = DEFAULT_QUEUE_SIZE);
+    ~PasswordHasher();
+
+    void Start();
+    void Stop();
+    /// Check the password against the bcrypt hash. Returns false when the request
+    /// was rejected, callback is not called in this case.
+    bool CheckPassword(uint32_t ip, std::string pass, std::string hash, CheckCallback&& callback);
+    /// Create a new bcrypt hash of pass. Returns false when the request was rejected,
+    /// callback is not called in this case.
+    bool HashPassword(uint32_t ip, std::string pass, HashCallback&& callback);
+    /// Run job on a worker, it is queued like the password requests of the IP.
+    /// Returns false when the request was rejected.
+    bool Enqueue(uint32_t ip, Job&& job);
+    void SetThreads(size_t value);
+    void SetMaxQueued(size_t value) { maxQueued_ = value; }
+    size_t GetThreads() const { return threads_; }
+    size_t GetMaxQueued() const { return maxQueued_; }
+    PasswordHasherStats GetStats() const;
+    /// Queue usage in % 0..100
+    unsigned GetLoad() const;
+private:
+    struct ClientQueue
+    {
+        std::deque<Job> jobs;
+        /// Jobs of this client currently executed by a worker
+        size_t running{ 0 };
+    };
+    void WorkerThread();
+    std::atomic<bool> running_{ false };
+    size_t threads_;
+    std::atomic<size_t> maxQueued_;
+    std::vector<std::thread> workers_;
+    mutable std::mutex lock_;
+    std::condition_variable signal_;
+    std::unordered_map<uint32_t, ClientQueue> clients_;
+    /// Clients with queued jobs in the order they get served
+    std::deque<uint32_t> ready_;
+    size_t queued_{ 0 };
+    size_t maxQueueDepth_{ 0 };
+    uint64_t rejected_{ 0 };
+    uint64_t hashed_{ 0 };
+    int64_t hashTime_{ 0 };
+    int64_t maxHashTime_{ 0 };
+};
+
+}
@@ -23,6 +23,7 @@
 #include "IOAccount.h"
 #include "IOGame.h"
 #include "IOService.h"
+#include "PasswordHasher.h"
 #include <AB/CommonConfig.h>
 #include <AB/Entities/Account.h>
 #include <AB/Entities/Game.h>
@@ -356,37 +357,65 @@ void ProtocolLogin::HandleGetServersPacket(NetworkMessage& message)
     );
 }
 
-void ProtocolLogin::AuthenticateSendCharacterList(AB::Packets::Client::Login::Login request)
+bool ProtocolLogin::CheckPasswordAuthResult(IO::IOAccount::PasswordAuthResult res)
 {
-    AB::Entities::Account account;
-    account.name = request.accountName;
-    IO::IOAccount::PasswordAuthResult res = IO::IOAccount::PasswordAuth(request.password, account);
     auto banMan = GetSubsystem<Auth::BanManager>();
     switch (res)
     {
     case IO::IOAccount::PasswordAuthResult::InvalidAccount:
         DisconnectClient(AB::ErrorCodes::InvalidAccount);
         banMan->AddLoginAttempt(GetIP(), false);
-        return;
+        return false;
     case IO::IOAccount::PasswordAuthResult::PasswordMismatch:
         DisconnectClient(AB::ErrorCodes::NamePasswordMismatch);
         banMan->AddLoginAttempt(GetIP(), false);
-        return;
+        return false;
     case IO::IOAccount::PasswordAuthResult::AlreadyLoggedIn:
         DisconnectClient(AB::ErrorCodes::AlreadyLoggedIn);
         banMan->AddLoginAttempt(GetIP(), false);
-        return;
+        return false;
     case IO::IOAccount::PasswordAuthResult::AccountBanned:
         DisconnectClient(AB::ErrorCodes::AlreadyLoggedIn);
         banMan->AddLoginAttempt(GetIP(), false);
-        return;
+        return false;
     case IO::IOAccount::PasswordAuthResult::InternalError:
         DisconnectClient(AB::ErrorCodes::UnknownError);
-        return;
+        return false;
     default:
-        break;
+        return true;
     }
+}
+
+void ProtocolLogin::AuthenticateSendCharacterList(AB::Packets::Client::Login::Login request)
+{
+    AB::Entities::Account account;
+    account.name = request.accountName;
+    if (!CheckPasswordAuthResult(IO::IOAccount::PreparePasswordAuth(account)))
+        return;
+
+    // bcrypt is slow, don't block the Dispatcher with it
+    std::shared_ptr<ProtocolLogin> thisPtr = std::static_pointer_cast<ProtocolLogin>(shared_from_this());
+    std::string password = request.password;
+    std::string passwordHash = account.password;
+    if (!GetSubsystem<Auth::PasswordHasher>()->CheckPassword(GetIP(), std::move(password), account.password,
+        [thisPtr, request = std::move(request), passwordHash = std::move(passwordHash)](bool matches)
+    {
+        thisPtr->PasswordChecked(request, passwordHash, matches);
+    }))
+    {
+        LOG_WARNING << Utils::ConvertIPToString(GetIP(), true) << ": Password hasher busy, rejecting login" << std::endl;
+        DisconnectClient(AB::ErrorCodes::AllServersFull);
+    }
+}
 
+void ProtocolLogin::PasswordChecked(AB::Packets::Client::Login::Login request, std::string passwordHash, bool matches)
+{
+    AB::Entities::Account account;
+    account.name = request.accountName;
+    if (!CheckPasswordAuthResult(IO::IOAccount::PasswordAuth(matches, passwordHash, account)))
+        return;
+
+    auto banMan = GetSubsystem<Auth::BanManager>();
     AB::Entities::Service gameServer;
     if (!IO::IOService::EnsureService(
         AB::Entities::ServiceTypeGameServer,
@@ -524,9 +553,41 @@ void ProtocolLogin::SendServers(AB::Packets::Client::Login::GetServers request)
 
 void ProtocolLogin::CreateAccount(AB::Packets::Client::Login::CreateAccount request)
 {
-    IO::IOAccount::CreateAccountResult res = IO::IOAccount::CreateAccount(
+    // Don't waste time on hashing the password when we can't create the account anyway
+    IO::IOAccount::CreateAccountResult res = IO::IOAccount::CanCreateAccount(
         request.accountName, request.password, request.email, request.accountKey);
+    if (res != IO::IOAccount::CreateAccountResult::OK)
+    {
+        SendCreateAccountResult(res);
+        return;
+    }
 
+    std::shared_ptr<ProtocolLogin> thisPtr = std::static_pointer_cast<ProtocolLogin>(shared_from_this());
+    std::string password = request.password;
+    if (!GetSubsystem<Auth::PasswordHasher>()->HashPassword(GetIP(), std::move(password),
+        [thisPtr, request = std::move(request)](const std::string& passwordHash)
+    {
+        thisPtr->PasswordHashed(request, passwordHash);
+    }))
+    {
+        LOG_WARNING << Utils::ConvertIPToString(GetIP(), true) << ": Password hasher busy, rejecting account creation" << std::endl;
+        DisconnectClient(AB::ErrorCodes::AllServersFull);
+    }
+}
+
+void ProtocolLogin::PasswordHashed(AB::Packets::Client::Login::CreateAccount request, std::string passwordHash)
+{
+    if (passwordHash.empty())
+    {
+        SendCreateAccountResult(IO::IOAccount::CreateAccountResult::InternalError);
+        return;
+    }
+    SendCreateAccountResult(IO::IOAccount::CreateAccount(
+        request.accountName, passwordHash, request.email, request.accountKey));
+}
+
+void ProtocolLogin::SendCreateAccountResult(IO::IOAccount::CreateAccountResult res)
+{
     auto output = OutputMessagePool::GetOutputMessage();
 
     if (res == IO::IOAccount::CreateAccountResult::OK)
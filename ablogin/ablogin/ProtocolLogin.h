@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include "IOAccount.h"
 #include <AB/Entities/Character.h>
 #include <AB/Packets/LoginPackets.h>
 #include <AB/ProtocolCodes.h>
@@ -46,6 +47,9 @@ public:
     void OnRecvFirstMessage(NetworkMessage& message) override;
 private:
     void DisconnectClient(AB::ErrorCodes error);
+    /// Returns true when res is OK, otherwise disconnects the client
+    bool CheckPasswordAuthResult(IO::IOAccount::PasswordAuthResult res);
+    void SendCreateAccountResult(IO::IOAccount::CreateAccountResult res);
 
     void HandleLoginPacket(NetworkMessage& message);
     void HandleCreateAccountPacket(NetworkMessage& message);
@@ -60,6 +64,9 @@ private:
     void SendOutposts(AB::Packets::Client::Login::GetOutposts request);
     void SendServers(AB::Packets::Client::Login::GetServers request);
     void CreateAccount(AB::Packets::Client::Login::CreateAccount request);
+    // Called by the Dispatcher when the PasswordHasher is done
+    void PasswordChecked(AB::Packets::Client::Login::Login request, std::string passwordHash, bool matches);
+    void PasswordHashed(AB::Packets::Client::Login::CreateAccount request, std::string passwordHash);
     void AddAccountKey(AB::Packets::Client::Login::AddAccountKey request);
     void CreatePlayer(AB::Packets::Client::Login::CreatePlayer request);
     void DeletePlayer(AB::Packets::Client::Login::DeleteCharacter request);
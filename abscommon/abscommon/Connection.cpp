@@ -21,6 +21,7 @@
 
 #include "Connection.h"
 #include "Dispatcher.h"
+#include "IoServicePool.h"
 #include "Logger.h"
 #include "Protocol.h"
 #include "Scheduler.h"
@@ -54,25 +55,31 @@ Connection::~Connection()
 
 bool Connection::Send(sa::SharedPtr<OutputMessage>&& message)
 {
-
     if (state_ != State::Open)
     {
         LOG_ERROR << "State not open " << static_cast<int>(state_.load()) << std::endl;
         return false;
     }
 
-    OutputMessage& msg = *message;
-    bool noPendingWrite = messageQueue_.empty();
-    {
-        std::scoped_lock<std::mutex> lockClass(lock_);
-        messageQueue_.emplace_back(std::move(message));
-    }
-    if (noPendingWrite)
-        InternalSend(msg);
-
+    // Runs inline when called from a handler of this connection, otherwise the
+    // message is queued on the thread of the connection.
+    asio::dispatch(socket_.get_executor(),
+        std::bind(&Connection::DoSend, shared_from_this(), std::move(message)));
     return true;
 }
 
+void Connection::DoSend(sa::SharedPtr<OutputMessage> message)
+{
+    IoServicePool::BusyScope busy;
+    if (state_ != State::Open)
+        return;
+
+    const bool noPendingWrite = messageQueue_.empty();
+    messageQueue_.emplace_back(std::move(message));
+    if (noPendingWrite)
+        InternalSend(*messageQueue_.front());
+}
+
 void Connection::InternalSend(OutputMessage& message)
 {
     if (!protocol_->OnSendMessage(message))
@@ -98,11 +105,9 @@ void Connection::InternalSend(OutputMessage& message)
 
 void Connection::OnWriteOperation(const asio::error_code& error)
 {
+    IoServicePool::BusyScope busy;
     writeTimer_.cancel();
-    {
-        std::scoped_lock<std::mutex> lockClass(lock_);
-        messageQueue_.pop_front();
-    }
+    messageQueue_.pop_front();
 
     if (error)
     {
@@ -118,6 +123,12 @@ void Connection::OnWriteOperation(const asio::error_code& error)
 }
 
 void Connection::Close(bool force /* = false */)
+{
+    asio::dispatch(socket_.get_executor(),
+        std::bind(&Connection::DoClose, shared_from_this(), force));
+}
+
+void Connection::DoClose(bool force)
 {
     auto* connMngr = GetSubsystem<ConnectionManager>();
     if (!connMngr)
@@ -143,17 +154,27 @@ void Connection::Close(bool force /* = false */)
 
 void Connection::Accept(std::shared_ptr<Protocol> protocol)
 {
-    protocol_ = protocol;
-    Accept();
-    // Not sure about this, but this seems to fix a crash I was hunting for so long time...
-    // Protocol::OnConnect() was called again.
-    protocol->OnConnect();
-//    GetSubsystem<Asynch::Dispatcher>()->Add(
-//        Asynch::CreateTask(std::bind(&Protocol::OnConnect, protocol))
-//    );
+    auto self = shared_from_this();
+    asio::dispatch(socket_.get_executor(), [self, protocol]()
+    {
+        self->protocol_ = protocol;
+        self->DoAccept();
+        // Not sure about this, but this seems to fix a crash I was hunting for so long time...
+        // Protocol::OnConnect() was called again.
+        protocol->OnConnect();
+//        GetSubsystem<Asynch::Dispatcher>()->Add(
+//            Asynch::CreateTask(std::bind(&Protocol::OnConnect, protocol))
+//        );
+    });
 }
 
 void Connection::Accept()
+{
+    asio::dispatch(socket_.get_executor(),
+        std::bind(&Connection::DoAccept, shared_from_this()));
+}
+
+void Connection::DoAccept()
 {
     try
     {
@@ -178,6 +199,7 @@ void Connection::Accept()
 
 void Connection::ParseHeader(const asio::error_code& error)
 {
+    IoServicePool::BusyScope busy;
     readTimer_.cancel();
 #ifdef DEBUG_NET
     lastReadHeader_ = sa::time::tick();
@@ -248,6 +270,7 @@ void Connection::ParseHeader(const asio::error_code& error)
 
 void Connection::ParsePacket(const asio::error_code& error)
 {
+    IoServicePool::BusyScope busy;
     readTimer_.cancel();
 #ifdef DEBUG_NET
     lastReadBody_ = sa::time::tick();
@@ -389,7 +412,12 @@ std::shared_ptr<Connection> ConnectionManager::CreateConnection(
         return std::shared_ptr<Connection>();
     }
 
-    std::shared_ptr<Connection> connection = std::make_shared<Connection>(ioService, servicer);
+    // Bind the connection to the I/O thread with the least sockets, when there are I/O threads
+    auto* pool = GetSubsystem<IoServicePool>();
+    const size_t ioIndex = (pool && pool->GetCount() != 0) ? pool->Acquire() : Connection::NoIoService;
+    std::shared_ptr<Connection> connection = std::make_shared<Connection>(
+        ioIndex != Connection::NoIoService ? pool->GetService(ioIndex) : ioService, servicer);
+    connection->ioIndex_ = ioIndex;
     {
         std::scoped_lock<std::mutex> lock(lock_);
         connections_.insert(connection);
@@ -404,7 +432,10 @@ void ConnectionManager::ReleaseConnection(std::shared_ptr<Connection> connection
     LOG_DEBUG << "Releasing connection" << std::endl;
 #endif
     std::scoped_lock<std::mutex> lockClass(lock_);
-    connections_.erase(connection);
+    if (connections_.erase(connection) == 0 || connection->ioIndex_ == Connection::NoIoService)
+        return;
+    if (auto* pool = GetSubsystem<IoServicePool>())
+        pool->Release(connection->ioIndex_);
 }
 
 void ConnectionManager::CloseAll()
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <unordered_set>
+#include <limits>
 #include <list>
 #include <memory>
 #include <asio.hpp>
@@ -58,6 +59,7 @@ class Connection : public std::enable_shared_from_this<Connection>
     NON_COPYABLE(Connection)
     NON_MOVEABLE(Connection)
 public:
+    static constexpr size_t NoIoService = std::numeric_limits<size_t>::max();
     enum { WriteTimeout = 30 };
     enum { ReadTimeout = 30 };
     enum class State
@@ -70,9 +72,10 @@ public:
     ~Connection();
 
     asio::ip::tcp::socket socket_;
-    /// Send the message
+    /// Send the message. Can be called from any thread, the message is encrypted
+    /// and written on the thread of the connection.
     bool Send(sa::SharedPtr<OutputMessage>&& message);
-    /// Close the connection
+    /// Close the connection. Can be called from any thread.
     void Close(bool force = false);
     /// Used by protocols that require server to send first
     void Accept(std::shared_ptr<Protocol> protocol);
@@ -91,6 +94,9 @@ private:
     void CloseSocket();
     void OnWriteOperation(const asio::error_code& error);
     void InternalSend(OutputMessage& message);
+    void DoSend(sa::SharedPtr<OutputMessage> message);
+    void DoClose(bool force);
+    void DoAccept();
 
 #ifdef DEBUG_NET
     int64_t lastReadHeader_{ 0 };
@@ -98,13 +104,14 @@ private:
 #endif
     std::shared_ptr<ServicePort> servicePort_;
     std::shared_ptr<Protocol> protocol_;
-    std::mutex lock_;
+    /// Index of the I/O thread in the IoServicePool or NoIoService
+    size_t ioIndex_{ NoIoService };
     bool receivedFirst_;
     asio::steady_timer readTimer_;
     asio::steady_timer writeTimer_;
     /// Message read from the client
     std::unique_ptr<NetworkMessage> msg_;
-    /// Messages will be sent to the client
+    /// Messages will be sent to the client. Only accessed on the thread of the connection.
     std::list<sa::SharedPtr<OutputMessage>> messageQueue_;
     time_t timeConnected_;
     uint32_t packetsSent_;
@@ -21,97 +21,330 @@
 
 
 #include "DataClient.h"
+#include "Logger.h"
+#include <algorithm>
 #include <chrono>
-#include <thread>
 
 namespace IO {
 
-DataClient::DataClient(asio::io_service& io_service) :
-    socket_(io_service),
-    resolver_(io_service)
+DataClient::DataClient() :
+    socket_(ioService_),
+    resolver_(ioService_),
+    header_(RESPONSE_HEADER_SIZE)
 {
 }
 
 DataClient::~DataClient()
 {
-    socket_.close();
+    if (running_)
+    {
+        running_ = false;
+        work_.reset();
+        asio::post(ioService_, [this]()
+        {
+            Disconnect();
+            writeQueue_.clear();
+        });
+        if (ioThread_.joinable())
+            ioThread_.join();
+    }
+    FailPending();
 }
 
 void DataClient::Connect(const std::string& host, uint16_t port)
 {
     host_ = host;
     port_ = port;
-    // First time connect, try longer other servers may not be up yet.
-    TryConnect(false, 100);
+    if (!running_)
+    {
+        running_ = true;
+        work_ = std::make_unique<asio::io_service::work>(ioService_);
+        ioThread_ = std::thread([this]() { ioService_.run(); });
+    }
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    asio::post(ioService_, [this, &promise]()
+    {
+        // First time connect, try longer other servers may not be up yet.
+        TryConnect(100);
+        promise.set_value();
+    });
+    future.wait();
 }
 
-bool DataClient::MakeRequest(OpCodes opCode, const DataKey& key, DataBuff& data)
+size_t DataClient::GetPendingCount()
 {
-    const uint8_t ksize1 = static_cast<uint8_t>(key.size());
-    const uint8_t ksize2 = static_cast<uint8_t>(key.size() >> 8);
-    const uint8_t header[] = { static_cast<uint8_t>(opCode), ksize1, ksize2 };
-    // All data must be sent at once. Multiple threads must not send different requests at the same time.
-    std::scoped_lock lock(lock_);
-    if (!TryWrite(asio::buffer(header)))
-        return false;
+    std::scoped_lock lock(pendingLock_);
+    return pending_.size();
+}
 
-    if (!TryWrite(asio::buffer(key.data_)))
-        return false;
+void DataClient::AddPending(uint32_t id, ResponseCallback&& callback)
+{
+    std::scoped_lock lock(pendingLock_);
+    pending_.emplace(id, std::move(callback));
+}
 
-    const uint8_t dsize4 = static_cast<uint8_t>(data.size() >> 24);
-    const uint8_t dsize3 = static_cast<uint8_t>(data.size() >> 16);
-    const uint8_t dsize2 = static_cast<uint8_t>(data.size() >> 8);
-    const uint8_t dsize1 = static_cast<uint8_t>(data.size());
+DataClient::ResponseCallback DataClient::RemovePending(uint32_t id)
+{
+    std::scoped_lock lock(pendingLock_);
+    auto it = pending_.find(id);
+    if (it == pending_.end())
+        return {};
+    ResponseCallback result = std::move((*it).second);
+    pending_.erase(it);
+    return result;
+}
 
-    const uint8_t data_header[] = { dsize1, dsize2, dsize3, dsize4 };
-    if (!TryWrite(asio::buffer(data_header)))
-        return false;
+void DataClient::FailPending()
+{
+    std::unordered_map<uint32_t, ResponseCallback> pending;
+    {
+        std::scoped_lock lock(pendingLock_);
+        pending.swap(pending_);
+    }
+    DataBuff empty;
+    for (auto& p : pending)
+        p.second(false, empty);
+}
 
-    if (!TryWrite(asio::buffer(data)))
-        return false;
+void DataClient::Request(OpCodes opCode, const DataKey& key, const DataBuff* data, ResponseCallback&& callback)
+{
+    // A callback is always needed to match the response, even if nobody is interested in it.
+    if (!callback)
+        callback = [](bool, DataBuff&) {};
+    if (!running_)
+    {
+        DataBuff empty;
+        callback(false, empty);
+        return;
+    }
 
-    std::vector<uint8_t> dataheader(5);
-    /* size_t read = */ asio::read(socket_, asio::buffer(dataheader, 5), asio::transfer_at_least(5));
-    if (static_cast<OpCodes>(dataheader[0]) == OpCodes::Status)
+    const uint32_t id = ++nextRequestId_;
+    Outgoing request{ id, {} };
+    DataBuff& buffer = request.buffer;
+    buffer.reserve(REQUEST_HEADER_SIZE + key.size() + (data ? 4 + data->size() : 0));
+    buffer.push_back(static_cast<uint8_t>(opCode));
+    buffer.push_back(static_cast<uint8_t>(id));
+    buffer.push_back(static_cast<uint8_t>(id >> 8));
+    buffer.push_back(static_cast<uint8_t>(id >> 16));
+    buffer.push_back(static_cast<uint8_t>(id >> 24));
+    buffer.push_back(static_cast<uint8_t>(key.size()));
+    buffer.push_back(static_cast<uint8_t>(key.size() >> 8));
+    buffer.insert(buffer.end(), key.data_.begin(), key.data_.end());
+    if (data)
     {
-        // Does not return data
-        uint8_t result[128];
-        // Read the rest of the status
-        socket_.read_some(asio::buffer(result));
-        return dataheader[1] == static_cast<unsigned char>(ErrorCodes::Ok);
+        buffer.push_back(static_cast<uint8_t>(data->size()));
+        buffer.push_back(static_cast<uint8_t>(data->size() >> 8));
+        buffer.push_back(static_cast<uint8_t>(data->size() >> 16));
+        buffer.push_back(static_cast<uint8_t>(data->size() >> 24));
+        buffer.insert(buffer.end(), data->begin(), data->end());
     }
 
-    // If we are here it returns data
-    const size_t size = static_cast<size_t>(ToInt32(dataheader, 1));
-    data.resize(size);
-    const size_t read2 = asio::read(socket_, asio::buffer(data), asio::transfer_at_least(size));
-    if (read2 != size)
-        return false;
+    // Add it before sending, the response may arrive before the write handler is called
+    AddPending(id, std::move(callback));
+    asio::post(ioService_, [this, request = std::move(request)]() mutable
+    {
+        Send(std::move(request));
+    });
+}
 
-    return true;
+void DataClient::Send(Outgoing&& request)
+{
+    if (!connected_ && !TryConnect())
+    {
+        ResponseCallback callback = RemovePending(request.id);
+        if (callback)
+        {
+            DataBuff empty;
+            callback(false, empty);
+        }
+        return;
+    }
+    writeQueue_.push_back(std::move(request));
+    if (!writing_)
+        Write();
 }
 
-bool DataClient::MakeRequestNoData(OpCodes opCode, const DataKey& key)
+void DataClient::Write()
 {
-    const uint8_t ksize1 = static_cast<uint8_t>(key.size());
-    const uint8_t ksize2 = static_cast<uint8_t>(key.size() >> 8);
-    const uint8_t header[] = { static_cast<uint8_t>(opCode), ksize1, ksize2 };
-    // All data must be sent at once. Multiple threads must not send different requests at the same time.
-    std::scoped_lock lock(lock_);
-    if (!TryWrite(asio::buffer(header)))
-        return false;
+    // One write at a time, asio must not write the same socket concurrently
+    writing_ = true;
+    asio::async_write(socket_, asio::buffer(writeQueue_.front().buffer),
+        [this, connection = connection_](const asio::error_code& ec, size_t)
+    {
+        OnWrite(connection, ec);
+    });
+}
 
-    if (!TryWrite(asio::buffer(key.data_)))
-        return false;
+void DataClient::OnWrite(uint32_t connection, const asio::error_code& ec)
+{
+    if (connection != connection_)
+        return;
+    if (ec)
+    {
+        HandleError();
+        return;
+    }
+    writeQueue_.pop_front();
+    writing_ = false;
+    if (!writeQueue_.empty())
+        Write();
+}
 
-    uint8_t result[128];
-    const size_t read = socket_.read_some(asio::buffer(result));
-    if (read < 2)
+void DataClient::ReadHeader()
+{
+    asio::async_read(socket_, asio::buffer(header_),
+        [this, connection = connection_](const asio::error_code& ec, size_t)
+    {
+        OnHeader(connection, ec);
+    });
+}
+
+void DataClient::OnHeader(uint32_t connection, const asio::error_code& ec)
+{
+    if (connection != connection_)
+        return;
+    if (ec)
+    {
+        HandleError();
+        return;
+    }
+    const size_t size = static_cast<size_t>(ToInt32(header_, 5));
+    data_.resize(size);
+    if (size == 0)
+    {
+        OnResponse();
+        return;
+    }
+    asio::async_read(socket_, asio::buffer(data_),
+        [this, connection](const asio::error_code& ec, size_t)
+    {
+        OnData(connection, ec);
+    });
+}
+
+void DataClient::OnData(uint32_t connection, const asio::error_code& ec)
+{
+    if (connection != connection_)
+        return;
+    if (ec)
+    {
+        HandleError();
+        return;
+    }
+    OnResponse();
+}
+
+void DataClient::OnResponse()
+{
+    ResponseCallback callback = RemovePending(ToInt32(header_, 1));
+    if (callback)
+    {
+        if (static_cast<OpCodes>(header_[0]) == OpCodes::Status)
+        {
+            const bool success = !data_.empty() && static_cast<ErrorCodes>(data_[0]) == ErrorCodes::Ok;
+            DataBuff empty;
+            callback(success, empty);
+        }
+        else
+        {
+            DataBuff data;
+            data.swap(data_);
+            callback(true, data);
+        }
+    }
+    ReadHeader();
+}
+
+void DataClient::HandleError()
+{
+    // The request being written may have been sent partially
+    if (writing_ && !writeQueue_.empty())
+        writeQueue_.pop_front();
+    Disconnect();
+
+    // Requests sent on this connection will never get a response. Requests which were
+    // not sent yet are sent on the next connection.
+    std::unordered_map<uint32_t, ResponseCallback> failed;
+    {
+        std::scoped_lock lock(pendingLock_);
+        for (auto it = pending_.begin(); it != pending_.end(); )
+        {
+            const uint32_t id = it->first;
+            const bool queued = std::any_of(writeQueue_.begin(), writeQueue_.end(),
+                [id](const Outgoing& current) { return current.id == id; });
+            if (queued)
+            {
+                ++it;
+                continue;
+            }
+            failed.emplace(id, std::move(it->second));
+            it = pending_.erase(it);
+        }
+    }
+    DataBuff empty;
+    for (auto& f : failed)
+        f.second(false, empty);
+
+    if (writeQueue_.empty() || !running_)
+        return;
+    if (TryConnect())
+    {
+        Write();
+        return;
+    }
+    for (const auto& request : writeQueue_)
+    {
+        ResponseCallback callback = RemovePending(request.id);
+        if (callback)
+            callback(false, empty);
+    }
+    writeQueue_.clear();
+}
+
+void DataClient::Disconnect()
+{
+    ++connection_;
+    connected_ = false;
+    writing_ = false;
+    asio::error_code ec;
+    socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+    socket_.close(ec);
+}
+
+bool DataClient::MakeRequest(OpCodes opCode, const DataKey& key, DataBuff& data)
+{
+    if (std::this_thread::get_id() == ioThread_.get_id())
+    {
+        LOG_ERROR << "Blocking request from the DataClient thread" << std::endl;
         return false;
+    }
+    std::promise<bool> promise;
+    auto future = promise.get_future();
+    Request(opCode, key, &data, [&promise, &data](bool success, DataBuff& response)
+    {
+        // Status responses don't return data
+        if (success && !response.empty())
+            data.swap(response);
+        promise.set_value(success);
+    });
+    return future.get();
+}
 
-    if (static_cast<OpCodes>(result[0]) == OpCodes::Status && static_cast<ErrorCodes>(result[1]) == ErrorCodes::Ok)
-        return true;
-    return false;
+bool DataClient::MakeRequestNoData(OpCodes opCode, const DataKey& key)
+{
+    if (std::this_thread::get_id() == ioThread_.get_id())
+    {
+        LOG_ERROR << "Blocking request from the DataClient thread" << std::endl;
+        return false;
+    }
+    std::promise<bool> promise;
+    auto future = promise.get_future();
+    Request(opCode, key, nullptr, [&promise](bool success, DataBuff&)
+    {
+        promise.set_value(success);
+    });
+    return future.get();
 }
 
 bool DataClient::LockData(const DataKey& key)
@@ -172,31 +405,31 @@ void DataClient::InternalConnect()
     if (connected_)
         return;
 
-    const asio::ip::tcp::resolver::query query(asio::ip::tcp::v4(), host_, std::to_string(port_));
-    asio::ip::tcp::resolver::iterator endpoint = resolver_.resolve(query);
     asio::error_code error;
+    const asio::ip::tcp::resolver::query query(asio::ip::tcp::v4(), host_, std::to_string(port_));
+    asio::ip::tcp::resolver::iterator endpoint = resolver_.resolve(query, error);
+    if (error || endpoint == asio::ip::tcp::resolver::iterator())
+        return;
     socket_.connect(*endpoint, error);
-    if (!error)
-        connected_ = true;
+    if (error)
+    {
+        socket_.close(error);
+        return;
+    }
+    connected_ = true;
+    ReadHeader();
 }
 
-bool DataClient::TryConnect(bool force, unsigned numTries /* = 10 */)
+bool DataClient::TryConnect(unsigned numTries /* = 10 */)
 {
-    if (force)
-    {
-        connected_ = false;
-        socket_.close();
-    }
     // By default try for 1 second, 10 tries
     unsigned tries = 0;
-    while (!connected_ && tries < numTries)
+    while (!connected_ && tries < numTries && running_)
     {
         ++tries;
         InternalConnect();
         if (connected_)
             return true;
-        if (tries >= 10)
-            return false;
 
         using namespace std::chrono_literals;
         std::this_thread::sleep_for(100ms);
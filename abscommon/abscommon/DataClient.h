@@ -34,19 +34,46 @@ PRAGMA_WARNING_POP
 #include <uuid.h>
 #include "DataKey.h"
 #include "DataCodes.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <asio.hpp>
 
 namespace IO {
 
 using DataBuff = std::vector<uint8_t>;
 
+/// Client for the data server. Requests are tagged with an ID, so many requests
+/// can be in flight on the same connection. The socket is owned by a background
+/// thread running its own io_service, it writes the requests, reads the responses
+/// and calls the completion callbacks. The blocking functions (Read(), Update()...)
+/// wait for the response, the *Async() functions return immediately.
 class DataClient
 {
+public:
+    /// Called from the DataClient thread when the response arrived. Must not
+    /// call blocking functions of the DataClient.
+    using ResponseCallback = std::function<void(bool success, DataBuff& data)>;
+    using StatusCallback = std::function<void(bool success)>;
 private:
-    std::mutex lock_;
+    struct Outgoing
+    {
+        uint32_t id;
+        DataBuff buffer;
+    };
+    std::mutex pendingLock_;
+    std::unordered_map<uint32_t, ResponseCallback> pending_;
+    std::atomic<uint32_t> nextRequestId_{ 0 };
+    asio::io_service ioService_;
+    std::unique_ptr<asio::io_service::work> work_;
+    std::thread ioThread_;
+    std::atomic<bool> running_{ false };
 public:
-    explicit DataClient(asio::io_service& io_service);
+    DataClient();
     ~DataClient();
 
     void Connect(const std::string& host, uint16_t port);
@@ -80,6 +107,35 @@ public:
             return true;
         return false;
     }
+    /// Read an entity without waiting for the response. The callback gets the entity
+    /// read from the data server.
+    template<typename E>
+    void ReadAsync(const E& entity, std::function<void(bool success, E& entity)>&& callback)
+    {
+        const DataKey aKey(E::KEY(), uuids::uuid(entity.uuid));
+        DataBuff data;
+        SetEntity<E>(entity, data);
+        Request(OpCodes::Read, aKey, &data, [entity, callback = std::move(callback)](bool success, DataBuff& data) mutable
+        {
+            if (success)
+                success = GetEntity(data, entity);
+            if (callback)
+                callback(success, entity);
+        });
+    }
+    /// The entity must outlive the returned future
+    template<typename E>
+    std::future<bool> ReadFuture(E& entity)
+    {
+        auto promise = std::make_shared<std::promise<bool>>();
+        ReadAsync(entity, [&entity, promise](bool success, E& result)
+        {
+            if (success)
+                entity = result;
+            promise->set_value(success);
+        });
+        return promise->get_future();
+    }
     /// Delete an entity. This entity must be in cache, if not, use Read first.
     template<typename E>
     bool Delete(const E& entity)
@@ -113,6 +169,27 @@ public:
             return false;
         return UpdateData(aKey, data);
     }
+    /// Update without waiting for the response
+    template<typename E>
+    void UpdateAsync(const E& entity, StatusCallback&& callback = {})
+    {
+        const DataKey aKey(E::KEY(), uuids::uuid(entity.uuid));
+        DataBuff data;
+        if (SetEntity<E>(entity, data) == 0)
+        {
+            if (callback)
+                callback(false);
+            return;
+        }
+        Request(OpCodes::Update, aKey, &data, ToResponseCallback(std::move(callback)));
+    }
+    template<typename E>
+    std::future<bool> UpdateFuture(const E& entity)
+    {
+        auto promise = std::make_shared<std::promise<bool>>();
+        UpdateAsync(entity, [promise](bool success) { promise->set_value(success); });
+        return promise->get_future();
+    }
     template<typename E>
     bool Create(E& entity)
     {
@@ -122,6 +199,20 @@ public:
             return false;
         return CreateData(aKey, data);
     }
+    /// Create without waiting for the response
+    template<typename E>
+    void CreateAsync(const E& entity, StatusCallback&& callback = {})
+    {
+        const DataKey aKey(E::KEY(), uuids::uuid(entity.uuid));
+        DataBuff data;
+        if (SetEntity<E>(entity, data) == 0)
+        {
+            if (callback)
+                callback(false);
+            return;
+        }
+        Request(OpCodes::Create, aKey, &data, ToResponseCallback(std::move(callback)));
+    }
     template<typename E>
     bool Preload(const E& entity)
     {
@@ -144,6 +235,20 @@ public:
         const DataKey aKey(E::KEY(), uuids::uuid(entity.uuid));
         return InvalidateData(aKey);
     }
+    /// Invalidate without waiting for the response
+    template<typename E>
+    void InvalidateAsync(const E& entity, StatusCallback&& callback = {})
+    {
+        const DataKey aKey(E::KEY(), uuids::uuid(entity.uuid));
+        Request(OpCodes::Invalidate, aKey, nullptr, ToResponseCallback(std::move(callback)));
+    }
+    /// Delete without waiting for the response
+    template<typename E>
+    void DeleteAsync(const E& entity, StatusCallback&& callback = {})
+    {
+        const DataKey aKey(E::KEY(), uuids::uuid(entity.uuid));
+        Request(OpCodes::Delete, aKey, nullptr, ToResponseCallback(std::move(callback)));
+    }
     /// Clears all cache
     bool Clear();
     bool IsConnected() const
@@ -158,7 +263,21 @@ public:
     {
         return port_;
     }
+    /// Number of requests waiting for a response
+    size_t GetPendingCount();
+    /// Send a request and call callback when the response arrived. When data is
+    /// not nullptr it is sent with the request.
+    void Request(OpCodes opCode, const DataKey& key, const DataBuff* data, ResponseCallback&& callback);
 private:
+    static ResponseCallback ToResponseCallback(StatusCallback&& callback)
+    {
+        if (!callback)
+            return {};
+        return [callback = std::move(callback)](bool success, DataBuff&)
+        {
+            callback(success);
+        };
+    }
     /// Unserialize Entitiy
     /// @param[in] data Input data
     /// @param[out] Resulting Entity
@@ -195,8 +314,25 @@ private:
             intBytes[static_cast<size_t>(start)];
     }
 
+    /// Send the request and wait for the response
     bool MakeRequest(OpCodes opCode, const DataKey& key, DataBuff& data);
     bool MakeRequestNoData(OpCodes opCode, const DataKey& key);
+    void AddPending(uint32_t id, ResponseCallback&& callback);
+    ResponseCallback RemovePending(uint32_t id);
+    /// Fail all requests waiting for a response
+    void FailPending();
+    // Called on the DataClient thread only
+    void Send(Outgoing&& request);
+    void Write();
+    void OnWrite(uint32_t connection, const asio::error_code& ec);
+    void ReadHeader();
+    void OnHeader(uint32_t connection, const asio::error_code& ec);
+    void OnData(uint32_t connection, const asio::error_code& ec);
+    void OnResponse();
+    /// Fail the requests sent on the current connection and reconnect when there are
+    /// requests not yet sent.
+    void HandleError();
+    void Disconnect();
     bool LockData(const DataKey& key);
     bool UnlockData(const DataKey& key);
     bool ReadData(const DataKey& key, DataBuff& data);
@@ -207,30 +343,22 @@ private:
     bool PreloadData(const DataKey& key);
     bool InvalidateData(const DataKey& key);
     void InternalConnect();
-    /// Try connect to server.
-    /// @param[in] force If force is true it disconnects first.
+    /// Try connect to server. Called on the DataClient thread.
     /// @return true on success.
-    bool TryConnect(bool force, unsigned numTries = 10);
-    /// Try to send some data. If not connected tries to reconnect.
-    template<typename B>
-    bool TryWrite(const B& buffer)
-    {
-        asio::error_code ec;
-        socket_.send(buffer, 0, ec);
-        if (ec)
-        {
-            if (!TryConnect(true))
-                return false;
-            socket_.send(buffer, 0, ec);
-        }
-        return !(bool)ec;
-    }
+    bool TryConnect(unsigned numTries = 10);
 
     std::string host_;
     uint16_t port_{ 0 };
     asio::ip::tcp::socket socket_;
     asio::ip::tcp::resolver resolver_;
-    bool connected_{ false };
+    std::atomic<bool> connected_{ false };
+    // The state of the connection, only used by the DataClient thread
+    /// Incremented when the socket is closed, handlers of the old connection do nothing
+    uint32_t connection_{ 0 };
+    std::deque<Outgoing> writeQueue_;
+    bool writing_{ false };
+    DataBuff header_;
+    DataBuff data_;
 };
 
 // RAII Entity locker
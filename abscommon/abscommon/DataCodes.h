@@ -22,9 +22,17 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 
 namespace IO {
 
+// Request: OpCode (1 byte), request ID (4 bytes), key size (2 bytes), key,
+// [data size (4 bytes), data]
+inline constexpr size_t REQUEST_HEADER_SIZE = 7;
+// Response: OpCode (1 byte), request ID (4 bytes), data size (4 bytes), data.
+// The data of a Status response is the ErrorCode (1 byte) followed by a message.
+inline constexpr size_t RESPONSE_HEADER_SIZE = 9;
+
 enum class OpCodes : uint8_t
 {
     None = 0,
@@ -25,6 +25,35 @@
 
 namespace Asynch {
 
+void Dispatcher::Overflow::Push(Task* task)
+{
+    std::scoped_lock lock(lock_);
+    tasks_.push_back(task);
+    ++size_;
+}
+
+Task* Dispatcher::Overflow::Pop()
+{
+    if (size_ == 0)
+        return nullptr;
+    std::scoped_lock lock(lock_);
+    if (tasks_.empty())
+        return nullptr;
+    Task* task = tasks_.front();
+    tasks_.pop_front();
+    --size_;
+    return task;
+}
+
+void Dispatcher::Overflow::Clear()
+{
+    std::scoped_lock lock(lock_);
+    for (Task* t : tasks_)
+        delete t;
+    tasks_.clear();
+    size_ = 0;
+}
+
 void Dispatcher::Start()
 {
     if (state_ != State::Running)
@@ -38,42 +67,98 @@ void Dispatcher::Stop()
 {
     if (state_ == State::Running)
     {
-        lock_.lock();
-        state_ = State::Terminated;
-        while (!tasks_.empty())
         {
-            Task* task = tasks_.front();
-            tasks_.pop_front();
-            delete task;
+            std::scoped_lock lock(lock_);
+            state_ = State::Terminated;
+            sleeping_ = false;
         }
-        lock_.unlock();
         // Notify thread to exit
         signal_.notify_one();
         thread_.join();
+        Clear();
     }
 }
 
-void Dispatcher::Add(Task* task, bool front /* = false */)
+void Dispatcher::Clear()
 {
-    bool doSignal = false;
-    lock_.lock();
+    Task* task = nullptr;
+    while (priorityTasks_.Dequeue(task))
+        delete task;
+    while (tasks_.Dequeue(task))
+        delete task;
+    priorityOverflow_.Clear();
+    overflow_.Clear();
+}
 
-    if (state_ == State::Running)
+void Dispatcher::Add(Task* task, bool front /* = false */)
+{
+    if (state_ != State::Running)
     {
-        doSignal = tasks_.empty();
+        delete task;
+        return;
+    }
+
+    task->queued_ = std::chrono::steady_clock::now();
+    TaskQueue& queue = front ? priorityTasks_ : tasks_;
+    Overflow& overflow = front ? priorityOverflow_ : overflow_;
+    // When there is already something in the overflow queue, append it there
+    // to keep the order.
+    if (overflow.Size() != 0 || !queue.Enqueue(task))
+        overflow.Push(task);
 
-        if (!front)
-            tasks_.push_back(task);
-        else
-            tasks_.push_front(task);
+    Wakeup();
+}
+
+void Dispatcher::Wakeup()
+{
+    // Pairs with the fence in DispatcherThread(), either the Dispatcher sees the
+    // new task or we see that it's sleeping.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!sleeping_.load(std::memory_order_relaxed))
+        return;
+    if (!sleeping_.exchange(false))
+        return;
+    {
+        // Make sure it is waiting
+        std::scoped_lock lock(lock_);
     }
-    else
-        delete task;
+    signal_.notify_one();
+}
 
-    lock_.unlock();
+bool Dispatcher::IsEmpty() const
+{
+    return priorityTasks_.IsEmpty() && priorityOverflow_.Size() == 0 &&
+        tasks_.IsEmpty() && overflow_.Size() == 0;
+}
 
-    if (doSignal)
-        signal_.notify_one();
+size_t Dispatcher::GetQueueDepth() const
+{
+    return priorityTasks_.Size() + priorityOverflow_.Size() + tasks_.Size() + overflow_.Size();
+}
+
+Task* Dispatcher::Next()
+{
+    // All priority tasks, including those which did not fit into the ring, run
+    // before the normal tasks.
+    Task* task = nullptr;
+    if (priorityTasks_.Dequeue(task))
+        return task;
+    if ((task = priorityOverflow_.Pop()) != nullptr)
+        return task;
+    if (tasks_.Dequeue(task))
+        return task;
+    return overflow_.Pop();
+}
+
+DispatcherStats Dispatcher::GetStats() const
+{
+    DispatcherStats result;
+    result.queueDepth = GetQueueDepth();
+    result.maxQueueDepth = maxQueueDepth_;
+    result.executed = executed_;
+    for (size_t i = 0; i < DispatcherStats::WAIT_BUCKETS; ++i)
+        result.waitTimes[i] = waitTimes_[i];
+    return result;
 }
 
 void Dispatcher::DispatcherThread()
@@ -82,57 +167,64 @@ void Dispatcher::DispatcherThread()
     LOG_DEBUG << "Dispatcher threat started" << std::endl;
 #endif
 
-    // NOTE: second argument defer_lock is to prevent from immediate locking
-    std::unique_lock<std::mutex> taskLockUnique(lock_, std::defer_lock);
-
     while (state_ != State::Terminated)
     {
-        taskLockUnique.lock();
-
         const int64_t observationStart = sa::time::tick();
 
-        if (tasks_.empty())
+        if (IsEmpty())
         {
-            // List is empty, wait for signal
-            signal_.wait(taskLockUnique);
+            // Queue is empty, wait for signal
+            std::unique_lock<std::mutex> lock(lock_);
+            sleeping_ = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (IsEmpty() && state_ == State::Running)
+            {
 #ifdef DEBUG_DISPATCHER
-            LOG_DEBUG << "Waiting for task" << std::endl;
+                LOG_DEBUG << "Waiting for task" << std::endl;
 #endif
+                signal_.wait(lock, [this]() { return !sleeping_ || state_ != State::Running; });
+            }
+            sleeping_ = false;
         }
 
 #ifdef DEBUG_DISPATCHER
         LOG_DEBUG << "Dispatcher signaled" << std::endl;
 #endif
 
-        if (!tasks_.empty())
+        Task* task = Next();
+        if (!task)
+            continue;
+
+        const size_t depth = GetQueueDepth() + 1;
+        if (depth > maxQueueDepth_)
+            maxQueueDepth_ = depth;
+        const auto waitTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - task->queued_).count();
+        size_t bucket = 0;
+        while (bucket < DispatcherStats::WAIT_LIMITS.size() && waitTime >= DispatcherStats::WAIT_LIMITS[bucket])
+            ++bucket;
+        waitTimes_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+        // Execute the task
+        if (!task->IsExpired())
         {
-            // Take first task
-            Task* task = tasks_.front();
-            tasks_.pop_front();
-            taskLockUnique.unlock();
+            const int64_t startExecTime = sa::time::tick();
 
-            // Execute the task
-            if (!task->IsExpired())
-            {
-                const int64_t startExecTime = sa::time::tick();
+            (*task)();
+            executed_.fetch_add(1, std::memory_order_relaxed);
 
-                (*task)();
-
-                // https://technet.microsoft.com/en-us/library/cc181325.aspx
-                const uint32_t busyTime = sa::time::time_elapsed(startExecTime);
-                const uint32_t observationTime = sa::time::time_elapsed(observationStart);
-                if (observationTime != 0)
-                    utilization_ = static_cast<uint32_t>(busyTime / observationTime);
-            }
+            // https://technet.microsoft.com/en-us/library/cc181325.aspx
+            const uint32_t busyTime = sa::time::time_elapsed(startExecTime);
+            const uint32_t observationTime = sa::time::time_elapsed(observationStart);
+            if (observationTime != 0)
+                utilization_ = static_cast<uint32_t>(busyTime / observationTime);
+        }
 
-            delete task;
+        delete task;
 
 #ifdef DEBUG_DISPATCHER
-            LOG_DEBUG << "Executing task" << std::endl;
+        LOG_DEBUG << "Executing task" << std::endl;
 #endif
-        }
-        else
-            taskLockUnique.unlock();
     }
 #ifdef DEBUG_DISPATCHER
     LOG_DEBUG << "Dispatcher threat stopped" << std::endl;
@@ -22,32 +22,49 @@
 #pragma once
 
 #include "Task.h"
-#include <list>
+#include <array>
+#include <atomic>
+#include <deque>
 #include <mutex>
 #include <thread>
 #include <condition_variable>
+#include <sa/MPSCQueue.h>
 
 namespace Asynch {
 
+struct DispatcherStats
+{
+    static constexpr size_t WAIT_BUCKETS = 5;
+    /// Upper bounds of the wait time buckets in us, the last bucket has no limit
+    static constexpr std::array<uint32_t, WAIT_BUCKETS - 1> WAIT_LIMITS = { 100, 1000, 10000, 100000 };
+    /// Tasks currently waiting
+    size_t queueDepth{ 0 };
+    size_t maxQueueDepth{ 0 };
+    uint64_t executed{ 0 };
+    /// Number of tasks which waited WAIT_LIMITS[i - 1]..WAIT_LIMITS[i] us before they were executed
+    std::array<uint64_t, WAIT_BUCKETS> waitTimes{};
+};
+
 class Dispatcher
 {
 public:
     Dispatcher() :
         state_(State::Terminated),
         utilization_(0)
-    {
-        tasks_.clear();
-    }
+    { }
     ~Dispatcher() = default;
 
     void Start();
     void Stop();
+    /// Can be called from any thread. Tasks added with front = true are executed
+    /// before all other tasks.
     void Add(Task* task, bool front = false);
     /// CPU Utilization in % something between 0..100
     uint32_t GetUtilization() const
     {
         return utilization_;
     }
+    DispatcherStats GetStats() const;
 
     bool IsDispatcherThread() const { return (state_ == State::Running) ? thread_.get_id() == std::this_thread::get_id() : false; }
 
@@ -57,13 +74,42 @@ public:
         Terminated
     };
 private:
+    static constexpr size_t QUEUE_SIZE = 4096;
+    using TaskQueue = sa::MPSCQueue<Task*, QUEUE_SIZE>;
+    /// Used when a queue is full
+    class Overflow
+    {
+    private:
+        std::mutex lock_;
+        std::deque<Task*> tasks_;
+        std::atomic<size_t> size_{ 0 };
+    public:
+        void Push(Task* task);
+        Task* Pop();
+        void Clear();
+        size_t Size() const { return size_; }
+    };
+    /// Tasks added to the front, e.g. by the Scheduler
+    TaskQueue priorityTasks_;
+    Overflow priorityOverflow_;
+    TaskQueue tasks_;
+    Overflow overflow_;
+    /// Only used to wait when there is nothing to do
     std::mutex lock_;
-    std::list<Task*> tasks_;
-    State state_;
-    std::thread thread_;
     std::condition_variable signal_;
-    uint32_t utilization_;
+    std::atomic<bool> sleeping_{ false };
+    std::atomic<State> state_;
+    std::thread thread_;
+    std::atomic<uint32_t> utilization_;
+    std::atomic<size_t> maxQueueDepth_{ 0 };
+    std::atomic<uint64_t> executed_{ 0 };
+    std::array<std::atomic<uint64_t>, DispatcherStats::WAIT_BUCKETS> waitTimes_{};
     void DispatcherThread();
+    Task* Next();
+    bool IsEmpty() const;
+    size_t GetQueueDepth() const;
+    void Wakeup();
+    void Clear();
 };
 
 }
@@ -0,0 +1,178 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "DispatcherPool.h"
+#include "Logger.h"
+#include "Subsystems.h"
+#include <sa/Assert.h>
+#include <algorithm>
+#include <limits>
+
+namespace Asynch {
+
+DispatcherPool::~DispatcherPool()
+{
+    Stop();
+}
+
+void DispatcherPool::Start(size_t count)
+{
+    if (running_)
+        return;
+    if (count == 0)
+        count = 1;
+
+    lanes_.reserve(count);
+    // Lane 0 is the main Dispatcher
+    auto mainLane = std::make_unique<Lane>();
+    mainLane->dispatcher = GetSubsystem<Dispatcher>();
+    mainLane->scheduler = GetSubsystem<Scheduler>();
+    ASSERT(mainLane->dispatcher && mainLane->scheduler);
+    lanes_.push_back(std::move(mainLane));
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        auto lane = std::make_unique<Lane>();
+        lane->ownDispatcher = std::make_unique<Dispatcher>();
+        lane->ownScheduler = std::make_unique<Scheduler>(lane->ownDispatcher.get());
+        lane->dispatcher = lane->ownDispatcher.get();
+        lane->scheduler = lane->ownScheduler.get();
+        lane->dispatcher->Start();
+        lane->scheduler->Start();
+        lanes_.push_back(std::move(lane));
+    }
+    running_ = true;
+}
+
+void DispatcherPool::Stop()
+{
+    if (!running_)
+        return;
+    running_ = false;
+    // The main lane is stopped by the owner of the subsystems
+    for (auto& lane : lanes_)
+    {
+        if (lane->ownScheduler)
+            lane->ownScheduler->Stop();
+        if (lane->ownDispatcher)
+            lane->ownDispatcher->Stop();
+    }
+}
+
+size_t DispatcherPool::Acquire()
+{
+    ASSERT(!lanes_.empty());
+    size_t result = 0;
+    uint32_t minOwners = std::numeric_limits<uint32_t>::max();
+    for (size_t i = 0; i < lanes_.size(); ++i)
+    {
+        const uint32_t owners = lanes_[i]->owners.load();
+        if (owners < minOwners)
+        {
+            minOwners = owners;
+            result = i;
+        }
+    }
+    ++lanes_[result]->owners;
+    return result;
+}
+
+void DispatcherPool::Release(size_t lane)
+{
+    if (lane >= lanes_.size())
+        return;
+    if (lanes_[lane]->owners > 0)
+        --lanes_[lane]->owners;
+}
+
+void DispatcherPool::Add(size_t lane, Task* task, bool front /* = false */)
+{
+    if (lane >= lanes_.size())
+    {
+        // Not started or invalid lane, fall back to the main Dispatcher
+        GetSubsystem<Dispatcher>()->Add(task, front);
+        return;
+    }
+    lanes_[lane]->dispatcher->Add(task, front);
+}
+
+uint32_t DispatcherPool::Schedule(size_t lane, ScheduledTask* task)
+{
+    if (lane >= lanes_.size())
+        return GetSubsystem<Scheduler>()->Add(task);
+    return lanes_[lane]->scheduler->Add(task);
+}
+
+bool DispatcherPool::StopEvent(size_t lane, uint32_t eventId)
+{
+    if (lane >= lanes_.size())
+        return GetSubsystem<Scheduler>()->StopEvent(eventId);
+    return lanes_[lane]->scheduler->StopEvent(eventId);
+}
+
+bool DispatcherPool::IsLaneThread(size_t lane) const
+{
+    if (lane >= lanes_.size())
+        return GetSubsystem<Dispatcher>()->IsDispatcherThread();
+    return lanes_[lane]->dispatcher->IsDispatcherThread();
+}
+
+size_t DispatcherPool::GetCurrentLane() const
+{
+    for (size_t i = 0; i < lanes_.size(); ++i)
+    {
+        if (lanes_[i]->dispatcher->IsDispatcherThread())
+            return i;
+    }
+    return lanes_.size();
+}
+
+uint32_t DispatcherPool::GetOwners(size_t lane) const
+{
+    if (lane >= lanes_.size())
+        return 0;
+    return lanes_[lane]->owners;
+}
+
+uint32_t DispatcherPool::GetUtilization() const
+{
+    uint32_t result = 0;
+    for (const auto& lane : lanes_)
+        result = std::max(result, lane->dispatcher->GetUtilization());
+    return result;
+}
+
+DispatcherStats DispatcherPool::GetStats() const
+{
+    DispatcherStats result;
+    for (const auto& lane : lanes_)
+    {
+        const DispatcherStats stats = lane->dispatcher->GetStats();
+        result.queueDepth += stats.queueDepth;
+        result.maxQueueDepth = std::max(result.maxQueueDepth, stats.maxQueueDepth);
+        result.executed += stats.executed;
+        for (size_t i = 0; i < DispatcherStats::WAIT_BUCKETS; ++i)
+            result.waitTimes[i] += stats.waitTimes[i];
+    }
+    return result;
+}
+
+}
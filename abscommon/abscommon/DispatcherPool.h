@@ -0,0 +1,82 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "Dispatcher.h"
+#include "Scheduler.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace Asynch {
+
+/// A set of Dispatcher lanes, each with its own Scheduler. Work that belongs
+/// to one lane (e.g. a game instance) is always executed on the same thread, so
+/// it does not need to be synchronized with itself, but different lanes run in
+/// parallel. Lane 0 is the Dispatcher and Scheduler subsystem, so with one lane
+/// everything runs like before.
+class DispatcherPool
+{
+private:
+    struct Lane
+    {
+        Dispatcher* dispatcher{ nullptr };
+        Scheduler* scheduler{ nullptr };
+        /// Extra lanes own their Dispatcher and Scheduler
+        std::unique_ptr<Dispatcher> ownDispatcher;
+        std::unique_ptr<Scheduler> ownScheduler;
+        /// Number of owners (e.g. games) assigned to this lane
+        std::atomic<uint32_t> owners{ 0 };
+    };
+    std::vector<std::unique_ptr<Lane>> lanes_;
+    bool running_{ false };
+public:
+    DispatcherPool() = default;
+    ~DispatcherPool();
+
+    /// Start with count lanes. Must be called after the Dispatcher and Scheduler
+    /// subsystems are started.
+    void Start(size_t count);
+    void Stop();
+    size_t GetCount() const { return lanes_.size(); }
+
+    /// Returns the lane with the least owners and adds an owner to it.
+    size_t Acquire();
+    /// Removes an owner from the lane.
+    void Release(size_t lane);
+
+    void Add(size_t lane, Task* task, bool front = false);
+    /// Add a Task to the Scheduler of the lane, return EventID
+    uint32_t Schedule(size_t lane, ScheduledTask* task);
+    bool StopEvent(size_t lane, uint32_t eventId);
+    bool IsLaneThread(size_t lane) const;
+    /// Returns the lane of the calling thread or GetCount() when the calling
+    /// thread is not a lane thread.
+    size_t GetCurrentLane() const;
+    uint32_t GetOwners(size_t lane) const;
+    /// The highest CPU Utilization of all lanes in %
+    uint32_t GetUtilization() const;
+    /// Sum of the stats of all lanes, the max queue depth is the highest of all lanes
+    DispatcherStats GetStats() const;
+};
+
+}
@@ -0,0 +1,173 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "IoServicePool.h"
+#include "Logger.h"
+#include <sa/Assert.h>
+#include <sa/time.h>
+#include <algorithm>
+#include <limits>
+
+namespace Net {
+
+thread_local IoServicePool::Worker* IoServicePool::currentWorker_ = nullptr;
+thread_local unsigned IoServicePool::busyDepth_ = 0;
+
+IoServicePool::BusyScope::BusyScope() :
+    worker_(busyDepth_++ == 0 ? currentWorker_ : nullptr)
+{
+    if (worker_)
+        start_ = std::chrono::steady_clock::now();
+}
+
+IoServicePool::BusyScope::~BusyScope()
+{
+    --busyDepth_;
+    if (!worker_)
+        return;
+    const auto busy = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_).count();
+    worker_->busyTime.fetch_add(static_cast<uint64_t>(busy), std::memory_order_relaxed);
+    worker_->handlers.fetch_add(1, std::memory_order_relaxed);
+}
+
+IoServicePool::~IoServicePool()
+{
+    Stop();
+}
+
+void IoServicePool::WorkerThread(Worker* worker)
+{
+    currentWorker_ = worker;
+    for (;;)
+    {
+        try
+        {
+            worker->service.run();
+            break;
+        }
+        catch (const std::exception& ex)
+        {
+            // Don't let one bad handler take down all connections of this thread
+            LOG_ERROR << "Exception in I/O thread: " << ex.what() << std::endl;
+        }
+    }
+    currentWorker_ = nullptr;
+}
+
+void IoServicePool::Start(size_t count)
+{
+    if (running_ || count == 0)
+        return;
+
+    workers_.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto worker = std::make_unique<Worker>();
+        worker->work = std::make_unique<asio::io_service::work>(worker->service);
+        worker->lastSample = sa::time::tick();
+        workers_.push_back(std::move(worker));
+    }
+    for (auto& worker : workers_)
+        worker->thread = std::thread(&IoServicePool::WorkerThread, worker.get());
+    running_ = true;
+}
+
+void IoServicePool::Stop()
+{
+    if (!running_)
+        return;
+    running_ = false;
+    for (auto& worker : workers_)
+    {
+        worker->work.reset();
+        worker->service.stop();
+    }
+    for (auto& worker : workers_)
+    {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+}
+
+size_t IoServicePool::Acquire()
+{
+    ASSERT(!workers_.empty());
+    size_t result = 0;
+    uint32_t minSockets = std::numeric_limits<uint32_t>::max();
+    for (size_t i = 0; i < workers_.size(); ++i)
+    {
+        const uint32_t sockets = workers_[i]->sockets.load();
+        if (sockets < minSockets)
+        {
+            minSockets = sockets;
+            result = i;
+        }
+    }
+    ++workers_[result]->sockets;
+    return result;
+}
+
+void IoServicePool::Release(size_t index)
+{
+    if (index >= workers_.size())
+        return;
+    if (workers_[index]->sockets > 0)
+        --workers_[index]->sockets;
+}
+
+asio::io_service& IoServicePool::GetService(size_t index)
+{
+    ASSERT(index < workers_.size());
+    return workers_[index]->service;
+}
+
+IoServiceStats IoServicePool::GetStats(size_t index) const
+{
+    IoServiceStats result;
+    if (index >= workers_.size())
+        return result;
+    const auto& worker = *workers_[index];
+    result.sockets = worker.sockets.load();
+    result.handlers = worker.handlers.load(std::memory_order_relaxed);
+    result.busyTime = worker.busyTime.load(std::memory_order_relaxed);
+    return result;
+}
+
+uint32_t IoServicePool::GetUtilization()
+{
+    uint32_t result = 0;
+    const int64_t now = sa::time::tick();
+    for (auto& worker : workers_)
+    {
+        const uint64_t busy = worker->busyTime.load(std::memory_order_relaxed);
+        const int64_t elapsed = now - worker->lastSample.exchange(now);
+        const uint64_t lastBusy = worker->lastBusyTime.exchange(busy);
+        if (elapsed <= 0)
+            continue;
+        // Busy time is in us, elapsed in ms
+        const uint64_t percent = (busy - lastBusy) / 10 / static_cast<uint64_t>(elapsed);
+        result = std::max(result, static_cast<uint32_t>(std::min<uint64_t>(percent, 100)));
+    }
+    return result;
+}
+
+}
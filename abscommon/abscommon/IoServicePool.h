@@ -0,0 +1,103 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <sa/Noncopyable.h>
+
+namespace Net {
+
+struct IoServiceStats
+{
+    /// Sockets assigned to the thread
+    uint32_t sockets{ 0 };
+    /// Handlers measured with IoServicePool::BusyScope
+    uint64_t handlers{ 0 };
+    /// Time spent in these handlers in us
+    uint64_t busyTime{ 0 };
+};
+
+/// A set of threads, each running its own io_service. A connection is bound to
+/// one of them for its whole lifetime, so all handlers of a connection run on the
+/// same thread and need no synchronization with each other, while different
+/// connections are read, decrypted and written in parallel.
+class IoServicePool
+{
+    NON_COPYABLE(IoServicePool)
+private:
+    struct Worker
+    {
+        asio::io_service service;
+        std::unique_ptr<asio::io_service::work> work;
+        std::thread thread;
+        std::atomic<uint32_t> sockets{ 0 };
+        std::atomic<uint64_t> handlers{ 0 };
+        std::atomic<uint64_t> busyTime{ 0 };
+        /// Busy time and time of the last GetUtilization() call
+        std::atomic<uint64_t> lastBusyTime{ 0 };
+        std::atomic<int64_t> lastSample{ 0 };
+    };
+    std::vector<std::unique_ptr<Worker>> workers_;
+    bool running_{ false };
+    static thread_local Worker* currentWorker_;
+    static thread_local unsigned busyDepth_;
+    static void WorkerThread(Worker* worker);
+public:
+    /// Measures the time the calling thread spends in a handler, nested scopes are
+    /// counted once. Does nothing when not called from an I/O thread of the pool.
+    class BusyScope
+    {
+        NON_COPYABLE(BusyScope)
+    private:
+        Worker* worker_;
+        std::chrono::steady_clock::time_point start_;
+    public:
+        BusyScope();
+        ~BusyScope();
+    };
+
+    IoServicePool() = default;
+    ~IoServicePool();
+
+    /// Start count threads. With 0 threads the pool is not used and connections
+    /// stay on the io_service of their acceptor.
+    void Start(size_t count);
+    void Stop();
+    size_t GetCount() const { return workers_.size(); }
+
+    /// Returns the thread with the least sockets and adds a socket to it.
+    size_t Acquire();
+    /// Removes a socket from the thread.
+    void Release(size_t index);
+    asio::io_service& GetService(size_t index);
+
+    IoServiceStats GetStats(size_t index) const;
+    /// The highest Utilization of all threads in % since the last call
+    uint32_t GetUtilization();
+};
+
+}
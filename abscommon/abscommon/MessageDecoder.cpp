@@ -29,6 +29,12 @@ MessageDecoder::MessageDecoder(const NetworkMessage& message) :
     pos_(NetworkMessage::INITIAL_BUFFER_POSITION)
 { }
 
+MessageDecoder::MessageDecoder(const NetworkMessage& message, size_t pos) :
+    ptr_(message.GetBuffer()),
+    size_(message.GetSize() + NetworkMessage::INITIAL_BUFFER_POSITION),
+    pos_(pos)
+{ }
+
 std::optional<AB::GameProtocol::ServerPacketType> MessageDecoder::GetNext()
 {
     if (!CanRead(1))
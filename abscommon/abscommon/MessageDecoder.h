@@ -41,6 +41,8 @@ private:
     std::string GetString();
 public:
     explicit MessageDecoder(const NetworkMessage& message);
+    /// Start decoding at pos of the buffer of message
+    MessageDecoder(const NetworkMessage& message, size_t pos);
     template <typename T>
     T Get()
     {
@@ -57,6 +59,8 @@ public:
     }
 
     std::optional<AB::GameProtocol::ServerPacketType> GetNext();
+    /// Position in the buffer of the message
+    size_t GetPos() const { return pos_; }
 };
 
 template <>
@@ -28,52 +28,43 @@
 #include "Dispatcher.h"
 #include "Subsystems.h"
 #include "Logger.h"
+#include "PoolCache.h"
 #include <sa/Assert.h>
 
 namespace Net {
 
+static NetworkMessage::MessagePool* GetMessagePool()
+{
+    return GetSubsystem<NetworkMessage::MessagePool>();
+}
+
+using MessageCache = PoolCache<NetworkMessage, NetworkMessage::MessagePool, &GetMessagePool>;
+
 void NetworkMessage::Delete(NetworkMessage* p)
 {
-    auto* pool = GetSubsystem<NetworkMessage::MessagePool>();
-    if (!pool)
-    {
-        LOG_ERROR << "No NetworkMessage::MessagePool" << std::endl;
-        return;
-    }
-    pool->deallocate(p, 1);
+    MessageCache::Deallocate(p);
 }
 
 std::unique_ptr<NetworkMessage> NetworkMessage::GetNew()
 {
-    auto* pool = GetSubsystem<NetworkMessage::MessagePool>();
-    if (!pool)
+    auto* ptr = MessageCache::Allocate();
+    if (!ptr)
     {
-        LOG_ERROR << "No NetworkMessage::MessagePool" << std::endl;
+        LOG_ERROR << "No NetworkMessage::MessagePool or pool exhausted" << std::endl;
         return std::unique_ptr<NetworkMessage>();
     }
-    auto* ptr = pool->allocate(1, nullptr);
-    ASSERT(ptr);
     ptr->Reset();
     return std::unique_ptr<NetworkMessage>(ptr);
 }
 
 sa::PoolInfo NetworkMessage::GetPoolInfo()
 {
-    auto* pool = GetSubsystem<NetworkMessage::MessagePool>();
-    if (!pool)
-    {
-        LOG_ERROR << "No NetworkMessage::MessagePool" << std::endl;
-        return { };
-    }
-    return pool->GetInfo();
+    return MessageCache::GetInfo();
 }
 
 unsigned NetworkMessage::GetPoolUsage()
 {
-    auto* pool = GetSubsystem<NetworkMessage::MessagePool>();
-    if (pool)
-        return pool->GetUsage();
-    return 0;
+    return MessageCache::GetUsage();
 }
 
 NetworkMessage::NetworkMessage()
@@ -25,28 +25,67 @@
 #include "Dispatcher.h"
 #include "Scheduler.h"
 #include "Subsystems.h"
+#include <lz4.h>
 #include "Protocol.h"
 #include "Connection.h"
+#include "PoolCache.h"
 #include "Subsystems.h"
 
 namespace Net {
 
 const std::chrono::milliseconds OUTPUTMESSAGE_AUTOSEND_DELAY{ 10 };
 
-std::mutex PoolWrapper::lock_;
+static PoolWrapper::MessagePool* GetMessagePool()
+{
+    return GetSubsystem<PoolWrapper::MessagePool>();
+}
+
+using MessageCache = PoolCache<OutputMessage, PoolWrapper::MessagePool, &GetMessagePool>;
 
 void OutputMessagePool::SendAll()
 {
     // Dispatcher Thread
-    for (const auto& proto : bufferedProtocols_)
+    std::vector<std::shared_ptr<Protocol>> protocols;
+    {
+        std::scoped_lock lock(lock_);
+        protocols = bufferedProtocols_;
+    }
+    // The messages of all connections of an I/O thread are encrypted together on that thread
+    std::vector<std::pair<asio::ip::tcp::socket::executor_type, ProtocolMessages>> batches;
+    for (const auto& proto : protocols)
     {
         auto msg = proto->TakeCurrentBuffer();
-        if (msg && msg->GetSize() > 0)
+        if (!msg || msg->GetSize() == 0)
+            continue;
+        auto conn = proto->GetConnection();
+        if (!conn)
+        {
+            // Send() takes care of it
             proto->Send(std::move(msg));
+            continue;
+        }
+        const auto executor = conn->GetSocket().get_executor();
+        auto it = std::find_if(batches.begin(), batches.end(), [&executor](const auto& current)
+        {
+            return current.first == executor;
+        });
+        if (it == batches.end())
+            it = batches.emplace(batches.end(), executor, ProtocolMessages());
+        it->second.emplace_back(proto, std::move(msg));
+    }
+    for (auto& batch : batches)
+    {
+        asio::post(batch.first, [messages = std::move(batch.second)]() mutable
+        {
+            Protocol::EncryptAndSend(messages);
+        });
     }
 
+    std::scoped_lock lock(lock_);
     if (!bufferedProtocols_.empty())
         ScheduleSendAll();
+    else
+        scheduled_ = false;
 }
 
 void OutputMessagePool::ScheduleSendAll()
@@ -59,16 +98,12 @@ void OutputMessagePool::ScheduleSendAll()
 
 sa::PoolInfo OutputMessagePool::GetPoolInfo()
 {
-    if (PoolWrapper::MessagePool* pool = PoolWrapper::GetOutputMessagePool())
-        return pool->GetInfo();
-    return { };
+    return MessageCache::GetInfo();
 }
 
 unsigned OutputMessagePool::GetPoolUsage()
 {
-    if (PoolWrapper::MessagePool* pool = PoolWrapper::GetOutputMessagePool())
-        return pool->GetUsage();
-    return 0;
+    return MessageCache::GetUsage();
 }
 
 sa::SharedPtr<OutputMessage> OutputMessagePool::GetOutputMessage()
@@ -78,17 +113,20 @@ sa::SharedPtr<OutputMessage> OutputMessagePool::GetOutputMessage()
 
 void OutputMessagePool::AddToAutoSend(std::shared_ptr<Protocol> protocol)
 {
-    // Dispatcher Thread
-    if (bufferedProtocols_.empty())
+    std::scoped_lock lock(lock_);
+    if (!scheduled_)
+    {
         // Create first task
+        scheduled_ = true;
         ScheduleSendAll();
+    }
 
     bufferedProtocols_.emplace_back(protocol);
 }
 
 void OutputMessagePool::RemoveFromAutoSend(const std::shared_ptr<Protocol>& protocol)
 {
-    // Dispatcher Thread
+    std::scoped_lock lock(lock_);
     auto it = std::find(bufferedProtocols_.begin(), bufferedProtocols_.end(), protocol);
     if (it != bufferedProtocols_.end())
     {
@@ -108,8 +146,45 @@ PoolWrapper::MessagePool* PoolWrapper::GetOutputMessagePool()
     return pool;
 }
 
+OutputMessage* PoolWrapper::Allocate()
+{
+    auto* ptr = MessageCache::Allocate();
+    if (!ptr)
+        LOG_ERROR << "No PoolWrapper::MessagePool or pool exhausted" << std::endl;
+    return ptr;
+}
+
+void PoolWrapper::Deallocate(OutputMessage* p)
+{
+    MessageCache::Deallocate(p);
+}
+
 OutputMessage::OutputMessage() :
     NetworkMessage()
 { }
 
+bool OutputMessage::Compress()
+{
+    if (compressed_ || encrypted_ || info_.length < COMPRESS_THRESHOLD)
+        return false;
+
+    // Compressed body: compressed size (2 bytes), LZ4 data
+    thread_local char compressed[NETWORKMESSAGE_BUFFER_SIZE];
+    uint8_t* body = buffer_ + outputBufferStart_;
+    // Only worth it when the result including the size is smaller than the original
+    const int capacity = static_cast<int>(info_.length) - static_cast<int>(sizeof(uint16_t)) - 1;
+    const int size = LZ4_compress_default(reinterpret_cast<const char*>(body), compressed,
+        static_cast<int>(info_.length), capacity);
+    if (size <= 0)
+        return false;
+
+    const uint16_t compressedSize = static_cast<uint16_t>(size);
+    memcpy(body, &compressedSize, sizeof(uint16_t));
+    memcpy(body + sizeof(uint16_t), compressed, static_cast<size_t>(size));
+    info_.length = static_cast<MsgSize_t>(sizeof(uint16_t) + compressedSize);
+    info_.position = static_cast<MsgSize_t>(outputBufferStart_ + info_.length);
+    compressed_ = true;
+    return true;
+}
+
 }
@@ -29,6 +29,7 @@
 #include <cstring>
 #include <mutex>
 #include <sa/Assert.h>
+#include <AB/ProtocolCodes.h>
 
 namespace Net {
 
@@ -38,6 +39,10 @@ class OutputMessage : public NetworkMessage
 {
 private:
     uint32_t outputBufferStart_ = INITIAL_BUFFER_POSITION;
+    /// Already encrypted by Protocol::EncryptAndSend()
+    bool encrypted_{ false };
+    /// Body was compressed by Compress()
+    bool compressed_{ false };
 
     friend class OutputMessagePool;
 
@@ -56,9 +61,18 @@ private:
         return true;
     }
 public:
+    /// Smaller messages are not worth compressing
+    static constexpr size_t COMPRESS_THRESHOLD = 512;
+
     OutputMessage();
 
     uint8_t* GetOutputBuffer() { return buffer_ + outputBufferStart_; }
+    bool IsEncrypted() const { return encrypted_; }
+    void SetEncrypted(bool value) { encrypted_ = value; }
+    bool IsCompressed() const { return compressed_; }
+    /// LZ4 compress the body if it is large enough and gets smaller. Must be called
+    /// before encryption.
+    bool Compress();
     bool AddCryptoHeader(bool addChecksum)
     {
         if (addChecksum)
@@ -71,6 +85,8 @@ public:
     }
     bool WriteMessageLength()
     {
+        if (compressed_)
+            return AddHeader<uint16_t>(info_.length | AB::MESSAGE_COMPRESSED_FLAG);
         return AddHeader<uint16_t>(info_.length);
     }
 
@@ -87,16 +103,30 @@ public:
         info_.length += static_cast<MsgSize_t>(msgLen);
         info_.position += static_cast<MsgSize_t>(msgLen);
     }
+    void Append(const uint8_t* data, size_t size)
+    {
+        ASSERT(size <= GetSpace());
+#ifdef _MSC_VER
+        memcpy_s(buffer_ + info_.position, NetworkMessage::NETWORKMESSAGE_BUFFER_SIZE - info_.position,
+            data, size);
+#else
+        memcpy(buffer_ + info_.position, data, size);
+#endif
+        info_.length += static_cast<MsgSize_t>(size);
+        info_.position += static_cast<MsgSize_t>(size);
+    }
 };
 
 static constexpr size_t OUTPUTMESSAGE_SIZE = sizeof(OutputMessage);
 
 struct PoolWrapper
 {
-    static std::mutex lock_;
     using MessagePool = sa::PoolAllocator<OutputMessage, OUTPUTMESSAGE_SIZE>;
     // Must be instantiated in one single cpp file
     static MessagePool* GetOutputMessagePool();
+    /// Allocate from the thread local cache of the pool
+    static OutputMessage* Allocate();
+    static void Deallocate(OutputMessage* p);
 };
 
 }
@@ -111,23 +141,16 @@ struct DefaultDelete<::Net::OutputMessage>
     DefaultDelete() = default;
     void operator()(::Net::OutputMessage* p) const noexcept
     {
-        auto* pool = Net::PoolWrapper::GetOutputMessagePool();
-        if (!pool)
-            return;
-        std::scoped_lock lock(Net::PoolWrapper::lock_);
-        pool->deallocate(p, 1);
+        Net::PoolWrapper::Deallocate(p);
     }
 };
 
 template <>
 inline SharedPtr<::Net::OutputMessage> MakeShared()
 {
-    auto* pool = Net::PoolWrapper::GetOutputMessagePool();
-    if (!pool)
+    auto* ptr = Net::PoolWrapper::Allocate();
+    if (!ptr)
         return sa::SharedPtr<::Net::OutputMessage>();
-    std::scoped_lock lock(Net::PoolWrapper::lock_);
-    auto* ptr = pool->allocate(1, nullptr);
-    ASSERT(ptr);
     return sa::SharedPtr<::Net::OutputMessage>(ptr);
 }
 
@@ -159,6 +182,10 @@ private:
     //NOTE: A vector is used here because this container is mostly read
     //and relatively rarely modified (only when a client connects/disconnects)
     std::vector<std::shared_ptr<Protocol>> bufferedProtocols_;
+    /// Protocols are removed on the game lane of the player
+    std::mutex lock_;
+    /// The SendAll() task is scheduled
+    bool scheduled_{ false };
 };
 
 }
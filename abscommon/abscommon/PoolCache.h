@@ -0,0 +1,152 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <sa/PoolAllocator.h>
+
+namespace Net {
+
+/// Thread local caches in front of a shared sa::PoolAllocator. Chunks are taken
+/// from and given back to the pool in batches, so the lock is only needed once
+/// per BATCH_SIZE allocations. A chunk freed on another thread than it was
+/// allocated (e.g. allocated on an IO thread, freed on the Dispatcher) goes to
+/// the cache of the freeing thread and is returned to the pool from there.
+/// GetPool is called to get the pool, it may return nullptr when there is none.
+template <typename T, typename Pool, Pool* (*GetPool)()>
+class PoolCache
+{
+public:
+    static constexpr size_t BATCH_SIZE = 32;
+private:
+    struct Cache
+    {
+        std::vector<void*> chunks;
+        ~Cache()
+        {
+            // Thread exits
+            if (!chunks.empty())
+                Return(chunks, chunks.size());
+        }
+    };
+    static Cache& GetCache()
+    {
+        thread_local Cache cache;
+        return cache;
+    }
+    /// Number of chunks in all caches, they are allocated from the pool but not used.
+    static std::atomic<size_t>& GetCachedCount()
+    {
+        static std::atomic<size_t> count{ 0 };
+        return count;
+    }
+    static void Return(std::vector<void*>& chunks, size_t count)
+    {
+        GetCachedCount() -= count;
+        Pool* pool = GetPool();
+        if (!pool)
+        {
+            // Gone, the memory went with it
+            chunks.resize(chunks.size() - count);
+            return;
+        }
+        std::scoped_lock lock(GetLock());
+        for (size_t i = 0; i < count; ++i)
+        {
+            pool->DeallocateChunk(chunks.back());
+            chunks.pop_back();
+        }
+    }
+public:
+    /// This lock must be held when accessing the pool
+    static std::mutex& GetLock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+    static T* Allocate()
+    {
+        Cache& cache = GetCache();
+        if (cache.chunks.empty())
+        {
+            Pool* pool = GetPool();
+            if (!pool)
+                return nullptr;
+            std::scoped_lock lock(GetLock());
+            for (size_t i = 0; i < BATCH_SIZE; ++i)
+            {
+                void* chunk = pool->AllocateChunk();
+                if (!chunk)
+                    break;
+                cache.chunks.push_back(chunk);
+            }
+            GetCachedCount() += cache.chunks.size();
+            if (cache.chunks.empty())
+                return nullptr;
+        }
+        void* chunk = cache.chunks.back();
+        cache.chunks.pop_back();
+        --GetCachedCount();
+        return new(chunk) T();
+    }
+    static void Deallocate(T* p)
+    {
+        p->~T();
+        Cache& cache = GetCache();
+        cache.chunks.push_back(p);
+        ++GetCachedCount();
+        // Keep at most 2 batches, so a thread which only frees doesn't collect all memory
+        if (cache.chunks.size() >= BATCH_SIZE * 2)
+            Return(cache.chunks, BATCH_SIZE);
+    }
+    /// Chunks in the caches count as free
+    static sa::PoolInfo GetInfo()
+    {
+        Pool* pool = GetPool();
+        if (!pool)
+            return {};
+        sa::PoolInfo result;
+        {
+            std::scoped_lock lock(GetLock());
+            result = pool->GetInfo();
+        }
+        const size_t cached = std::min(GetCachedCount().load(), result.current);
+        const size_t total = result.used + result.avail;
+        const size_t chunkSize = result.current != 0 ? result.used / result.current : 0;
+        result.current -= cached;
+        result.used -= cached * chunkSize;
+        result.avail = total - result.used;
+        result.usage = total != 0 ?
+            static_cast<unsigned>((static_cast<float>(result.used) / static_cast<float>(total)) * 100.0f) : 0;
+        return result;
+    }
+    static unsigned GetUsage()
+    {
+        return GetInfo().usage;
+    }
+};
+
+}
@@ -73,21 +73,52 @@ void Protocol::Send(sa::SharedPtr<OutputMessage>&& message)
 
 sa::SharedPtr<OutputMessage> Protocol::TakeCurrentBuffer()
 {
+    std::scoped_lock lock(outputLock_);
     auto curr = std::move(outputBuffer_);
     ResetOutputBuffer();
     return curr;
 }
 
-void Protocol::XTEAEncrypt(OutputMessage& msg) const
+static uint32_t PadForEncryption(OutputMessage& msg)
 {
     // The message must be a multiple of 8
     size_t paddingBytes = msg.GetSize() % 8;
     if (paddingBytes != 0)
         msg.AddPaddingBytes(static_cast<uint32_t>(8 - paddingBytes));
+    return static_cast<uint32_t>(msg.GetSize()) / 4;
+}
 
+void Protocol::XTEAEncrypt(OutputMessage& msg) const
+{
+    const uint32_t length = PadForEncryption(msg);
     uint32_t* buffer = reinterpret_cast<uint32_t*>(msg.GetOutputBuffer());
-    const uint32_t messageLength = static_cast<uint32_t>(msg.GetSize());
-    xxtea_enc(buffer, (messageLength / 4), reinterpret_cast<const uint32_t*>(&encKey_));
+    xxtea_enc(buffer, length, reinterpret_cast<const uint32_t*>(&encKey_));
+}
+
+void Protocol::EncryptAndSend(ProtocolMessages& messages)
+{
+    std::vector<uint32_t*> buffers;
+    std::vector<uint32_t> lengths;
+    std::vector<const uint32_t*> keys;
+    buffers.reserve(messages.size());
+    lengths.reserve(messages.size());
+    keys.reserve(messages.size());
+    for (auto& message : messages)
+    {
+        OutputMessage& msg = *message.second;
+        if (message.first->compressionEnabled_)
+            msg.Compress();
+        if (!message.first->encryptionEnabled_)
+            continue;
+        lengths.push_back(PadForEncryption(msg));
+        buffers.push_back(reinterpret_cast<uint32_t*>(msg.GetOutputBuffer()));
+        keys.push_back(reinterpret_cast<const uint32_t*>(&message.first->encKey_));
+        msg.SetEncrypted(true);
+    }
+    xxtea_enc_batch(buffers.data(), lengths.data(), keys.data(), buffers.size());
+
+    for (auto& message : messages)
+        message.first->Send(std::move(message.second));
 }
 
 bool Protocol::XTEADecrypt(NetworkMessage& msg) const
@@ -107,8 +138,13 @@ bool Protocol::OnSendMessage(OutputMessage& message) const
 #ifdef DEBUG_NET
 //    LOG_DEBUG << "Sending message with size " << message.GetSize() << std::endl;
 #endif
-    if (encryptionEnabled_)
-        XTEAEncrypt(message);
+    if (!message.IsEncrypted())
+    {
+        if (compressionEnabled_)
+            message.Compress();
+        if (encryptionEnabled_)
+            XTEAEncrypt(message);
+    }
     return message.AddCryptoHeader(true);
 }
 
@@ -132,7 +168,6 @@ void Protocol::OnRecvMessage(NetworkMessage& message)
 
 sa::SharedPtr<OutputMessage> Protocol::GetOutputBuffer(size_t size)
 {
-    // Dispatcher Thread
     if (!outputBuffer_)
     {
         outputBuffer_ = OutputMessagePool::GetOutputMessage();
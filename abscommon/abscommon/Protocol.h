@@ -24,6 +24,9 @@
 #include "Logger.h"
 #include <abcrypto.hpp>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include <sa/SmartPtr.h>
 #include <sa/Noncopyable.h>
 
@@ -32,20 +35,32 @@ namespace Net {
 class Connection;
 class OutputMessage;
 class NetworkMessage;
+class Protocol;
+
+using ProtocolMessages = std::vector<std::pair<std::shared_ptr<Protocol>, sa::SharedPtr<OutputMessage>>>;
 
 class Protocol : public std::enable_shared_from_this<Protocol>
 {
     NON_COPYABLE(Protocol)
 protected:
     std::weak_ptr<Connection> connection_;
+    /// The owner of the protocol writes to outputBuffer_ while the autosend task
+    /// takes it, these may run on different threads.
+    std::mutex outputLock_;
     sa::SharedPtr<OutputMessage> outputBuffer_;
     bool encryptionEnabled_;
+    /// LZ4 compress large messages, the client must support it
+    bool compressionEnabled_{ false };
     DH_KEY encKey_;
     void XTEAEncrypt(OutputMessage& msg) const;
     bool XTEADecrypt(NetworkMessage& msg) const;
 
     void Disconnect() const;
     virtual void Release() {}
+    /// outputLock_ must be held
+    sa::SharedPtr<OutputMessage> GetOutputBuffer(size_t size);
+    /// outputLock_ must be held
+    void ResetOutputBuffer();
 
     friend class Connection;
 public:
@@ -68,12 +83,21 @@ public:
     bool IsConnectionExpired() const { return connection_.expired(); }
     std::shared_ptr<Connection> GetConnection() const { return connection_.lock(); }
 
-    sa::SharedPtr<OutputMessage> GetOutputBuffer(size_t size);
-    void ResetOutputBuffer();
+    /// Calls callback with the buffer sent by the next autosend, which has at least
+    /// size bytes space.
+    template<typename Callback>
+    void AppendToOutput(size_t size, Callback&& callback)
+    {
+        std::scoped_lock lock(outputLock_);
+        callback(*GetOutputBuffer(size));
+    }
     uint32_t GetIP();
     sa::SharedPtr<OutputMessage> TakeCurrentBuffer();
 
     void Send(sa::SharedPtr<OutputMessage>&& message);
+    /// Encrypt the messages in one batch and send them. Must be called on the thread
+    /// of their connections.
+    static void EncryptAndSend(ProtocolMessages& messages);
 };
 
 }
@@ -27,57 +27,150 @@
 
 namespace Asynch {
 
+uint64_t Scheduler::GetTick() const
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_).count());
+}
+
+void Scheduler::Link(ScheduledTaskList& list, ScheduledTask* task)
+{
+    task->list_ = &list;
+    task->prev_ = nullptr;
+    task->next_ = list.head;
+    if (list.head)
+        list.head->prev_ = task;
+    list.head = task;
+}
+
+void Scheduler::Unlink(ScheduledTask* task)
+{
+    if (!task->list_)
+        return;
+    if (task->prev_)
+        task->prev_->next_ = task->next_;
+    else
+        task->list_->head = task->next_;
+    if (task->next_)
+        task->next_->prev_ = task->prev_;
+    task->list_ = nullptr;
+    task->prev_ = nullptr;
+    task->next_ = nullptr;
+}
+
+void Scheduler::Insert(ScheduledTask* task)
+{
+    if (task->due_ <= currentTick_)
+    {
+        Link(ready_, task);
+        return;
+    }
+    const uint64_t delta = task->due_ - currentTick_;
+    size_t level = 0;
+    while (level < WHEEL_LEVELS - 1 && delta >= (uint64_t(1) << (WHEEL_BITS * (level + 1))))
+        ++level;
+    // Longer than the wheel can hold, cascaded again when the last level wraps
+    const uint64_t due = std::min(task->due_, currentTick_ + (uint64_t(1) << (WHEEL_BITS * WHEEL_LEVELS)) - 1);
+    Link(wheels_[level][(due >> (WHEEL_BITS * level)) & WHEEL_MASK], task);
+}
+
+void Scheduler::Cascade(size_t level)
+{
+    ScheduledTaskList& slot = wheels_[level][(currentTick_ >> (WHEEL_BITS * level)) & WHEEL_MASK];
+    ScheduledTask* task = slot.head;
+    slot.head = nullptr;
+    while (task)
+    {
+        ScheduledTask* next = task->next_;
+        task->list_ = nullptr;
+        Insert(task);
+        task = next;
+    }
+}
+
+void Scheduler::Advance(uint64_t tick)
+{
+    if (events_.empty())
+    {
+        // Nothing to do, just jump there
+        currentTick_ = std::max(currentTick_, tick);
+        return;
+    }
+    while (currentTick_ < tick)
+    {
+        ++currentTick_;
+        // When a lower level wraps, move the tasks of the next slot of the higher
+        // level down.
+        for (size_t level = 1; level < WHEEL_LEVELS; ++level)
+        {
+            if (((currentTick_ >> (WHEEL_BITS * (level - 1))) & WHEEL_MASK) != 0)
+                break;
+            Cascade(level);
+        }
+        ScheduledTaskList& slot = wheels_[0][currentTick_ & WHEEL_MASK];
+        while (slot.head)
+        {
+            ScheduledTask* task = slot.head;
+            Unlink(task);
+            Link(ready_, task);
+        }
+    }
+}
+
+uint64_t Scheduler::GetNextTick() const
+{
+    // Either a slot of the first level or when it wraps and the next level cascades
+    const uint64_t wrap = (currentTick_ | WHEEL_MASK) + 1;
+    for (uint64_t tick = currentTick_ + 1; tick < wrap; ++tick)
+    {
+        if (wheels_[0][tick & WHEEL_MASK].head)
+            return tick;
+    }
+    return wrap;
+}
+
 void Scheduler::SchedulerThread()
 {
 #ifdef DEBUG_SCHEDULER
     LOG_DEBUG << "Scheduler threat started" << std::endl;
 #endif
 
+    std::vector<ScheduledTask*> batch;
     std::unique_lock<std::mutex> lockUnique(lock_, std::defer_lock);
     while (state_ != State::Terminated)
     {
-        ScheduledTask* task = nullptr;
-        std::cv_status ret = std::cv_status::no_timeout;
-
         lockUnique.lock();
 
-        if (events_.empty())
+        Advance(GetTick());
+        if (!ready_.head)
         {
-            signal_.wait(lockUnique);
+            if (events_.empty())
+                signal_.wait(lockUnique);
+            else
+                signal_.wait_until(lockUnique, start_ + std::chrono::milliseconds(GetNextTick()));
+            lockUnique.unlock();
+            continue;
         }
-        else
+
+        // Take all due tasks
+        while (ready_.head)
         {
-            ret = signal_.wait_until(
-                lockUnique,
-                events_.top()->GetCycle()
-            );
+            ScheduledTask* task = ready_.head;
+            Unlink(task);
+            events_.erase(task->GetEventId());
+            batch.push_back(task);
         }
+        lockUnique.unlock();
 
-        if (ret == std::cv_status::timeout)
+        auto* disp = dispatcher_ ? dispatcher_ : GetSubsystem<Asynch::Dispatcher>();
+        for (ScheduledTask* task : batch)
         {
-            // Timeout
-            task = events_.top();
-            events_.pop();
-
-            auto it = eventIds_.find(task->GetEventId());
-            if (it == eventIds_.end())
-            {
-                lockUnique.unlock();
-                delete task;
-                continue;
-            }
-
-            eventIds_.erase(it);
-            lockUnique.unlock();
-
             task->SetDontExpires();
-            auto* disp = GetSubsystem<Asynch::Dispatcher>();
             if (disp)
                 disp->Add(task, true);
+            else
+                delete task;
         }
-        else
-            lockUnique.unlock();
-
+        batch.clear();
     }
 #ifdef DEBUG_SCHEDULER
     LOG_DEBUG << "Scheduler threat stopped" << std::endl;
@@ -97,13 +190,17 @@ uint32_t Scheduler::Add(ScheduledTask* task)
             if (task->GetEventId() == 0)
                 // Generate new ID
                 task->SetEventId(idGenerator_.Next());
-            // Insert this ID in the list of active events
-            eventIds_.insert(task->GetEventId());
 
-            // Add it to the Queue
-            events_.push(task);
-            // Signal if the list was empty or this event is at the top
-            doSignal = (task == events_.top());
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(task->GetCycle() - the_clock::now()).count();
+            const uint64_t tick = GetTick();
+            task->due_ = tick + static_cast<uint64_t>(std::max<decltype(remaining)>(remaining, 0));
+            // The thread may sleep for some time, bring the wheel up to date first,
+            // so the delay is relative to now.
+            Advance(tick);
+            // Signal if it is due before the thread would wake up
+            doSignal = events_.empty() || task->due_ < GetNextTick() || ready_.head != nullptr;
+            events_[task->GetEventId()] = task;
+            Insert(task);
 
 #ifdef DEBUG_SCHEDULER
             LOG_DEBUG << "Added event " << task->GetEventId() << std::endl;
@@ -134,10 +231,13 @@ bool Scheduler::StopEvent(uint32_t eventId)
 
     std::scoped_lock lock(lock_);
 
-    auto it = eventIds_.find(eventId);
-    if (it != eventIds_.end())
+    auto it = events_.find(eventId);
+    if (it != events_.end())
     {
-        eventIds_.erase(it);
+        ScheduledTask* task = it->second;
+        events_.erase(it);
+        Unlink(task);
+        delete task;
         return true;
     }
 
@@ -145,10 +245,23 @@ bool Scheduler::StopEvent(uint32_t eventId)
     return false;
 }
 
+void Scheduler::Clear()
+{
+    for (const auto& event : events_)
+        delete event.second;
+    events_.clear();
+    for (auto& wheel : wheels_)
+        for (auto& slot : wheel)
+            slot.head = nullptr;
+    ready_.head = nullptr;
+}
+
 void Scheduler::Start()
 {
     if (state_ != State::Running)
     {
+        start_ = Clock::now();
+        currentTick_ = 0;
         state_ = State::Running;
         thread_ = std::thread(&Scheduler::SchedulerThread, this);
     }
@@ -161,13 +274,7 @@ void Scheduler::Stop()
         {
             std::scoped_lock lock(lock_);
             state_ = State::Terminated;
-            while (!events_.empty())
-            {
-                ScheduledTask* task = events_.top();
-                events_.pop();
-                delete task;
-            }
-            eventIds_.clear();
+            Clear();
         }
 
         signal_.notify_one();
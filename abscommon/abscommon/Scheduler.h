@@ -22,19 +22,34 @@
 #pragma once
 
 #include "Task.h"
-#include <set>
-#include <queue>
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 #include <sa/IdGenerator.h>
 
 namespace Asynch {
 
+class Dispatcher;
+class Scheduler;
+
 inline constexpr uint32_t SCHEDULER_MINTICKS = 10u;
 
+class ScheduledTask;
+
+/// Intrusive list of tasks in a slot of the timing wheel
+struct ScheduledTaskList
+{
+    ScheduledTask* head{ nullptr };
+};
+
 class ScheduledTask : public Task
 {
+    friend class Scheduler;
 public:
     ~ScheduledTask() {}
     void SetEventId(uint32_t eventId) { eventId_ = eventId; }
@@ -54,6 +69,11 @@ protected:
     friend ScheduledTask* CreateScheduledTask(std::function<void(void)>&&);
 private:
     uint32_t eventId_;
+    /// Tick of the Scheduler when it is due
+    uint64_t due_{ 0 };
+    ScheduledTaskList* list_{ nullptr };
+    ScheduledTask* prev_{ nullptr };
+    ScheduledTask* next_{ nullptr };
 };
 
 inline ScheduledTask* CreateScheduledTask(std::function<void(void)>&& f)
@@ -61,21 +81,16 @@ inline ScheduledTask* CreateScheduledTask(std::function<void(void)>&& f)
     return new ScheduledTask(SCHEDULER_MINTICKS, std::move(f));
 }
 
+/// A delay of 0 executes the task with the next batch of due tasks, e.g. when a
+/// game update took longer than its frame time.
 inline ScheduledTask* CreateScheduledTask(uint32_t delay, std::function<void(void)>&& f)
 {
-    if (delay < SCHEDULER_MINTICKS)
-        delay = SCHEDULER_MINTICKS;
     return new ScheduledTask(delay, std::move(f));
 }
 
-struct TaskComparator
-{
-    bool operator()(const ScheduledTask* lhs, const ScheduledTask* rhs) const
-    {
-        return lhs->GetCycle() > rhs->GetCycle();
-    }
-};
-
+/// Executes tasks after a delay with a hierarchical timing wheel. Adding and
+/// stopping an event is O(1). One tick is 1 ms, all tasks due in the same tick
+/// are handed to the Dispatcher at once.
 class Scheduler
 {
 public:
@@ -84,17 +99,43 @@ public:
         Terminated
     };
 private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr unsigned WHEEL_BITS = 8;
+    static constexpr size_t WHEEL_SIZE = 1u << WHEEL_BITS;
+    static constexpr uint64_t WHEEL_MASK = WHEEL_SIZE - 1;
+    /// 256 ms, 65 s, 4.6 h, 49 days
+    static constexpr size_t WHEEL_LEVELS = 4;
+    using Wheel = std::array<ScheduledTaskList, WHEEL_SIZE>;
+
     State state_;
     std::mutex lock_;
     std::condition_variable signal_;
-    std::set<uint32_t> eventIds_;
     std::thread thread_;
-    std::priority_queue<ScheduledTask*, std::deque<ScheduledTask*>, TaskComparator> events_;
+    std::array<Wheel, WHEEL_LEVELS> wheels_;
+    /// Tasks which are due
+    ScheduledTaskList ready_;
+    std::unordered_map<uint32_t, ScheduledTask*> events_;
     sa::IdGenerator<uint32_t> idGenerator_;
+    Clock::time_point start_;
+    /// All ticks up to this were processed
+    uint64_t currentTick_{ 0 };
+    /// Dispatcher which executes the due tasks. When nullptr the Dispatcher subsystem is used.
+    Dispatcher* dispatcher_;
     void SchedulerThread();
+    uint64_t GetTick() const;
+    static void Link(ScheduledTaskList& list, ScheduledTask* task);
+    static void Unlink(ScheduledTask* task);
+    void Insert(ScheduledTask* task);
+    void Cascade(size_t level);
+    /// Advance the wheel to tick and move all due tasks to ready_
+    void Advance(uint64_t tick);
+    /// The next tick something may be due
+    uint64_t GetNextTick() const;
+    void Clear();
 public:
-    Scheduler() :
-        state_(State::Terminated)
+    explicit Scheduler(Dispatcher* dispatcher = nullptr) :
+        state_(State::Terminated),
+        dispatcher_(dispatcher)
     {}
     ~Scheduler() = default;
 
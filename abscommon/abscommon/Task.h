@@ -30,6 +30,7 @@ using the_clock = std::chrono::system_clock;
 
 class Task
 {
+    friend class Dispatcher;
 public:
     explicit Task(unsigned ms, std::function<void(void)>&& f) :
         expires_(true),
@@ -66,6 +67,8 @@ protected:
     bool expires_;
 private:
     std::function<void(void)> function_;
+    /// When it was added to the Dispatcher
+    std::chrono::steady_clock::time_point queued_;
 };
 
 /// Creates a task that does not expire.
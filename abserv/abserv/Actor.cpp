@@ -33,7 +33,6 @@
 #include "Item.h"
 #include "ItemFactory.h"
 #include "ItemsCache.h"
-#include "OctreeQuery.h"
 #include "PartyManager.h"
 #include "Player.h"
 #include "ProgressComp.h"
@@ -348,16 +347,12 @@ void Actor::DropRandomItem()
             // Drop nothing when no target
             return;
 
-        GetSubsystem<Asynch::Scheduler>()->Add(
-            Asynch::CreateScheduledTask(std::bind(&Game::AddRandomItemDropFor, game, this, target))
-        );
+        game->Schedule(std::bind(&Game::AddRandomItemDropFor, game, this, target));
     }
     else
     {
         // Not killed by an actor, drop for any player in game
-        GetSubsystem<Asynch::Scheduler>()->Add(
-            Asynch::CreateScheduledTask(std::bind(&Game::AddRandomItemDrop, game, this))
-        );
+        game->Schedule(std::bind(&Game::AddRandomItemDrop, game, this));
     }
 }
 
@@ -961,11 +956,8 @@ void Actor::Update(uint32_t timeElapsed, Net::NetworkMessage& message)
     collisionComp_->Update(timeElapsed);
     progressComp_->Update(timeElapsed);
 
-    if (moveComp_->moved_ && octant_)
-    {
-        Math::Octree* octree = octant_->GetRoot();
-        octree->AddObjectUpdate(this);
-    }
+    if (moveComp_->moved_)
+        AddSpatialIndexUpdate();
 
     // Write all
     stateComp_.Write(message);
@@ -33,6 +33,7 @@
 #include "ResourceComp.h"
 #include "SkillBar.h"
 #include "SkillsComp.h"
+#include "StateSnapshot.h"
 #include <abscommon/UuidUtils.h>
 #include <AB/ProtocolCodes.h>
 
@@ -331,6 +332,8 @@ public:
     ea::unique_ptr<Components::MoveComp> moveComp_;
     ea::unique_ptr<Components::CollisionComp> collisionComp_;
     ea::unique_ptr<Components::SelectionComp> selectionComp_;
+    /// Quantized position and rotation sent by the StateSnapshot of players, updated by the Game each tick
+    StateSnapshot::State snapshotState_{};
 
     bool undestroyable_{ false };
     /// Friend foe identification. Upper 16 bit is foe mask, lower 16 bit friend mask.
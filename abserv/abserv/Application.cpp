@@ -51,6 +51,8 @@
 #include <abai/Dump.h>
 #include <abscommon/BanManager.h>
 #include <abscommon/CpuUsage.h>
+#include <abscommon/DispatcherPool.h>
+#include <abscommon/IoServicePool.h>
 #include <abscommon/Logo.h>
 #include <abscommon/MessageClient.h>
 #include <abscommon/MessageMsg.h>
@@ -85,9 +87,11 @@ Application::Application() :
     Subsystems::Instance.CreateSubsystem<Net::PoolWrapper::MessagePool>(OUTPUTMESSAGE_POOLSIZE);
     Subsystems::Instance.CreateSubsystem<Asynch::Dispatcher>();
     Subsystems::Instance.CreateSubsystem<Asynch::Scheduler>();
+    Subsystems::Instance.CreateSubsystem<Asynch::DispatcherPool>();
     Subsystems::Instance.CreateSubsystem<Asynch::ThreadPool>();
+    Subsystems::Instance.CreateSubsystem<Net::IoServicePool>();
     Subsystems::Instance.CreateSubsystem<Net::ConnectionManager>();
-    Subsystems::Instance.CreateSubsystem<IO::DataClient>(ioService_);
+    Subsystems::Instance.CreateSubsystem<IO::DataClient>();
     Subsystems::Instance.CreateSubsystem<Net::MessageClient>(ioService_);
 
     Subsystems::Instance.CreateSubsystem<Crypto::Random>();
@@ -119,8 +123,11 @@ Application::Application() :
 Application::~Application()
 {
     serviceManager_->Stop();
+    // No I/O threads may use the connections when they are closed
+    GetSubsystem<Net::IoServicePool>()->Stop();
     GetSubsystem<Net::ConnectionManager>()->CloseAll();
     GetSubsystem<Asynch::ThreadPool>()->Stop();
+    GetSubsystem<Asynch::DispatcherPool>()->Stop();
     GetSubsystem<Asynch::Scheduler>()->Stop();
     GetSubsystem<Asynch::Dispatcher>()->Stop();
 }
@@ -343,6 +350,7 @@ bool Application::LoadMain()
     if (serverLocation_.empty())
         serverLocation_ = (*config)[ConfigManager::Key::Location].GetString();
     Net::ProtocolGame::serverId_ = GetServerId();
+    Net::ProtocolGame::compressMessages_ = (*config)[ConfigManager::Key::CompressMessages].GetBool();
     GetSubsystem<IO::DataProvider>()->watchFiles_ = (*config)[ConfigManager::Key::WatchAssets].GetBool();
 
     Net::ConnectionManager::maxPacketsPerSec = static_cast<uint32_t>((*config)[ConfigManager::Key::MaxPacketsPerSecond].GetInt64());
@@ -351,6 +359,21 @@ bool Application::LoadMain()
     Auth::BanManager::LoginTries = 0;
     Auth::BanManager::LoginRetryTimeout = 0;
 
+    int64_t gameThreads = (*config)[ConfigManager::Key::GameThreads].GetInt64();
+    if (gameThreads <= 0)
+        gameThreads = std::max<int64_t>(1, std::thread::hardware_concurrency());
+    if (gameThreads > 1)
+    {
+        // Parties, chat channels, guilds and the items cache are shared by all games,
+        // and players modify parties of players on other lanes. This is not safe yet.
+        LOG_WARNING << "game_threads " << gameThreads << " is not supported yet, using 1" << std::endl;
+        gameThreads = 1;
+    }
+    GetSubsystem<Asynch::DispatcherPool>()->Start(static_cast<size_t>(gameThreads));
+    const int64_t ioThreads = (*config)[ConfigManager::Key::IoThreads].GetInt64();
+    if (ioThreads > 0)
+        GetSubsystem<Net::IoServicePool>()->Start(static_cast<size_t>(ioThreads));
+
     LOG_INFO << "[done]" << std::endl;
 
     // RNG --------------------------------------------------------------------
@@ -551,6 +574,9 @@ void Application::PrintServerInfo()
     const std::string& recDir = (*config)[ConfigManager::Key::RecordingsDir].GetString();
     LOG_INFO << "  Recording directory: " << (recDir.empty() ? "(empty)" : recDir) << std::endl;
     LOG_INFO << "  Background threads: " << GetSubsystem<Asynch::ThreadPool>()->GetNumThreads() << std::endl;
+    LOG_INFO << "  Game threads: " << GetSubsystem<Asynch::DispatcherPool>()->GetCount() << std::endl;
+    LOG_INFO << "  I/O threads: " << GetSubsystem<Net::IoServicePool>()->GetCount() << std::endl;
+    LOG_INFO << "  Compress messages: " << Net::ProtocolGame::compressMessages_ << std::endl;
     if ((*config)[ConfigManager::Key::AiServer])
     {
         const std::string& sAiIp = (*config)[ConfigManager::Key::AiServerIp].GetString();
@@ -704,15 +730,13 @@ unsigned Application::GetLoad()
         float ld = (static_cast<float>(playerCount) / static_cast<float>(SERVER_MAX_CONNECTIONS)) * 100.0f;
         unsigned load = static_cast<unsigned>(ld);
 
-        load = std::max(load, GetSubsystem<Asynch::Dispatcher>()->GetUtilization());
+        load = std::max(load, GetSubsystem<Asynch::DispatcherPool>()->GetUtilization());
+        load = std::max(load, GetSubsystem<Net::IoServicePool>()->GetUtilization());
         load = std::max(load, usage.GetUsage());
 
-        {
-            // Get memory pool usage
-            std::scoped_lock lock(lock_);    // Memory pool must always be locked!
-            load = std::max(load, Net::OutputMessagePool::GetPoolUsage());
-            load = std::max(load, Net::NetworkMessage::GetPoolUsage());
-        }
+        // Get memory pool usage
+        load = std::max(load, Net::OutputMessagePool::GetPoolUsage());
+        load = std::max(load, Net::NetworkMessage::GetPoolUsage());
 
         loads_.Enqueue(std::min(load, 100u));
     }
@@ -47,7 +47,6 @@ class Application final : public ServerApp
 {
 private:
     asio::io_service ioService_;
-    std::mutex lock_;
     ea::unique_ptr<Net::ServiceManager> serviceManager_;
     ea::unique_ptr<MessageDispatcher> msgDispatcher_;
     sa::CircularQueue<unsigned, 10> loads_;
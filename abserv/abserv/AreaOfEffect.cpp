@@ -67,16 +67,16 @@ AreaOfEffect::AreaOfEffect() :
     // AOE usually not colliding
     collisionMask_ = 0;
     selectable_ = false;
-
-    InitializeLua();
 }
 
 AreaOfEffect::~AreaOfEffect() = default;
 
 void AreaOfEffect::InitializeLua()
 {
-    Lua::RegisterLuaAll(luaState_);
-    luaState_["self"] = this;
+    // Game bound objects share the VM of the game
+    auto game = GetGame();
+    luaEnv_.Create(game ? game->GetScriptState() : ea::make_shared<Lua::SharedState>());
+    luaEnv_["self"] = this;
     luaInitialized_ = true;
 }
 
@@ -98,34 +98,32 @@ bool AreaOfEffect::LoadScript(const std::string& fileName)
     auto script = GetSubsystem<IO::DataProvider>()->GetAsset<Script>(fileName);
     if (!script)
         return false;
-    if (!script->Execute(luaState_))
+    InitializeLua();
+    if (!script->Execute(luaEnv_))
         return false;
 
-    if (Lua::IsNumber(luaState_, "itemIndex"))
-        itemIndex_ = luaState_["itemIndex"];
+    if (Lua::IsNumber(luaEnv_, "itemIndex"))
+        itemIndex_ = luaEnv_["itemIndex"];
     else
         LOG_WARNING << "AOE " << fileName << " does not have an itemIndex" << std::endl;
-    if (Lua::IsNumber(luaState_, "creatureState"))
-        stateComp_.SetState(luaState_["creatureState"], true);
+    if (Lua::IsNumber(luaEnv_, "creatureState"))
+        stateComp_.SetState(luaEnv_["creatureState"], true);
     else
         stateComp_.SetState(AB::GameProtocol::CreatureState::Idle, true);
-    if (Lua::IsNumber(luaState_, "effect"))
-        skillEffect_ = luaState_["effect"];
-    if (Lua::IsNumber(luaState_, "effectTarget"))
-        effectTarget_ = luaState_["effectTarget"];
-
-    if (Lua::IsFunction(luaState_, "onUpdate"))
-        sa::bits::set(functions_, FunctionUpdate);
-    if (Lua::IsFunction(luaState_, "onEnded"))
-        sa::bits::set(functions_, FunctionEnded);
-    if (Lua::IsFunction(luaState_, "onCollide"))
-        sa::bits::set(functions_, FunctionOnCollide);
-    if (Lua::IsFunction(luaState_, "onTrigger"))
-        sa::bits::set(functions_, FunctionOnTrigger);
-    if (Lua::IsFunction(luaState_, "onLeftArea"))
-        sa::bits::set(functions_, FunctionOnLeftArea);
-
-    bool ret = luaState_["onInit"]();
+    if (Lua::IsNumber(luaEnv_, "effect"))
+        skillEffect_ = luaEnv_["effect"];
+    if (Lua::IsNumber(luaEnv_, "effectTarget"))
+        effectTarget_ = luaEnv_["effectTarget"];
+
+    functions_.Resolve(luaEnv_, {
+        { FunctionUpdate, "onUpdate" },
+        { FunctionEnded, "onEnded" },
+        { FunctionOnTrigger, "onTrigger" },
+        { FunctionOnLeftArea, "onLeftArea" },
+        { FunctionOnCollide, "onCollide" }
+    });
+
+    bool ret = luaEnv_["onInit"]();
     return ret;
 }
 
@@ -138,11 +136,11 @@ void AreaOfEffect::Update(uint32_t timeElapsed, Net::NetworkMessage& message)
     stateComp_.Write(message);
 
     if (HaveFunction(FunctionUpdate))
-        Lua::CallFunction(luaState_, "onUpdate", timeElapsed);
+        functions_.Call(FunctionUpdate, timeElapsed);
     if (sa::time::time_elapsed(startTime_) > lifetime_)
     {
         if (HaveFunction(FunctionEnded))
-            Lua::CallFunction(luaState_, "onEnded");
+            functions_.Call(FunctionEnded);
         Remove();
     }
 }
@@ -152,21 +150,21 @@ void AreaOfEffect::OnCollide(GameObject* other)
     // Called from collisionComp_ of the moving object
     // AOE can also be a trap for example
     if (HaveFunction(FunctionOnCollide))
-        Lua::CallFunction(luaState_, "onCollide", other);
+        functions_.Call(FunctionOnCollide, other);
 }
 
 void AreaOfEffect::OnTrigger(GameObject* other)
 {
     // AOE can also be a trap for example
     if (HaveFunction(FunctionOnTrigger))
-        Lua::CallFunction(luaState_, "onTrigger", other);
+        functions_.Call(FunctionOnTrigger, other);
 }
 
 void AreaOfEffect::OnLeftArea(GameObject* other)
 {
     // AOE can also be a trap for example
     if (HaveFunction(FunctionOnLeftArea))
-        Lua::CallFunction(luaState_, "onLeftArea", other);
+        functions_.Call(FunctionOnLeftArea, other);
 }
 
 Math::ShapeType AreaOfEffect::GetShapeType() const
@@ -22,6 +22,7 @@
 #pragma once
 
 #include "GameObject.h"
+#include "ScriptManager.h"
 #include "Skill.h"
 #include <sa/Bits.h>
 #include <eastl.hpp>
@@ -43,21 +44,21 @@ private:
         FunctionOnCollide = 1 << 4,
     };
     ea::weak_ptr<Actor> source_;
-    kaguya::State luaState_;
+    Lua::Environment luaEnv_;
+    Lua::ScriptFunctions<Function, 5> functions_;
     bool luaInitialized_{ false };
     /// Effect or skill index
     uint32_t index_{ 0 };
     Ranges range_{ Ranges::Adjecent };
     uint32_t skillEffect_{ SkillEffectNone };
     uint32_t effectTarget_{ SkillTargetNone };
-    uint32_t functions_{ FunctionNone };
     int64_t startTime_;
     // Lifetime
     uint32_t lifetime_{ std::numeric_limits<uint32_t>::max() };
     uint32_t itemIndex_{ 0 };
     bool HaveFunction(Function func) const
     {
-        return luaInitialized_ && sa::bits::is_set(functions_, func);
+        return luaInitialized_ && functions_.Have(func);
     }
     void InitializeLua();
     void _LuaSetSource(Actor* source);
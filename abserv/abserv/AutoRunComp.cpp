@@ -185,19 +185,19 @@ Math::Vector3 AutoRunComp::AvoidObstaclesInternal(const Math::Vector3& destinati
     const Math::Vector3& pos = owner_.transformation_.position_;
 
     // Raycast to the point and see if there is a hit.
-    const auto raycast = [&pos, this](const Math::Vector3& dest) -> std::optional<Math::RayQueryResult>
+    const auto raycast = [&pos, this](const Math::Vector3& dest) -> std::optional<RayQueryResult>
     {
-        ea::vector<Math::RayQueryResult> result;
+        ea::vector<RayQueryResult> result;
         float dist = pos.Distance(dest);
         if (!owner_.RaycastWithResult(result, pos, dest - pos, dist))
-            // No Octree (shouldn't happen)
+            // Not in the scene (shouldn't happen)
             return {};
         if (result.size() == 0)
             // Lucky, no obstacles
             return {};
 
         // The first non-TerrainPatch hit
-        Math::RayQueryResult* hit = nullptr;
+        RayQueryResult* hit = nullptr;
         for (auto& r : result)
         {
             if (!Is<TerrainPatch>(r.object_) && owner_.CollisionMaskMatches(r.object_->GetCollisionMask()))
@@ -59,6 +59,11 @@ bool ConfigManager::Load(const std::string& file)
     config_[Key::MessageServerPort] = static_cast<int>(GetGlobalInt("message_port", 2771ll));
 
     config_[Key::MaxPacketsPerSecond] = static_cast<int>(GetGlobalInt("max_packets_per_second", 25ll));
+    config_[Key::GameThreads] = static_cast<int>(GetGlobalInt("game_threads", 1ll));
+    config_[Key::IoThreads] = static_cast<int>(GetGlobalInt("io_threads", 0ll));
+    config_[Key::CompressMessages] = GetGlobalBool("compress_messages", true);
+    config_[Key::GridCellSize] = GetGlobalFloat("grid_cell_size", 0.0f);
+    config_[Key::StateSnapshots] = GetGlobalBool("state_snapshots", false);
 
     config_[Key::Behaviours] = GetGlobalString("behaviours", "/scripts/behaviors/behaviors.lua");
     config_[Key::AiServer] = GetGlobalBool("ai_server", false);
@@ -67,6 +72,7 @@ bool ConfigManager::Load(const std::string& file)
     config_[Key::AiUpdateInterval] = static_cast<int>(GetGlobalInt("ai_server_interval", 1000ll));
 
     config_[Key::WatchAssets] = GetGlobalBool("watch_assets", true);
+    config_[Key::ScriptBytecodeCache] = GetGlobalBool("script_bytecode_cache", false);
 
     Close();
     return true;
@@ -49,6 +49,11 @@ public:
         MessageServerPort,
 
         MaxPacketsPerSecond,
+        GameThreads,
+        IoThreads,
+        CompressMessages,
+        GridCellSize,
+        StateSnapshots,
 
         Behaviours,
         AiServer,
@@ -56,6 +61,7 @@ public:
         AiServerPort,
         AiUpdateInterval,
         WatchAssets,
+        ScriptBytecodeCache,
     };
 public:
     ConfigManager();
@@ -44,68 +44,72 @@ void Effect::RegisterLua(kaguya::State& state)
     // clang-format on
 }
 
+Effect::~Effect()
+{
+    // May be on a different lane than the state
+    functions_.Release(luaEnv_);
+}
+
 void Effect::InitializeLua()
 {
-    Lua::RegisterLuaAll(luaState_);
-    luaState_["self"] = this;
+    // Effects move with their target between games, they use the VM of the current lane
+    luaEnv_.Create(Lua::GetLaneState());
+    luaEnv_["self"] = this;
 }
 
 bool Effect::LoadScript(const std::string& fileName)
 {
+    if (!ExecuteScript(fileName))
+        return false;
+
+    persistent_ = luaEnv_["isPersistent"];
+    if (Lua::IsBool(luaEnv_, "internal"))
+        internal_ = luaEnv_["internal"];
+    return true;
+}
+
+bool Effect::EnsureLua()
+{
+    if (!luaEnv_.NeedsBind())
+        return true;
+    return ExecuteScript(data_.script);
+}
+
+bool Effect::ExecuteScript(const std::string& fileName)
+{
+    functions_.Release(luaEnv_);
+    InitializeLua();
     auto script = GetSubsystem<IO::DataProvider>()->GetAsset<Script>(fileName);
     if (!script)
         return false;
-    if (!script->Execute(luaState_))
+    if (!script->Execute(luaEnv_))
         return false;
 
-    persistent_ = luaState_["isPersistent"];
-    if (Lua::IsBool(luaState_, "internal"))
-        internal_ = luaState_["internal"];
-
-    if (Lua::IsFunction(luaState_, "onUpdate"))
-        sa::bits::set(functions_, FunctionUpdate);
-    if (Lua::IsFunction(luaState_, "getSkillCost"))
-        sa::bits::set(functions_, FunctionGetSkillCost);
-    if (Lua::IsFunction(luaState_, "getDamage"))
-        sa::bits::set(functions_, FunctionGetDamage);
-    if (Lua::IsFunction(luaState_, "getAttackSpeed"))
-        sa::bits::set(functions_, FunctionGetAttackSpeed);
-    if (Lua::IsFunction(luaState_, "getAttackDamageType"))
-        sa::bits::set(functions_, FunctionGetAttackDamageType);
-    if (Lua::IsFunction(luaState_, "getAttackDamage"))
-        sa::bits::set(functions_, FunctionGetAttackDamage);
-    if (Lua::IsFunction(luaState_, "onAttack"))
-        sa::bits::set(functions_, FunctionOnAttack);
-    if (Lua::IsFunction(luaState_, "onGettingAttacked"))
-        sa::bits::set(functions_, FunctionOnGettingAttacked);
-    if (Lua::IsFunction(luaState_, "onUseSkill"))
-        sa::bits::set(functions_, FunctionOnUseSkill);
-    if (Lua::IsFunction(luaState_, "onSkillTargeted"))
-        sa::bits::set(functions_, FunctionOnSkillTargeted);
-    if (Lua::IsFunction(luaState_, "onAttacked"))
-        sa::bits::set(functions_, FunctionOnAttacked);
-    if (Lua::IsFunction(luaState_, "onInterruptingAttack"))
-        sa::bits::set(functions_, FunctionOnInterruptingAttack);
-    if (Lua::IsFunction(luaState_, "onInterruptingSkill"))
-        sa::bits::set(functions_, FunctionOnInterruptingSkill);
-    if (Lua::IsFunction(luaState_, "onKnockingDown"))
-        sa::bits::set(functions_, FunctionOnKnockingDown);
-    if (Lua::IsFunction(luaState_, "onHealing"))
-        sa::bits::set(functions_, FunctionOnHealing);
-    if (Lua::IsFunction(luaState_, "onGetCriticalHit"))
-        sa::bits::set(functions_, FunctionOnGetCriticalHit);
-    if (Lua::IsFunction(luaState_, "getArmor"))
-        sa::bits::set(functions_, FunctionGetArmor);
-    if (Lua::IsFunction(luaState_, "getArmorPenetration"))
-        sa::bits::set(functions_, FunctionGetArmorPenetration);
-    if (Lua::IsFunction(luaState_, "getAttributeRank"))
-        sa::bits::set(functions_, FunctionGetAttributeRank);
-    if (Lua::IsFunction(luaState_, "getResources"))
-        sa::bits::set(functions_, FunctionGetResources);
-    if (Lua::IsFunction(luaState_, "getSkillRecharge"))
-        sa::bits::set(functions_, FunctionGetSkillRecharge);
-    if (Lua::IsFunction(luaState_, "onRemove"))
-        sa::bits::set(functions_, FunctionOnRemoved);
+    functions_.Resolve(luaEnv_, {
+        { FunctionUpdate, "onUpdate" },
+        { FunctionGetSkillCost, "getSkillCost" },
+        { FunctionGetDamage, "getDamage" },
+        { FunctionGetAttackSpeed, "getAttackSpeed" },
+        { FunctionGetAttackDamageType, "getAttackDamageType" },
+        { FunctionGetAttackDamage, "getAttackDamage" },
+        { FunctionOnAttack, "onAttack" },
+        { FunctionOnGettingAttacked, "onGettingAttacked" },
+        { FunctionOnUseSkill, "onUseSkill" },
+        { FunctionOnSkillTargeted, "onSkillTargeted" },
+        { FunctionOnAttacked, "onAttacked" },
+        { FunctionOnInterruptingAttack, "onInterruptingAttack" },
+        { FunctionOnInterruptingSkill, "onInterruptingSkill" },
+        { FunctionOnKnockingDown, "onKnockingDown" },
+        { FunctionOnHealing, "onHealing" },
+        { FunctionOnGetCriticalHit, "onGetCriticalHit" },
+        { FunctionGetArmor, "getArmor" },
+        { FunctionGetArmorPenetration, "getArmorPenetration" },
+        { FunctionGetAttributeRank, "getAttributeRank" },
+        { FunctionGetResources, "getResources" },
+        { FunctionGetSkillRecharge, "getSkillRecharge" },
+        { FunctionOnRemoved, "onRemove" },
+        { FunctionOnEnd, "onEnd" }
+    });
     return true;
 }
 
@@ -131,10 +135,10 @@ void Effect::Update(uint32_t timeElapsed)
     auto source = source_.lock();
     auto target = target_.lock();
     if (HaveFunction(FunctionUpdate))
-        luaState_["onUpdate"](source.get(), target.get(), timeElapsed);
+        functions_[FunctionUpdate](source.get(), target.get(), timeElapsed);
     if (endTime_ <= sa::time::tick())
     {
-        luaState_["onEnd"](source.get(), target.get());
+        functions_.Call(FunctionOnEnd, source.get(), target.get());
         ended_ = true;
     }
 }
@@ -156,12 +160,14 @@ bool Effect::Start(ea::shared_ptr<Actor> source, ea::shared_ptr<Actor> target, u
     target_ = target;
     source_ = source;
     startTime_ = sa::time::tick();
+    if (!EnsureLua())
+        return false;
     if (time == 0)
-        ticks_ = luaState_["getDuration"](source.get(), target.get());
+        ticks_ = luaEnv_["getDuration"](source.get(), target.get());
     else
         ticks_ = time;
     endTime_ = startTime_ + ticks_;
-    const bool succ = luaState_["onStart"](source.get(), target.get());
+    const bool succ = luaEnv_["onStart"](source.get(), target.get());
     if (!succ)
         endTime_ = 0;
     return succ;
@@ -174,7 +180,7 @@ void Effect::Remove()
     {
         auto source = source_.lock();
         auto target = target_.lock();
-        Lua::CallFunction(luaState_, "onRemove", source.get(), target.get());
+        functions_.Call(FunctionOnRemoved, source.get(), target.get());
     }
     cancelled_ = true;
 }
@@ -184,7 +190,7 @@ void Effect::GetSkillRecharge(Skill* skill, uint32_t& recharge)
     if (!HaveFunction(FunctionGetSkillRecharge))
         return;
 
-    recharge = luaState_["getSkillRecharge"](skill, recharge);
+    recharge = functions_[FunctionGetSkillRecharge](skill, recharge);
 }
 
 void Effect::GetSkillCost(Skill* skill,
@@ -194,7 +200,7 @@ void Effect::GetSkillCost(Skill* skill,
         return;
 
     kaguya::tie(activation, energy, adrenaline, overcast, hp) =
-        luaState_["getSkillCost"](skill, activation, energy, adrenaline, overcast, hp);
+        functions_[FunctionGetSkillCost](skill, activation, energy, adrenaline, overcast, hp);
 }
 
 void Effect::GetDamage(DamageType type, int32_t& value, bool& critical)
@@ -203,116 +209,116 @@ void Effect::GetDamage(DamageType type, int32_t& value, bool& critical)
         return;
 
     kaguya::tie(value, critical) =
-        luaState_["getDamage"](static_cast<int>(type), value, critical);
+        functions_[FunctionGetDamage](static_cast<int>(type), value, critical);
 }
 
 void Effect::GetAttackSpeed(Item* weapon, uint32_t& value)
 {
     if (!HaveFunction(FunctionGetAttackSpeed))
         return;
-    value = luaState_["getAttackSpeed"](weapon, value);
+    value = functions_[FunctionGetAttackSpeed](weapon, value);
 }
 
 void Effect::GetAttackDamageType(DamageType& type)
 {
     if (!HaveFunction(FunctionGetAttackDamageType))
         return;
-    type = luaState_["getAttackDamageType"](type);
+    type = functions_[FunctionGetAttackDamageType](type);
 }
 
 void Effect::GetArmor(DamageType type, int& value)
 {
     if (!HaveFunction(FunctionGetArmor))
         return;
-    value = luaState_["getArmor"](type, value);
+    value = functions_[FunctionGetArmor](type, value);
 }
 
 void Effect::GetArmorPenetration(float& value)
 {
     if (!HaveFunction(FunctionGetArmorPenetration))
         return;
-    value = luaState_["getArmorPenetration"](value);
+    value = functions_[FunctionGetArmorPenetration](value);
 }
 
 void Effect::GetAttributeRank(Attribute index, int32_t& value)
 {
     if (!HaveFunction(FunctionGetAttributeRank))
         return;
-    value = luaState_["getAttributeRank"](static_cast<uint32_t>(index), value);
+    value = functions_[FunctionGetAttributeRank](static_cast<uint32_t>(index), value);
 }
 
 void Effect::GetAttackDamage(int32_t& value)
 {
     if (!HaveFunction(FunctionGetAttackDamage))
         return;
-    value = luaState_["getAttackDamage"](value);
+    value = functions_[FunctionGetAttackDamage](value);
 }
 
 void Effect::GetRecources(int& maxHealth, int& maxEnergy)
 {
     if (!HaveFunction(FunctionGetResources))
         return;
-    kaguya::tie(maxHealth, maxEnergy) = luaState_["getResources"](maxHealth, maxEnergy);
+    kaguya::tie(maxHealth, maxEnergy) = functions_[FunctionGetResources](maxHealth, maxEnergy);
 }
 
 void Effect::OnAttack(Actor* source, Actor* target, bool& value)
 {
     if (HaveFunction(FunctionOnAttack))
-        value = luaState_["onAttack"](source, target);
+        value = functions_[FunctionOnAttack](source, target);
 }
 
 void Effect::OnAttacked(Actor* source, Actor* target, DamageType type, int32_t damage, bool& success)
 {
     if (HaveFunction(FunctionOnAttacked))
-        success = luaState_["onAttacked"](source, target, type, damage);
+        success = functions_[FunctionOnAttacked](source, target, type, damage);
 }
 
 void Effect::OnGettingAttacked(Actor* source, Actor* target, bool& value)
 {
     if (HaveFunction(FunctionOnGettingAttacked))
-        value = luaState_["onGettingAttacked"](source, target);
+        value = functions_[FunctionOnGettingAttacked](source, target);
 }
 
 void Effect::OnUseSkill(Actor* source, Actor* target, Skill* skill, bool& value)
 {
     if (HaveFunction(FunctionOnUseSkill))
-        value = luaState_["onUseSkill"](source, target, skill);
+        value = functions_[FunctionOnUseSkill](source, target, skill);
 }
 
 void Effect::OnSkillTargeted(Actor* source, Actor* target, Skill* skill, bool& value)
 {
     if (HaveFunction(FunctionOnSkillTargeted))
-        value = luaState_["onSkillTargeted"](source, target, skill);
+        value = functions_[FunctionOnSkillTargeted](source, target, skill);
 }
 
 void Effect::OnInterruptingAttack(bool& value)
 {
     if (HaveFunction(FunctionOnInterruptingAttack))
-        value = luaState_["onInterruptingAttack"]();
+        value = functions_[FunctionOnInterruptingAttack]();
 }
 
 void Effect::OnInterruptingSkill(AB::Entities::SkillType type, Skill* skill, bool& value)
 {
     if (HaveFunction(FunctionOnInterruptingSkill))
-        value = luaState_["onInterruptingSkill"](type, skill);
+        value = functions_[FunctionOnInterruptingSkill](type, skill);
 }
 
 void Effect::OnKnockingDown(Actor* source, Actor* target, uint32_t time, bool& value)
 {
     if (HaveFunction(FunctionOnKnockingDown))
-        value = luaState_["onKnockingDown"](source, target, time);
+        value = functions_[FunctionOnKnockingDown](source, target, time);
 }
 
 void Effect::OnGetCriticalHit(Actor* source, Actor* target, bool& value)
 {
-    if (HaveFunction(FunctionOnKnockingDown))
-        value = luaState_["onGetCriticalHit"](source, target);
+    if (HaveFunction(FunctionOnGetCriticalHit))
+        value = functions_[FunctionOnGetCriticalHit](source, target);
 }
 
 void Effect::OnHealing(Actor* source, Actor* target, int& value)
 {
     if (HaveFunction(FunctionOnHealing))
-        value = luaState_["onHealing"](source, target, value);
+        value = functions_[FunctionOnHealing](source, target, value);
 }
 
 bool Effect::Serialize(sa::PropWriteStream& stream)
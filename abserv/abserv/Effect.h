@@ -30,6 +30,7 @@
 #include <abshared/Attributes.h>
 #include <sa/Noncopyable.h>
 #include <sa/Bits.h>
+#include "ScriptManager.h"
 #include <eastl.hpp>
 
 namespace Game {
@@ -76,23 +77,28 @@ private:
         FunctionGetResources = 1 << 19,
         FunctionGetSkillRecharge = 1 << 20,
         FunctionOnRemoved = 1 << 21,
+        FunctionOnEnd = 1 << 22,
     };
     int64_t startTime_;
     int64_t endTime_;
     /// Duration
     uint32_t ticks_;
-    kaguya::State luaState_;
+    Lua::Environment luaEnv_;
+    Lua::ScriptFunctions<Function, 23> functions_;
     ea::weak_ptr<Actor> target_;
     ea::weak_ptr<Actor> source_;
     bool persistent_{ false };
-    uint32_t functions_{ FunctionNone };
     /// Internal effects are not visible to the player.
     bool internal_{ false };
     bool UnserializeProp(EffectAttr attr, sa::PropReadStream& stream);
     void InitializeLua();
-    bool HaveFunction(Function func) const
+    bool ExecuteScript(const std::string& fileName);
+    /// Rebind the script when the Effect is used on a different lane than before.
+    /// Variables of the script are reset then.
+    bool EnsureLua();
+    bool HaveFunction(Function func)
     {
-        return sa::bits::is_set(functions_, func);
+        return EnsureLua() && functions_.Have(func);
     }
     Actor* _LuaGetTarget();
     Actor* _LuaGetSource();
@@ -107,10 +113,8 @@ public:
         data_(effect),
         ended_(false),
         cancelled_(false)
-    {
-        InitializeLua();
-    }
-    ~Effect() = default;
+    { }
+    ~Effect();
 
     /// Gets saved to the DB when player logs out, e.g. Dishonored.
     bool IsPersistent() const
@@ -44,6 +44,7 @@
 #include <AB/Packets/Packet.h>
 #include <AB/Packets/ServerPackets.h>
 #include <AB/ProtocolCodes.h>
+#include <abscommon/DispatcherPool.h>
 #include <abscommon/MessageClient.h>
 #include <abscommon/Random.h>
 #include <abscommon/ThreadPool.h>
@@ -56,6 +57,7 @@
 namespace Game {
 
 ea::unique_ptr<Net::MessageFilter> Game::messageFilter;
+bool Game::stateSnapshots = false;
 
 void Game::InitMessageFilter()
 {
@@ -63,26 +65,31 @@ void Game::InitMessageFilter()
     ASSERT(!messageFilter);
     using namespace AB::Packets::Server;
     messageFilter = ea::make_unique<Net::MessageFilter>();
+    stateSnapshots = (*GetSubsystem<ConfigManager>())[ConfigManager::Key::StateSnapshots].GetBool();
     // Subscribe to all messages we may filter out
-    messageFilter->Subscribe<ObjectPositionUpdate>([](const Game& game, const Player& player, ObjectPositionUpdate& packet) -> bool
+    messageFilter->Subscribe<ObjectPositionUpdate>([](const Game& game, const Player& player, const ObjectPositionUpdate& packet) -> bool
     {
         if (packet.id == player.id_)
             return true;
+        if (stateSnapshots)
+            return false;
         const auto* object = game.GetObject<GameObject>(packet.id);
         if (!player.IsInRange(Ranges::Interest, object))
             return false;
         return true;
     });
-    messageFilter->Subscribe<ObjectRotationUpdate>([](const Game& game, const Player& player, ObjectRotationUpdate& packet) -> bool
+    messageFilter->Subscribe<ObjectRotationUpdate>([](const Game& game, const Player& player, const ObjectRotationUpdate& packet) -> bool
     {
         if (packet.id == player.id_)
             return true;
+        if (stateSnapshots)
+            return false;
         const auto* object = game.GetObject<GameObject>(packet.id);
         if (!player.IsInRange(Ranges::Interest, object))
             return false;
         return true;
     });
-    messageFilter->Subscribe<ObjectSkillFailure>([](const Game& game, const Player& player, ObjectSkillFailure& packet) -> bool
+    messageFilter->Subscribe<ObjectSkillFailure>([](const Game& game, const Player& player, const ObjectSkillFailure& packet) -> bool
     {
         if (packet.id == player.id_)
             return true;
@@ -91,7 +98,7 @@ void Game::InitMessageFilter()
             return false;
         return true;
     });
-    messageFilter->Subscribe<ObjectUseSkill>([](const Game& game, const Player& player, ObjectUseSkill& packet) -> bool
+    messageFilter->Subscribe<ObjectUseSkill>([](const Game& game, const Player& player, const ObjectUseSkill& packet) -> bool
     {
         if (packet.id == player.id_)
             return true;
@@ -100,7 +107,7 @@ void Game::InitMessageFilter()
             return false;
         return true;
     });
-    messageFilter->Subscribe<ObjectSkillSuccess>([](const Game& game, const Player& player, ObjectSkillSuccess& packet) -> bool
+    messageFilter->Subscribe<ObjectSkillSuccess>([](const Game& game, const Player& player, const ObjectSkillSuccess& packet) -> bool
     {
         if (packet.id == player.id_)
             return true;
@@ -109,7 +116,7 @@ void Game::InitMessageFilter()
             return false;
         return true;
     });
-    messageFilter->Subscribe<ObjectAttackFailure>([](const Game& game, const Player& player, ObjectAttackFailure& packet) -> bool
+    messageFilter->Subscribe<ObjectAttackFailure>([](const Game& game, const Player& player, const ObjectAttackFailure& packet) -> bool
     {
         if (packet.id == player.id_)
             return true;
@@ -118,7 +125,7 @@ void Game::InitMessageFilter()
             return false;
         return true;
     });
-    messageFilter->Subscribe<ObjectSetAttackSpeed>([](const Game& game, const Player& player, ObjectSetAttackSpeed& packet) -> bool
+    messageFilter->Subscribe<ObjectSetAttackSpeed>([](const Game& game, const Player& player, const ObjectSetAttackSpeed& packet) -> bool
     {
         if (packet.id == player.id_)
             return true;
@@ -127,7 +134,7 @@ void Game::InitMessageFilter()
             return false;
         return true;
     });
-    messageFilter->Subscribe<ObjectTargetSelected>([](const Game& game, const Player& player, ObjectTargetSelected& packet) -> bool
+    messageFilter->Subscribe<ObjectTargetSelected>([](const Game& game, const Player& player, const ObjectTargetSelected& packet) -> bool
     {
         if (packet.id == player.id_ || packet.targetId == player.id_)
             return true;
@@ -136,7 +143,7 @@ void Game::InitMessageFilter()
             return false;
         return true;
     });
-    messageFilter->Subscribe<ObjectEffectAdded>([](const Game& game, const Player& player, ObjectEffectAdded& packet) -> bool
+    messageFilter->Subscribe<ObjectEffectAdded>([](const Game& game, const Player& player, const ObjectEffectAdded& packet) -> bool
     {
         if (packet.id == player.id_)
             return true;
@@ -153,7 +160,7 @@ void Game::InitMessageFilter()
             return false;
         return true;
     });
-    messageFilter->Subscribe<ObjectEffectRemoved>([](const Game& game, const Player& player, ObjectEffectRemoved& packet) -> bool
+    messageFilter->Subscribe<ObjectEffectRemoved>([](const Game& game, const Player& player, const ObjectEffectRemoved& packet) -> bool
     {
         if (packet.id == player.id_)
             return true;
@@ -172,7 +179,7 @@ void Game::InitMessageFilter()
             return false;
         return true;
     });
-    messageFilter->Subscribe<ObjectDamaged>([](const Game& game, const Player& player, ObjectDamaged& packet) -> bool
+    messageFilter->Subscribe<ObjectDamaged>([](const Game& game, const Player& player, const ObjectDamaged& packet) -> bool
     {
         if (packet.id == player.id_ || packet.sourceId == player.id_)
             return true;
@@ -181,7 +188,7 @@ void Game::InitMessageFilter()
             return false;
         return true;
     });
-    messageFilter->Subscribe<ObjectHealed>([](const Game& game, const Player& player, ObjectHealed& packet) -> bool
+    messageFilter->Subscribe<ObjectHealed>([](const Game& game, const Player& player, const ObjectHealed& packet) -> bool
     {
         if (packet.id == player.id_ || packet.sourceId == player.id_)
             return true;
@@ -190,7 +197,7 @@ void Game::InitMessageFilter()
             return false;
         return true;
     });
-    messageFilter->Subscribe<ObjectResourceChanged>([](const Game& game, const Player& player, ObjectResourceChanged& packet) -> bool
+    messageFilter->Subscribe<ObjectResourceChanged>([](const Game& game, const Player& player, const ObjectResourceChanged& packet) -> bool
     {
         if (packet.id == player.id_)
             return true;
@@ -213,11 +220,11 @@ Game::~Game()
 {
     instanceData_.running = false;
     instanceData_.stopTime = sa::time::tick();
-    UpdateEntity(instanceData_);
+    UpdateEntityAsync(instanceData_);
     auto* client = GetSubsystem<IO::DataClient>();
-    client->Invalidate(instanceData_);
+    client->InvalidateAsync(instanceData_);
     AB::Entities::GameInstanceList il;
-    client->Invalidate(il);
+    client->InvalidateAsync(il);
     players_.clear();
     objects_.clear();
     GetSubsystem<Chat>()->Remove(ChatType::Map, id_);
@@ -352,7 +359,8 @@ void Game::Start()
     if ((*config)[ConfigManager::Key::RecordGames])
     {
         writeStream_ = std::make_unique<IO::GameWriteStream>();
-        if (writeStream_->Open((*config)[ConfigManager::Key::RecordingsDir], this))
+        if (writeStream_->Open((*config)[ConfigManager::Key::RecordingsDir], instanceData_.uuid,
+            data_.uuid, startTime_))
             instanceData_.recording = writeStream_->GetFilename();
     }
     instanceData_.running = true;
@@ -368,15 +376,29 @@ void Game::Start()
     SetState(ExecutionState::Running);
 
     // Initial game update
-    GetSubsystem<Asynch::Dispatcher>()->Add(
-        Asynch::CreateTask(std::bind(&Game::Update, shared_from_this()))
-    );
+    Post(std::bind(&Game::Update, shared_from_this()));
+}
+
+void Game::Post(std::function<void(void)>&& f)
+{
+    GetSubsystem<Asynch::DispatcherPool>()->Add(lane_, Asynch::CreateTask(std::move(f)));
+}
+
+uint32_t Game::Schedule(uint32_t delay, std::function<void(void)>&& f)
+{
+    return GetSubsystem<Asynch::DispatcherPool>()->Schedule(lane_,
+        Asynch::CreateScheduledTask(delay, std::move(f)));
+}
+
+bool Game::IsLaneThread() const
+{
+    return GetSubsystem<Asynch::DispatcherPool>()->IsLaneThread(lane_);
 }
 
 void Game::Update()
 {
     const uint32_t frequency = GetUpdateFrequency();
-    // Dispatcher Thread
+    // Game lane thread
     if (state_ != ExecutionState::Terminated)
     {
         if (lastUpdate_ == 0)
@@ -413,6 +435,8 @@ void Game::Update()
             AB::Packets::Add(packet, *gameStatus_);
         }
 
+        UpdateRanges();
+
         // First Update all objects
         {
             // We need a copy of the objects because the iterator may become
@@ -427,12 +451,14 @@ void Game::Update()
             }
         }
 
-        // Update Octree
-        map_->UpdateOctree(delta);
+        // Update the spatial index with the objects that moved
+        map_->UpdateSpatialIndex(delta);
 
         // Then call Lua Update function
         Lua::CallFunction(luaState_, "onUpdate", delta);
 
+        if (stateSnapshots)
+            UpdateSnapshotStates();
         // Send game status to players
         SendStatus();
 
@@ -463,14 +489,12 @@ void Game::Update()
         const uint32_t sleepTime = frequency > duration ?
             frequency - duration :
             0;
-        GetSubsystem<Asynch::Scheduler>()->Add(
-            Asynch::CreateScheduledTask(sleepTime, std::bind(&Game::Update, shared_from_this()))
-        );
+        Schedule(sleepTime, std::bind(&Game::Update, shared_from_this()));
 
         break;
     }
     case ExecutionState::Terminated:
-        // Delete this game
+        // Delete this game. The GameManager runs on the main lane.
         LOG_INFO << "Stopping game " << id_ << ", " << map_->name_ << std::endl;
         GetSubsystem<Asynch::Scheduler>()->Add(
             Asynch::CreateScheduledTask(500, std::bind(&GameManager::DeleteGameTask,
@@ -482,6 +506,23 @@ void Game::Update()
         break;
     }
     Lua::CollectGarbage(luaState_);
+    if (scriptState_)
+        Lua::CollectGarbage(*scriptState_);
+    // Skills, Effects etc. of the players on this lane
+    Lua::CollectLaneGarbage();
+}
+
+void Game::UpdateRanges()
+{
+    UpdateInterestRanges(objects_, rangeQuery_, [](GameObject& object, ea::vector<GameObject*>& result)
+    {
+        if (!object.HasGame())
+            return false;
+        return object.QueryObjects(result, RANGE_INTEREST + AVERAGE_BB_EXTENDS);
+    });
+
+    for (const auto& o : objects_)
+        o.second->CallRangeEvents();
 }
 
 void Game::SendStatus()
@@ -489,19 +530,78 @@ void Game::SendStatus()
     // Must not be empty. Update adds at least the time stamp.
     ASSERT(gameStatus_->GetSize() != 0);
 
+    // Decode it only once, players get the ranges of the packets they should see
+    messageFilter->Prepare(*gameStatus_, statusPackets_);
+    const StateSnapshot::GetStateFunc getState = [this](uint32_t id) -> const StateSnapshot::State*
+    {
+        // Only these move
+        auto* actor = GetObject<Actor>(id);
+        if (!actor)
+            return nullptr;
+        return &actor->snapshotState_;
+    };
     for (const auto& p : players_)
     {
-        auto msg = Net::NetworkMessage::GetNew();
-        messageFilter->Execute(*this, *p.second, *gameStatus_, *msg);
-        p.second->WriteToOutput(*msg);
+        messageFilter->Execute(*this, *p.second, *gameStatus_, statusPackets_, statusRanges_);
+        p.second->WriteToOutput(*gameStatus_, statusRanges_);
+        if (stateSnapshots)
+        {
+            auto msg = Net::NetworkMessage::GetNew();
+            p.second->GetInRangeIds(Ranges::Interest, snapshotInRange_);
+            p.second->snapshot_.Write(snapshotInRange_, snapshotChanged_, getState, *msg);
+            p.second->WriteToOutput(*msg);
+        }
     }
 
     if (writeStream_ && writeStream_->IsOpen())
+    {
+        if (writeStream_->NeedsKeyframe())
+            WriteKeyframe();
         writeStream_->Write(*gameStatus_);
+    }
 
     ResetStatus();
 }
 
+void Game::UpdateSnapshotStates()
+{
+    // objects_ is sorted by ID
+    snapshotChanged_.clear();
+    for (const auto& o : objects_)
+    {
+        if (!o.second->IsActorType())
+            continue;
+        auto& actor = To<Actor>(*o.second);
+        const auto& pos = actor.transformation_.position_;
+        const float position[3] = { pos.x_, pos.y_, pos.z_ };
+        // MoveComp::Write() already ran this tick, so it remembers how the rotation was changed
+        if (StateSnapshot::Update(actor.snapshotState_, position, actor.transformation_.GetYRotation(),
+            actor.moveComp_->rotationManual_))
+            snapshotChanged_.push_back(actor.id_);
+    }
+}
+
+void Game::WriteKeyframe()
+{
+    // A replay can start at a keyframe, so it must contain all objects
+    writeStream_->BeginKeyframe();
+    auto msg = Net::NetworkMessage::GetNew();
+    for (const auto& o : objects_)
+    {
+        if (o.second->GetType() < AB::GameProtocol::GameObjectType::__SentToPlayer)
+            continue;
+        msg->AddByte(AB::GameProtocol::ServerPacketType::ObjectSpawnExisting);
+        o.second->WriteSpawnData(*msg);
+        if (msg->GetSpace() < 512)
+        {
+            writeStream_->Write(*msg);
+            msg->Reset();
+        }
+    }
+    if (msg->GetSize() != 0)
+        writeStream_->Write(*msg);
+}
+
 void Game::ResetStatus()
 {
     gameStatus_ = Net::NetworkMessage::GetNew();
@@ -554,10 +654,7 @@ ea::shared_ptr<Npc> Game::AddNpc(const std::string& script)
         return ea::shared_ptr<Npc>();
 
     // After all initialization is done, we can call this
-    GetSubsystem<Asynch::Scheduler>()->Add(
-        Asynch::CreateScheduledTask(std::bind(&Game::SendSpawnObject,
-            shared_from_this(), result))
-    );
+    Schedule(std::bind(&Game::SendSpawnObject, shared_from_this(), result));
 
     return result;
 }
@@ -578,10 +675,7 @@ ea::shared_ptr<AreaOfEffect> Game::AddAreaOfEffect(const std::string& script,
         return ea::shared_ptr<AreaOfEffect>();
 
     // After all initialization is done, we can call this
-    GetSubsystem<Asynch::Scheduler>()->Add(
-        Asynch::CreateScheduledTask(std::bind(&Game::SendSpawnObject,
-            shared_from_this(), result))
-    );
+    Schedule(std::bind(&Game::SendSpawnObject, shared_from_this(), result));
 
     return result;
 }
@@ -598,10 +692,7 @@ void Game::AddProjectile(const std::string& itemUuid,
     if (!result->Load())
         return;
 
-    GetSubsystem<Asynch::Scheduler>()->Add(
-        Asynch::CreateScheduledTask(std::bind(&Game::SendSpawnObject,
-            shared_from_this(), result))
-    );
+    Schedule(std::bind(&Game::SendSpawnObject, shared_from_this(), result));
 }
 
 ea::shared_ptr<ItemDrop> Game::AddRandomItemDropFor(Actor* dropper, Actor* target)
@@ -821,7 +912,7 @@ void Game::SendInitStateToPlayer(Player& player)
 void Game::PlayerJoin(uint32_t playerId)
 {
 #ifdef DEBUG_NET
-    ASSERT(GetSubsystem<Asynch::Dispatcher>()->IsDispatcherThread());
+    ASSERT(IsLaneThread());
 #endif
     ea::shared_ptr<Player> player = GetSubsystem<PlayerManager>()->GetPlayerById(playerId);
     if (!player)
@@ -830,7 +921,7 @@ void Game::PlayerJoin(uint32_t playerId)
     if (AB::Entities::IsOutpost(data_.type))
         player->data_.lastOutpostUuid = data_.uuid;
     player->data_.instanceUuid = instanceData_.uuid;
-    UpdateEntity(player->data_);
+    UpdateEntityAsync(player->data_);
 
     SendInitStateToPlayer(*player);
 
@@ -848,11 +939,7 @@ void Game::PlayerJoin(uint32_t playerId)
     Lua::CallFunction(luaState_, "onPlayerJoin", player.get());
 
     // Notify other servers that a player joined, e.g. for friend list
-    GetSubsystem<Asynch::Scheduler>()->Add(
-        Asynch::CreateScheduledTask(std::bind(&Game::BroadcastPlayerLoggedIn,
-            shared_from_this(),
-            player))
-    );
+    Schedule(std::bind(&Game::BroadcastPlayerLoggedIn, shared_from_this(), player));
 }
 
 void Game::RemoveObject(GameObject* object)
@@ -863,16 +950,14 @@ void Game::RemoveObject(GameObject* object)
     if (it == objects_.end())
         return;
 
-    GetSubsystem<Asynch::Scheduler>()->Add(
-        Asynch::CreateScheduledTask(std::bind(&Game::SendLeaveObject, shared_from_this(), object->id_))
-    );
+    Schedule(std::bind(&Game::SendLeaveObject, shared_from_this(), object->id_));
     InternalRemoveObject(object);
 }
 
 void Game::PlayerLeave(uint32_t playerId)
 {
 #ifdef DEBUG_NET
-    ASSERT(GetSubsystem<Asynch::Dispatcher>()->IsDispatcherThread());
+    ASSERT(IsLaneThread());
 #endif
     Player* player = GetPlayerById(playerId);
     if (!player)
@@ -886,18 +971,11 @@ void Game::PlayerLeave(uint32_t playerId)
         players_.erase(it);
     }
     player->data_.instanceUuid = "";
-    UpdateEntity(player->data_);
+    UpdateEntityAsync(player->data_);
 
-    auto* sched = GetSubsystem<Asynch::Scheduler>();
-    sched->Add(
-        Asynch::CreateScheduledTask(std::bind(&Game::SendLeaveObject, shared_from_this(), playerId))
-    );
+    Schedule(std::bind(&Game::SendLeaveObject, shared_from_this(), playerId));
     // Notify other servers that a player left, e.g. for friend list
-    sched->Add(
-        Asynch::CreateScheduledTask(std::bind(&Game::BroadcastPlayerLoggedOut,
-            shared_from_this(),
-            player->GetPtr<Player>()))
-    );
+    Schedule(std::bind(&Game::BroadcastPlayerLoggedOut, shared_from_this(), player->GetPtr<Player>()));
     InternalRemoveObject(player);
 }
 
@@ -909,6 +987,13 @@ Crowd* Game::AddCrowd()
     return result;
 }
 
+ea::shared_ptr<Lua::SharedState> Game::GetScriptState()
+{
+    if (!scriptState_)
+        scriptState_ = ea::make_shared<Lua::SharedState>();
+    return scriptState_;
+}
+
 Group* Game::GetGroup(uint32_t id)
 {
     const auto it = crowds_.find(id);
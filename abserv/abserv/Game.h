@@ -26,6 +26,7 @@
 #include "GameObject.h"
 #include "GameStream.h"
 #include "Map.h"
+#include "MessageFilter.h"
 #include "NavigationMesh.h"
 #include "PartyManager.h"
 #include <AB/Entities/Game.h>
@@ -39,10 +40,6 @@
 #include <sa/Iteration.h>
 #include <sa/time.h>
 
-namespace Net {
-class MessageFilter;
-}
-
 namespace Game {
 
 class Player;
@@ -52,6 +49,10 @@ class ItemDrop;
 class Projectile;
 class Crowd;
 
+namespace Lua {
+class SharedState;
+}
+
 /// The list which owns the objects. We use a std::map because we want to
 /// have it in the order of creation (allocation) when Update() is called.
 using ObjectList = ea::map<uint32_t, ea::shared_ptr<GameObject>>;
@@ -62,6 +63,8 @@ class Game : public ea::enable_shared_from_this<Game>
 {
 private:
     static ea::unique_ptr<Net::MessageFilter> messageFilter;
+    /// Position and rotation updates are written by the StateSnapshot of the player
+    static bool stateSnapshots;
 public:
     static void InitMessageFilter();
 public:
@@ -82,12 +85,26 @@ private:
     PlayersList players_;
     CrowdList crowds_;
     kaguya::State luaState_;
+    /// The VM of game bound objects, e.g. NPCs, AOEs and Projectiles
+    ea::shared_ptr<Lua::SharedState> scriptState_;
     /// First player(s) triggering the creation of this game
     ea::vector<ea::shared_ptr<GameObject>> queuedObjects_;
     void InitializeLua();
     void InternalLoad();
     void Update();
+    /// Update the objects in range of all objects
+    void UpdateRanges();
+    /// Reused by UpdateRanges()
+    ea::vector<GameObject*> rangeQuery_;
     void SendStatus();
+    /// Update the StateSnapshot::State of all actors and remember the changed ones
+    void UpdateSnapshotStates();
+    /// Actors whose snapshot state changed this tick, sorted by ID
+    ea::vector<uint32_t> snapshotChanged_;
+    /// Reused by SendStatus()
+    ea::vector<uint32_t> snapshotInRange_;
+    /// Write the spawn data of all objects to the recording
+    void WriteKeyframe();
     void ResetStatus();
     uint32_t GetUpdateFrequency() const
     {
@@ -97,6 +114,9 @@ private:
     }
     /// Changes to the game are written to this message and sent to all players
     std::unique_ptr<Net::NetworkMessage> gameStatus_;
+    /// Reused for each tick to avoid allocations
+    Net::MessageFilter::Packets statusPackets_;
+    Net::MessageFilter::Ranges statusRanges_;
     /// Stream to record games
     std::unique_ptr<IO::GameWriteStream> writeStream_;
     template<typename E>
@@ -105,6 +125,13 @@ private:
         IO::DataClient* cli = GetSubsystem<IO::DataClient>();
         return cli->Update(e);
     }
+    /// Does not block the game, requests are processed in order by the data server
+    template<typename E>
+    void UpdateEntityAsync(const E& e)
+    {
+        IO::DataClient* cli = GetSubsystem<IO::DataClient>();
+        cli->UpdateAsync(e);
+    }
     template<typename E>
     bool DeleteEntity(const E& e)
     {
@@ -157,6 +184,8 @@ public:
 
     /// Auto generated ID used by the GameManager
     uint32_t id_{ 0 };
+    /// Dispatcher lane this game runs on, assigned by the GameManager
+    size_t lane_{ 0 };
     int64_t startTime_{ 0 };
     AB::Entities::Game data_;
     AB::Entities::GameInstance instanceData_;
@@ -197,6 +226,9 @@ public:
     void AddObjectInternal(ea::shared_ptr<GameObject> object);
     Group* GetGroup(uint32_t id);
     Crowd* AddCrowd();
+    /// Lua VM shared by the game bound objects, created on first use. Must only be used
+    /// on the lane of this game.
+    ea::shared_ptr<Lua::SharedState> GetScriptState();
 
     ea::shared_ptr<Npc> AddNpc(const std::string& script);
     ea::shared_ptr<AreaOfEffect> AddAreaOfEffect(const std::string& script,
@@ -210,6 +242,17 @@ public:
     ea::shared_ptr<ItemDrop> AddRandomItemDropFor(Actor* dropper, Actor* target);
     void SpawnItemDrop(ea::shared_ptr<ItemDrop> item);
 
+    /// Execute a function on the lane of this game
+    void Post(std::function<void(void)>&& f);
+    /// Schedule a function on the lane of this game, returns the event ID
+    uint32_t Schedule(uint32_t delay, std::function<void(void)>&& f);
+    uint32_t Schedule(std::function<void(void)>&& f)
+    {
+        return Schedule(Asynch::SCHEDULER_MINTICKS, std::move(f));
+    }
+    /// Returns true when called from the thread executing this game
+    bool IsLaneThread() const;
+
     ExecutionState GetState() const { return state_; }
     Net::NetworkMessage& GetGameStatus()
     {
@@ -27,6 +27,7 @@
 #include "IOGame.h"
 #include "Npc.h"
 #include "Player.h"
+#include <abscommon/DispatcherPool.h>
 #include <sa/Assert.h>
 
 namespace Game {
@@ -64,6 +65,7 @@ ea::shared_ptr<Game> GameManager::CreateGame(const std::string& mapUuid)
     {
         std::scoped_lock lock(lock_);
         game->id_ = GetNewGameId();
+        game->lane_ = GetSubsystem<Asynch::DispatcherPool>()->Acquire();
         games_[game->id_] = game;
         maps_[mapUuid].push_back(game.get());
     }
@@ -74,7 +76,7 @@ ea::shared_ptr<Game> GameManager::CreateGame(const std::string& mapUuid)
         GetSubsystem<AI::DebugServer>()->AddGame(game);
     }
 #ifdef DEBUG_GAME
-    LOG_DEBUG << "Created game " << mapUuid << " " << game->GetName() << std::endl;
+    LOG_DEBUG << "Created game " << mapUuid << " " << game->GetName() << " on lane " << game->lane_ << std::endl;
 #endif
     return game;
 }
@@ -91,6 +93,7 @@ void GameManager::DeleteGameTask(uint32_t gameId)
         // games_.size() may be called from another thread so lock it
         std::scoped_lock lock(lock_);
         GetSubsystem<AI::DebugServer>()->RemoveGame(gameId);
+        GetSubsystem<Asynch::DispatcherPool>()->Release((*it).second->lane_);
         maps_.erase((*it).second->data_.uuid);
         games_.erase(it);
     }
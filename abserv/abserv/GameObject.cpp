@@ -97,63 +97,44 @@ GameObject::GameObject() :
 
 GameObject::~GameObject()
 {
-    RemoveFromOctree();
+    RemoveFromSpatialIndex();
 }
 
-void GameObject::UpdateRanges()
+void GameObject::CallRangeEvents()
 {
-    ranges_.clear();
-    ea::vector<GameObject*> res;
+    if (!events_.HasSubscribers<void(GameObject*, Ranges)>(EVENT_ON_ENTERRANGE) &&
+        !events_.HasSubscribers<void(GameObject*, Ranges)>(EVENT_ON_LEAVERANGE))
+        return;
+    auto game = GetGame();
+    if (!game)
+        return;
 
-    // Compass radius
-    if (QueryObjects(res, RANGE_INTEREST))
+    ranges_.VisitChanges([&](uint32_t id, uint16_t oldRanges, uint16_t newRanges)
     {
-        const Math::Vector3& myPos = GetPosition();
-        for (const auto& o : res)
+        // Objects that were removed from the game don't leave a range
+        auto* object = game->GetObject<GameObject>(id);
+        if (!object)
+            return;
+        for (unsigned r = static_cast<unsigned>(Ranges::Aggro); r < static_cast<unsigned>(Ranges::Map); ++r)
         {
-            if (o->GetType() > AB::GameProtocol::GameObjectType::__SentToPlayer)
-            {
-                const Math::Vector3& objectPos = o->GetPosition();
-                const float dist = myPos.Distance(objectPos) - AVERAGE_BB_EXTENDS;
-                if (dist <= RANGE_AGGRO)
-                    ranges_[Ranges::Aggro].emplace(o->id_);
-                if (dist <= RANGE_COMPASS)
-                    ranges_[Ranges::Compass].emplace(o->id_);
-                if (dist <= RANGE_SPIRIT)
-                    ranges_[Ranges::Spirit].emplace(o->id_);
-                if (dist <= RANGE_EARSHOT)
-                    ranges_[Ranges::Earshot].emplace(o->id_);
-                if (dist <= RANGE_CASTING)
-                    ranges_[Ranges::Casting].emplace(o->id_);
-                if (dist <= RANGE_PROJECTILE)
-                    ranges_[Ranges::Projectile].emplace(o->id_);
-                if (dist <= RANGE_HALF_COMPASS)
-                    ranges_[Ranges::HalfCompass].emplace(o->id_);
-                if (dist <= RANGE_TOUCH)
-                    ranges_[Ranges::Touch].emplace(o->id_);
-                if (dist <= RANGE_ADJECENT)
-                    ranges_[Ranges::Adjecent].emplace(o->id_);
-                if (dist <= RANGE_VISIBLE)
-                    ranges_[Ranges::Visible].emplace(o->id_);
-                if (dist <= RANGE_TWO_COMPASS)
-                    ranges_[Ranges::TwoCompass].emplace(o->id_);
-                if (dist <= RANGE_INTEREST)
-                    ranges_[Ranges::Interest].emplace(o->id_);
-            }
+            const uint16_t bit = static_cast<uint16_t>(1u << r);
+            if ((newRanges & bit) && !(oldRanges & bit))
+                CallEvent<void(GameObject*, Ranges)>(EVENT_ON_ENTERRANGE, object, static_cast<Ranges>(r));
+            else if ((oldRanges & bit) && !(newRanges & bit))
+                CallEvent<void(GameObject*, Ranges)>(EVENT_ON_LEAVERANGE, object, static_cast<Ranges>(r));
         }
-    }
+    });
 }
 
 void GameObject::Update(uint32_t timeElapsed, Net::NetworkMessage&)
 {
-    UpdateRanges();
     if (triggerComp_)
         triggerComp_->Update(timeElapsed);
 
     if (removeAt_ != 0 && removeAt_ <= sa::time::tick())
     {
-        auto* disp = GetSubsystem<Asynch::Dispatcher>();
-        disp->Add(Asynch::CreateTask(std::bind(&GameObject::Remove, shared_from_this())));
+        if (auto game = GetGame())
+            game->Post(std::bind(&GameObject::Remove, shared_from_this()));
     }
 }
 
@@ -298,12 +279,12 @@ void GameObject::SetVar(const std::string& name, const Utils::Variant& val)
     variables_[sa::StringHashRt(name.c_str())] = val;
 }
 
-void GameObject::ProcessRayQuery(const Math::RayOctreeQuery& query, ea::vector<Math::RayQueryResult>& results)
+void GameObject::ProcessRayQuery(const RayQuery& query, ea::vector<RayQueryResult>& results)
 {
     float distance = query.ray_.HitDistance(GetWorldBoundingBox());
     if (distance < query.maxDistance_)
     {
-        Math::RayQueryResult result;
+        RayQueryResult result;
         result.position_ = query.ray_.origin_ + distance * query.ray_.direction_;
         result.normal_ = -query.ray_.direction_;
         result.distance_ = distance;
@@ -314,24 +295,19 @@ void GameObject::ProcessRayQuery(const Math::RayOctreeQuery& query, ea::vector<M
 
 bool GameObject::QueryObjects(ea::vector<GameObject*>& result, float radius)
 {
-    if (!octant_)
+    if (!spatialIndex_)
         return false;
 
-    Math::Sphere sphere(transformation_.position_, radius);
-    Math::SphereOctreeQuery query(result, sphere, this);
-    Math::Octree* octree = octant_->GetRoot();
-    octree->GetObjects(query);
+    spatialIndex_->GetObjects(result, Math::Sphere(transformation_.position_, radius), this);
     return true;
 }
 
 bool GameObject::QueryObjects(ea::vector<GameObject*>& result, const Math::BoundingBox& box)
 {
-    if (!octant_)
+    if (!spatialIndex_)
         return false;
 
-    Math::BoxOctreeQuery query(result, box, this);
-    Math::Octree* octree = octant_->GetRoot();
-    octree->GetObjects(query);
+    spatialIndex_->GetObjects(result, box, this);
     return true;
 }
 
@@ -346,10 +322,10 @@ bool GameObject::Raycast(ea::vector<GameObject*>& result,
     const Math::Vector3& position, const Math::Vector3& direction,
     float maxDist /* = Math::M_INFINITE */) const
 {
-    if (!octant_)
+    if (!spatialIndex_)
         return false;
 
-    ea::vector<Math::RayQueryResult> res;
+    ea::vector<RayQueryResult> res;
     if (!RaycastWithResult(res, position, direction, maxDist))
         return false;
 
@@ -358,17 +334,16 @@ bool GameObject::Raycast(ea::vector<GameObject*>& result,
     return true;
 }
 
-bool GameObject::RaycastWithResult(ea::vector<Math::RayQueryResult>& result,
+bool GameObject::RaycastWithResult(ea::vector<RayQueryResult>& result,
     const Math::Vector3& position, const Math::Vector3& direction,
     float maxDist /* = Math::M_INFINITE */) const
 {
-    if (!octant_)
+    if (!spatialIndex_)
         return false;
 
     const Math::Ray ray(position, direction);
-    Math::RayOctreeQuery query(result, ray, maxDist, this);
-    Math::Octree* octree = octant_->GetRoot();
-    octree->Raycast(query);
+    RayQuery query(result, ray, maxDist, this);
+    spatialIndex_->Raycast(query);
     return true;
 }
 
@@ -469,17 +444,16 @@ std::vector<GameObject*> GameObject::_LuaRaycast(const Math::StdVector3& directi
 {
     std::vector<GameObject*> result;
 
-    if (!octant_)
+    if (!spatialIndex_)
         return result;
 
     const Math::Vector3& src = transformation_.position_;
     const Math::Vector3 dest(direction);
-    ea::vector<Math::RayQueryResult> res;
+    ea::vector<RayQueryResult> res;
     const Math::Ray ray(src, dest);
-    Math::RayOctreeQuery query(res, ray, src.Distance(dest));
+    RayQuery query(res, ray, src.Distance(dest));
     query.ignore_ = this;
-    Math::Octree* octree = octant_->GetRoot();
-    octree->Raycast(query);
+    spatialIndex_->Raycast(query);
     for (const auto& o : query.result_)
     {
         result.push_back(o.object_);
@@ -498,15 +472,8 @@ bool GameObject::IsInRange(Ranges range, const GameObject* object) const
 {
     if (!object)
         return false;
-    if (range == Ranges::Map)
-        return true;
     // Don't calculate the distance now, but use previously calculated values.
-    const auto rIt = ranges_.find(range);
-    if (rIt == ranges_.end())
-        return false;
-    const auto& r = (*rIt).second;
-    const auto it = r.find(object->id_);
-    return it != r.end();
+    return ranges_.IsInRange(range, object->id_);
 }
 
 bool GameObject::IsCloserThan(float maxDist, const GameObject* object) const
@@ -709,37 +676,25 @@ void GameObject::_LuaSetState(int state)
     SetState(static_cast<AB::GameProtocol::CreatureState>(state));
 }
 
-void GameObject::AddToOctree()
+void GameObject::AddToSpatialIndex()
 {
     if (auto g = game_.lock())
     {
 #ifdef DEBUG_OCTREE
-        LOG_DEBUG << "Adding " << *this << " to Octree" << std::endl;
-#endif
-        g->map_->octree_->InsertObject(this);
-        // Initial update.
-        if (octant_)
-        {
-            Math::Octree* octree = octant_->GetRoot();
-            octree->AddObjectUpdate(this);
-        }
-#ifdef DEBUG_OCTREE
-        else
-        {
-            LOG_WARNING << "octant_ == null" << std::endl;
-        }
+        LOG_DEBUG << "Adding " << *this << " to spatial index" << std::endl;
 #endif
+        g->map_->spatialIndex_->InsertObject(this);
     }
 }
 
-void GameObject::RemoveFromOctree()
+void GameObject::RemoveFromSpatialIndex()
 {
-    if (octant_)
+    if (spatialIndex_)
     {
 #ifdef DEBUG_OCTREE
-        LOG_DEBUG << "Removing " << *this << " from Octree" << std::endl;
+        LOG_DEBUG << "Removing " << *this << " from spatial index" << std::endl;
 #endif
-        octant_->RemoveObject(this);
+        spatialIndex_->RemoveObject(this);
     }
 }
 
@@ -792,18 +747,18 @@ void GameObject::VisitInRange(Ranges range, const std::function<Iteration(GameOb
 {
     auto game = GetGame();
     ASSERT(game);
-    const auto r = ranges_.find(range);
-    if (r == ranges_.end())
-        return;
-    for (uint32_t objectId : (*r).second)
+    ranges_.Visit(range, [&](uint32_t id)
     {
-        auto* object = game->GetObject<GameObject>(objectId);
-        if (object)
-        {
-            if (func(*object) != Iteration::Continue)
-                break;
-        }
-    }
+        auto* object = game->GetObject<GameObject>(id);
+        if (!object)
+            return Iteration::Continue;
+        return func(*object);
+    });
+}
+
+void GameObject::GetInRangeIds(Ranges range, ea::vector<uint32_t>& result) const
+{
+    ranges_.GetIds(range, result);
 }
 
 }
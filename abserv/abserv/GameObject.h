@@ -22,7 +22,8 @@
 #pragma once
 
 #include <abshared/Damage.h>
-#include "Octree.h"
+#include "InterestRanges.h"
+#include "SpatialIndex.h"
 #include "StateComp.h"
 #include <AB/Entities/Character.h>
 #include <AB/Entities/Skill.h>
@@ -77,6 +78,8 @@ inline constexpr sa::event_t EVENT_ON_TRIGGER = sa::StringHash("OnTrigger");
 inline constexpr sa::event_t EVENT_ON_STATECHANGE = sa::StringHash("OnStateChange");
 inline constexpr sa::event_t EVENT_ON_INTERACT = sa::StringHash("OnInteract");
 inline constexpr sa::event_t EVENT_ON_CANCELALL = sa::StringHash("OnCancelAll");
+inline constexpr sa::event_t EVENT_ON_ENTERRANGE = sa::StringHash("OnEnterRange");
+inline constexpr sa::event_t EVENT_ON_LEAVERANGE = sa::StringHash("OnLeaveRange");
 
 using GameObjectEvents = sa::Events<
     void(void),
@@ -86,6 +89,7 @@ using GameObjectEvents = sa::Events<
     void(AB::GameProtocol::CreatureState, AB::GameProtocol::CreatureState),                   // OnStateChange(old,new)
     void(int, int),
     void(GameObject*),
+    void(GameObject*, Ranges),                               // OnEnterRange, OnLeaveRange
     void(Actor*),
     void(Skill*),
     void(Actor*, Actor*),
@@ -99,12 +103,10 @@ using GameObjectEvents = sa::Events<
     void(AB::GameProtocol::CommandType, const std::string&, Net::NetworkMessage&)
 >;
 
-inline const float AVERAGE_BB_EXTENDS = 0.3f;
-
 class GameObject : public ea::enable_shared_from_this<GameObject>
 {
-    friend class Math::Octant;
-    friend class Math::Octree;
+    friend class Math::OctreeIndex<GameObject>;
+    friend class Math::GridIndex<GameObject>;
     NON_COPYABLE(GameObject)
 public:
     static sa::IdGenerator<uint32_t> objectIds_;
@@ -148,17 +150,21 @@ protected:
     Utils::VariantMap variables_;
     ea::weak_ptr<Game> game_;
     GameObjectEvents events_;
-    /// Octree octant.
-    Math::Octant* octant_{ nullptr };
+    /// Spatial index of the map, when the object is in the scene
+    SpatialIndex* spatialIndex_{ nullptr };
+    /// Octree octant, when the map uses an Octree.
+    Octant* octant_{ nullptr };
+    /// ID in the grid, when the map uses a grid
+    Math::LooseGrid<GameObject>::Id gridId_{ Math::LooseGrid<GameObject>::INVALID_ID };
     float sortValue_{ 0.0f };
-    ea::map<Ranges, ea::set<uint32_t>> ranges_;
-    void UpdateRanges();
+    /// Objects in range, updated by the Game each tick
+    InterestRanges ranges_;
     uint32_t GetNewId()
     {
         return objectIds_.Next();
     }
-    void AddToOctree();
-    void RemoveFromOctree();
+    void AddToSpatialIndex();
+    void RemoveFromSpatialIndex();
 public:
     static void RegisterLua(kaguya::State& state);
     /// Let's make the head 1.7m above the ground
@@ -189,10 +195,10 @@ public:
     bool IsInOutpost() const;
     virtual void SetGame(ea::shared_ptr<Game> game)
     {
-        RemoveFromOctree();
+        RemoveFromSpatialIndex();
         game_ = game;
         if (game)
-            AddToOctree();
+            AddToSpatialIndex();
         hasGame_ = !!game;
     }
     bool HasGame() const { return hasGame_; }
@@ -221,12 +227,19 @@ public:
         return transformation_.position_.Distance(other->transformation_.position_);
     }
 
+    InterestRanges& GetInterestRanges() { return ranges_; }
+    /// Whether this object is added to the interest ranges of others
+    bool IsRangeNeighbour() const { return GetType() > AB::GameProtocol::GameObjectType::__SentToPlayer; }
+    /// Emit the enter/leave range events after the Game updated the ranges
+    void CallRangeEvents();
     /// Test if object is in our range
     bool IsInRange(Ranges range, const GameObject* object) const;
     /// Check if the object is within maxDist
     bool IsCloserThan(float maxDist, const GameObject* object) const;
     /// Allows to execute a functor/lambda on the objects in range
     void VisitInRange(Ranges range, const std::function<Iteration(GameObject&)>& func) const;
+    /// Get the IDs of the objects in range sorted by ID, without looking them up
+    void GetInRangeIds(Ranges range, ea::vector<uint32_t>& result) const;
     /// Returns the closest actor or nullptr
     /// @param[in] undestroyable If true include undestroyable actors
     /// @param[in] unselectable If true includes unselectable actors
@@ -250,25 +263,31 @@ public:
 
     const Utils::Variant& GetVar(const std::string& name) const;
     void SetVar(const std::string& name, const Utils::Variant& val);
-    /// Process octree raycast.
-    virtual void ProcessRayQuery(const Math::RayOctreeQuery& query, ea::vector<Math::RayQueryResult>& results);
+    /// Process spatial index raycast.
+    virtual void ProcessRayQuery(const RayQuery& query, ea::vector<RayQueryResult>& results);
     void SetSortValue(float value) { sortValue_ = value; }
     float GetSortValue() const { return sortValue_; }
 
     /// Return octree octant.
-    Math::Octant* GetOctant() const
+    Octant* GetOctant() const
     {
         return octant_;
     }
     /// Move into another octree octant.
-    void SetOctant(Math::Octant* octant)
+    void SetOctant(Octant* octant)
     {
         octant_ = octant;
     }
+    /// The object moved, update it in the spatial index with the next update
+    void AddSpatialIndexUpdate()
+    {
+        if (spatialIndex_)
+            spatialIndex_->AddObjectUpdate(this);
+    }
 
     bool Raycast(ea::vector<GameObject*>& result, const Math::Vector3& direction, float maxDist = Math::M_INFINITE) const;
     bool Raycast(ea::vector<GameObject*>& result, const Math::Vector3& position, const Math::Vector3& direction, float maxDist = Math::M_INFINITE) const;
-    bool RaycastWithResult(ea::vector<Math::RayQueryResult>& result, const Math::Vector3& position, const Math::Vector3& direction, float maxDist = Math::M_INFINITE) const;
+    bool RaycastWithResult(ea::vector<RayQueryResult>& result, const Math::Vector3& position, const Math::Vector3& direction, float maxDist = Math::M_INFINITE) const;
     bool IsObjectInSight(const GameObject& object) const;
     /// Remove this object from scene
     void Remove();
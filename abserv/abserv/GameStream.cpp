@@ -21,64 +21,293 @@
 
 
 #include "GameStream.h"
-#include "Game.h"
+#include <algorithm>
+#include <cstring>
 #include <abscommon/FileUtils.h>
+#include <abscommon/Logger.h>
+#include <abscommon/NetworkMessage.h>
+#include <abscommon/Subsystems.h>
+#include <abscommon/ThreadPool.h>
+#include <lz4.h>
+#include <sa/time.h>
 
 namespace IO {
 
-static constexpr int16_t REC_FILE_VERSION = 1;
+static constexpr int16_t REC_FILE_VERSION = 2;
+/// Uncompressed size at which a block is handed to the writer
+static constexpr size_t REC_BLOCK_SIZE = 64 * 1024;
+/// Offset of the index offset in the header
+static constexpr std::streamoff REC_INDEX_OFFSET_POS = 4 + sizeof(REC_FILE_VERSION);
+/// compressed size, uncompressed size, time, count, flags
+static constexpr size_t REC_BLOCK_HEADER_SIZE = sizeof(uint32_t) * 4 + sizeof(uint8_t);
+
+/// Owns the file. Blocks are pushed by the game thread, compressed and written
+/// by a thread pool task. Only one task drains the queue at a time.
+class GameRecordWriter : public std::enable_shared_from_this<GameRecordWriter>
+{
+private:
+    std::fstream stream_;
+    sa::MPSCQueue<GameWriteStream::Block*, 256> queue_;
+    std::atomic<bool> draining_{ false };
+    std::atomic<bool> closed_{ false };
+    bool finalized_{ false };
+    /// Blocks the game could not push before closing
+    std::deque<std::unique_ptr<GameWriteStream::Block>> leftover_;
+    std::vector<GameRecordIndexEntry> index_;
+    std::vector<char> compressed_;
+    void Schedule();
+    void Drain();
+    void WriteBlock(const GameWriteStream::Block& block);
+    void Finalize();
+public:
+    ~GameRecordWriter();
+    bool Open(const std::string& filename, const std::string& gameUuid, int64_t startTime);
+    bool Push(GameWriteStream::Block* block);
+    void Close(std::deque<std::unique_ptr<GameWriteStream::Block>>&& leftover);
+};
+
+GameRecordWriter::~GameRecordWriter()
+{
+    // The thread pool may already be stopped when the server shuts down
+    GameWriteStream::Block* block = nullptr;
+    while (queue_.Dequeue(block))
+    {
+        std::unique_ptr<GameWriteStream::Block> b(block);
+        if (!finalized_)
+            WriteBlock(*b);
+    }
+    if (!finalized_)
+        Finalize();
+}
+
+bool GameRecordWriter::Open(const std::string& filename, const std::string& gameUuid, int64_t startTime)
+{
+    stream_.open(filename, std::ios::binary | std::fstream::out);
+    if (!stream_.is_open())
+        return false;
+
+    stream_.write((char*)"REC\0", 4);
+    stream_.write((char*)&REC_FILE_VERSION, sizeof(REC_FILE_VERSION));
+    // Placeholder for the index offset
+    static const uint64_t PLACEHOLDER = 0;
+    stream_.write((char*)&PLACEHOLDER, sizeof(PLACEHOLDER));
+
+    stream_.write((char*)gameUuid.c_str(), 36);
+    stream_.write((char*)&startTime, sizeof(startTime));
+    return true;
+}
+
+bool GameRecordWriter::Push(GameWriteStream::Block* block)
+{
+    if (!queue_.Enqueue(block))
+        return false;
+    Schedule();
+    return true;
+}
+
+void GameRecordWriter::Close(std::deque<std::unique_ptr<GameWriteStream::Block>>&& leftover)
+{
+    leftover_ = std::move(leftover);
+    closed_.store(true, std::memory_order_release);
+    Schedule();
+}
+
+void GameRecordWriter::Schedule()
+{
+    bool expected = false;
+    if (!draining_.compare_exchange_strong(expected, true))
+        // A task is already running and will pick it up
+        return;
+    auto self = shared_from_this();
+    GetSubsystem<Asynch::ThreadPool>()->Enqueue([self]()
+    {
+        self->Drain();
+    });
+}
+
+void GameRecordWriter::Drain()
+{
+    for (;;)
+    {
+        GameWriteStream::Block* block = nullptr;
+        while (queue_.Dequeue(block))
+        {
+            std::unique_ptr<GameWriteStream::Block> b(block);
+            WriteBlock(*b);
+        }
+        if (closed_.load(std::memory_order_acquire) && !finalized_)
+        {
+            while (queue_.Dequeue(block))
+            {
+                std::unique_ptr<GameWriteStream::Block> b(block);
+                WriteBlock(*b);
+            }
+            Finalize();
+        }
+
+        draining_.store(false, std::memory_order_release);
+        // Something may have been pushed after the queue was empty but before we
+        // released draining_, in this case the producer didn't schedule a new task.
+        if (queue_.IsEmpty() && (finalized_ || !closed_.load(std::memory_order_acquire)))
+            return;
+        bool expected = false;
+        if (!draining_.compare_exchange_strong(expected, true))
+            return;
+    }
+}
+
+void GameRecordWriter::WriteBlock(const GameWriteStream::Block& block)
+{
+    if (block.data.empty() || finalized_)
+        return;
+
+    const int rawSize = static_cast<int>(block.data.size());
+    compressed_.resize(static_cast<size_t>(LZ4_compressBound(rawSize)));
+    const int size = LZ4_compress_default(reinterpret_cast<const char*>(block.data.data()),
+        compressed_.data(), rawSize, static_cast<int>(compressed_.size()));
+    if (size <= 0)
+    {
+        LOG_ERROR << "Failed to compress block" << std::endl;
+        return;
+    }
+
+    const uint64_t offset = static_cast<uint64_t>(stream_.tellp());
+    const uint32_t compressedSize = static_cast<uint32_t>(size);
+    const uint32_t uncompressedSize = static_cast<uint32_t>(rawSize);
+    stream_.write((char*)&compressedSize, sizeof(compressedSize));
+    stream_.write((char*)&uncompressedSize, sizeof(uncompressedSize));
+    stream_.write((char*)&block.time, sizeof(block.time));
+    stream_.write((char*)&block.count, sizeof(block.count));
+    stream_.write((char*)&block.flags, sizeof(block.flags));
+    stream_.write(compressed_.data(), size);
+    index_.push_back({ block.time, offset, block.flags });
+}
+
+void GameRecordWriter::Finalize()
+{
+    for (const auto& block : leftover_)
+        WriteBlock(*block);
+    leftover_.clear();
+
+    const uint64_t indexOffset = static_cast<uint64_t>(stream_.tellp());
+    stream_.write((char*)"IDX\0", 4);
+    const uint32_t count = static_cast<uint32_t>(index_.size());
+    stream_.write((char*)&count, sizeof(count));
+    for (const auto& entry : index_)
+    {
+        stream_.write((char*)&entry.time, sizeof(entry.time));
+        stream_.write((char*)&entry.offset, sizeof(entry.offset));
+        stream_.write((char*)&entry.flags, sizeof(entry.flags));
+    }
+
+    stream_.seekp(REC_INDEX_OFFSET_POS, std::ios::beg);
+    stream_.write((char*)&indexOffset, sizeof(indexOffset));
+    stream_.close();
+    finalized_ = true;
+}
 
 GameWriteStream::~GameWriteStream()
 {
     Close();
 }
 
-bool GameWriteStream::Open(const std::string& dir, Game::Game* game)
+uint32_t GameWriteStream::GetTime() const
 {
-    filename_ = Utils::AddSlash(dir) + game->instanceData_.uuid + ".rec";
-    stream_.open(filename_, std::ios::binary | std::fstream::out);
-    open_ = stream_.is_open();
+    return static_cast<uint32_t>(sa::time::time_elapsed(startTime_));
+}
+
+bool GameWriteStream::Open(const std::string& dir, const std::string& instance,
+    const std::string& gameUuid, int64_t startTime)
+{
+    filename_ = Utils::AddSlash(dir) + instance + ".rec";
+    writer_ = std::make_shared<GameRecordWriter>();
+    open_ = writer_->Open(filename_, gameUuid, startTime);
     if (open_)
     {
-        // Write header
-        stream_.write((char*)"REC\0", 4);
-        stream_.write((char*)&REC_FILE_VERSION, sizeof(REC_FILE_VERSION));
-        // Placeholder for size
-        static const size_t PLACEHOLDER = 0;
-        stream_.write((char*)&PLACEHOLDER, sizeof(size_t));
-
-        stream_.write((char*)game->data_.uuid.c_str(), 36);
-        stream_.write((char*)&game->startTime_, sizeof(decltype(game->startTime_)));
+        startTime_ = startTime;
+        // The first block is always a keyframe
+        lastKeyframe_ = 0;
     }
     else
     {
+        writer_.reset();
         LOG_ERROR << "Unable to open file for writing: " << filename_ << std::endl;
     }
     return open_;
 }
 
+void GameWriteStream::Flush()
+{
+    if (current_ && !current_->data.empty())
+        overflow_.push_back(std::move(current_));
+    current_.reset();
+
+    while (!overflow_.empty())
+    {
+        // Hand over ownership only when the writer accepted it
+        if (!writer_->Push(overflow_.front().get()))
+            break;
+        overflow_.front().release();
+        overflow_.pop_front();
+    }
+}
+
 void GameWriteStream::Close()
 {
     if (open_)
     {
-        // Write size
-        stream_.seekp(4 + sizeof(REC_FILE_VERSION), std::ios::beg);
-        stream_.write((char*)&size_, sizeof(size_t));
-
-        stream_.close();
+        Flush();
+        writer_->Close(std::move(overflow_));
+        overflow_.clear();
+        // The writer finishes the file on the thread pool and is deleted with the last task
+        writer_.reset();
         open_ = false;
     }
 }
 
 void GameWriteStream::Write(const Net::NetworkMessage& msg)
 {
-    if (open_)
+    if (!open_)
+        return;
+
+    if (!current_)
     {
-        uint32_t size = static_cast<uint32_t>(msg.GetSize());
-        size_ += size;
-        stream_.write((char*)&size, sizeof(size));
-        stream_.write((char*)msg.GetBuffer(), size);
+        current_ = std::make_unique<Block>();
+        current_->time = GetTime();
+        current_->data.reserve(REC_BLOCK_SIZE + Net::NETWORKMESSAGE_MAXSIZE);
     }
+
+    const uint32_t size = static_cast<uint32_t>(msg.GetSize());
+    const auto* body = msg.GetBuffer() + Net::NetworkMessage::INITIAL_BUFFER_POSITION;
+    auto& data = current_->data;
+    const size_t pos = data.size();
+    data.resize(pos + sizeof(size) + size);
+    memcpy(data.data() + pos, &size, sizeof(size));
+    memcpy(data.data() + pos + sizeof(size), body, size);
+    ++current_->count;
+
+    if (data.size() >= REC_BLOCK_SIZE)
+        Flush();
+}
+
+void GameWriteStream::BeginKeyframe()
+{
+    if (!open_)
+        return;
+
+    Flush();
+    current_ = std::make_unique<Block>();
+    current_->time = GetTime();
+    current_->flags = REC_BLOCK_KEYFRAME;
+    current_->data.reserve(REC_BLOCK_SIZE + Net::NETWORKMESSAGE_MAXSIZE);
+    lastKeyframe_ = sa::time::tick();
+}
+
+bool GameWriteStream::NeedsKeyframe() const
+{
+    if (!open_)
+        return false;
+    return lastKeyframe_ == 0 || sa::time::time_elapsed(lastKeyframe_) >= REC_KEYFRAME_INTERVAL;
 }
 
 GameReadStream::~GameReadStream()
@@ -98,8 +327,7 @@ bool GameReadStream::Open(const std::string& dir, const std::string& instance)
         if (header[0] != 'R' || header[1] != 'E' || header[2] != 'C' || header[3] != '\0')
         {
             LOG_ERROR << "Wrong file header" << std::endl;
-            stream_.close();
-            open_ = false;
+            Close();
             return false;
         }
         int16_t version;
@@ -107,15 +335,27 @@ bool GameReadStream::Open(const std::string& dir, const std::string& instance)
         if (version != REC_FILE_VERSION)
         {
             LOG_ERROR << "Wrong file version, got " << version << ", expected " << REC_FILE_VERSION << std::endl;
-            stream_.close();
-            open_ = false;
+            Close();
             return false;
         }
-        stream_.read((char*)&size_, sizeof(size_t));
+        uint64_t indexOffset = 0;
+        stream_.read((char*)&indexOffset, sizeof(indexOffset));
 
         gameUuid_.resize(36);
         stream_.read((char*)gameUuid_.data(), 36);
         stream_.read((char*)&startTime_, sizeof(startTime_));
+
+        // When the server crashed there is no index, but the blocks are still there.
+        const bool hasIndex = indexOffset != 0 && ReadIndex(indexOffset);
+        if (!hasIndex && !ScanBlocks())
+        {
+            LOG_ERROR << "Recording is corrupted: " << filename << std::endl;
+            Close();
+            return false;
+        }
+        nextBlock_ = 0;
+        block_.clear();
+        blockPos_ = 0;
     }
     else
         LOG_ERROR << "Unable to open file for reading: " << filename << std::endl;
@@ -123,6 +363,102 @@ bool GameReadStream::Open(const std::string& dir, const std::string& instance)
     return open_;
 }
 
+bool GameReadStream::ReadIndex(uint64_t offset)
+{
+    stream_.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+    char header[4] = { 0 };
+    stream_.read((char*)&header, 4);
+    if (!stream_ || header[0] != 'I' || header[1] != 'D' || header[2] != 'X' || header[3] != '\0')
+    {
+        stream_.clear();
+        return false;
+    }
+    uint32_t count = 0;
+    stream_.read((char*)&count, sizeof(count));
+    index_.clear();
+    index_.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        GameRecordIndexEntry entry;
+        stream_.read((char*)&entry.time, sizeof(entry.time));
+        stream_.read((char*)&entry.offset, sizeof(entry.offset));
+        stream_.read((char*)&entry.flags, sizeof(entry.flags));
+        if (!stream_)
+        {
+            stream_.clear();
+            index_.clear();
+            return false;
+        }
+        index_.push_back(entry);
+    }
+    return true;
+}
+
+bool GameReadStream::ScanBlocks()
+{
+    index_.clear();
+    stream_.clear();
+    const std::streamoff first = REC_INDEX_OFFSET_POS + sizeof(uint64_t) + 36 + sizeof(startTime_);
+    stream_.seekg(0, std::ios::end);
+    const uint64_t fileSize = static_cast<uint64_t>(stream_.tellg());
+    uint64_t offset = static_cast<uint64_t>(first);
+    while (offset + REC_BLOCK_HEADER_SIZE <= fileSize)
+    {
+        stream_.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+        uint32_t compressedSize = 0;
+        uint32_t uncompressedSize = 0;
+        GameRecordIndexEntry entry;
+        uint32_t count = 0;
+        stream_.read((char*)&compressedSize, sizeof(compressedSize));
+        stream_.read((char*)&uncompressedSize, sizeof(uncompressedSize));
+        stream_.read((char*)&entry.time, sizeof(entry.time));
+        stream_.read((char*)&count, sizeof(count));
+        stream_.read((char*)&entry.flags, sizeof(entry.flags));
+        // Stop at a truncated block
+        if (!stream_ || offset + REC_BLOCK_HEADER_SIZE + compressedSize > fileSize)
+            break;
+        entry.offset = offset;
+        index_.push_back(entry);
+        offset += REC_BLOCK_HEADER_SIZE + compressedSize;
+    }
+    stream_.clear();
+    return !index_.empty();
+}
+
+bool GameReadStream::ReadBlock()
+{
+    if (nextBlock_ >= index_.size())
+        return false;
+
+    const auto& entry = index_[nextBlock_];
+    ++nextBlock_;
+    stream_.seekg(static_cast<std::streamoff>(entry.offset), std::ios::beg);
+    uint32_t compressedSize = 0;
+    uint32_t uncompressedSize = 0;
+    stream_.read((char*)&compressedSize, sizeof(compressedSize));
+    stream_.read((char*)&uncompressedSize, sizeof(uncompressedSize));
+    stream_.seekg(sizeof(uint32_t) * 2 + sizeof(uint8_t), std::ios::cur);
+    if (!stream_)
+        return false;
+
+    std::vector<char> compressed(compressedSize);
+    stream_.read(compressed.data(), compressedSize);
+    if (!stream_)
+        return false;
+
+    block_.resize(uncompressedSize);
+    const int size = LZ4_decompress_safe(compressed.data(), reinterpret_cast<char*>(block_.data()),
+        static_cast<int>(compressedSize), static_cast<int>(uncompressedSize));
+    if (size < 0 || static_cast<uint32_t>(size) != uncompressedSize)
+    {
+        LOG_ERROR << "Failed to decompress block at " << entry.offset << std::endl;
+        block_.clear();
+        return false;
+    }
+    blockPos_ = 0;
+    return true;
+}
+
 void GameReadStream::Close()
 {
     if (open_)
@@ -130,21 +466,54 @@ void GameReadStream::Close()
         stream_.close();
         open_ = false;
     }
+    index_.clear();
+    block_.clear();
 }
 
 bool GameReadStream::Read(Net::NetworkMessage& msg)
 {
-    if (stream_.eof())
+    if (!open_)
+        return false;
+
+    while (blockPos_ + sizeof(uint32_t) > block_.size())
+    {
+        if (!ReadBlock())
+            return false;
+    }
+
+    uint32_t size = 0;
+    memcpy(&size, block_.data() + blockPos_, sizeof(size));
+    blockPos_ += sizeof(size);
+    if (blockPos_ + size > block_.size() ||
+        size > Net::NetworkMessage::NETWORKMESSAGE_BUFFER_SIZE - Net::NetworkMessage::INITIAL_BUFFER_POSITION)
         return false;
 
-    uint32_t size;
-    stream_.read((char*)&size, sizeof(uint32_t));
-    if (read_ + size > size_)
+    msg.Reset();
+    memcpy(msg.GetBuffer() + Net::NetworkMessage::INITIAL_BUFFER_POSITION, block_.data() + blockPos_, size);
+    msg.SetSize(static_cast<Net::NetworkMessage::MsgSize_t>(size));
+    blockPos_ += size;
+    return true;
+}
+
+bool GameReadStream::Seek(uint32_t time)
+{
+    if (!open_ || index_.empty())
+        return false;
+
+    size_t found = index_.size();
+    for (size_t i = 0; i < index_.size(); ++i)
+    {
+        if (index_[i].time > time)
+            break;
+        if (index_[i].flags & REC_BLOCK_KEYFRAME)
+            found = i;
+    }
+    if (found == index_.size())
         return false;
 
-    auto* buff = msg.GetBuffer();
-    stream_.read((char*)buff, size);
-    size_ += size;
+    nextBlock_ = found;
+    block_.clear();
+    blockPos_ = 0;
     return true;
 }
 
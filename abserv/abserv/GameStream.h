@@ -21,50 +21,105 @@
 
 #pragma once
 
-#include <string>
+#include <atomic>
+#include <deque>
 #include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sa/MPSCQueue.h>
 
 /// File Format
 ///  =============== Header ===============
 ///   4 Byte: Header == REC\0
 ///   sizeof(int16_t) Byte: File version == REC_FILE_VERSION
-///   sizeof(uint32_t) Byte: overall size of network messages
+///   sizeof(uint64_t) Byte: Offset of the index, 0 when the file was not closed
 ///   char[36]: Game UUID
 ///   sizeof(int64_t) Byte: Game start time
 ///  ================ Body ================
-///   --------- Network message ----------
-///   sizeof(int32_t) Byte: Size of message
-///   size Byte: The message
+///   -------------- Block ---------------
+///   sizeof(uint32_t) Byte: Compressed size
+///   sizeof(uint32_t) Byte: Uncompressed size
+///   sizeof(uint32_t) Byte: Game time of the first message in ms
+///   sizeof(uint32_t) Byte: Number of messages
+///   sizeof(uint8_t) Byte: Flags, REC_BLOCK_KEYFRAME
+///   Compressed size Byte: LZ4 compressed network messages
+///     --------- Network message --------
+///     sizeof(uint32_t) Byte: Size of message
+///     size Byte: The message
+///     ----------------------------------
 ///   ------------------------------------
 ///   ...
+///  =============== Index ================
+///   4 Byte: IDX\0
+///   sizeof(uint32_t) Byte: Number of blocks
+///   --------- Entry, for each block ------
+///   sizeof(uint32_t) Byte: Game time of the block
+///   sizeof(uint64_t) Byte: Offset of the block
+///   sizeof(uint8_t) Byte: Flags of the block
+///
+/// A keyframe block starts with the spawn data of all objects (ObjectSpawnExisting),
+/// a replay can start at any keyframe.
 
 namespace Net {
 class NetworkMessage;
 }
 
-namespace Game {
-class Game;
-}
-
 namespace IO {
 
+static constexpr uint8_t REC_BLOCK_KEYFRAME = 1;
+/// Game time between keyframes in ms
+static constexpr uint32_t REC_KEYFRAME_INTERVAL = 10000;
+
+struct GameRecordIndexEntry
+{
+    uint32_t time;
+    uint64_t offset;
+    uint8_t flags;
+};
+
+class GameRecordWriter;
+
+/// Collects the messages of a game in blocks. The blocks are compressed and written
+/// by the background thread pool, so recording doesn't add disk latency to the game.
 class GameWriteStream
 {
+public:
+    struct Block
+    {
+        uint32_t time{ 0 };
+        uint32_t count{ 0 };
+        uint8_t flags{ 0 };
+        std::vector<uint8_t> data;
+    };
 private:
-    std::fstream stream_;
+    std::shared_ptr<GameRecordWriter> writer_;
+    std::unique_ptr<Block> current_;
+    /// Blocks which did not fit into the writer queue
+    std::deque<std::unique_ptr<Block>> overflow_;
     bool open_;
-    size_t size_;
+    int64_t startTime_;
+    int64_t lastKeyframe_;
     std::string filename_;
+    uint32_t GetTime() const;
+    void Flush();
 public:
     GameWriteStream() :
         open_(false),
-        size_(0)
+        startTime_(0),
+        lastKeyframe_(0)
     { }
     ~GameWriteStream();
 
-    bool Open(const std::string& dir, Game::Game* game);
+    /// Records to dir/instance.rec. startTime is the start time of the game, block
+    /// times are relative to it.
+    bool Open(const std::string& dir, const std::string& instance,
+        const std::string& gameUuid, int64_t startTime);
     void Close();
     void Write(const Net::NetworkMessage& msg);
+    /// Start a new keyframe block, the following messages should contain the complete game state
+    void BeginKeyframe();
+    bool NeedsKeyframe() const;
     bool IsOpen() const
     {
         return open_;
@@ -78,21 +133,30 @@ private:
     std::fstream stream_;
     bool open_;
     int64_t startTime_;
-    uint32_t read_;
-    uint32_t size_;
     std::string gameUuid_;
+    std::vector<GameRecordIndexEntry> index_;
+    /// Next block in index_
+    size_t nextBlock_;
+    /// Uncompressed messages of the current block
+    std::vector<uint8_t> block_;
+    size_t blockPos_;
+    bool ReadIndex(uint64_t offset);
+    bool ScanBlocks();
+    bool ReadBlock();
 public:
     GameReadStream() :
         open_(false),
         startTime_(0),
-        read_(0),
-        size_(0)
+        nextBlock_(0),
+        blockPos_(0)
     { }
     ~GameReadStream();
 
     bool Open(const std::string& dir, const std::string& instance);
     void Close();
     bool Read(Net::NetworkMessage& msg);
+    /// Continue reading at the last keyframe at or before time
+    bool Seek(uint32_t time);
     bool IsOpen() const
     {
         return open_;
@@ -101,6 +165,8 @@ public:
     {
         return gameUuid_;
     }
+    int64_t GetStartTime() const { return startTime_; }
+    const std::vector<GameRecordIndexEntry>& GetIndex() const { return index_; }
 };
 
 }
@@ -426,6 +426,8 @@ bool Load(Game::Map& map)
         return false;
     }
 
+    // The scene sets the transformation of the terrain
+    map.FitSpatialIndex();
     map.CreatePatches();
     // After loading the Scene add terrain patches as game objects
     for (size_t i = 0; i < map.GetPatchesCount(); ++i)
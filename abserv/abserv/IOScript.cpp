@@ -21,12 +21,31 @@
 
 
 #include "IOScript.h"
+#include "ConfigManager.h"
+#include <cstdio>
+#include <fstream>
 #include <lua.hpp>
 #include <llimits.h>
 #include <sa/ScopeGuard.h>
+#include <sa/StringHash.h>
 
 namespace IO {
 
+static const int BYTECODE_MAGIC = 'L' << 24 | 'U' << 16 | 'A' << 8 | 'C'; //'LUAC';
+
+/// Header of a bytecode file. The source size and hash tell if it was
+/// compiled from the current source, the bytecode size and hash if the
+/// file is complete.
+struct BytecodeHeader
+{
+    int magic;
+    int luaVersion;
+    uint64_t sourceSize;
+    uint64_t sourceHash;
+    uint64_t bytecodeSize;
+    uint64_t bytecodeHash;
+};
+
 static int writer(lua_State*, const void* p, size_t size, void* u)
 {
     if (size == 0)
@@ -37,20 +56,130 @@ static int writer(lua_State*, const void* p, size_t size, void* u)
     return 0;
 }
 
+static bool ReadSource(const std::string& name, ea::vector<char>& source)
+{
+    std::ifstream f(name, std::ios::binary | std::ios::ate);
+    if (!f.is_open())
+        return false;
+    const auto size = f.tellg();
+    if (size < 0)
+        return false;
+    source.resize(static_cast<size_t>(size));
+    f.seekg(0);
+    return static_cast<bool>(f.read(source.data(), size));
+}
+
+static bool LoadBytecode(const std::string& name, const BytecodeHeader& expected, ea::vector<char>& buffer)
+{
+    std::ifstream f(name, std::ios::binary | std::ios::ate);
+    if (!f.is_open())
+        return false;
+    const auto size = f.tellg();
+    if (size <= static_cast<std::streamoff>(sizeof(BytecodeHeader)))
+        return false;
+    f.seekg(0);
+    BytecodeHeader header;
+    if (!f.read(reinterpret_cast<char*>(&header), sizeof(BytecodeHeader)))
+        return false;
+    if (header.magic != expected.magic || header.luaVersion != expected.luaVersion ||
+        header.sourceSize != expected.sourceSize || header.sourceHash != expected.sourceHash)
+        // Compiled from another version of the source
+        return false;
+    if (header.bytecodeSize != static_cast<uint64_t>(size) - sizeof(BytecodeHeader))
+    {
+        LOG_WARNING << "Bytecode file " << name << " is truncated" << std::endl;
+        return false;
+    }
+    buffer.resize(static_cast<size_t>(header.bytecodeSize));
+    if (!f.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) ||
+        sa::StringHashRt(buffer.data(), buffer.size()) != header.bytecodeHash)
+    {
+        LOG_WARNING << "Bytecode file " << name << " is corrupt" << std::endl;
+        buffer.clear();
+        return false;
+    }
+    return true;
+}
+
+static void SaveBytecode(const std::string& name, BytecodeHeader header, const ea::vector<char>& buffer)
+{
+    header.bytecodeSize = buffer.size();
+    header.bytecodeHash = sa::StringHashRt(buffer.data(), buffer.size());
+
+    // Write to a temporary file first, a crash while writing or another server
+    // loading the script at the same time never sees a partial file.
+    const std::string tempName = name + ".tmp";
+    {
+        std::ofstream f(tempName, std::ios::binary | std::ios::trunc);
+        if (!f.is_open())
+        {
+            LOG_WARNING << "Unable to write bytecode file " << tempName << std::endl;
+            return;
+        }
+        f.write(reinterpret_cast<const char*>(&header), sizeof(BytecodeHeader));
+        f.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        f.close();
+        if (!f)
+        {
+            LOG_WARNING << "Error writing bytecode file " << tempName << std::endl;
+            std::remove(tempName.c_str());
+            return;
+        }
+    }
+    if (std::rename(tempName.c_str(), name.c_str()) != 0)
+    {
+        // Windows does not replace an existing file
+        std::remove(name.c_str());
+        if (std::rename(tempName.c_str(), name.c_str()) != 0)
+        {
+            LOG_WARNING << "Unable to rename " << tempName << " to " << name << std::endl;
+            std::remove(tempName.c_str());
+        }
+    }
+}
+
 bool IOScript::Import(Game::Script& asset, const std::string& name)
 {
+    asset.GetBuffer().clear();
+
+    ea::vector<char> source;
+    if (!ReadSource(name, source))
+    {
+        LOG_ERROR << "Unable to read file " << name << std::endl;
+        return false;
+    }
+
+    BytecodeHeader header;
+    memset(&header, 0, sizeof(BytecodeHeader));
+    header.magic = BYTECODE_MAGIC;
+    header.luaVersion = LUA_VERSION_NUM;
+    header.sourceSize = source.size();
+    header.sourceHash = sa::StringHashRt(source.data(), source.size());
+
+    // The bytecode is stored next to the source, e.g. script.lua -> script.luac.
+    // When the source changes, e.g. hot reloading, the hash does not match and
+    // it's compiled again.
+    const bool useCache = (*GetSubsystem<ConfigManager>())[ConfigManager::Key::ScriptBytecodeCache].GetBool();
+    const std::string bytecodeFile = name + "c";
+    if (useCache && LoadBytecode(bytecodeFile, header, asset.GetBuffer()))
+        return true;
+
     // https://stackoverflow.com/questions/8936369/compile-lua-code-store-bytecode-then-load-and-execute-it
     // https://stackoverflow.com/questions/17597816/lua-dump-in-c
     lua_State* L;
     L = luaL_newstate();
 
-    asset.GetBuffer().clear();
     sa::ScopeGuard luaGuard([&L]()
     {
         lua_close(L);
     });
 
-    int ret = luaL_loadfile(L, name.c_str());
+    // Skip an UTF-8 BOM like luaL_loadfile() does
+    size_t offset = 0;
+    if (source.size() >= 3 && memcmp(source.data(), "\xEF\xBB\xBF", 3) == 0)
+        offset = 3;
+    const std::string chunkName = "@" + name;
+    int ret = luaL_loadbufferx(L, source.data() + offset, source.size() - offset, chunkName.c_str(), "t");
     if (ret != LUA_OK)
     {
         LOG_ERROR << "Compile error: " << lua_tostring(L, -1) << std::endl;
@@ -60,6 +189,9 @@ bool IOScript::Import(Game::Script& asset, const std::string& name)
     lua_dump(L, writer, &asset, 1);
     lua_unlock(L);
 
+    if (useCache)
+        SaveBytecode(bytecodeFile, header, asset.GetBuffer());
+
     return true;
 }
 
@@ -0,0 +1,85 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "InterestRanges.h"
+
+namespace Game {
+
+uint16_t InterestRanges::GetMask(float dist)
+{
+    uint16_t result = 0;
+    for (unsigned r = static_cast<unsigned>(Ranges::Aggro); r < static_cast<unsigned>(Ranges::Map); ++r)
+    {
+        if (dist <= RangeDistances[r])
+            result |= static_cast<uint16_t>(1u << r);
+    }
+    return result;
+}
+
+void InterestRanges::Begin()
+{
+    // Swap, so we don't need to allocate new memory each tick
+    prevRanges_.swap(ranges_);
+    ranges_.clear();
+}
+
+bool InterestRanges::Has(uint32_t id, size_t count) const
+{
+    const auto end = ranges_.begin() + static_cast<ptrdiff_t>(ea::min(count, ranges_.size()));
+    const auto it = ea::lower_bound(ranges_.begin(), end, id, [](const Neighbour& current, uint32_t value)
+    {
+        return current.id < value;
+    });
+    return it != end && (*it).id == id;
+}
+
+void InterestRanges::End()
+{
+    ea::sort(ranges_.begin(), ranges_.end(), [](const Neighbour& lhs, const Neighbour& rhs)
+    {
+        return lhs.id < rhs.id;
+    });
+}
+
+bool InterestRanges::IsInRange(Ranges range, uint32_t id) const
+{
+    if (range == Ranges::Map)
+        return true;
+    const auto it = ea::lower_bound(ranges_.begin(), ranges_.end(), id, [](const Neighbour& current, uint32_t value)
+    {
+        return current.id < value;
+    });
+    if (it == ranges_.end() || (*it).id != id)
+        return false;
+    return ((*it).ranges & (1u << static_cast<unsigned>(range))) != 0;
+}
+
+void InterestRanges::GetIds(Ranges range, ea::vector<uint32_t>& result) const
+{
+    result.clear();
+    Visit(range, [&result](uint32_t id)
+    {
+        result.push_back(id);
+        return Iteration::Continue;
+    });
+}
+
+}
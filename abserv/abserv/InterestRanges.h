@@ -0,0 +1,164 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <abshared/Mechanic.h>
+#include <absmath/Vector3.h>
+#include <eastl.hpp>
+#include <sa/Iteration.h>
+#include <stdint.h>
+
+namespace Game {
+
+inline const float AVERAGE_BB_EXTENDS = 0.3f;
+
+/// The objects in the interest range of an object, sorted by ID. The Game updates
+/// them once per tick with UpdateInterestRanges(), between the updates range checks
+/// use these values and don't calculate distances.
+class InterestRanges
+{
+public:
+    /// An object in our interest range
+    struct Neighbour
+    {
+        uint32_t id;
+        /// Bit n is set when the object is in Ranges(n)
+        uint16_t ranges;
+    };
+private:
+    ea::vector<Neighbour> ranges_;
+    /// Previous ranges_ to find objects entering and leaving ranges
+    ea::vector<Neighbour> prevRanges_;
+public:
+    /// Returns the ranges a neighbour in distance dist is in as bit mask
+    static uint16_t GetMask(float dist);
+    /// Start a new update. Called for all objects before Add().
+    void Begin();
+    void Add(uint32_t id, uint16_t ranges) { ranges_.push_back({ id, ranges }); }
+    size_t GetCount() const { return ranges_.size(); }
+    /// Returns true if the object is in the first count objects added since Begin().
+    /// These must be sorted.
+    bool Has(uint32_t id, size_t count) const;
+    /// Finish the update
+    void End();
+    bool IsInRange(Ranges range, uint32_t id) const;
+    /// Get the IDs of the objects in range sorted by ID
+    void GetIds(Ranges range, ea::vector<uint32_t>& result) const;
+    /// Call callback(id) for all objects in range until it returns Iteration::Break
+    template<typename Callback>
+    void Visit(Ranges range, Callback&& callback) const
+    {
+        if (range == Ranges::Map)
+            return;
+        const uint16_t bit = static_cast<uint16_t>(1u << static_cast<unsigned>(range));
+        for (const auto& neighbour : ranges_)
+        {
+            if ((neighbour.ranges & bit) == 0)
+                continue;
+            if (callback(neighbour.id) != Iteration::Continue)
+                break;
+        }
+    }
+    /// Call callback(id, oldRanges, newRanges) for all objects whose ranges changed
+    /// with the last update. Objects that left all ranges have newRanges = 0.
+    template<typename Callback>
+    void VisitChanges(Callback&& callback) const
+    {
+        // Both are sorted, so merge them to find the changes
+        auto oldIt = prevRanges_.begin();
+        auto newIt = ranges_.begin();
+        while (oldIt != prevRanges_.end() || newIt != ranges_.end())
+        {
+            if (newIt == ranges_.end() || (oldIt != prevRanges_.end() && (*oldIt).id < (*newIt).id))
+            {
+                callback((*oldIt).id, (*oldIt).ranges, static_cast<uint16_t>(0));
+                ++oldIt;
+            }
+            else if (oldIt == prevRanges_.end() || (*newIt).id < (*oldIt).id)
+            {
+                callback((*newIt).id, static_cast<uint16_t>(0), (*newIt).ranges);
+                ++newIt;
+            }
+            else
+            {
+                if ((*oldIt).ranges != (*newIt).ranges)
+                    callback((*newIt).id, (*oldIt).ranges, (*newIt).ranges);
+                ++oldIt;
+                ++newIt;
+            }
+        }
+    }
+};
+
+/// Update the interest ranges of all objects. The distance between two objects is
+/// calculated only once. objects is a map of ID -> pointer, query(object, result)
+/// fills result with the objects around object and returns false when the object
+/// doesn't look for neighbours. T must have GetId(), GetPosition(), GetInterestRanges()
+/// and IsRangeNeighbour(), objects that aren't neighbours are not added to the
+/// ranges of others.
+template<typename Map, typename T, typename Query>
+void UpdateInterestRanges(const Map& objects, ea::vector<T*>& result, Query&& query)
+{
+    for (const auto& o : objects)
+        o.second->GetInterestRanges().Begin();
+
+    // Objects are visited in the order of their IDs, so an object with a lower ID
+    // already added us when it found us.
+    for (const auto& o : objects)
+    {
+        T& object = *o.second;
+        result.clear();
+        if (!query(object, result))
+            continue;
+        InterestRanges& ranges = object.GetInterestRanges();
+        const uint32_t id = object.GetId();
+        const Math::Vector3& pos = object.GetPosition();
+        // Objects with lower IDs added us in order, so this part is sorted
+        const size_t known = ranges.GetCount();
+        for (T* other : result)
+        {
+            // When it was already visited and found us, we know it already
+            if (other->GetId() >= id || !other->IsRangeNeighbour() || ranges.Has(other->GetId(), known))
+                continue;
+            const uint16_t mask = InterestRanges::GetMask(pos.Distance(other->GetPosition()) - AVERAGE_BB_EXTENDS);
+            if (mask != 0)
+                ranges.Add(other->GetId(), mask);
+        }
+        for (T* other : result)
+        {
+            if (other->GetId() <= id)
+                continue;
+            const uint16_t mask = InterestRanges::GetMask(pos.Distance(other->GetPosition()) - AVERAGE_BB_EXTENDS);
+            if (mask == 0)
+                continue;
+            if (other->IsRangeNeighbour())
+                ranges.Add(other->GetId(), mask);
+            if (object.IsRangeNeighbour())
+                other->GetInterestRanges().Add(id, mask);
+        }
+    }
+
+    for (const auto& o : objects)
+        o.second->GetInterestRanges().End();
+}
+
+}
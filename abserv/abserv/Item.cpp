@@ -49,16 +49,19 @@ void Item::RegisterLua(kaguya::State& state)
 
 Item::Item(const AB::Entities::Item& item) :
     data_(item)
+{ }
+
+Item::~Item()
 {
-    InitializeLua();
+    // May be on a different lane than the state
+    functions_.Release(luaEnv_);
 }
 
-Item::~Item() = default;
-
 void Item::InitializeLua()
 {
-    Lua::RegisterLuaAll(luaState_);
-    luaState_["self"] = this;
+    // Items move with the player between games, they use the VM of the current lane
+    luaEnv_.Create(Lua::GetLaneState());
+    luaEnv_["self"] = this;
 }
 
 void Item::RemoveFromCache()
@@ -90,6 +93,20 @@ bool Item::LoadConcrete(const AB::Entities::ConcreteItem& item)
 
 bool Item::LoadScript(const std::string& fileName)
 {
+    return ExecuteScript(fileName);
+}
+
+bool Item::EnsureLua()
+{
+    if (!luaEnv_.NeedsBind())
+        return true;
+    return ExecuteScript(data_.script);
+}
+
+bool Item::ExecuteScript(const std::string& fileName)
+{
+    functions_.Release(luaEnv_);
+    InitializeLua();
     if (fileName.empty())
         // An item does not need a script
         return true;
@@ -97,36 +114,31 @@ bool Item::LoadScript(const std::string& fileName)
     auto script = GetSubsystem<IO::DataProvider>()->GetAsset<Script>(fileName);
     if (!script)
         return false;
-    if (!script->Execute(luaState_))
+    if (!script->Execute(luaEnv_))
         return false;
 
-    if (Lua::IsFunction(luaState_, "onUpdate"))
-        sa::bits::set(functions_, FunctionUpdate);
-    if (Lua::IsFunction(luaState_, "getDamage"))
-        sa::bits::set(functions_, FunctionGetDamage);
-    if (Lua::IsFunction(luaState_, "getDamageType"))
-        sa::bits::set(functions_, FunctionGetDamageType);
-    if (Lua::IsFunction(luaState_, "onEquip"))
-        sa::bits::set(functions_, FunctionOnEquip);
-    if (Lua::IsFunction(luaState_, "onUnequip"))
-        sa::bits::set(functions_, FunctionOnUnequip);
-    if (Lua::IsFunction(luaState_, "getSkillCost"))
-        sa::bits::set(functions_, FunctionGetSkillCost);
-    if (Lua::IsFunction(luaState_, "getSkillRecharge"))
-        sa::bits::set(functions_, FunctionGetSkillRecharge);
+    functions_.Resolve(luaEnv_, {
+        { FunctionUpdate, "onUpdate" },
+        { FunctionGetDamage, "getDamage" },
+        { FunctionGetDamageType, "getDamageType" },
+        { FunctionOnEquip, "onEquip" },
+        { FunctionOnUnequip, "onUnequip" },
+        { FunctionGetSkillCost, "getSkillCost" },
+        { FunctionGetSkillRecharge, "getSkillRecharge" }
+    });
     return true;
 }
 
 void Item::CreateGeneralStats(uint32_t level, bool maxStats)
 {
-    if (!Lua::IsFunction(luaState_, "getValueStat"))
+    if (!Lua::IsFunction(luaEnv_, "getValueStat"))
         return;
 
     auto setValues = [&](int number)
     {
         uint32_t index;
         uint32_t count;
-        kaguya::tie(index, count) = luaState_["getValueStat"](number, level, maxStats);
+        kaguya::tie(index, count) = luaEnv_["getValueStat"](number, level, maxStats);
         if (index != 0 && count != 0)
         {
             stats_.SetValue(static_cast<int>(ItemStatIndex::Material1Index) + ((number - 1) * 2), index);
@@ -139,11 +151,11 @@ void Item::CreateGeneralStats(uint32_t level, bool maxStats)
 
 void Item::CreateAttributeStats(uint32_t level, bool maxStats)
 {
-    if (Lua::IsFunction(luaState_, "getAttributeStats"))
+    if (Lua::IsFunction(luaEnv_, "getAttributeStats"))
     {
         int32_t attribIndex = 0;
         int32_t attribValue = 0;
-        kaguya::tie(attribIndex, attribValue) = luaState_["getAttributeStats"](level, maxStats);
+        kaguya::tie(attribIndex, attribValue) = luaEnv_["getAttributeStats"](level, maxStats);
         if (attribIndex > 0)
             stats_.SetValue(ItemStatIndex::Attribute, attribIndex);
         if (attribValue > -1)
@@ -153,54 +165,54 @@ void Item::CreateAttributeStats(uint32_t level, bool maxStats)
 
 void Item::CreateInsigniaStats(uint32_t level, bool maxStats)
 {
-    if (Lua::IsFunction(luaState_, "getHealthStats"))
+    if (Lua::IsFunction(luaEnv_, "getHealthStats"))
     {
-        int32_t health = luaState_["getHealthStats"](level, maxStats);
+        int32_t health = luaEnv_["getHealthStats"](level, maxStats);
         stats_.SetValue(ItemStatIndex::Health, health);
     }
 }
 
 void Item::CreateWeaponStats(uint32_t level, bool maxStats)
 {
-    if (Lua::IsFunction(luaState_, "getDamageStats"))
+    if (Lua::IsFunction(luaEnv_, "getDamageStats"))
     {
         int32_t minDamage = 0;
         int32_t maxDamage = 0;
-        kaguya::tie(minDamage, maxDamage) = luaState_["getDamageStats"](level, maxStats);
+        kaguya::tie(minDamage, maxDamage) = luaEnv_["getDamageStats"](level, maxStats);
         stats_.SetValue(ItemStatIndex::MinDamage, minDamage);
         stats_.SetValue(ItemStatIndex::MaxDamage, maxDamage);
     }
-    if (Lua::IsFunction(luaState_, "getDamageTypeStats"))
+    if (Lua::IsFunction(luaEnv_, "getDamageTypeStats"))
     {
         int attrib = static_cast<int>(stats_.GetAttribute());
-        int32_t damageType = luaState_["getDamageTypeStats"](level, maxStats, attrib);
+        int32_t damageType = luaEnv_["getDamageTypeStats"](level, maxStats, attrib);
         stats_.SetValue(ItemStatIndex::DamageType, damageType);
     }
 }
 
 void Item::CreateFocusStats(uint32_t level, bool maxStats)
 {
-    if (Lua::IsFunction(luaState_, "getEnergyStats"))
+    if (Lua::IsFunction(luaEnv_, "getEnergyStats"))
     {
-        int32_t energy = luaState_["getEnergyStats"](level, maxStats);
+        int32_t energy = luaEnv_["getEnergyStats"](level, maxStats);
         stats_.SetValue(ItemStatIndex::Energy, energy);
     }
 }
 
 void Item::CreateShieldStats(uint32_t level, bool maxStats)
 {
-    if (Lua::IsFunction(luaState_, "getArmorStats"))
+    if (Lua::IsFunction(luaEnv_, "getArmorStats"))
     {
-        int32_t armor = luaState_["getArmorStats"](level, maxStats);
+        int32_t armor = luaEnv_["getArmorStats"](level, maxStats);
         stats_.SetValue(ItemStatIndex::Armor, armor);
     }
 }
 
 void Item::CreateConsumeableStats(uint32_t level, bool maxStats)
 {
-    if (Lua::IsFunction(luaState_, "getUsagesStats"))
+    if (Lua::IsFunction(luaEnv_, "getUsagesStats"))
     {
-        int32_t usages = luaState_["getUsagesStats"](level, maxStats);
+        int32_t usages = luaEnv_["getUsagesStats"](level, maxStats);
         stats_.SetValue(ItemStatIndex::Usages, usages);
     }
 }
@@ -211,6 +223,9 @@ bool Item::GenerateConcrete(AB::Entities::ConcreteItem& ci, uint32_t level, bool
 
     if (stats.empty())
     {
+        // The stats come from the script. When it can't be executed, the functions are missing
+        // and the stats stay empty.
+        EnsureLua();
         CreateGeneralStats(level, maxStats);
         switch (data_.type)
         {
@@ -269,7 +284,7 @@ bool Item::IsPossibleAttribute(Attribute attribute)
 void Item::Update(uint32_t timeElapsed)
 {
     if (HaveFunction(FunctionUpdate))
-        luaState_["onUpdate"](timeElapsed);
+        functions_[FunctionUpdate](timeElapsed);
 
     auto* cache = GetSubsystem<ItemsCache>();
     for (auto& i : upgrades_)
@@ -606,7 +621,7 @@ void Item::GetSkillRecharge(Skill *skill, uint32_t &recharge)
 {
     if (HaveFunction(FunctionGetSkillRecharge))
     {
-        recharge = luaState_["getSkillRecharge"](skill, recharge);
+        recharge = functions_[FunctionGetSkillRecharge](skill, recharge);
     }
 
     auto* cache = GetSubsystem<ItemsCache>();
@@ -623,7 +638,7 @@ void Item::GetSkillCost(Skill* skill, int32_t& activation, int32_t& energy, int3
     if (HaveFunction(FunctionGetSkillCost))
     {
         kaguya::tie(activation, energy, adrenaline, overcast, hp) =
-            luaState_["getSkillCost"](skill, activation, energy, adrenaline, overcast, hp);
+            functions_[FunctionGetSkillCost](skill, activation, energy, adrenaline, overcast, hp);
     }
 
     auto* cache = GetSubsystem<ItemsCache>();
@@ -652,7 +667,7 @@ void Item::GetAttributeRank(Attribute index, uint32_t& value)
 void Item::OnEquip(Actor* target)
 {
     if (HaveFunction(FunctionOnEquip))
-        luaState_["onEquip"](target);
+        functions_[FunctionOnEquip](target);
 
     auto* cache = GetSubsystem<ItemsCache>();
     for (auto& i : upgrades_)
@@ -666,7 +681,7 @@ void Item::OnEquip(Actor* target)
 void Item::OnUnequip(Actor* target)
 {
     if (HaveFunction(FunctionOnUnequip))
-        luaState_["onUnequip"](target);
+        functions_[FunctionOnUnequip](target);
 
     auto* cache = GetSubsystem<ItemsCache>();
     for (auto& i : upgrades_)
@@ -734,11 +749,13 @@ bool Item::Consume()
 {
     if (data_.type != AB::Entities::ItemType::Consumeable && data_.type != AB::Entities::ItemType::Dye)
         return false;
-    if (Lua::IsFunction(luaState_, "onConsume"))
+    if (!EnsureLua())
+        return false;
+    if (Lua::IsFunction(luaEnv_, "onConsume"))
         return false;
     if (stats_.GetUsages() < 1)
         return false;
-    bool ret = luaState_["onConsume"]();
+    bool ret = luaEnv_["onConsume"]();
     if (ret)
     {
         stats_.DescreaseUsages();
@@ -751,7 +768,7 @@ void Item::GetWeaponDamage(int32_t& value, bool critical)
 {
     if (HaveFunction(FunctionGetDamage))
     {
-        float val = luaState_["getDamage"](baseMinDamage_, baseMaxDamage_, critical);
+        float val = functions_[FunctionGetDamage](baseMinDamage_, baseMaxDamage_, critical);
         value = static_cast<int32_t>(val);
     }
 
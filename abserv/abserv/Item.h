@@ -22,6 +22,7 @@
 #pragma once
 
 #include "ItemStats.h"
+#include "ScriptManager.h"
 #include <AB/Entities/ConcreteItem.h>
 #include <AB/Entities/Item.h>
 #include <abshared/Attributes.h>
@@ -77,15 +78,18 @@ private:
         FunctionGetSkillCost = 1 << 5,
         FunctionGetSkillRecharge = 1 << 6,
     };
-    kaguya::State luaState_;
-    uint32_t functions_{ FunctionNone };
+    Lua::Environment luaEnv_;
+    Lua::ScriptFunctions<Function, 7> functions_;
     UpgradesMap upgrades_;
     int32_t baseMinDamage_{ 0 };
     int32_t baseMaxDamage_{ 0 };
     void InitializeLua();
-    bool HaveFunction(Function func) const
+    bool ExecuteScript(const std::string& fileName);
+    /// Rebind the script when the Item is used on a different lane than before
+    bool EnsureLua();
+    bool HaveFunction(Function func)
     {
-        return sa::bits::is_set(functions_, func);
+        return EnsureLua() && functions_.Have(func);
     }
     void CreateGeneralStats(uint32_t level, bool maxStats);
     void CreateAttributeStats(uint32_t level, bool maxStats);
@@ -30,7 +30,9 @@
 #include <AB/Entities/Service.h>
 #include <abscommon/CpuUsage.h>
 #include <abscommon/DataClient.h>
+#include <abscommon/DispatcherPool.h>
 #include <abscommon/FileWatcher.h>
+#include <abscommon/IoServicePool.h>
 #include <abscommon/ThreadPool.h>
 #include <sa/time.h>
 #include "Game.h"
@@ -97,6 +99,22 @@ void Maintenance::UpdateServerLoadTask()
         ", peak: " << oinfo.peak <<
         ", used: " << oinfo.used << ", avail: " << oinfo.avail << std::endl;
 #endif
+#ifdef DEBUG_DISPATCHER
+    const Asynch::DispatcherStats dstats = GetSubsystem<Asynch::DispatcherPool>()->GetStats();
+    LOG_DEBUG << "Dispatcher: executed: " << dstats.executed << ", queue depth: " << dstats.queueDepth <<
+        ", max queue depth: " << dstats.maxQueueDepth << ", wait times (<100us, <1ms, <10ms, <100ms, more): " <<
+        dstats.waitTimes[0] << ", " << dstats.waitTimes[1] << ", " << dstats.waitTimes[2] << ", " <<
+        dstats.waitTimes[3] << ", " << dstats.waitTimes[4] << std::endl;
+#endif
+#ifdef DEBUG_NET
+    auto* ioPool = GetSubsystem<Net::IoServicePool>();
+    for (size_t i = 0; i < ioPool->GetCount(); ++i)
+    {
+        const Net::IoServiceStats istats = ioPool->GetStats(i);
+        LOG_DEBUG << "I/O thread " << i << ": sockets: " << istats.sockets << ", handlers: " << istats.handlers <<
+            ", busy time: " << istats.busyTime << "us" << std::endl;
+    }
+#endif
 
     AB::Entities::Service serv;
     serv.uuid = Application::Instance->GetServerId();
@@ -21,6 +21,7 @@
 
 
 #include "Map.h"
+#include "ConfigManager.h"
 #include "DataProvider.h"
 #include "Game.h"
 #include "IOMap.h"
@@ -29,9 +30,14 @@
 namespace Game {
 
 Map::Map(ea::shared_ptr<Game> game) :
-    game_(game),
-    octree_(ea::make_unique<Math::Octree>())
+    game_(game)
 {
+    // Objects may be added before the map is loaded, FitSpatialIndex() sets the real size
+    const float cellSize = (*GetSubsystem<ConfigManager>())[ConfigManager::Key::GridCellSize].GetFloat();
+    if (cellSize > 0.0f)
+        spatialIndex_ = ea::make_unique<Math::GridIndex<GameObject>>(Math::BoundingBox(-1000.0f, 1000.0f), cellSize);
+    else
+        spatialIndex_ = ea::make_unique<Math::OctreeIndex<GameObject>>();
 }
 
 Map::~Map()
@@ -75,9 +81,21 @@ void Map::AddGameObject(ea::shared_ptr<GameObject> object)
         game->AddObjectInternal(object);
 }
 
-void Map::UpdateOctree(uint32_t)
+void Map::FitSpatialIndex()
+{
+    Math::BoundingBox bounds = terrain_->GetHeightMap()->GetBoundingBox().Transformed(terrain_->transformation_.GetMatrix());
+    // Objects can be above the terrain, and octants should not be flat
+    const Math::Vector3 size = bounds.Size();
+    const float halfHeight = std::max(size.x_, size.z_) * 0.5f;
+    const float centerY = bounds.Center().y_;
+    bounds.min_.y_ = centerY - halfHeight;
+    bounds.max_.y_ = centerY + halfHeight;
+    spatialIndex_->SetSize(bounds);
+}
+
+void Map::UpdateSpatialIndex(uint32_t)
 {
-    octree_->Update();
+    spatialIndex_->Update();
 }
 
 SpawnPoint Map::GetFreeSpawnPoint()
@@ -117,8 +135,7 @@ SpawnPoint Map::GetFreeSpawnPoint(const ea::vector<SpawnPoint>& points)
     for (const auto& p : points)
     {
         ea::vector<GameObject*> result;
-        Math::SphereOctreeQuery query(result, Math::Sphere(p.position, 5.0f));
-        octree_->GetObjects(query);
+        spatialIndex_->GetObjects(result, Math::Sphere(p.position, 5.0f), nullptr);
         cleanObjects(result);
         if (result.size() < minObjects)
         {
@@ -131,21 +148,21 @@ SpawnPoint Map::GetFreeSpawnPoint(const ea::vector<SpawnPoint>& points)
 
     {
         ea::vector<GameObject*> result;
-        Math::SphereOctreeQuery query(result, Math::Sphere(minPos.position, 1.0f));
-        octree_->GetObjects(query);
+        Math::Sphere sphere(minPos.position, 1.0f);
+        spatialIndex_->GetObjects(result, sphere, nullptr);
         cleanObjects(result);
         while (result.size() != 0)
         {
 #ifdef DEBUG_GAME
 //            LOG_DEBUG << "In place " << result.size() << " Object: " << *result.front() << std::endl;
 #endif
-            query.sphere_.center_.x_ += 0.2f;
-            query.sphere_.center_.z_ += 0.2f;
-            query.sphere_.center_.y_ = terrain_->GetHeight(query.sphere_.center_);
-            octree_->GetObjects(query);
+            sphere.center_.x_ += 0.2f;
+            sphere.center_.z_ += 0.2f;
+            sphere.center_.y_ = terrain_->GetHeight(sphere.center_);
+            spatialIndex_->GetObjects(result, sphere, nullptr);
             cleanObjects(result);
         }
-        return{ query.sphere_.center_, minPos.rotation, minPos.group };
+        return{ sphere.center_, minPos.rotation, minPos.group };
     }
 }
 
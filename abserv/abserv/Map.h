@@ -22,7 +22,7 @@
 #pragma once
 
 #include "NavigationMesh.h"
-#include "Octree.h"
+#include "SpatialIndex.h"
 #include "Terrain.h"
 #include <absmath/Vector3.h>
 #include <pugixml.hpp>
@@ -82,7 +82,9 @@ public:
     }
 
     void AddGameObject(ea::shared_ptr<GameObject> object);
-    void UpdateOctree(uint32_t delta);
+    /// Resize the spatial index to the terrain, must be called after the scene was loaded.
+    void FitSpatialIndex();
+    void UpdateSpatialIndex(uint32_t delta);
     SpawnPoint GetFreeSpawnPoint();
     SpawnPoint GetFreeSpawnPoint(const std::string& group);
     SpawnPoint GetFreeSpawnPoint(const ea::vector<SpawnPoint>& points);
@@ -103,7 +105,8 @@ public:
     ea::vector<SpawnPoint> spawnPoints_;
     ea::shared_ptr<Navigation::NavigationMesh> navMesh_;
     ea::shared_ptr<Terrain> terrain_;
-    ea::unique_ptr<Math::Octree> octree_;
+    /// A grid when grid_cell_size is set, otherwise an Octree
+    ea::unique_ptr<SpatialIndex> spatialIndex_;
 };
 
 }
@@ -28,36 +28,70 @@
 
 namespace Net {
 
-void MessageFilter::Execute(const Game::Game& game, const Game::Player& player, const NetworkMessage& source, NetworkMessage& dest)
+void MessageFilter::Prepare(const NetworkMessage& source, Packets& packets)
 {
     using namespace AB::Packets::Server;
+    packets.clear();
     MessageDecoder decoder(source);
     for (;;)
     {
+        const size_t start = decoder.GetPos();
         auto code = decoder.GetNext();
         if (!code.has_value())
             return;
 
+        bool filtered = false;
         switch (code.value())
         {
-#define ENUMERATE_SERVER_PACKET_CODE(v) case AB::GameProtocol::ServerPacketType::v:                 \
-            {                                                                                       \
-                v packet = AB::Packets::Get<v>(decoder);                                            \
-                constexpr size_t id = sa::StringHash(sa::TypeName<v>::Get());                       \
-                if (events_.HasSubscribers<bool(const Game::Game&, const Game::Player&, v&)>(id))   \
-                {                                                                                   \
-                    if (!events_.CallOne<bool(const Game::Game&, const Game::Player&, v&)>(id, game, player, packet))  \
-                        continue;                                                                   \
-                }                                                                                   \
-                Insert(dest, AB::GameProtocol::ServerPacketType::v, packet);                        \
-                break;                                                                              \
+#define ENUMERATE_SERVER_PACKET_CODE(v) case AB::GameProtocol::ServerPacketType::v:                     \
+            {                                                                                           \
+                /* Skip over it */                                                                      \
+                AB::Packets::Get<v>(decoder);                                                           \
+                constexpr size_t id = sa::StringHash(sa::TypeName<v>::Get());                           \
+                filtered = events_.HasSubscribers<bool(const Game::Game&, const Game::Player&, const v&)>(id); \
+                break;                                                                                  \
             }
             ENUMERATE_SERVER_PACKET_CODES
 #undef ENUMERATE_SERVER_PACKET_CODE
         default:
-            dest.Add(code.value());
             break;
         }
+        packets.push_back({ start, decoder.GetPos(), code.value(), filtered });
+    }
+}
+
+bool MessageFilter::Keep(const Game::Game& game, const Game::Player& player, const NetworkMessage& source, const Packet& packet)
+{
+    using namespace AB::Packets::Server;
+    // Skip the packet type
+    MessageDecoder decoder(source, packet.start + 1);
+    switch (packet.type)
+    {
+#define ENUMERATE_SERVER_PACKET_CODE(v) case AB::GameProtocol::ServerPacketType::v:                     \
+        {                                                                                               \
+            const v p = AB::Packets::Get<v>(decoder);                                                   \
+            constexpr size_t id = sa::StringHash(sa::TypeName<v>::Get());                               \
+            return events_.CallOne<bool(const Game::Game&, const Game::Player&, const v&)>(id, game, player, p); \
+        }
+        ENUMERATE_SERVER_PACKET_CODES
+#undef ENUMERATE_SERVER_PACKET_CODE
+    default:
+        return true;
+    }
+}
+
+void MessageFilter::Execute(const Game::Game& game, const Game::Player& player, const NetworkMessage& source,
+    const Packets& packets, Ranges& ranges)
+{
+    ranges.clear();
+    for (const auto& packet : packets)
+    {
+        if (packet.filtered && !Keep(game, player, source, packet))
+            continue;
+        if (!ranges.empty() && ranges.back().first + ranges.back().second == packet.start)
+            ranges.back().second += packet.end - packet.start;
+        else
+            ranges.push_back({ packet.start, packet.end - packet.start });
     }
 }
 
@@ -24,6 +24,7 @@
 #include <AB/Packets/Packet.h>
 #include <AB/Packets/ServerPackets.h>
 #include <abscommon/NetworkMessage.h>
+#include <eastl.hpp>
 #include <sa/Events.h>
 #include <sa/StringHash.h>
 #include <sa/TypeName.h>
@@ -39,20 +40,29 @@ namespace Net {
 
 class MessageFilter
 {
+public:
+    /// A packet in the source message
+    struct Packet
+    {
+        /// Offsets in the buffer of the source message
+        size_t start;
+        size_t end;
+        AB::GameProtocol::ServerPacketType type;
+        /// If there are subscribers for this packet type
+        bool filtered;
+    };
+    using Packets = ea::vector<Packet>;
+    /// Offset in the buffer of the source message and size
+    using Ranges = ea::vector<ea::pair<size_t, size_t>>;
 private:
     using FilterEvents = sa::Events<
-#define ENUMERATE_SERVER_PACKET_CODE(v) bool(const Game::Game&, const Game::Player&, AB::Packets::Server::v&),
+#define ENUMERATE_SERVER_PACKET_CODE(v) bool(const Game::Game&, const Game::Player&, const AB::Packets::Server::v&),
         ENUMERATE_SERVER_PACKET_CODES
 #undef ENUMERATE_SERVER_PACKET_CODE
         bool(void)
     >;
     FilterEvents events_;
-    template<typename T>
-    static void Insert(NetworkMessage& dest, AB::GameProtocol::ServerPacketType type, T& packet)
-    {
-        dest.AddByte(type);
-        AB::Packets::Add(packet, dest);
-    }
+    bool Keep(const Game::Game& game, const Game::Player& player, const NetworkMessage& source, const Packet& packet);
 public:
     MessageFilter()
     { }
@@ -62,9 +72,14 @@ public:
     size_t Subscribe(Callback&& callback)
     {
         constexpr size_t id = sa::StringHash(sa::TypeName<T>::Get());
-        return events_.Subscribe<bool(const Game::Game&, const Game::Player&, T&)>(id, std::move(callback));
+        return events_.Subscribe<bool(const Game::Game&, const Game::Player&, const T&)>(id, std::move(callback));
     }
-    void Execute(const Game::Game& game, const Game::Player& player, const NetworkMessage& source, NetworkMessage& dest);
+    /// Split source into packets. This is done once for all players.
+    void Prepare(const NetworkMessage& source, Packets& packets);
+    /// Get the parts of source the player gets. Adjacent packets are merged into one
+    /// range, so when nothing is filtered out it's just one range.
+    void Execute(const Game::Game& game, const Game::Player& player, const NetworkMessage& source,
+        const Packets& packets, Ranges& ranges);
 };
 
 }
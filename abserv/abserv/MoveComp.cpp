@@ -69,15 +69,12 @@ bool MoveComp::SetPosition(const Math::Vector3& pos)
 
     const bool moved = oldPosition_ != owner_.transformation_.position_;
 
-    if (moved && owner_.octant_)
+    if (moved)
     {
         // We need to do it here because this is not called from Update()
-        Math::Octree* octree = owner_.octant_->GetRoot();
-        octree->AddObjectUpdate(&owner_);
-    }
-
-    if (moved)
+        owner_.AddSpatialIndexUpdate();
         moved_ = true;
+    }
 
     return moved;
 }
@@ -209,6 +206,7 @@ void MoveComp::Write(Net::NetworkMessage& message)
             directionSet_
         };
         AB::Packets::Add(packet, message);
+        rotationManual_ = directionSet_;
         turned_ = false;
         directionSet_ = false;
     }
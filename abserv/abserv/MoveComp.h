@@ -114,6 +114,8 @@ public:
     bool speedDirty_{ false };
     /// Manual direction set
     bool directionSet_{ false };
+    /// The last rotation update was a manually set direction
+    bool rotationManual_{ false };
     bool newAngle_{ false };
     /// Sends a special message to the client to force the client to set the position.
     bool forcePosition_{ false };
@@ -37,8 +37,10 @@ namespace Game {
 
 void Npc::InitializeLua()
 {
-    Lua::RegisterLuaAll(luaState_);
-    luaState_["self"] = this;
+    // Game bound objects share the VM of the game
+    auto game = GetGame();
+    luaEnv_.Create(game ? game->GetScriptState() : ea::make_shared<Lua::SharedState>());
+    luaEnv_["self"] = this;
     luaInitialized_ = true;
 }
 
@@ -97,7 +99,6 @@ Npc::Npc() :
     events_.Subscribe<void(Actor*)>(EVENT_ON_INTERACT, std::bind(&Npc::OnInteract, this, std::placeholders::_1));
     // Party and Groups must be unique, i.e. share the same ID pool.
     groupId_ = Group::GetNewId();
-    InitializeLua();
 }
 
 Npc::~Npc()
@@ -112,31 +113,32 @@ bool Npc::LoadScript(const std::string& fileName)
     auto script = GetSubsystem<IO::DataProvider>()->GetAsset<Script>(fileName);
     if (!script)
         return false;
-    if (!script->Execute(luaState_))
+    InitializeLua();
+    if (!script->Execute(luaEnv_))
         return false;
 
-    name_ = static_cast<const char*>(luaState_["name"]);
-    level_ = luaState_["level"];
-    itemIndex_ = luaState_["itemIndex"];
-    if (Lua::IsNumber(luaState_, "sex"))
-        sex_ = luaState_["sex"];
-    if (Lua::IsNumber(luaState_, "interactionRange"))
-        interactionRange_ = static_cast<Ranges>(luaState_["interactionRange"]);
-    if (Lua::IsNumber(luaState_, "group_id"))
-        groupId_ = luaState_["group_id"];
-    if (Lua::IsBool(luaState_, "wander"))
-        SetWander(luaState_("wander"));
-
-    if (Lua::IsNumber(luaState_, "creatureState"))
-        stateComp_.SetState(luaState_["creatureState"], true);
+    name_ = static_cast<const char*>(luaEnv_["name"]);
+    level_ = luaEnv_["level"];
+    itemIndex_ = luaEnv_["itemIndex"];
+    if (Lua::IsNumber(luaEnv_, "sex"))
+        sex_ = luaEnv_["sex"];
+    if (Lua::IsNumber(luaEnv_, "interactionRange"))
+        interactionRange_ = static_cast<Ranges>(luaEnv_["interactionRange"]);
+    if (Lua::IsNumber(luaEnv_, "group_id"))
+        groupId_ = luaEnv_["group_id"];
+    if (Lua::IsBool(luaEnv_, "wander"))
+        SetWander(luaEnv_["wander"]);
+
+    if (Lua::IsNumber(luaEnv_, "creatureState"))
+        stateComp_.SetState(luaEnv_["creatureState"], true);
     else
         stateComp_.SetState(AB::GameProtocol::CreatureState::Idle, true);
 
     IO::DataClient* client = GetSubsystem<IO::DataClient>();
 
-    if (Lua::IsNumber(luaState_, "prof1Index"))
+    if (Lua::IsNumber(luaEnv_, "prof1Index"))
     {
-        skills_->prof1_.index = luaState_["prof1Index"];
+        skills_->prof1_.index = luaEnv_["prof1Index"];
         if (skills_->prof1_.index != 0)
         {
             if (!client->Read(skills_->prof1_))
@@ -145,9 +147,9 @@ bool Npc::LoadScript(const std::string& fileName)
             }
         }
     }
-    if (Lua::IsNumber(luaState_, "prof2Index"))
+    if (Lua::IsNumber(luaEnv_, "prof2Index"))
     {
-        skills_->prof2_.index = luaState_["prof2Index"];
+        skills_->prof2_.index = luaEnv_["prof2Index"];
         if (skills_->prof2_.index != 0)
         {
             if (!client->Read(skills_->prof2_))
@@ -158,20 +160,39 @@ bool Npc::LoadScript(const std::string& fileName)
     }
 
     std::string bt;
-    if (Lua::IsString(luaState_, "behavior"))
-        bt = static_cast<const char*>(luaState_["behavior"]);
-    if (Lua::IsFunction(luaState_, "onUpdate"))
-        sa::bits::set(functions_, FunctionUpdate);
-    if (Lua::IsFunction(luaState_, "onTrigger"))
-        sa::bits::set(functions_, FunctionOnTrigger);
-    if (Lua::IsFunction(luaState_, "onLeftArea"))
-        sa::bits::set(functions_, FunctionOnLeftArea);
-    if (Lua::IsFunction(luaState_, "onGetQuote"))
-        sa::bits::set(functions_, FunctionOnGetQuote);
-
-    if (Lua::IsFunction(luaState_, "getSellingItemTypes"))
+    if (Lua::IsString(luaEnv_, "behavior"))
+        bt = static_cast<const char*>(luaEnv_["behavior"]);
+    functions_.Resolve(luaEnv_, {
+        { FunctionUpdate, "onUpdate" },
+        { FunctionOnTrigger, "onTrigger" },
+        { FunctionOnLeftArea, "onLeftArea" },
+        { FunctionOnGetQuote, "onGetQuote" },
+        { FunctionOnSelected, "onSelected" },
+        { FunctionOnClicked, "onClicked" },
+        { FunctionOnArrived, "onArrived" },
+        { FunctionOnCollide, "onCollide" },
+        { FunctionOnEndUseSkill, "onEndUseSkill" },
+        { FunctionOnStartUseSkill, "onStartUseSkill" },
+        { FunctionOnAttack, "onAttack" },
+        { FunctionOnAttacked, "onAttacked" },
+        { FunctionOnGettingAttacked, "onGettingAttacked" },
+        { FunctionOnUseSkill, "onUseSkill" },
+        { FunctionOnSkillTargeted, "onSkillTargeted" },
+        { FunctionOnInteract, "onInteract" },
+        { FunctionOnInterruptingAttack, "onInterruptingAttack" },
+        { FunctionOnInterruptingSkill, "onInterruptingSkill" },
+        { FunctionOnInterruptedAttack, "onInterruptedAttack" },
+        { FunctionOnInterruptedSkill, "onInterruptedSkill" },
+        { FunctionOnKnockedDown, "onKnockedDown" },
+        { FunctionOnHealed, "onHealed" },
+        { FunctionOnDied, "onDied" },
+        { FunctionOnResurrected, "onResurrected" },
+        { FunctionIsSellingItem, "isSellingItem" }
+    });
+
+    if (Lua::IsFunction(luaEnv_, "getSellingItemTypes"))
     {
-        std::vector<uint32_t> types = luaState_["getSellingItemTypes"]();
+        std::vector<uint32_t> types = luaEnv_["getSellingItemTypes"]();
         for (auto type : types)
         {
             sellItemTypes_.emplace(static_cast<AB::Entities::ItemType>(type));
@@ -185,7 +206,7 @@ bool Npc::LoadScript(const std::string& fileName)
     if (!bt.empty())
         SetBehavior(bt);
 
-    return luaState_["onInit"]();
+    return luaEnv_["onInit"]();
 }
 
 void Npc::SetLevel(uint32_t value)
@@ -205,9 +226,7 @@ void Npc::Update(uint32_t timeElapsed, Net::NetworkMessage& message)
     Actor::Update(timeElapsed, message);
 
     if (luaInitialized_ && HaveFunction(FunctionUpdate))
-        luaState_["onUpdate"](timeElapsed);
-
-    Lua::CollectGarbage(luaState_);
+        functions_[FunctionUpdate](timeElapsed);
 }
 
 bool Npc::SetBehavior(const std::string& name)
@@ -377,7 +396,7 @@ std::string Npc::GetQuote(int index)
 {
     if (!HaveFunction(FunctionOnGetQuote))
         return "";
-    const char* q = static_cast<const char*>(luaState_["onGetQuote"](index));
+    const char* q = static_cast<const char*>(functions_[FunctionOnGetQuote](index));
     return q;
 }
 
@@ -446,13 +465,13 @@ void Npc::ShootAt(const std::string& itemUuid, Actor* target)
 void Npc::OnSelected(Actor* selector)
 {
     if (luaInitialized_ && selector)
-        Lua::CallFunction(luaState_, "onSelected", selector);
+        functions_.Call(FunctionOnSelected, selector);
 }
 
 void Npc::OnClicked(Actor* selector)
 {
     if (luaInitialized_ && selector)
-        Lua::CallFunction(luaState_, "onClicked", selector);
+        functions_.Call(FunctionOnClicked, selector);
     if (Is<Player>(selector))
     {
         if (!IsInRange(Ranges::Adjecent, selector))
@@ -467,121 +486,121 @@ void Npc::OnClicked(Actor* selector)
 void Npc::OnArrived()
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onArrived");
+        functions_.Call(FunctionOnArrived);
 }
 
 void Npc::OnCollide(GameObject* other)
 {
     if (luaInitialized_ && other)
-        Lua::CallFunction(luaState_, "onCollide", other);
+        functions_.Call(FunctionOnCollide, other);
 }
 
 void Npc::OnTrigger(GameObject* other)
 {
     if (luaInitialized_ && HaveFunction(FunctionOnTrigger))
-        Lua::CallFunction(luaState_, "onTrigger", other);
+        functions_.Call(FunctionOnTrigger, other);
 }
 
 void Npc::OnLeftArea(GameObject* other)
 {
     if (luaInitialized_ && HaveFunction(FunctionOnLeftArea))
-        Lua::CallFunction(luaState_, "onLeftArea", other);
+        functions_.Call(FunctionOnLeftArea, other);
 }
 
 void Npc::OnEndUseSkill(Skill* skill)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onEndUseSkill", skill);
+        functions_.Call(FunctionOnEndUseSkill, skill);
 }
 
 void Npc::OnStartUseSkill(Skill* skill)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onStartUseSkill", skill);
+        functions_.Call(FunctionOnStartUseSkill, skill);
 }
 
 void Npc::OnAttack(Actor* target, bool& canAttack)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onAttack", target, canAttack);
+        functions_.Call(FunctionOnAttack, target, canAttack);
 }
 
 void Npc::OnAttacked(Actor* source, DamageType type, int32_t damage, bool& canGetAttacked)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onAttacked", source, type, damage, canGetAttacked);
+        functions_.Call(FunctionOnAttacked, source, type, damage, canGetAttacked);
 }
 
 void Npc::OnGettingAttacked(Actor* source, bool& canGetAttacked)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onGettingAttacked", source, canGetAttacked);
+        functions_.Call(FunctionOnGettingAttacked, source, canGetAttacked);
 }
 
 void Npc::OnUseSkill(Actor* target, Skill* skill, bool& success)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onUseSkill", target, skill, success);
+        functions_.Call(FunctionOnUseSkill, target, skill, success);
 }
 
 void Npc::OnSkillTargeted(Actor* source, Skill* skill, bool& success)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onSkillTargeted", source, skill, success);
+        functions_.Call(FunctionOnSkillTargeted, source, skill, success);
 }
 
 void Npc::OnInteract(Actor* actor)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onInteract", actor);
+        functions_.Call(FunctionOnInteract, actor);
 }
 
 void Npc::OnInterruptingAttack(bool& success)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onInterruptingAttack", success);
+        functions_.Call(FunctionOnInterruptingAttack, success);
 }
 
 void Npc::OnInterruptingSkill(AB::Entities::SkillType type, Skill* skill, bool& success)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onInterruptingSkill", type, skill, success);
+        functions_.Call(FunctionOnInterruptingSkill, type, skill, success);
 }
 
 void Npc::OnInterruptedAttack()
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onInterruptedAttack");
+        functions_.Call(FunctionOnInterruptedAttack);
 }
 
 void Npc::OnInterruptedSkill(Skill* skill)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onInterruptedSkill", skill);
+        functions_.Call(FunctionOnInterruptedSkill, skill);
 }
 
 void Npc::OnKnockedDown(uint32_t time)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onKnockedDown", time);
+        functions_.Call(FunctionOnKnockedDown, time);
 }
 
 void Npc::OnHealed(int hp)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onHealed", hp);
+        functions_.Call(FunctionOnHealed, hp);
 }
 
 void Npc::OnDied(Actor*, Actor*)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onDied");
+        functions_.Call(FunctionOnDied);
 }
 
 void Npc::OnResurrected(int, int)
 {
     if (luaInitialized_)
-        Lua::CallFunction(luaState_, "onResurrected");
+        functions_.Call(FunctionOnResurrected);
 }
 
 void Npc::_LuaAddQuest(uint32_t index)
@@ -619,9 +638,9 @@ bool Npc::IsSellingItemType(AB::Entities::ItemType type) const
 
 bool Npc::IsSellingItem(uint32_t itemIndex)
 {
-    if (!Lua::IsFunction(luaState_, "isSellingItem"))
+    if (!HaveFunction(FunctionIsSellingItem))
         return false;
-    const bool result = luaState_["isSellingItem"](itemIndex);
+    const bool result = functions_[FunctionIsSellingItem](itemIndex);
     return result;
 }
 
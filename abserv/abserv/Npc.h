@@ -25,6 +25,7 @@
 #include "AiComp.h"
 #include "AiLoader.h"
 #include "Chat.h"
+#include "ScriptManager.h"
 #include "TriggerComp.h"
 #include "WanderComp.h"
 #include <eastl.hpp>
@@ -45,7 +46,28 @@ private:
         FunctionUpdate = 1,
         FunctionOnTrigger = 1 << 1,
         FunctionOnLeftArea = 1 << 2,
-        FunctionOnGetQuote = 1 << 3
+        FunctionOnGetQuote = 1 << 3,
+        FunctionOnSelected = 1 << 4,
+        FunctionOnClicked = 1 << 5,
+        FunctionOnArrived = 1 << 6,
+        FunctionOnCollide = 1 << 7,
+        FunctionOnEndUseSkill = 1 << 8,
+        FunctionOnStartUseSkill = 1 << 9,
+        FunctionOnAttack = 1 << 10,
+        FunctionOnAttacked = 1 << 11,
+        FunctionOnGettingAttacked = 1 << 12,
+        FunctionOnUseSkill = 1 << 13,
+        FunctionOnSkillTargeted = 1 << 14,
+        FunctionOnInteract = 1 << 15,
+        FunctionOnInterruptingAttack = 1 << 16,
+        FunctionOnInterruptingSkill = 1 << 17,
+        FunctionOnInterruptedAttack = 1 << 18,
+        FunctionOnInterruptedSkill = 1 << 19,
+        FunctionOnKnockedDown = 1 << 20,
+        FunctionOnHealed = 1 << 21,
+        FunctionOnDied = 1 << 22,
+        FunctionOnResurrected = 1 << 23,
+        FunctionIsSellingItem = 1 << 24,
     };
 
     /// This NPC exists only on the server, i.e. is not spawned on the client, e.g. a trigger box.
@@ -57,12 +79,12 @@ private:
     /// Quests this NPC may have for the player
     ea::set<uint32_t> quests_;
     ea::set<AB::Entities::ItemType> sellItemTypes_;
-    uint32_t functions_{ FunctionNone };
     bool HaveFunction(Function func) const
     {
-        return luaInitialized_ && sa::bits::is_set(functions_, func);
+        return luaInitialized_ && functions_.Have(func);
     }
-    kaguya::State luaState_;
+    Lua::Environment luaEnv_;
+    Lua::ScriptFunctions<Function, 25> functions_;
     bool luaInitialized_;
     void InitializeLua();
     std::string GetQuote(int index);
@@ -118,6 +118,7 @@ void Player::SendError(AB::GameProtocol::PlayerErrorValue value)
 void Player::SetGame(ea::shared_ptr<Game> game)
 {
     Actor::SetGame(game);
+    snapshot_.Clear();
     // Changing the instance also clears any invites. The client should check that we
     // leave the instance so don't send anything to invitees.
     party_->ClearInvites();
@@ -191,7 +192,7 @@ void Player::Logout(bool leavePary)
         PartyLeave();
     if (auto g = GetGame())
     {
-        GetSubsystem<Asynch::Scheduler>()->Add(Asynch::CreateScheduledTask(std::bind(&Game::PlayerLeave, g, id_)));
+        g->Schedule(std::bind(&Game::PlayerLeave, g, id_));
     }
     client_->Logout();
 }
@@ -1011,8 +1012,34 @@ void Player::WriteToOutput(const Net::NetworkMessage& message)
         return;
     }
 
-    if (message.GetSize() != 0)
-        client_->WriteToOutput(message);
+    if (message.GetSize() == 0)
+        return;
+
+    auto game = GetGame();
+    if (game && !game->IsLaneThread())
+    {
+        // Written from a different lane, e.g. chat or party invite from a player
+        // in a game running on another thread. Hand a copy over to our lane.
+        std::shared_ptr<Net::NetworkMessage> copy = Net::NetworkMessage::GetNew();
+        copy->AddBytes(reinterpret_cast<const char*>(message.GetBuffer() + Net::NetworkMessage::INITIAL_BUFFER_POSITION),
+            static_cast<uint32_t>(message.GetSize()));
+        game->Post([player = GetPtr<Player>(), copy]()
+        {
+            player->WriteToOutput(*copy);
+        });
+        return;
+    }
+    client_->WriteToOutput(message);
+}
+
+void Player::WriteToOutput(const Net::NetworkMessage& message, const Net::MessageFilter::Ranges& ranges)
+{
+    if (!client_)
+    {
+        LOG_ERROR << "client_ expired" << std::endl;
+        return;
+    }
+    client_->WriteToOutput(message, ranges);
 }
 
 void Player::OnPingObject(uint32_t targetId, AB::GameProtocol::ObjectCallType type, int skillIndex)
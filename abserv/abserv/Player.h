@@ -24,6 +24,8 @@
 #include "Actor.h"
 #include "Effect.h"
 #include "Game.h"
+#include "MessageFilter.h"
+#include "StateSnapshot.h"
 #include <AB/Entities/Account.h>
 #include <AB/Entities/Character.h>
 #include <AB/Entities/FriendList.h>
@@ -161,6 +163,8 @@ public:
     void PingPosition(const Math::Vector3& worldPos);
 
     void WriteToOutput(const Net::NetworkMessage& message);
+    /// Write the ranges of the game status, must be called from the lane of the game
+    void WriteToOutput(const Net::NetworkMessage& message, const Net::MessageFilter::Ranges& ranges);
     bool IsResigned() const { return resigned_; }
 
     void SetParty(ea::shared_ptr<Party> party);
@@ -269,6 +273,8 @@ public:
     ea::unique_ptr<Components::QuestComp> questComp_;
     ea::unique_ptr<Components::TradeComp> tradeComp_;
     ea::unique_ptr<Components::InteractionComp> interactionComp_;
+    /// What the client knows about other objects
+    StateSnapshot snapshot_;
 };
 
 template <>
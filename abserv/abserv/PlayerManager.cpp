@@ -33,15 +33,21 @@ ea::shared_ptr<Player> PlayerManager::GetPlayerByName(const std::string& name)
 
 ea::shared_ptr<Player> PlayerManager::GetPlayerByUuid(const std::string& uuid)
 {
-    auto& index = playerIndex_.get<PlayerUuidIndexTag>();
-    const auto accountIt = index.find(uuid);
-    if (accountIt == index.end())
-        return ea::shared_ptr<Player>();
-    return GetPlayerById((*accountIt).id);
+    uint32_t id = 0;
+    {
+        std::scoped_lock lock(lock_);
+        auto& index = playerIndex_.get<PlayerUuidIndexTag>();
+        const auto accountIt = index.find(uuid);
+        if (accountIt == index.end())
+            return ea::shared_ptr<Player>();
+        id = (*accountIt).id;
+    }
+    return GetPlayerById(id);
 }
 
 ea::shared_ptr<Player> PlayerManager::GetPlayerById(uint32_t id)
 {
+    std::scoped_lock lock(lock_);
     auto it = players_.find(id);
     if (it != players_.end())
         return (*it).second;
@@ -51,15 +57,21 @@ ea::shared_ptr<Player> PlayerManager::GetPlayerById(uint32_t id)
 
 ea::shared_ptr<Player> PlayerManager::GetPlayerByAccountUuid(const std::string& uuid)
 {
-    auto& index = playerIndex_.get<AccountUuidIndexTag>();
-    const auto accountIt = index.find(uuid);
-    if (accountIt == index.end())
-        return ea::shared_ptr<Player>();
-    return GetPlayerById((*accountIt).id);
+    uint32_t id = 0;
+    {
+        std::scoped_lock lock(lock_);
+        auto& index = playerIndex_.get<AccountUuidIndexTag>();
+        const auto accountIt = index.find(uuid);
+        if (accountIt == index.end())
+            return ea::shared_ptr<Player>();
+        id = (*accountIt).id;
+    }
+    return GetPlayerById(id);
 }
 
 uint32_t PlayerManager::GetPlayerIdByName(const std::string& name)
 {
+    std::scoped_lock lock(lock_);
     auto& index = playerIndex_.get<PlayerNameIndexTag>();
     // Player names are case insensitive
     const auto accountIt = index.find(Utils::Utf8ToLower(name));
@@ -71,6 +83,7 @@ uint32_t PlayerManager::GetPlayerIdByName(const std::string& name)
 ea::shared_ptr<Player> PlayerManager::CreatePlayer(std::shared_ptr<Net::ProtocolGame> client)
 {
     ea::shared_ptr<Player> result = ea::make_shared<Player>(client);
+    std::scoped_lock lock(lock_);
     players_[result->id_] = result;
 
     return result;
@@ -78,6 +91,7 @@ ea::shared_ptr<Player> PlayerManager::CreatePlayer(std::shared_ptr<Net::Protocol
 
 void PlayerManager::UpdatePlayerIndex(const Player& player)
 {
+    std::scoped_lock lock(lock_);
     playerIndex_.insert({
         player.id_,
         player.data_.uuid,
@@ -88,11 +102,15 @@ void PlayerManager::UpdatePlayerIndex(const Player& player)
 
 void PlayerManager::RemovePlayer(uint32_t playerId)
 {
+    // Keep a reference so the Player is not deleted while we hold the lock
+    ea::shared_ptr<Player> player;
+    std::scoped_lock lock(lock_);
     auto it = players_.find(playerId);
     if (it != players_.end())
     {
+        player = (*it).second;
         auto& idIndex = playerIndex_.get<IdIndexTag>();
-        auto indexIt = idIndex.find((*it).second->id_);
+        auto indexIt = idIndex.find(player->id_);
         if (indexIt != idIndex.end())
             idIndex.erase(indexIt);
 
@@ -105,23 +123,17 @@ void PlayerManager::RemovePlayer(uint32_t playerId)
 
 void PlayerManager::CleanPlayers()
 {
-    if (players_.size() == 0)
-        return;
-
-    // Logout all inactive players
-    auto i = players_.begin();
-    while ((i = ea::find_if(i, players_.end(), [](const auto& current) -> bool
+    // Logout all inactive players, disconnect after 10sec
+    const auto inactive = CollectPlayers([](const Player& current) -> bool
     {
-        // Disconnect after 10sec
-        return current.second->GetInactiveTime() > PLAYER_INACTIVE_TIME_KICK;
-    })) != players_.end())
+        return current.GetInactiveTime() > PLAYER_INACTIVE_TIME_KICK;
+    });
+    for (const auto& p : inactive)
     {
-        ea::shared_ptr<Player> p = (*i).second;
         LOG_INFO << "No ping from player " << p->GetName() << " for " << p->GetInactiveTime() << "ms, logging out now" << std::endl;
-        ++i;
         // Calls PlayerManager::RemovePlayer()
         p->Logout(true);
-   }
+    }
 }
 
 void PlayerManager::RefreshAuthTokens()
@@ -129,22 +141,22 @@ void PlayerManager::RefreshAuthTokens()
     // No inactive players here
     auto* client = GetSubsystem<IO::DataClient>();
     int64_t tick = sa::time::tick();
-    for (const auto& player : players_)
+    const auto players = CollectPlayers([tick](const Player& current) -> bool
     {
-        if (tick - player.second->account_.authTokenExpiry < Auth::AUTH_TOKEN_EXPIRES_IN / 2)
-        {
-            player.second->account_.authTokenExpiry = tick + Auth::AUTH_TOKEN_EXPIRES_IN;
-            client->Update(player.second->account_);
-        }
+        return tick - current.account_.authTokenExpiry < Auth::AUTH_TOKEN_EXPIRES_IN / 2;
+    });
+    for (const auto& player : players)
+    {
+        player->account_.authTokenExpiry = tick + Auth::AUTH_TOKEN_EXPIRES_IN;
+        client->Update(player->account_);
     }
 }
 
 void PlayerManager::KickPlayer(uint32_t playerId)
 {
-    auto it = players_.find(playerId);
-    if (it != players_.end())
+    ea::shared_ptr<Player> p = GetPlayerById(playerId);
+    if (p)
     {
-        ea::shared_ptr<Player> p = (*it).second;
         LOG_INFO << "Kicking player " << p->GetName() << std::endl;
         p->Logout(true);
     }
@@ -153,20 +165,16 @@ void PlayerManager::KickPlayer(uint32_t playerId)
 void PlayerManager::KickAllPlayers()
 {
     LOG_INFO << "Kicking all players" << std::endl;
-    while (!players_.empty())
-    {
-        auto it = players_.begin();
-        ea::shared_ptr<Player> p = (*it).second;
+    const auto players = CollectPlayers([](const Player&) { return true; });
+    for (const auto& p : players)
         p->Logout(true);
-    }
 }
 
 void PlayerManager::BroadcastNetMessage(const Net::NetworkMessage& msg)
 {
-    for (const auto& p : players_)
-    {
-        p.second->WriteToOutput(msg);
-    }
+    const auto players = CollectPlayers([](const Player&) { return true; });
+    for (const auto& p : players)
+        p->WriteToOutput(msg);
 }
 
 }
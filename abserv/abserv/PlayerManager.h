@@ -24,6 +24,7 @@
 #include <unordered_map>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <limits>
 #include <abscommon/Utils.h>
 #include <eastl.hpp>
@@ -81,12 +82,30 @@ private:
         >
     >;
 
+    /// Players are added, removed and looked up from all lanes, this protects
+    /// players_, playerIndex_ and idleTime_. Callbacks and Logout() must not be
+    /// called while holding it, because Logout() calls RemovePlayer().
+    mutable std::mutex lock_;
     /// Index to lookup players
     PlayerIndex playerIndex_;
     /// Time with no players
     int64_t idleTime_;
     /// The owner of players
     ea::map<uint32_t, ea::shared_ptr<Player>> players_;
+    /// Returns a copy of all players matching the predicate
+    template<typename Predicate>
+    ea::vector<ea::shared_ptr<Player>> CollectPlayers(Predicate&& predicate) const
+    {
+        ea::vector<ea::shared_ptr<Player>> result;
+        std::scoped_lock lock(lock_);
+        result.reserve(players_.size());
+        for (const auto& player : players_)
+        {
+            if (player.second && predicate(*player.second))
+                result.push_back(player.second);
+        }
+        return result;
+    }
 public:
     PlayerManager() :
         idleTime_(sa::time::tick())
@@ -116,25 +135,26 @@ public:
 
     size_t GetPlayerCount() const
     {
+        std::scoped_lock lock(lock_);
         return players_.size();
     }
 
     int64_t GetIdleTime() const
     {
+        std::scoped_lock lock(lock_);
         if (players_.size() != 0)
             return 0;
         return sa::time::tick() - idleTime_;
     }
+    /// Visits a snapshot of the players, the callback is called without holding the lock.
     template<typename Callback>
     inline void VisitPlayers(Callback&& callback)
     {
-        for (auto& player : players_)
+        const auto players = CollectPlayers([](const Player&) { return true; });
+        for (const auto& player : players)
         {
-            if (player.second)
-            {
-                if (callback(*player.second) != Iteration::Continue)
-                    break;
-            }
+            if (callback(*player) != Iteration::Continue)
+                break;
         }
     }
 };
@@ -52,16 +52,16 @@ Projectile::Projectile(const std::string& itemUuid) :
     undestroyable_ = true;
     selectable_ = false;
     itemUuid_ = itemUuid;
-
-    InitializeLua();
 }
 
 Projectile::~Projectile() = default;
 
 void Projectile::InitializeLua()
 {
-    Lua::RegisterLuaAll(luaState_);
-    luaState_["self"] = this;
+    // Game bound objects share the VM of the game
+    auto game = GetGame();
+    luaEnv_.Create(game ? game->GetScriptState() : ea::make_shared<Lua::SharedState>());
+    luaEnv_["self"] = this;
     luaInitialized_ = true;
 }
 
@@ -70,17 +70,17 @@ bool Projectile::LoadScript(const std::string& fileName)
     auto script = GetSubsystem<IO::DataProvider>()->GetAsset<Script>(fileName);
     if (!script)
         return false;
-    if (!script->Execute(luaState_))
+    InitializeLua();
+    if (!script->Execute(luaEnv_))
         return false;
 
-    if (Lua::IsFunction(luaState_, "onCollide"))
-        sa::bits::set(functions_, FunctionOnCollide);
-    if (Lua::IsFunction(luaState_, "onHitTarget"))
-        sa::bits::set(functions_, FunctionOnHitTarget);
-    if (Lua::IsFunction(luaState_, "onStart"))
-        sa::bits::set(functions_, FunctionOnStart);
+    functions_.Resolve(luaEnv_, {
+        { FunctionOnCollide, "onCollide" },
+        { FunctionOnHitTarget, "onHitTarget" },
+        { FunctionOnStart, "onStart" }
+    });
 
-    bool ret = luaState_["onInit"]();
+    bool ret = luaEnv_["onInit"]();
     return ret;
 }
 
@@ -267,7 +267,7 @@ uint32_t Projectile::GetLevel() const
 void Projectile::OnCollide(GameObject* other)
 {
     if (HaveFunction(FunctionOnCollide))
-        Lua::CallFunction(luaState_, "onCollide", other);
+        functions_.Call(FunctionOnCollide, other);
 
     if (other)
     {
@@ -276,7 +276,7 @@ void Projectile::OnCollide(GameObject* other)
             if (other->id_ == spt->id_)
             {
                 if (HaveFunction(FunctionOnHitTarget))
-                    Lua::CallFunction(luaState_, "onHitTarget", other);
+                    functions_.Call(FunctionOnHitTarget, other);
             }
         }
     }
@@ -291,7 +291,7 @@ bool Projectile::DoStart()
     ASSERT(t);
     bool ret = true;
     if (HaveFunction(FunctionOnStart))
-        ret = luaState_["onStart"](t.get());
+        ret = functions_[FunctionOnStart](t.get());
     if (ret)
         startTick_ = sa::time::tick();
     return true;
@@ -22,6 +22,7 @@
 #pragma once
 
 #include "Actor.h"
+#include "ScriptManager.h"
 #include <abscommon/Utils.h>
 #include <sa/Bits.h>
 #include <eastl.hpp>
@@ -45,7 +46,8 @@ private:
         FunctionOnHitTarget = 1 << 2,
         FunctionOnStart = 1 << 3,
     };
-    kaguya::State luaState_;
+    Lua::Environment luaEnv_;
+    Lua::ScriptFunctions<Function, 4> functions_;
     bool luaInitialized_{ false };
     bool startSet_{ false };
     Math::Vector3 startPos_;
@@ -60,13 +62,12 @@ private:
     std::string itemUuid_;
     int64_t startTick_{ 0 };
     uint32_t lifeTime_{ DEFAULT_LIFETIME };
-    uint32_t functions_{ FunctionNone };
     AB::GameProtocol::AttackError error_{ AB::GameProtocol::AttackError::None };
     void InitializeLua();
     bool LoadScript(const std::string& fileName);
     bool HaveFunction(Function func) const
     {
-        return luaInitialized_ && sa::bits::is_set(functions_, func);
+        return luaInitialized_ && functions_.Have(func);
     }
     void SetError(AB::GameProtocol::AttackError error);
     Actor* _LuaGetSource();
@@ -33,12 +33,15 @@
 #include <AB/Packets/Packet.h>
 #include <AB/Packets/ServerPackets.h>
 #include <abscommon/BanManager.h>
+#include <abscommon/DispatcherPool.h>
 #include <abscommon/StringUtils.h>
+#include <sa/Bits.h>
 #include <sa/time.h>
 
 namespace Net {
 
 std::string ProtocolGame::serverId_ = Utils::Uuid::EMPTY_UUID;
+bool ProtocolGame::compressMessages_ = true;
 
 ProtocolGame::ProtocolGame(std::shared_ptr<Connection> connection) :
     Protocol(connection)
@@ -620,6 +623,8 @@ void ProtocolGame::OnRecvFirstMessage(NetworkMessage& msg)
         DisconnectClient(AB::ErrorCodes::WrongProtocolVersion);
         return;
     }
+    compressionEnabled_ = compressMessages_ &&
+        sa::bits::is_set(packet.capabilities, AB::ClientCapabilityCompression);
     for (int i = 0; i < DH_KEY_LENGTH; ++i)
         clientKey_[i] = packet.key[i];
     auto* keys = GetSubsystem<Crypto::DHKeys>();
@@ -713,12 +718,45 @@ void ProtocolGame::Connect()
     EnterGame(player);
 }
 
+void ProtocolGame::PostPlayerTask(Game::Player& player, std::function<void(void)>&& task)
+{
+    if (auto game = player.GetGame())
+    {
+        game->Post(std::move(task));
+        return;
+    }
+    GetSubsystem<Asynch::Dispatcher>()->Add(Asynch::CreateTask(std::move(task)));
+}
+
 void ProtocolGame::WriteToOutput(const NetworkMessage& message)
 {
 #ifdef DEBUG_NET
-    ASSERT(GetSubsystem<Asynch::Dispatcher>()->IsDispatcherThread());
+    auto* lanes = GetSubsystem<Asynch::DispatcherPool>();
+    ASSERT(lanes->GetCurrentLane() < lanes->GetCount());
+#endif
+    AppendToOutput(message.GetSize(), [&message](OutputMessage& output)
+    {
+        output.Append(message);
+    });
+}
+
+void ProtocolGame::WriteToOutput(const NetworkMessage& message, const MessageFilter::Ranges& ranges)
+{
+#ifdef DEBUG_NET
+    auto* lanes = GetSubsystem<Asynch::DispatcherPool>();
+    ASSERT(lanes->GetCurrentLane() < lanes->GetCount());
 #endif
-    GetOutputBuffer(message.GetSize())->Append(message);
+    size_t size = 0;
+    for (const auto& range : ranges)
+        size += range.second;
+    if (size == 0)
+        return;
+    // Copy the ranges directly into the output buffer
+    AppendToOutput(size, [&message, &ranges](OutputMessage& output)
+    {
+        for (const auto& range : ranges)
+            output.Append(message.GetBuffer() + range.first, range.second);
+    });
 }
 
 void ProtocolGame::EnterGame(ea::shared_ptr<Game::Player> player)
@@ -774,7 +812,10 @@ void ProtocolGame::EnterGame(ea::shared_ptr<Game::Player> player)
     WriteToOutput(*output);
 
     // (2) Then we can send all the rest that happens when entering an game
-    instance->PlayerJoin(player->id_);
+    if (instance->IsLaneThread())
+        instance->PlayerJoin(player->id_);
+    else
+        instance->Post(std::bind(&Game::Game::PlayerJoin, instance, player->id_));
 }
 
 void ProtocolGame::ChangeServerInstance(const std::string& serverUuid,
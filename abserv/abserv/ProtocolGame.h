@@ -29,6 +29,7 @@
 #include <AB/ProtocolCodes.h>
 #include <abscommon/Subsystems.h>
 #include "InputQueue.h"
+#include "MessageFilter.h"
 #include <AB/Packets/ClientPackets.h>
 #include <eastl.hpp>
 
@@ -48,6 +49,8 @@ public:
     enum { UseChecksum = true };
     static const char* ProtocolName() { return "Game Protocol"; }
     static std::string serverId_;
+    /// Compress messages to clients supporting it
+    static bool compressMessages_;
 private:
     ea::weak_ptr<Game::Player> player_;
     DH_KEY clientKey_;
@@ -72,17 +75,17 @@ public:
     void ChangeServerInstance(const std::string& serverUuid,
         const std::string& mapUuid, const std::string& instanceUuid);
     void WriteToOutput(const NetworkMessage& message);
+    /// Write only the ranges of message
+    void WriteToOutput(const NetworkMessage& message, const MessageFilter::Ranges& ranges);
 private:
     template <typename Callable, typename... Args>
     void AddPlayerTask(Callable&& function, Args&&... args)
     {
         if (auto player = GetPlayer())
-        {
-            GetSubsystem<Asynch::Dispatcher>()->Add(
-                Asynch::CreateTask(std::bind(std::move(function), player, std::forward<Args>(args)...))
-            );
-        }
+            PostPlayerTask(*player, std::bind(std::move(function), player, std::forward<Args>(args)...));
     }
+    /// Player tasks run on the lane of the game the player is in
+    void PostPlayerTask(Game::Player& player, std::function<void(void)>&& task);
 
     std::shared_ptr<ProtocolGame> GetPtr()
     {
@@ -57,29 +57,51 @@ Quest::Quest(Player& owner,
 {
     owner_.SubscribeEvent<void(Actor*, Actor*)>(EVENT_ON_KILLEDFOE, std::bind(&Quest::OnKilledFoe,
         this, std::placeholders::_1, std::placeholders::_2));
-    InitializeLua();
     LoadProgress();
 }
 
+Quest::~Quest()
+{
+    // May be on a different lane than the state
+    functions_.Release(luaEnv_);
+}
+
 void Quest::InitializeLua()
 {
-    Lua::RegisterLuaAll(luaState_);
-    luaState_["self"] = this;
+    // Quests move with the player between games, they use the VM of the current lane
+    luaEnv_.Create(Lua::GetLaneState());
+    luaEnv_["self"] = this;
 }
 
 bool Quest::LoadScript(const std::string& fileName)
 {
     if (fileName.empty())
         return false;
+    scriptFile_ = fileName;
+    return ExecuteScript();
+}
 
-    auto script = GetSubsystem<IO::DataProvider>()->GetAsset<Script>(fileName);
+bool Quest::EnsureLua()
+{
+    if (!luaEnv_.NeedsBind())
+        return true;
+    return ExecuteScript();
+}
+
+bool Quest::ExecuteScript()
+{
+    functions_.Release(luaEnv_);
+    InitializeLua();
+    auto script = GetSubsystem<IO::DataProvider>()->GetAsset<Script>(scriptFile_);
     if (!script)
         return false;
-    if (!script->Execute(luaState_))
+    if (!script->Execute(luaEnv_))
         return false;
 
-    if (Lua::IsFunction(luaState_, "onUpdate"))
-        sa::bits::set(functions_, FunctionUpdate);
+    functions_.Resolve(luaEnv_, {
+        { FunctionUpdate, "onUpdate" },
+        { FunctionOnKilledFoe, "onKilledFoe" }
+    });
     return true;
 }
 
@@ -140,7 +162,7 @@ void Quest::Update(uint32_t timeElapsed)
         return;
 
     if (HaveFunction(FunctionUpdate))
-        luaState_["onUpdate"](timeElapsed);
+        functions_[FunctionUpdate](timeElapsed);
 }
 
 void Quest::Write(Net::NetworkMessage& message)
@@ -211,7 +233,8 @@ void Quest::SetVar(const std::string& name, const Utils::Variant& val)
 
 void Quest::OnKilledFoe(Actor* foe, Actor* killer)
 {
-    Lua::CallFunction(luaState_, "onKilledFoe", foe, killer);
+    if (EnsureLua())
+        functions_.Call(FunctionOnKilledFoe, foe, killer);
 }
 
 bool Quest::IsActive() const
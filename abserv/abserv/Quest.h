@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include "ScriptManager.h"
 #include <abscommon/Variant.h>
 #include <stdint.h>
 #include <kaguya/kaguya.hpp>
@@ -42,11 +43,13 @@ class Quest
 private:
     enum Function : uint32_t
     {
-        FunctionNone,
+        FunctionNone = 0,
         FunctionUpdate = 1,
+        FunctionOnKilledFoe = 1 << 1,
     };
-    uint32_t functions_{ FunctionNone };
-    kaguya::State luaState_;
+    Lua::Environment luaEnv_;
+    Lua::ScriptFunctions<Function, 2> functions_;
+    std::string scriptFile_;
     Utils::VariantMap variables_;
     Player& owner_;
     uint32_t index_;
@@ -54,9 +57,12 @@ private:
     bool internalRewarded_{ false };
     bool internalDeleted_{ false };
     void InitializeLua();
-    bool HaveFunction(Function func) const
+    bool ExecuteScript();
+    /// Rebind the script when the Quest is used on a different lane than before
+    bool EnsureLua();
+    bool HaveFunction(Function func)
     {
-        return sa::bits::is_set(functions_, func);
+        return EnsureLua() && functions_.Have(func);
     }
     std::string _LuaGetVarString(const std::string& name);
     void _LuaSetVarString(const std::string& name, const std::string& value);
@@ -76,7 +82,7 @@ public:
     Quest(const Quest&) = delete;
     Quest& operator=(const Quest&) = delete;
 
-    ~Quest() = default;
+    ~Quest();
 
     bool LoadScript(const std::string& fileName);
 
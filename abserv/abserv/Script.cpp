@@ -21,33 +21,95 @@
 
 
 #include "Script.h"
+#include "ScriptManager.h"
+#include <abscommon/Logger.h>
+#include <sa/StringTempl.h>
 
 namespace Game {
 
-namespace Internal {
-template<typename CharT, typename TraitsT = std::char_traits<CharT> >
-class vectorbuf : public std::basic_streambuf<CharT, TraitsT>
+/// Run the precompiled chunk, see IOScript. If envIndex is not 0, the table at this
+/// index becomes the global table of the chunk.
+static bool RunChunk(lua_State* L, const ea::vector<char>& buffer, const std::string& name,
+    int envIndex)
 {
-public:
-    vectorbuf(ea::vector<CharT>& vec)
+    if (envIndex != 0)
+        envIndex = lua_absindex(L, envIndex);
+    kaguya::util::ScopedSavedStack save(L);
+    const std::string chunkName = "@" + name;
+    if (luaL_loadbufferx(L, buffer.data(), buffer.size(), chunkName.c_str(), "b") != LUA_OK)
     {
-        this->setg(vec.data(), vec.data(), vec.data() + vec.size());
+        LOG_ERROR << "Error loading script " << name << ": " << lua_tostring(L, -1) << std::endl;
+        return false;
+    }
+    if (envIndex != 0)
+    {
+        // _ENV is the first upvalue of a main chunk
+        lua_pushvalue(L, envIndex);
+        lua_setupvalue(L, -2, 1);
     }
-};
+    kaguya::LuaStackRef chunk(L, -1, true);
+    kaguya::FunctionResults ret = chunk.call<kaguya::FunctionResults>();
+    return !ret.resultStatus();
 }
 
 Script::~Script() = default;
 
 bool Script::Execute(kaguya::State& luaState)
 {
-    Internal::vectorbuf<char> databuf(buffer_);
-    std::istream is(&databuf);
-    if (!luaState.dostream(is))
+    return RunChunk(luaState.state(), buffer_, GetFileName(), 0);
+}
+
+bool Script::Execute(Lua::Environment& env)
+{
+    lua_State* L = env.GetState().state();
+    kaguya::util::ScopedSavedStack save(L);
+    env.GetTable().push(L);
+    return RunChunk(L, buffer_, GetFileName(), -1);
+}
+
+bool Script::Execute(lua_State* L, int envIndex)
+{
+    return RunChunk(L, buffer_, GetFileName(), envIndex);
+}
+
+int Script::LuaInclude(lua_State* L)
+{
+    const std::string file = luaL_checkstring(L, 1);
+    const int env = lua_upvalueindex(1);
+    auto loader = reinterpret_cast<Loader>(lua_touserdata(L, lua_upvalueindex(2)));
+    auto script = loader(file);
+    if (!script)
+        return 0;
+
+    // Make something like an include guard, it lives in the environment and not in
+    // the globals it inherits.
+    std::string ident(file);
+    sa::MakeIdent(ident);
+    ident = "__included_" + ident + "__";
+    lua_pushstring(L, ident.c_str());
+    if (lua_rawget(L, env) != LUA_TNIL)
+        return 0;
+    lua_pop(L, 1);
+    if (script->Execute(L, env))
     {
-        LOG_ERROR << lua_tostring(luaState.state(), -1) << std::endl;
-        return false;
+        lua_pushstring(L, ident.c_str());
+        lua_pushboolean(L, 1);
+        lua_rawset(L, env);
     }
-    return true;
+    return 0;
+}
+
+void Script::AddInclude(kaguya::LuaTable& env, Loader loader)
+{
+    lua_State* L = env.state();
+    kaguya::util::ScopedSavedStack save(L);
+    env.push(L);
+    lua_pushstring(L, "include");
+    // The closure references the environment, the GC collects this cycle.
+    lua_pushvalue(L, -2);
+    lua_pushlightuserdata(L, reinterpret_cast<void*>(loader));
+    lua_pushcclosure(L, &Script::LuaInclude, 2);
+    lua_rawset(L, -3);
 }
 
 }
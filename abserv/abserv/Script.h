@@ -24,17 +24,27 @@
 #include <eastl.hpp>
 #include "Asset.h"
 
+struct lua_State;
+
 namespace kaguya {
 class State;
+class LuaTable;
 }
 
 namespace Game {
 
+namespace Lua {
+class Environment;
+}
+
 class Script final : public IO::Asset
 {
 private:
     ea::vector<char> buffer_;
+    bool Execute(lua_State* L, int envIndex);
+    static int LuaInclude(lua_State* L);
 public:
+    using Loader = ea::shared_ptr<Script>(*)(const std::string& name);
     Script() :
         IO::Asset()
     { }
@@ -47,6 +57,12 @@ public:
 
     /// Execute the script
     bool Execute(kaguya::State& luaState);
+    /// Execute the script with env as its global table
+    bool Execute(Lua::Environment& env);
+    /// Add an include function to the environment table env. Included scripts run with
+    /// env as their global table once per environment, so their globals are not shared
+    /// with other environments.
+    static void AddInclude(kaguya::LuaTable& env, Loader loader);
 };
 
 }
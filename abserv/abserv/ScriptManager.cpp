@@ -34,6 +34,7 @@
 #include "Projectile.h"
 #include "Quest.h"
 #include "Script.h"
+#include <abscommon/DispatcherPool.h>
 #include <sa/StringTempl.h>
 #include <sa/time.h>
 
@@ -47,6 +48,11 @@ static void LuaErrorHandler(int errCode, const char* message)
     LOG_ERROR << "Lua Error (" << errCode << "): " << message << std::endl;
 }
 
+static ea::shared_ptr<Script> LoadScript(const std::string& file)
+{
+    return GetSubsystem<IO::DataProvider>()->GetAsset<Script>(file);
+}
+
 void RegisterLuaAll(kaguya::State& state)
 {
     state.setErrorHandler(LuaErrorHandler);
@@ -69,9 +75,10 @@ void RegisterLuaAll(kaguya::State& state)
     {
         return Group::GetNewId();
     });
+    // Environments have their own include, see Script::AddInclude()
     state["include"] = kaguya::function([&state](const std::string& file)
     {
-        auto script = GetSubsystem<IO::DataProvider>()->GetAsset<Script>(file);
+        auto script = LoadScript(file);
         if (script)
         {
             // Make something like an include guard
@@ -112,10 +119,96 @@ void RegisterLuaAll(kaguya::State& state)
         mainS->Execute(state);
 }
 
+/// Each lane is one thread
+static thread_local ea::shared_ptr<SharedState> laneState;
+
+static size_t GetCurrentLane()
+{
+    auto* lanes = GetSubsystem<Asynch::DispatcherPool>();
+    if (!lanes)
+        return SharedState::NO_LANE;
+    const size_t lane = lanes->GetCurrentLane();
+    if (lane >= lanes->GetCount())
+        return SharedState::NO_LANE;
+    return lane;
+}
+
+SharedState::SharedState(size_t lane /* = NO_LANE */) :
+    envMeta_(state_.newTable()),
+    lane_(lane)
+{
+    RegisterLuaAll(state_);
+    envMeta_["__index"] = state_.globalTable();
+}
+
+bool SharedState::IsUsable() const
+{
+    if (lane_ == NO_LANE)
+        return true;
+    return GetCurrentLane() == lane_;
+}
+
+void SharedState::Release(kaguya::Ref::RegistoryRef&& ref)
+{
+    if (IsUsable())
+    {
+        // Goes out of scope now
+        kaguya::Ref::RegistoryRef r(std::move(ref));
+        return;
+    }
+    std::scoped_lock lock(releasedLock_);
+    released_.push_back(std::move(ref));
+}
+
+void SharedState::FreeReleased()
+{
+    ea::vector<kaguya::Ref::RegistoryRef> released;
+    {
+        std::scoped_lock lock(releasedLock_);
+        if (released_.empty())
+            return;
+        released.swap(released_);
+    }
+}
+
+ea::shared_ptr<SharedState> GetLaneState()
+{
+    if (laneState)
+    {
+        laneState->FreeReleased();
+        return laneState;
+    }
+    const size_t lane = GetCurrentLane();
+    if (lane == SharedState::NO_LANE)
+        return ea::make_shared<SharedState>();
+    laneState = ea::make_shared<SharedState>(lane);
+    return laneState;
+}
+
+kaguya::LuaTable SharedState::NewEnvironment()
+{
+    kaguya::LuaTable result = state_.newTable();
+    result.setMetatable(envMeta_);
+    Script::AddInclude(result, &LoadScript);
+    return result;
+}
+
 void CollectGarbage(kaguya::State& state)
 {
     state.gc().step();
 }
 
+void CollectGarbage(SharedState& state)
+{
+    state.FreeReleased();
+    CollectGarbage(state.GetState());
+}
+
+void CollectLaneGarbage()
+{
+    if (laneState)
+        CollectGarbage(*laneState);
+}
+
 }
 }
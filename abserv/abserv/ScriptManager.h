@@ -21,53 +21,231 @@
 
 #pragma once
 
+#include <eastl.hpp>
 #include <kaguya/kaguya.hpp>
+#include <limits>
+#include <mutex>
+#include <sa/Assert.h>
 
 namespace Game {
 namespace Lua {
 
 void RegisterLuaAll(kaguya::State& state);
 
+/// A Lua VM with all bindings registered once. It is shared by the scripts of many
+/// objects, each script runs in its own Environment.
+class SharedState
+{
+private:
+    kaguya::State state_;
+    /// Metatable of all environments, makes the globals of the state visible to them.
+    kaguya::LuaTable envMeta_;
+    /// The dispatcher lane using this state, NO_LANE when the owner takes care of it
+    size_t lane_;
+    /// References dropped on other lanes, they are freed on our lane
+    std::mutex releasedLock_;
+    ea::vector<kaguya::Ref::RegistoryRef> released_;
+public:
+    static constexpr size_t NO_LANE = std::numeric_limits<size_t>::max();
+    explicit SharedState(size_t lane = NO_LANE);
+    SharedState(const SharedState&) = delete;
+    SharedState& operator=(const SharedState&) = delete;
+
+    kaguya::State& GetState() { return state_; }
+    kaguya::LuaTable NewEnvironment();
+    size_t GetLane() const { return lane_; }
+    /// True when the state may be used by the calling thread
+    bool IsUsable() const;
+    /// Drop a reference into this state. Lua references must not be freed while
+    /// another thread uses the state, so this is deferred when called from another lane.
+    void Release(kaguya::Ref::RegistoryRef&& ref);
+    /// Free the references released from other lanes
+    void FreeReleased();
+};
+
+/// The state of the calling dispatcher lane, created on first use. Objects which move
+/// between lanes with a player (Skills, Effects, Items, Quests) run their scripts in it
+/// and rebind their Environment when they are used on a different lane. Returns a new
+/// private state when the calling thread is not a lane.
+ea::shared_ptr<SharedState> GetLaneState();
+
+/// Global table of one script instance inside a SharedState. Globals written by the
+/// script and the scripts it includes go into this table, reading falls back to the
+/// globals of the state, i.e. the bindings and main.lua. The environment keeps the state
+/// alive, so the owner of an Environment may outlive whoever created the state.
+class Environment
+{
+private:
+    // Declaration order matters: the table must be released before the state.
+    ea::shared_ptr<SharedState> state_;
+    kaguya::LuaTable table_;
+public:
+    Environment() = default;
+    Environment(const Environment&) = delete;
+    Environment& operator=(const Environment&) = delete;
+    ~Environment() { Release(); }
+
+    /// Create a new empty environment in state, releases the previous one.
+    void Create(ea::shared_ptr<SharedState> state)
+    {
+        Release();
+        state_ = std::move(state);
+        table_ = state_->NewEnvironment();
+    }
+    void Release()
+    {
+        if (!state_)
+            return;
+        state_->Release(std::move(table_));
+        table_ = kaguya::LuaTable();
+        state_.reset();
+    }
+    /// Drop a reference into the state of this environment, e.g. a function of the script
+    void Release(kaguya::Ref::RegistoryRef&& ref)
+    {
+        if (state_)
+            state_->Release(std::move(ref));
+    }
+    /// The environment was not created yet or on a different lane than the calling one.
+    /// The script must be executed in a new environment then, which resets its variables.
+    bool NeedsBind() const { return !state_ || !state_->IsUsable(); }
+    kaguya::State& GetState() { return state_->GetState(); }
+    const kaguya::LuaTable& GetTable() const { return table_; }
+
+    kaguya::TableKeyReferenceProxy<std::string> operator[](const std::string& name)
+    {
+        return table_[name];
+    }
+    kaguya::TableKeyReferenceProxy<const char*> operator[](const char* name)
+    {
+        return table_[name];
+    }
+};
+
+// The helpers below work with a kaguya::State and an Environment.
+
 /// Check if a function exists
-inline bool IsFunction(kaguya::State& state, const std::string& name)
+template<typename T>
+inline bool IsFunction(T& state, const std::string& name)
 {
     return state[name].type() == LUA_TFUNCTION;
 }
 
-inline bool IsVariable(kaguya::State& state, const std::string& name)
+template<typename T>
+inline bool IsVariable(T& state, const std::string& name)
 {
     auto t = state[name].type();
     return t == LUA_TBOOLEAN || t == LUA_TNUMBER || t == LUA_TSTRING;
 }
 
-inline bool IsString(kaguya::State& state, const std::string& name)
+template<typename T>
+inline bool IsString(T& state, const std::string& name)
 {
     return state[name].type() == LUA_TSTRING;
 }
 
-inline bool IsBool(kaguya::State& state, const std::string& name)
+template<typename T>
+inline bool IsBool(T& state, const std::string& name)
 {
     return state[name].type() == LUA_TBOOLEAN;
 }
 
-inline bool IsNumber(kaguya::State& state, const std::string& name)
+template<typename T>
+inline bool IsNumber(T& state, const std::string& name)
 {
     return state[name].type() == LUA_TNUMBER;
 }
 
-inline bool IsNil(kaguya::State& state, const std::string& name)
+template<typename T>
+inline bool IsNil(T& state, const std::string& name)
 {
     return state[name].type() == LUA_TNIL;
 }
 
-template<typename... _CArgs>
-inline void CallFunction(kaguya::State& state, const std::string& name, _CArgs&& ... _Args)
+template<typename T, typename... _CArgs>
+inline void CallFunction(T& state, const std::string& name, _CArgs&& ... _Args)
 {
     if (IsFunction(state, name))
         state[name](std::forward<_CArgs>(_Args)...);
 }
 
+/// Event functions of a script, looked up once after the script was executed.
+/// Calling an absent function does no Lua work, a present function is called
+/// through its reference instead of looking it up by name each time.
+/// Function is an enum of bit flags, Count the number of flags. Declare it after
+/// the state or environment, the references must be released first.
+template<typename Function, size_t Count>
+class ScriptFunctions
+{
+    static_assert(Count <= 32);
+private:
+    uint32_t present_{ 0 };
+    ea::array<kaguya::LuaFunction, Count> functions_;
+    static size_t Index(Function func)
+    {
+        auto value = static_cast<uint32_t>(func);
+        size_t result = 0;
+        while (value > 1)
+        {
+            value >>= 1;
+            ++result;
+        }
+        ASSERT(result < Count);
+        return result;
+    }
+public:
+    template<typename T>
+    void Resolve(T& state, std::initializer_list<ea::pair<Function, const char*>> names)
+    {
+        for (const auto& name : names)
+        {
+            auto ref = state[name.second];
+            if (ref.type() != LUA_TFUNCTION)
+                continue;
+            functions_[Index(name.first)] = ref.template get<kaguya::LuaFunction>();
+            present_ |= static_cast<uint32_t>(name.first);
+        }
+    }
+    void Reset()
+    {
+        present_ = 0;
+        for (auto& f : functions_)
+            f = kaguya::LuaFunction();
+    }
+    /// Like Reset() but the references are dropped through the environment,
+    /// use it when the functions may be released on a different lane.
+    void Release(Environment& env)
+    {
+        present_ = 0;
+        for (auto& f : functions_)
+        {
+            env.Release(std::move(f));
+            f = kaguya::LuaFunction();
+        }
+    }
+    bool Have(Function func) const
+    {
+        return (present_ & static_cast<uint32_t>(func)) != 0;
+    }
+    /// Call the function and ignore its result, does nothing when the script doesn't have it.
+    template<typename... _CArgs>
+    void Call(Function func, _CArgs&& ... _Args)
+    {
+        if (Have(func))
+            functions_[Index(func)](std::forward<_CArgs>(_Args)...);
+    }
+    /// Get the function to call it with results. Check with Have() first.
+    kaguya::LuaFunction& operator[](Function func)
+    {
+        ASSERT(Have(func));
+        return functions_[Index(func)];
+    }
+};
+
 void CollectGarbage(kaguya::State& state);
+void CollectGarbage(SharedState& state);
+/// Step the GC of the state of the calling lane, if it has one
+void CollectLaneGarbage();
 
 }
 }
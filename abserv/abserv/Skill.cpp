@@ -53,41 +53,75 @@ void Skill::RegisterLua(kaguya::State& state)
     // clang-format on
 }
 
+Skill::~Skill()
+{
+    // May be on a different lane than the state
+    functions_.Release(luaEnv_);
+}
+
 void Skill::InitializeLua()
 {
-    Lua::RegisterLuaAll(luaState_);
-    luaState_["self"] = this;
+    // Skills move with the player between games, they use the VM of the current lane
+    luaEnv_.Create(Lua::GetLaneState());
+    luaEnv_["self"] = this;
 }
 
-bool Skill::LoadScript(const std::string& fileName)
+bool Skill::ExecuteScript(const std::string& fileName)
 {
+    functions_.Release(luaEnv_);
+    InitializeLua();
     auto script = GetSubsystem<IO::DataProvider>()->GetAsset<Script>(fileName);
     if (!script)
         return false;
-    if (!script->Execute(luaState_))
+    if (!script->Execute(luaEnv_))
+        return false;
+
+    functions_.Resolve(luaEnv_, {
+        { FunctionOnStartUse, "onStartUse" },
+        { FunctionOnSuccess, "onSuccess" },
+        { FunctionCanUse, "canUse" },
+        { FunctionOnCancelled, "onCancelled" },
+        { FunctionOnInterrupted, "onInterrupted" }
+    });
+    return true;
+}
+
+bool Skill::EnsureLua()
+{
+    if (luaEnv_.NeedsBind() && !ExecuteScript(data_.script))
+        return false;
+    return HaveFunction(FunctionOnStartUse) && HaveFunction(FunctionOnSuccess);
+}
+
+bool Skill::LoadScript(const std::string& fileName)
+{
+    if (!ExecuteScript(fileName))
         return false;
 
-    energy_ = luaState_["costEnergy"];
-    adrenaline_ = luaState_["costAdrenaline"];
-    activation_ = luaState_["activation"];
-    recharge_ = luaState_["recharge"];
-    overcast_ = luaState_["overcast"];
-    if (Lua::IsNumber(luaState_, "hp"))
-        hp_ = luaState_["hp"];
-
-    if (Lua::IsNumber(luaState_, "range"))
-        range_ = static_cast<Ranges>(luaState_["range"]);
-    if (Lua::IsNumber(luaState_, "targetType"))
-        targetType_ = static_cast<SkillTargetType>(luaState_["targetType"]);
-    if (Lua::IsNumber(luaState_, "effect"))
-        skillEffect_ = static_cast<uint32_t>(luaState_["effect"]);
-    if (Lua::IsNumber(luaState_, "effectTarget"))
-        effectTarget_ = static_cast<uint32_t>(luaState_["effectTarget"]);
-    if (Lua::IsNumber(luaState_, "canInterrupt"))
-        canInterrupt_ = luaState_["canInterrupt"];
-
-    haveOnCancelled_ = Lua::IsFunction(luaState_, "onCancelled");
-    haveOnInterrupted_ = Lua::IsFunction(luaState_, "onInterrupted");
+    energy_ = luaEnv_["costEnergy"];
+    adrenaline_ = luaEnv_["costAdrenaline"];
+    activation_ = luaEnv_["activation"];
+    recharge_ = luaEnv_["recharge"];
+    overcast_ = luaEnv_["overcast"];
+    if (Lua::IsNumber(luaEnv_, "hp"))
+        hp_ = luaEnv_["hp"];
+
+    if (Lua::IsNumber(luaEnv_, "range"))
+        range_ = static_cast<Ranges>(luaEnv_["range"]);
+    if (Lua::IsNumber(luaEnv_, "targetType"))
+        targetType_ = static_cast<SkillTargetType>(luaEnv_["targetType"]);
+    if (Lua::IsNumber(luaEnv_, "effect"))
+        skillEffect_ = static_cast<uint32_t>(luaEnv_["effect"]);
+    if (Lua::IsNumber(luaEnv_, "effectTarget"))
+        effectTarget_ = static_cast<uint32_t>(luaEnv_["effectTarget"]);
+    if (Lua::IsNumber(luaEnv_, "canInterrupt"))
+        canInterrupt_ = luaEnv_["canInterrupt"];
+
+    if (!HaveFunction(FunctionOnStartUse) || !HaveFunction(FunctionOnSuccess))
+    {
+        LOG_ERROR << "Skill script " << fileName << " does not define onStartUse() and onSuccess()" << std::endl;
+        return false;
+    }
 
     return true;
 }
@@ -102,7 +136,10 @@ void Skill::Update(uint32_t)
             auto source = source_.lock();
             auto target = target_.lock();
             // A Skill may even fail here, e.g. when resurrecting an already resurrected target
-            lastError_ = luaState_["onSuccess"](source.get(), target.get());
+            if (EnsureLua())
+                lastError_ = functions_[FunctionOnSuccess](source.get(), target.get());
+            else
+                lastError_ = AB::GameProtocol::SkillError::CannotUseSkill;
             startUse_ = 0;
             if (lastError_ != AB::GameProtocol::SkillError::None)
                 recharged_ = 0;
@@ -200,9 +237,11 @@ uint32_t Skill::GetRecharge(uint32_t recharge)
 
 AB::GameProtocol::SkillError Skill::CanUse(Actor* source, Actor* target)
 {
-    if (Lua::IsFunction(luaState_, "canUse"))
-        return luaState_["canUse"](source, target);
-    return luaState_["onStartUse"](source, target);
+    if (!EnsureLua())
+        return AB::GameProtocol::SkillError::CannotUseSkill;
+    if (HaveFunction(FunctionCanUse))
+        return functions_[FunctionCanUse](source, target);
+    return functions_[FunctionOnStartUse](source, target);
 }
 
 AB::GameProtocol::SkillError Skill::StartUse(ea::shared_ptr<Actor> source, ea::shared_ptr<Actor> target)
@@ -228,12 +267,18 @@ AB::GameProtocol::SkillError Skill::StartUse(ea::shared_ptr<Actor> source, ea::s
     if (lastError_ != AB::GameProtocol::SkillError::None)
         return lastError_;
 
+    if (!EnsureLua())
+    {
+        lastError_ = AB::GameProtocol::SkillError::CannotUseSkill;
+        return lastError_;
+    }
+
     startUse_ = sa::time::tick();
 
     source_ = source;
     target_ = target;
 
-    lastError_ = luaState_["onStartUse"](source.get(), target.get());
+    lastError_ = functions_[FunctionOnStartUse](source.get(), target.get());
     if (lastError_ != AB::GameProtocol::SkillError::None)
     {
         startUse_ = 0;
@@ -252,11 +297,10 @@ AB::GameProtocol::SkillError Skill::StartUse(ea::shared_ptr<Actor> source, ea::s
 void Skill::CancelUse()
 {
     auto source = source_.lock();
-    if (haveOnCancelled_)
+    if (EnsureLua() && HaveFunction(FunctionOnCancelled))
     {
         auto target = target_.lock();
-        Lua::CallFunction(luaState_, "onCancelled",
-            source.get(), target.get());
+        functions_[FunctionOnCancelled](source.get(), target.get());
     }
     if (source)
         source->CallEvent<void(Skill*)>(EVENT_ON_ENDUSESKILL, this);
@@ -273,11 +317,10 @@ bool Skill::Interrupt()
         return false;
 
     auto source = source_.lock();
-    if (haveOnInterrupted_)
+    if (EnsureLua() && HaveFunction(FunctionOnInterrupted))
     {
         auto target = target_.lock();
-        Lua::CallFunction(luaState_, "onInterrupted",
-            source.get(), target.get());
+        functions_[FunctionOnInterrupted](source.get(), target.get());
     }
     if (source)
     {
@@ -22,6 +22,7 @@
 #pragma once
 
 #include "GameObject.h"
+#include "ScriptManager.h"
 #include <AB/Entities/Skill.h>
 #include <AB/ProtocolCodes.h>
 #include <eastl.hpp>
@@ -82,7 +83,17 @@ class Skill
     NON_COPYABLE(Skill)
     friend class SkillBar;
 private:
-    kaguya::State luaState_;
+    enum Function : uint32_t
+    {
+        FunctionNone = 0,
+        FunctionOnStartUse = 1,
+        FunctionOnSuccess = 1 << 1,
+        FunctionCanUse = 1 << 2,
+        FunctionOnCancelled = 1 << 3,
+        FunctionOnInterrupted = 1 << 4,
+    };
+    Lua::Environment luaEnv_;
+    Lua::ScriptFunctions<Function, 5> functions_;
     int64_t startUse_{ 0 };
     int64_t lastUse_{ 0 };
     int64_t recharged_{ 0 };
@@ -100,12 +111,17 @@ private:
     int32_t realOvercast_{ 0 };
     int32_t realHp_{ 0 };
 
-    bool haveOnCancelled_{ false };
-    bool haveOnInterrupted_{ false };
     AB::GameProtocol::SkillError lastError_{ AB::GameProtocol::SkillError::None };
 
     bool CanUseSkill(Actor& source, Actor* target);
     void InitializeLua();
+    bool ExecuteScript(const std::string& fileName);
+    /// Rebind the script when the Skill is used on a different lane than before
+    bool EnsureLua();
+    bool HaveFunction(Function func) const
+    {
+        return functions_.Have(func);
+    }
     int _LuaGetType() const { return static_cast<int>(data_.type); }
     uint32_t _LuaGetIndex() const { return data_.index; }
     bool _LuaIsElite() const { return data_.isElite; }
@@ -118,11 +134,9 @@ public:
 
     explicit Skill(const AB::Entities::Skill& skill) :
         data_(skill)
-    {
-        InitializeLua();
-    }
+    { }
     // non-copyable
-    ~Skill() = default;
+    ~Skill();
 
     bool LoadScript(const std::string& fileName);
     void Update(uint32_t timeElapsed);
@@ -0,0 +1,138 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "StateSnapshot.h"
+#include <AB/Packets/Packet.h>
+#include <AB/ProtocolCodes.h>
+#include <cmath>
+#include <limits>
+
+namespace Game {
+
+static int32_t Quantize(float value, float precision)
+{
+    return static_cast<int32_t>(std::lround(value * precision));
+}
+
+bool StateSnapshot::Update(State& state, const float pos[3], float yRot, bool manual)
+{
+    const State current = {
+        { Quantize(pos[0], POSITION_PRECISION), Quantize(pos[1], POSITION_PRECISION), Quantize(pos[2], POSITION_PRECISION) },
+        Quantize(yRot, ROTATION_PRECISION),
+        manual
+    };
+    if (current.pos[0] == state.pos[0] && current.pos[1] == state.pos[1] && current.pos[2] == state.pos[2] &&
+        current.rot == state.rot && current.manual == state.manual)
+        return false;
+    state = current;
+    return true;
+}
+
+void StateSnapshot::WriteChanges(uint32_t id, const State* last, const State& state, Net::NetworkMessage& message)
+{
+    if (!last || last->pos[0] != state.pos[0] || last->pos[1] != state.pos[1] || last->pos[2] != state.pos[2])
+    {
+        bool delta = last != nullptr;
+        int32_t diff[3] = {};
+        for (size_t i = 0; delta && i < 3; ++i)
+        {
+            diff[i] = state.pos[i] - last->pos[i];
+            delta = diff[i] >= std::numeric_limits<int16_t>::min() && diff[i] <= std::numeric_limits<int16_t>::max();
+        }
+        if (delta)
+        {
+            message.AddByte(AB::GameProtocol::ServerPacketType::ObjectPositionDelta);
+            AB::Packets::Server::ObjectPositionDelta packet = {
+                id,
+                { static_cast<int16_t>(diff[0]), static_cast<int16_t>(diff[1]), static_cast<int16_t>(diff[2]) }
+            };
+            AB::Packets::Add(packet, message);
+        }
+        else
+        {
+            // The client quantizes it again and gets the same value
+            message.AddByte(AB::GameProtocol::ServerPacketType::ObjectPositionUpdate);
+            AB::Packets::Server::ObjectPositionUpdate packet = {
+                id,
+                {
+                    static_cast<float>(state.pos[0]) / POSITION_PRECISION,
+                    static_cast<float>(state.pos[1]) / POSITION_PRECISION,
+                    static_cast<float>(state.pos[2]) / POSITION_PRECISION
+                }
+            };
+            AB::Packets::Add(packet, message);
+        }
+    }
+    if (!last || last->rot != state.rot)
+    {
+        message.AddByte(AB::GameProtocol::ServerPacketType::ObjectRotationUpdate);
+        AB::Packets::Server::ObjectRotationUpdate packet = {
+            id,
+            static_cast<float>(state.rot) / ROTATION_PRECISION,
+            state.manual
+        };
+        AB::Packets::Add(packet, message);
+    }
+}
+
+void StateSnapshot::Write(const ea::vector<uint32_t>& inRange, const ea::vector<uint32_t>& changed,
+    const GetStateFunc& getState, Net::NetworkMessage& message)
+{
+    // Objects that are no longer in range are dropped, so they are sent again when
+    // they come back.
+    entries_.swap(prevEntries_);
+    entries_.clear();
+    // All three are sorted, so merge them
+    size_t prev = 0;
+    size_t change = 0;
+    for (uint32_t id : inRange)
+    {
+        while (prev < prevEntries_.size() && prevEntries_[prev].id < id)
+            ++prev;
+        const Entry* last = (prev < prevEntries_.size() && prevEntries_[prev].id == id) ?
+            &prevEntries_[prev] : nullptr;
+        while (change < changed.size() && changed[change] < id)
+            ++change;
+        const bool isChanged = change < changed.size() && changed[change] == id;
+        if (last && !isChanged)
+        {
+            entries_.push_back(*last);
+            continue;
+        }
+
+        const State* state = getState(id);
+        if (!state)
+        {
+            entries_.push_back({ id, false, {} });
+            continue;
+        }
+        WriteChanges(id, (last && last->hasState) ? &last->state : nullptr, *state, message);
+        entries_.push_back({ id, true, *state });
+    }
+}
+
+void StateSnapshot::Clear()
+{
+    entries_.clear();
+    prevEntries_.clear();
+}
+
+}
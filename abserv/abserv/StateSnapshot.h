@@ -0,0 +1,77 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <AB/Packets/ServerPackets.h>
+#include <abscommon/NetworkMessage.h>
+#include <eastl.hpp>
+#include <stdint.h>
+
+namespace Game {
+
+/// The position and rotation of other objects last sent to a player. Each game tick
+/// only objects in the interest range of the player whose quantized position or
+/// rotation changed since then are written. Positions are sent as the difference to
+/// the last sent position when it is small enough.
+class StateSnapshot
+{
+public:
+    /// Quantized position and rotation of an object
+    struct State
+    {
+        int32_t pos[3];
+        int32_t rot;
+        /// The rotation was set manually, the client snaps to it instead of turning
+        bool manual;
+    };
+    /// Returns nullptr for objects which don't have a State, i.e. don't move
+    using GetStateFunc = ea::function<const State*(uint32_t id)>;
+private:
+    struct Entry
+    {
+        uint32_t id;
+        bool hasState;
+        State state;
+    };
+    /// Sorted by ID, like the ranges of the player
+    ea::vector<Entry> entries_;
+    ea::vector<Entry> prevEntries_;
+    static void WriteChanges(uint32_t id, const State* last, const State& state, Net::NetworkMessage& message);
+public:
+    /// 1 cm
+    static constexpr float POSITION_PRECISION = AB::Packets::Server::POSITION_DELTA_PRECISION;
+    /// ~0.25 deg
+    static constexpr float ROTATION_PRECISION = 256.0f;
+
+    /// Returns true when state changed
+    static bool Update(State& state, const float pos[3], float yRot, bool manual);
+
+    /// Write the changes since the last call to message.
+    /// @param inRange IDs of the objects in the interest range of the player, sorted
+    /// @param changed IDs of the objects whose State changed since the last call, sorted.
+    /// Only these and objects entering the range are looked up with getState.
+    void Write(const ea::vector<uint32_t>& inRange, const ea::vector<uint32_t>& changed,
+        const GetStateFunc& getState, Net::NetworkMessage& message);
+    void Clear();
+};
+
+}
@@ -117,8 +117,8 @@ float TerrainPatch::CastRay(const Math::Vector3& origin, const Math::Vector3& di
     return Math::M_INFINITE;
 }
 
-void TerrainPatch::ProcessRayQuery(const Math::RayOctreeQuery& query,
-    ea::vector<Math::RayQueryResult>& results)
+void TerrainPatch::ProcessRayQuery(const RayQuery& query,
+    ea::vector<RayQueryResult>& results)
 {
     if (auto o = owner_.lock())
     {
@@ -137,7 +137,7 @@ void TerrainPatch::ProcessRayQuery(const Math::RayOctreeQuery& query,
 #ifdef DEBUG_COLLISION
             LOG_DEBUG << "Raycast hit " << *this << std::endl;
 #endif
-            Math::RayQueryResult result;
+            RayQueryResult result;
             result.position_ = query.ray_.origin_ + distance * query.ray_.direction_;
             result.normal_ = normal;
             result.distance_ = distance;
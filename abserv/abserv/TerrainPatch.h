@@ -43,8 +43,8 @@ public:
         const Math::Point<int>& size);
     ~TerrainPatch() override = default;
 
-    /// Process octree raycast.
-    void ProcessRayQuery(const Math::RayOctreeQuery& query, ea::vector<Math::RayQueryResult>& results) override;
+    /// Process spatial index raycast.
+    void ProcessRayQuery(const RayQuery& query, ea::vector<RayQueryResult>& results) override;
     Math::BoundingBox GetWorldBoundingBox() const override
     {
         return worldBoundingBox_;
@@ -0,0 +1,360 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "BoundingBox.h"
+#include "Ray.h"
+#include "Sphere.h"
+#include <algorithm>
+#include <cmath>
+#include <eastl.hpp>
+#include <limits>
+#include <sa/Assert.h>
+#include <stdint.h>
+
+namespace Math {
+
+/// Loose uniform grid on the XZ plane for 2.5D worlds. An object is stored in the cell
+/// containing the center of its bounding box, queries are extended by the largest
+/// extent of an object in a cell. Objects larger than a cell or outside of the grid are
+/// stored in a separate list. Moving an object is O(1). The bounding boxes are cached,
+/// so queries don't need to recalculate them.
+template<typename T>
+class LooseGrid
+{
+public:
+    using Id = uint32_t;
+    static constexpr Id INVALID_ID = std::numeric_limits<Id>::max();
+private:
+    static constexpr uint32_t LARGE_CELL = std::numeric_limits<uint32_t>::max();
+    struct Item
+    {
+        T* object;
+        BoundingBox box;
+        Id id;
+    };
+    struct Location
+    {
+        /// Cell index, LARGE_CELL for large objects
+        uint32_t cell;
+        /// Index in the cell
+        uint32_t index;
+    };
+    using Cell = ea::vector<Item>;
+    float minX_{ 0.0f };
+    float minZ_{ 0.0f };
+    float maxX_{ 0.0f };
+    float maxZ_{ 0.0f };
+    float cellSize_{ 1.0f };
+    float invCellSize_{ 1.0f };
+    int width_{ 0 };
+    int height_{ 0 };
+    /// Largest half extent of an object in a cell
+    float maxExtent_{ 0.0f };
+    ea::vector<Cell> cells_;
+    Cell large_;
+    ea::vector<Location> locations_;
+    ea::vector<Id> freeIds_;
+    size_t count_{ 0 };
+
+    static float GetHalfExtent(const BoundingBox& box)
+    {
+        const Vector3 size = box.Size();
+        const float result = 0.5f * std::max(size.x_, size.z_);
+        // Rotated it may be larger
+        return box.IsOriented() ? result * 1.4143f : result;
+    }
+    int GetCellX(float x) const
+    {
+        const int result = static_cast<int>(std::floor((x - minX_) * invCellSize_));
+        return std::clamp(result, 0, width_ - 1);
+    }
+    int GetCellZ(float z) const
+    {
+        const int result = static_cast<int>(std::floor((z - minZ_) * invCellSize_));
+        return std::clamp(result, 0, height_ - 1);
+    }
+    uint32_t GetCell(const BoundingBox& box) const
+    {
+        if (!box.IsDefined() || GetHalfExtent(box) > cellSize_)
+            return LARGE_CELL;
+        const Vector3 center = box.Center();
+        if (center.x_ < minX_ || center.x_ >= maxX_ || center.z_ < minZ_ || center.z_ >= maxZ_)
+            return LARGE_CELL;
+        return static_cast<uint32_t>(GetCellZ(center.z_) * width_ + GetCellX(center.x_));
+    }
+    Cell& GetCellItems(uint32_t cell)
+    {
+        return cell == LARGE_CELL ? large_ : cells_[cell];
+    }
+    void AddToCell(Id id, uint32_t cell, T* object, const BoundingBox& box)
+    {
+        Cell& items = GetCellItems(cell);
+        locations_[id] = { cell, static_cast<uint32_t>(items.size()) };
+        items.push_back({ object, box, id });
+        if (cell != LARGE_CELL)
+            maxExtent_ = std::max(maxExtent_, GetHalfExtent(box));
+    }
+    void RemoveFromCell(Id id)
+    {
+        const Location loc = locations_[id];
+        Cell& items = GetCellItems(loc.cell);
+        // Swap with the last, so we don't need to move all following items
+        if (loc.index + 1 != items.size())
+        {
+            items[loc.index] = items.back();
+            locations_[items[loc.index].id].index = loc.index;
+        }
+        items.pop_back();
+    }
+    template<typename Shape, typename Callback>
+    void QueryItems(const Shape& shape, const Vector3& center, float radius, Callback&& callback) const
+    {
+        for (const auto& item : large_)
+        {
+            if (shape.IsInsideFast(item.box) != Intersection::Outside)
+                callback(item.object);
+        }
+        if (count_ == large_.size())
+            return;
+
+        const float r = radius + maxExtent_;
+        const int x1 = GetCellX(center.x_ - r);
+        const int x2 = GetCellX(center.x_ + r);
+        const int z1 = GetCellZ(center.z_ - r);
+        const int z2 = GetCellZ(center.z_ + r);
+        for (int z = z1; z <= z2; ++z)
+            QueryRow(z, x1, x2, [&](const Item& item)
+            {
+                if (shape.IsInsideFast(item.box) != Intersection::Outside)
+                    callback(item.object);
+            });
+    }
+    template<typename Callback>
+    void QueryRow(int z, int x1, int x2, Callback&& callback) const
+    {
+        const Cell* cell = &cells_[static_cast<size_t>(z * width_ + x1)];
+        for (int x = x1; x <= x2; ++x, ++cell)
+        {
+            for (const auto& item : *cell)
+                callback(item);
+        }
+    }
+    /// Clip the ray parameter range [t1, t2] to a slab on one axis
+    static bool ClipRay(float origin, float direction, float min, float max, float& t1, float& t2)
+    {
+        if (std::fabs(direction) < M_EPSILON)
+            return origin >= min && origin <= max;
+        float ta = (min - origin) / direction;
+        float tb = (max - origin) / direction;
+        if (ta > tb)
+            std::swap(ta, tb);
+        t1 = std::max(t1, ta);
+        t2 = std::min(t2, tb);
+        return t1 <= t2;
+    }
+public:
+    LooseGrid() = default;
+    LooseGrid(const BoundingBox& bounds, float cellSize)
+    {
+        SetSize(bounds, cellSize);
+    }
+    /// Objects already in the grid are kept
+    void SetSize(const BoundingBox& bounds, float cellSize)
+    {
+        Cell items;
+        items.reserve(count_);
+        for (const auto& cell : cells_)
+            items.insert(items.end(), cell.begin(), cell.end());
+        items.insert(items.end(), large_.begin(), large_.end());
+
+        cellSize_ = std::max(cellSize, 1.0f);
+        invCellSize_ = 1.0f / cellSize_;
+        minX_ = bounds.min_.x_;
+        minZ_ = bounds.min_.z_;
+        width_ = std::max(static_cast<int>(std::ceil(bounds.Size().x_ * invCellSize_)), 1);
+        height_ = std::max(static_cast<int>(std::ceil(bounds.Size().z_ * invCellSize_)), 1);
+        maxX_ = minX_ + static_cast<float>(width_) * cellSize_;
+        maxZ_ = minZ_ + static_cast<float>(height_) * cellSize_;
+        maxExtent_ = 0.0f;
+        cells_.clear();
+        cells_.resize(static_cast<size_t>(width_) * static_cast<size_t>(height_));
+        large_.clear();
+        for (const auto& item : items)
+            AddToCell(item.id, GetCell(item.box), item.object, item.box);
+    }
+    Id Insert(T* object, const BoundingBox& box)
+    {
+        Id id;
+        if (!freeIds_.empty())
+        {
+            id = freeIds_.back();
+            freeIds_.pop_back();
+        }
+        else
+        {
+            id = static_cast<Id>(locations_.size());
+            locations_.push_back({});
+        }
+        AddToCell(id, GetCell(box), object, box);
+        ++count_;
+        return id;
+    }
+    void Remove(Id id)
+    {
+        if (id >= locations_.size())
+            return;
+        RemoveFromCell(id);
+        freeIds_.push_back(id);
+        --count_;
+    }
+    /// Update the bounding box of a moved object
+    void Move(Id id, const BoundingBox& box)
+    {
+        if (id >= locations_.size())
+            return;
+        const Location loc = locations_[id];
+        const uint32_t cell = GetCell(box);
+        if (cell == loc.cell)
+        {
+            GetCellItems(cell)[loc.index].box = box;
+            if (cell != LARGE_CELL)
+                maxExtent_ = std::max(maxExtent_, GetHalfExtent(box));
+            return;
+        }
+        T* object = GetCellItems(loc.cell)[loc.index].object;
+        RemoveFromCell(id);
+        AddToCell(id, cell, object, box);
+    }
+    size_t GetCount() const { return count_; }
+    /// Calls callback for all objects
+    template<typename Callback>
+    void VisitObjects(Callback&& callback) const
+    {
+        for (const auto& cell : cells_)
+        {
+            for (const auto& item : cell)
+                callback(item.object);
+        }
+        for (const auto& item : large_)
+            callback(item.object);
+    }
+    float GetCellSize() const { return cellSize_; }
+
+    /// Calls callback for all objects intersecting the sphere
+    template<typename Callback>
+    void Query(const Sphere& sphere, Callback&& callback) const
+    {
+        QueryItems(sphere, sphere.center_, sphere.radius_, std::forward<Callback>(callback));
+    }
+    /// Calls callback for all objects intersecting the box
+    template<typename Callback>
+    void Query(const BoundingBox& box, Callback&& callback) const
+    {
+        QueryItems(box, box.Center(), GetHalfExtent(box), std::forward<Callback>(callback));
+    }
+    void Query(const Sphere& sphere, ea::vector<T*>& result, const T* ignore = nullptr) const
+    {
+        Query(sphere, [&](T* object)
+        {
+            if (object != ignore)
+                result.push_back(object);
+        });
+    }
+    void Query(const BoundingBox& box, ea::vector<T*>& result, const T* ignore = nullptr) const
+    {
+        Query(box, [&](T* object)
+        {
+            if (object != ignore)
+                result.push_back(object);
+        });
+    }
+    /// Calls callback for all objects whose bounding box is hit by the ray closer than maxDistance.
+    /// Only the cells along the ray are visited.
+    template<typename Callback>
+    void Query(const Ray& ray, float maxDistance, Callback&& callback) const
+    {
+        for (const auto& item : large_)
+        {
+            if (ray.HitDistance(item.box) < maxDistance)
+                callback(item.object);
+        }
+        if (count_ == large_.size())
+            return;
+
+        const auto test = [&](const Item& item)
+        {
+            if (ray.HitDistance(item.box) < maxDistance)
+                callback(item.object);
+        };
+        // A hit point is at most maxExtent_ away from the center of the object
+        const float r = maxExtent_;
+        const Vector3& origin = ray.origin_;
+        const Vector3& dir = ray.direction_;
+        if (std::fabs(dir.x_) < M_EPSILON && std::fabs(dir.z_) < M_EPSILON)
+        {
+            // Straight up or down
+            const int x1 = GetCellX(origin.x_ - r);
+            const int x2 = GetCellX(origin.x_ + r);
+            for (int z = GetCellZ(origin.z_ - r); z <= GetCellZ(origin.z_ + r); ++z)
+                QueryRow(z, x1, x2, test);
+            return;
+        }
+
+        // The part of the ray inside the grid
+        float t1 = 0.0f;
+        float t2 = maxDistance;
+        if (!ClipRay(origin.x_, dir.x_, minX_ - r, maxX_ + r, t1, t2) ||
+            !ClipRay(origin.z_, dir.z_, minZ_ - r, maxZ_ + r, t1, t2))
+            return;
+
+        const float zStart = origin.z_ + dir.z_ * t1;
+        const float zEnd = origin.z_ + dir.z_ * t2;
+        const int z1 = GetCellZ(std::min(zStart, zEnd) - r);
+        const int z2 = GetCellZ(std::max(zStart, zEnd) + r);
+        for (int z = z1; z <= z2; ++z)
+        {
+            // The part of the ray crossing this row, extended by r
+            float rowT1 = t1;
+            float rowT2 = t2;
+            const float rowMin = minZ_ + static_cast<float>(z) * cellSize_;
+            if (!ClipRay(origin.z_, dir.z_, rowMin - r, rowMin + cellSize_ + r, rowT1, rowT2))
+                continue;
+            const float xStart = origin.x_ + dir.x_ * rowT1;
+            const float xEnd = origin.x_ + dir.x_ * rowT2;
+            QueryRow(z, GetCellX(std::min(xStart, xEnd) - r), GetCellX(std::max(xStart, xEnd) + r), test);
+        }
+    }
+    /// Run many queries at once. The result of sphere i is result[offsets[i]..offsets[i + 1]].
+    void Query(const Sphere* spheres, size_t count, ea::vector<T*>& result, ea::vector<size_t>& offsets) const
+    {
+        offsets.resize(count + 1);
+        for (size_t i = 0; i < count; ++i)
+        {
+            offsets[i] = result.size();
+            Query(spheres[i], [&](T* object) { result.push_back(object); });
+        }
+        offsets[count] = result.size();
+    }
+};
+
+}
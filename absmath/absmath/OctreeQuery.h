@@ -21,94 +21,145 @@
 
 #pragma once
 
-#include <absmath/BoundingBox.h>
-#include <absmath/Vector3.h>
-#include <absmath/Sphere.h>
-#include <absmath/Ray.h>
+#include "BoundingBox.h"
+#include "Vector3.h"
+#include "Sphere.h"
+#include "Ray.h"
 #include <eastl.hpp>
 
-namespace Game {
-class GameObject;
-}
-
 namespace Math {
 
+template<typename T>
 class OctreeQuery
 {
 protected:
-    const Game::GameObject* ignore_;
+    const T* ignore_;
 public:
-    explicit OctreeQuery(ea::vector<Game::GameObject*>& result, const Game::GameObject* ignore) :
+    explicit OctreeQuery(ea::vector<T*>& result, const T* ignore) :
         ignore_(ignore),
         result_(result)
     { }
-    virtual ~OctreeQuery();
+    virtual ~OctreeQuery() = default;
     OctreeQuery(const OctreeQuery& rhs) = delete;
     OctreeQuery& operator =(const OctreeQuery& rhs) = delete;
 
     /// Intersection test for an octant.
     virtual Intersection TestOctant(const BoundingBox& box, bool inside) = 0;
     /// Intersection test for objects.
-    virtual void TestObjects(Game::GameObject** start, Game::GameObject** end, bool inside) = 0;
+    virtual void TestObjects(T** start, T** end, bool inside) = 0;
 
-    ea::vector<Game::GameObject*>& result_;
+    ea::vector<T*>& result_;
 };
 
-class PointOctreeQuery : public OctreeQuery
+template<typename T>
+class PointOctreeQuery : public OctreeQuery<T>
 {
 public:
-    PointOctreeQuery(ea::vector<Game::GameObject*>& result,
-        const Vector3 point, const Game::GameObject* ignore = nullptr) :
-        OctreeQuery(result, ignore),
+    PointOctreeQuery(ea::vector<T*>& result,
+        const Vector3 point, const T* ignore = nullptr) :
+        OctreeQuery<T>(result, ignore),
         point_(point)
     { }
 
     /// Intersection test for an octant.
-    Intersection TestOctant(const BoundingBox& box, bool inside) override;
+    Intersection TestOctant(const BoundingBox& box, bool inside) override
+    {
+        if (inside)
+            return Intersection::Inside;
+        else
+            return box.IsInside(point_);
+    }
     /// Intersection test for objects.
-    void TestObjects(Game::GameObject** start, Game::GameObject** end, bool inside) override;
+    void TestObjects(T** start, T** end, bool inside) override
+    {
+        while (start != end)
+        {
+            T* object = *start++;
+
+            if (object == this->ignore_)
+                continue;
+            if (inside || object->GetWorldBoundingBox().IsInside(point_) != Intersection::Outside)
+                this->result_.push_back(object);
+        }
+    }
 
     Vector3 point_;
 };
 
-class SphereOctreeQuery : public OctreeQuery
+template<typename T>
+class SphereOctreeQuery : public OctreeQuery<T>
 {
 public:
     /// Construct with sphere and query parameters.
-    SphereOctreeQuery(ea::vector<Game::GameObject*>& result,
-        const Sphere& sphere, const Game::GameObject* ignore = nullptr) :
-        OctreeQuery(result, ignore),
+    SphereOctreeQuery(ea::vector<T*>& result,
+        const Sphere& sphere, const T* ignore = nullptr) :
+        OctreeQuery<T>(result, ignore),
         sphere_(sphere)
     {}
 
     /// Intersection test for an octant.
-    Intersection TestOctant(const BoundingBox& box, bool inside) override;
+    Intersection TestOctant(const BoundingBox& box, bool inside) override
+    {
+        if (inside)
+            return Intersection::Inside;
+        else
+            return sphere_.IsInside(box);
+    }
     /// Intersection test for objects.
-    void TestObjects(Game::GameObject** start, Game::GameObject** end, bool inside) override;
+    void TestObjects(T** start, T** end, bool inside) override
+    {
+        while (start != end)
+        {
+            T* object = *start++;
+
+            if (object == this->ignore_)
+                continue;
+            if (inside || sphere_.IsInsideFast(object->GetWorldBoundingBox()) != Intersection::Outside)
+                this->result_.push_back(object);
+        }
+    }
 
     /// Sphere.
     Sphere sphere_;
 };
 
-class BoxOctreeQuery : public OctreeQuery
+template<typename T>
+class BoxOctreeQuery : public OctreeQuery<T>
 {
 public:
     /// Construct with bounding box and query parameters.
-    BoxOctreeQuery(ea::vector<Game::GameObject*>& result,
-        const BoundingBox& box, const Game::GameObject* ignore = nullptr) :
-        OctreeQuery(result, ignore),
+    BoxOctreeQuery(ea::vector<T*>& result,
+        const BoundingBox& box, const T* ignore = nullptr) :
+        OctreeQuery<T>(result, ignore),
         box_(box)
     {}
 
     /// Intersection test for an octant.
-    Intersection TestOctant(const BoundingBox& box, bool inside) override;
+    Intersection TestOctant(const BoundingBox& box, bool inside) override
+    {
+        if (inside)
+            return Intersection::Inside;
+        else
+            return box_.IsInside(box);
+    }
     /// Intersection test for objects.
-    void TestObjects(Game::GameObject** start, Game::GameObject** end, bool inside) override;
+    void TestObjects(T** start, T** end, bool inside) override
+    {
+        while (start != end)
+        {
+            T* object = *start++;
+            if (object == this->ignore_)
+                continue;
+            if (inside || box_.IsInsideFast(object->GetWorldBoundingBox()) != Intersection::Outside)
+                this->result_.push_back(object);
+        }
+    }
 
     /// Bounding box.
     BoundingBox box_;
 };
 
+template<typename T>
 struct RayQueryResult
 {
     /// Construct with defaults.
@@ -166,32 +217,40 @@ struct RayQueryResult
     /// Distance from ray origin.
     float distance_{ 0.0f };
     /// Drawable.
-    Game::GameObject* object_{ nullptr };
+    T* object_{ nullptr };
 };
 
-class RayOctreeQuery
+template<typename T>
+inline bool CompareRayQueryResults(const RayQueryResult<T>& lhs, const RayQueryResult<T>& rhs)
+{
+    return lhs.distance_ < rhs.distance_;
+}
+
+/// Ray query for any spatial index
+template<typename T>
+class RayQuery
 {
 public:
     /// Construct with ray and query parameters.
-    RayOctreeQuery(ea::vector<RayQueryResult>& result, const Ray& ray,
+    RayQuery(ea::vector<RayQueryResult<T>>& result, const Ray& ray,
         float maxDistance = Math::M_INFINITE,
-        const Game::GameObject* ignore = nullptr) :
+        const T* ignore = nullptr) :
         result_(result),
         ray_(ray),
         maxDistance_(maxDistance),
         ignore_(ignore)
     { }
 
-    RayOctreeQuery(const RayOctreeQuery& rhs) = delete;
-    RayOctreeQuery& operator =(const RayOctreeQuery& rhs) = delete;
+    RayQuery(const RayQuery& rhs) = delete;
+    RayQuery& operator =(const RayQuery& rhs) = delete;
 
     /// Result vector reference.
-    ea::vector<RayQueryResult>& result_;
+    ea::vector<RayQueryResult<T>>& result_;
     /// Ray.
     Ray ray_;
     /// Maximum ray distance.
     float maxDistance_;
-    const Game::GameObject* ignore_;
+    const T* ignore_;
 };
 
 }
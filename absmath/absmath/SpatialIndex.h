@@ -0,0 +1,194 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "LooseGrid.h"
+#include "Octree.h"
+#include <eastl.hpp>
+
+namespace Math {
+
+/// Spatial index of the objects in a scene, used for range queries and raycasts.
+/// T must have a SpatialIndex<T>* spatialIndex_ member. It points to the index
+/// while the object is in it, and is reset when the index is destroyed.
+template<typename T>
+class SpatialIndex
+{
+public:
+    virtual ~SpatialIndex() = default;
+    /// Set the size of the world. Objects already in the index are kept.
+    virtual void SetSize(const BoundingBox& box) = 0;
+    virtual void InsertObject(T* object) = 0;
+    virtual void RemoveObject(T* object) = 0;
+    /// The object moved, it is updated with the next call to Update()
+    virtual void AddObjectUpdate(T* object) = 0;
+    /// Update all moved objects
+    virtual void Update() = 0;
+    /// Return all objects intersecting the sphere
+    virtual void GetObjects(ea::vector<T*>& result, const Sphere& sphere, const T* ignore) const = 0;
+    /// Return all objects intersecting the box
+    virtual void GetObjects(ea::vector<T*>& result, const BoundingBox& box, const T* ignore) const = 0;
+    /// Return all objects hit by the ray sorted by distance
+    virtual void Raycast(RayQuery<T>& query) const = 0;
+};
+
+/// For real 3D worlds
+template<typename T>
+class OctreeIndex final : public SpatialIndex<T>
+{
+private:
+    Octree<T> octree_;
+public:
+    ~OctreeIndex() override
+    {
+        ea::vector<T*> objects;
+        octree_.GetAllObjects(objects);
+        for (T* object : objects)
+            object->spatialIndex_ = nullptr;
+    }
+    void SetSize(const BoundingBox& box) override
+    {
+        octree_.SetSize(box, octree_.numLevels_);
+    }
+    void InsertObject(T* object) override
+    {
+        octree_.InsertObject(object);
+        object->spatialIndex_ = this;
+        // Initial update.
+        if (object->GetOctant())
+            octree_.AddObjectUpdate(object);
+    }
+    void RemoveObject(T* object) override
+    {
+        if (Octant<T>* octant = object->GetOctant())
+            octant->RemoveObject(object);
+        object->spatialIndex_ = nullptr;
+    }
+    void AddObjectUpdate(T* object) override
+    {
+        if (object->GetOctant())
+            octree_.AddObjectUpdate(object);
+    }
+    void Update() override
+    {
+        octree_.Update();
+    }
+    void GetObjects(ea::vector<T*>& result, const Sphere& sphere, const T* ignore) const override
+    {
+        SphereOctreeQuery<T> query(result, sphere, ignore);
+        octree_.GetObjects(query);
+    }
+    void GetObjects(ea::vector<T*>& result, const BoundingBox& box, const T* ignore) const override
+    {
+        BoxOctreeQuery<T> query(result, box, ignore);
+        octree_.GetObjects(query);
+    }
+    void Raycast(RayQuery<T>& query) const override
+    {
+        octree_.Raycast(query);
+    }
+};
+
+/// For 2.5D worlds, uses a LooseGrid on the XZ plane. T must also have a LooseGrid<T>::Id
+/// gridId_ member, initialized with LooseGrid<T>::INVALID_ID.
+template<typename T>
+class GridIndex final : public SpatialIndex<T>
+{
+private:
+    using Grid = LooseGrid<T>;
+    Grid grid_;
+    ea::vector<T*> objectUpdate_;
+    void RemoveObjectUpdate(T* object)
+    {
+        auto it = ea::find(objectUpdate_.begin(), objectUpdate_.end(), object);
+        if (it != objectUpdate_.end())
+            objectUpdate_.erase(it);
+    }
+public:
+    GridIndex(const BoundingBox& bounds, float cellSize) :
+        grid_(bounds, cellSize)
+    { }
+    ~GridIndex() override
+    {
+        grid_.VisitObjects([](T* object)
+        {
+            object->spatialIndex_ = nullptr;
+            object->gridId_ = Grid::INVALID_ID;
+        });
+    }
+    void SetSize(const BoundingBox& box) override
+    {
+        grid_.SetSize(box, grid_.GetCellSize());
+    }
+    void InsertObject(T* object) override
+    {
+        if (object->gridId_ != Grid::INVALID_ID)
+            return;
+        object->gridId_ = grid_.Insert(object, object->GetWorldBoundingBox());
+        object->spatialIndex_ = this;
+    }
+    void RemoveObject(T* object) override
+    {
+        if (object->gridId_ == Grid::INVALID_ID)
+            return;
+        RemoveObjectUpdate(object);
+        grid_.Remove(object->gridId_);
+        object->gridId_ = Grid::INVALID_ID;
+        object->spatialIndex_ = nullptr;
+    }
+    void AddObjectUpdate(T* object) override
+    {
+        if (object->gridId_ == Grid::INVALID_ID)
+            return;
+        auto it = ea::find(objectUpdate_.begin(), objectUpdate_.end(), object);
+        if (it == objectUpdate_.end())
+            objectUpdate_.push_back(object);
+    }
+    void Update() override
+    {
+        for (T* object : objectUpdate_)
+            grid_.Move(object->gridId_, object->GetWorldBoundingBox());
+        objectUpdate_.clear();
+    }
+    void GetObjects(ea::vector<T*>& result, const Sphere& sphere, const T* ignore) const override
+    {
+        result.clear();
+        grid_.Query(sphere, result, ignore);
+    }
+    void GetObjects(ea::vector<T*>& result, const BoundingBox& box, const T* ignore) const override
+    {
+        result.clear();
+        grid_.Query(box, result, ignore);
+    }
+    void Raycast(RayQuery<T>& query) const override
+    {
+        query.result_.clear();
+        grid_.Query(query.ray_, query.maxDistance_, [&query](T* object)
+        {
+            if (object != query.ignore_)
+                object->ProcessRayQuery(query, query.result_);
+        });
+        ea::sort(query.result_.begin(), query.result_.end(), CompareRayQueryResults<T>);
+    }
+};
+
+}
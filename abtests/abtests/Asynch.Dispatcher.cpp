@@ -0,0 +1,75 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <abscommon/Dispatcher.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Dispatcher priority overflow", "[dispatcher]")
+{
+    // More than fit into the rings, so both lanes spill into their overflow queues
+    static constexpr int COUNT = 5000;
+
+    Asynch::Dispatcher dispatcher;
+    dispatcher.Start();
+
+    // Block the Dispatcher until all tasks are queued
+    std::atomic<bool> release{ false };
+    dispatcher.Add(Asynch::CreateTask([&]()
+    {
+        while (!release)
+            std::this_thread::sleep_for(1ms);
+    }));
+
+    // Only accessed from the Dispatcher thread
+    std::vector<int> order;
+    order.reserve(COUNT * 2);
+    std::atomic<int> count{ 0 };
+    for (int i = 0; i < COUNT; ++i)
+        dispatcher.Add(Asynch::CreateTask([&, i]() { order.push_back(COUNT + i); ++count; }));
+    for (int i = 0; i < COUNT; ++i)
+        dispatcher.Add(Asynch::CreateTask([&, i]() { order.push_back(i); ++count; }), true);
+    release = true;
+
+    const auto start = std::chrono::steady_clock::now();
+    while (count < COUNT * 2 && std::chrono::steady_clock::now() - start < 5s)
+        std::this_thread::sleep_for(1ms);
+    dispatcher.Stop();
+
+    REQUIRE(count == COUNT * 2);
+    // All priority tasks first, each lane in the order they were added
+    bool ordered = true;
+    for (int i = 0; i < COUNT * 2; ++i)
+    {
+        if (order[static_cast<size_t>(i)] != i)
+        {
+            ordered = false;
+            break;
+        }
+    }
+    REQUIRE(ordered);
+}
@@ -0,0 +1,102 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <abscommon/Dispatcher.h>
+#include <abscommon/Scheduler.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Scheduler", "[scheduler]")
+{
+    Asynch::Dispatcher dispatcher;
+    dispatcher.Start();
+    Asynch::Scheduler scheduler(&dispatcher);
+    scheduler.Start();
+
+    SECTION("Order")
+    {
+        std::mutex lock;
+        std::vector<int> order;
+        std::atomic<int> count{ 0 };
+        for (int delay : { 300, 20, 0, 100 })
+        {
+            scheduler.Add(Asynch::CreateScheduledTask(static_cast<uint32_t>(delay), [&, delay]()
+            {
+                std::scoped_lock l(lock);
+                order.push_back(delay);
+                ++count;
+            }));
+        }
+        const auto start = std::chrono::steady_clock::now();
+        while (count < 4 && std::chrono::steady_clock::now() - start < 2s)
+            std::this_thread::sleep_for(1ms);
+        REQUIRE(count == 4);
+        REQUIRE(order == std::vector<int>{ 0, 20, 100, 300 });
+    }
+    SECTION("Delay")
+    {
+        std::atomic<bool> done{ false };
+        const auto start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point executed;
+        scheduler.Add(Asynch::CreateScheduledTask(50, [&]()
+        {
+            executed = std::chrono::steady_clock::now();
+            done = true;
+        }));
+        while (!done && std::chrono::steady_clock::now() - start < 2s)
+            std::this_thread::sleep_for(1ms);
+        REQUIRE(done);
+        REQUIRE(executed - start >= 49ms);
+    }
+    SECTION("Stop event")
+    {
+        std::atomic<int> count{ 0 };
+        const uint32_t id1 = scheduler.Add(Asynch::CreateScheduledTask(30, [&]() { ++count; }));
+        // Goes to a higher level of the wheel
+        const uint32_t id2 = scheduler.Add(Asynch::CreateScheduledTask(1000, [&]() { ++count; }));
+        scheduler.Add(Asynch::CreateScheduledTask(60, [&]() { count += 10; }));
+        REQUIRE(scheduler.StopEvent(id1));
+        REQUIRE(scheduler.StopEvent(id2));
+        REQUIRE(!scheduler.StopEvent(id2));
+        std::this_thread::sleep_for(200ms);
+        REQUIRE(count == 10);
+    }
+    SECTION("Many")
+    {
+        // Crosses a few wraps of the first level
+        std::atomic<int> count{ 0 };
+        for (uint32_t i = 0; i < 1000; ++i)
+            scheduler.Add(Asynch::CreateScheduledTask(i % 700, [&]() { ++count; }));
+        const auto start = std::chrono::steady_clock::now();
+        while (count < 1000 && std::chrono::steady_clock::now() - start < 3s)
+            std::this_thread::sleep_for(1ms);
+        REQUIRE(count == 1000);
+    }
+
+    scheduler.Stop();
+    dispatcher.Stop();
+}
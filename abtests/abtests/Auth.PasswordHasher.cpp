@@ -0,0 +1,188 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include "PasswordHasher.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+template<typename Predicate>
+bool WaitFor(Predicate&& predicate)
+{
+    const auto start = std::chrono::steady_clock::now();
+    while (!predicate() && std::chrono::steady_clock::now() - start < 5s)
+        std::this_thread::sleep_for(1ms);
+    return predicate();
+}
+
+// Jobs instead of bcrypt calls, they record the order they were executed in
+struct Jobs
+{
+    std::mutex lock;
+    std::vector<int> order;
+    std::atomic<bool> release{ false };
+    std::atomic<bool> blocking{ false };
+
+    Auth::PasswordHasher::Job Record(int id)
+    {
+        return [this, id]()
+        {
+            std::scoped_lock l(lock);
+            order.push_back(id);
+        };
+    }
+    // Keeps the worker busy until release is set
+    Auth::PasswordHasher::Job Block()
+    {
+        return [this]()
+        {
+            blocking = true;
+            while (!release)
+                std::this_thread::sleep_for(1ms);
+        };
+    }
+    size_t Count()
+    {
+        std::scoped_lock l(lock);
+        return order.size();
+    }
+};
+
+}
+
+TEST_CASE("PasswordHasher", "[auth]")
+{
+    // One worker, so the jobs run in the order they are served
+    Auth::PasswordHasher hasher(1);
+    hasher.Start();
+    Jobs jobs;
+
+    SECTION("Round robin")
+    {
+        REQUIRE(hasher.Enqueue(100, jobs.Block()));
+        REQUIRE(WaitFor([&]() { return jobs.blocking.load(); }));
+        for (int i = 0; i < 3; ++i)
+            REQUIRE(hasher.Enqueue(1, jobs.Record(10 + i)));
+        for (int i = 0; i < 2; ++i)
+            REQUIRE(hasher.Enqueue(2, jobs.Record(20 + i)));
+        REQUIRE(hasher.Enqueue(3, jobs.Record(30)));
+        jobs.release = true;
+
+        REQUIRE(WaitFor([&]() { return jobs.Count() == 6; }));
+        // A client with many requests does not delay the others
+        REQUIRE(jobs.order == std::vector<int>{ 10, 20, 30, 11, 21, 12 });
+    }
+    SECTION("Limit per IP")
+    {
+        // The running request counts too
+        REQUIRE(hasher.Enqueue(1, jobs.Block()));
+        REQUIRE(WaitFor([&]() { return jobs.blocking.load(); }));
+        for (int i = 1; i < static_cast<int>(Auth::PasswordHasher::MAX_PENDING_PER_IP); ++i)
+            REQUIRE(hasher.Enqueue(1, jobs.Record(i)));
+        REQUIRE(!hasher.Enqueue(1, jobs.Record(0)));
+        // Other IPs are not affected
+        REQUIRE(hasher.Enqueue(2, jobs.Record(0)));
+        REQUIRE(hasher.GetStats().rejected == 1);
+
+        jobs.release = true;
+        REQUIRE(WaitFor([&]() { return jobs.Count() == Auth::PasswordHasher::MAX_PENDING_PER_IP; }));
+        // When they are done the IP may send requests again
+        REQUIRE(WaitFor([&]() { return hasher.GetStats().hashed == Auth::PasswordHasher::MAX_PENDING_PER_IP + 1; }));
+        REQUIRE(hasher.Enqueue(1, jobs.Record(0)));
+    }
+    SECTION("Queue size")
+    {
+        hasher.SetMaxQueued(2);
+        REQUIRE(hasher.Enqueue(1, jobs.Block()));
+        REQUIRE(WaitFor([&]() { return jobs.blocking.load(); }));
+        // The running request is not queued anymore
+        REQUIRE(hasher.Enqueue(2, jobs.Record(2)));
+        REQUIRE(hasher.Enqueue(3, jobs.Record(3)));
+        REQUIRE(!hasher.Enqueue(4, jobs.Record(4)));
+        REQUIRE(hasher.GetLoad() == 100);
+
+        jobs.release = true;
+        REQUIRE(WaitFor([&]() { return jobs.Count() == 2; }));
+        REQUIRE(jobs.order == std::vector<int>{ 2, 3 });
+    }
+    SECTION("Stats")
+    {
+        REQUIRE(hasher.Enqueue(1, jobs.Block()));
+        REQUIRE(WaitFor([&]() { return jobs.blocking.load(); }));
+        for (uint32_t ip = 2; ip < 5; ++ip)
+            REQUIRE(hasher.Enqueue(ip, jobs.Record(static_cast<int>(ip))));
+        hasher.SetMaxQueued(3);
+        REQUIRE(!hasher.Enqueue(5, jobs.Record(5)));
+
+        auto stats = hasher.GetStats();
+        REQUIRE(stats.queueDepth == 3);
+        REQUIRE(stats.maxQueueDepth == 3);
+        REQUIRE(stats.capacity == 3);
+        REQUIRE(stats.rejected == 1);
+        REQUIRE(stats.hashed == 0);
+
+        std::this_thread::sleep_for(10ms);
+        jobs.release = true;
+        REQUIRE(WaitFor([&]() { return hasher.GetStats().hashed == 4; }));
+        stats = hasher.GetStats();
+        REQUIRE(stats.queueDepth == 0);
+        REQUIRE(stats.maxQueueDepth == 3);
+        // The blocking job took at least 10ms
+        REQUIRE(stats.maxHashTime >= 10000);
+        REQUIRE(stats.avgHashTime > 0);
+        REQUIRE(stats.avgHashTime <= stats.maxHashTime);
+    }
+    SECTION("Stop")
+    {
+        REQUIRE(hasher.Enqueue(1, jobs.Block()));
+        REQUIRE(WaitFor([&]() { return jobs.blocking.load(); }));
+        REQUIRE(hasher.Enqueue(2, jobs.Record(2)));
+        REQUIRE(hasher.Enqueue(3, jobs.Record(3)));
+
+        // Stop() waits for the running request
+        std::atomic<bool> stopped{ false };
+        std::thread stopper([&]()
+        {
+            hasher.Stop();
+            stopped = true;
+        });
+        std::this_thread::sleep_for(20ms);
+        REQUIRE(!stopped);
+        jobs.release = true;
+        stopper.join();
+
+        // The queued ones are dropped
+        REQUIRE(jobs.Count() == 0);
+        const auto stats = hasher.GetStats();
+        REQUIRE(stats.queueDepth == 0);
+        REQUIRE(stats.hashed == 1);
+        REQUIRE(hasher.GetLoad() == 0);
+        REQUIRE(!hasher.Enqueue(4, jobs.Record(4)));
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <abcrypto.hpp>
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Messages
+{
+    std::vector<std::vector<uint32_t>> data;
+    std::vector<std::array<uint32_t, 4>> keys;
+    std::vector<uint32_t*> buffers;
+    std::vector<uint32_t> lengths;
+    std::vector<const uint32_t*> keyPtrs;
+    size_t bytes{ 0 };
+
+    // Lengths are in 8 byte blocks, like encrypted packets
+    Messages(size_t count, uint32_t minBlocks, uint32_t maxBlocks)
+    {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<uint32_t> blocks(minBlocks, maxBlocks);
+        data.resize(count);
+        keys.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            data[i].resize(blocks(rng) * 2);
+            for (auto& w : data[i])
+                w = static_cast<uint32_t>(rng());
+            for (auto& k : keys[i])
+                k = static_cast<uint32_t>(rng());
+            bytes += data[i].size() * 4;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            buffers.push_back(data[i].data());
+            lengths.push_back(static_cast<uint32_t>(data[i].size()));
+            keyPtrs.push_back(keys[i].data());
+        }
+    }
+    void EncryptEach()
+    {
+        for (size_t i = 0; i < buffers.size(); ++i)
+            xxtea_enc(buffers[i], lengths[i], keyPtrs[i]);
+    }
+    void EncryptBatch()
+    {
+        xxtea_enc_batch(buffers.data(), lengths.data(), keyPtrs.data(), buffers.size());
+    }
+};
+
+}
+
+TEST_CASE("XXTEA batch", "[xxtea]")
+{
+    SECTION("Same length")
+    {
+        Messages scalar(37, 16, 16);
+        Messages batch(37, 16, 16);
+        scalar.EncryptEach();
+        batch.EncryptBatch();
+        REQUIRE(scalar.data == batch.data);
+    }
+    SECTION("Mixed lengths")
+    {
+        Messages scalar(200, 1, 6);
+        Messages batch(200, 1, 6);
+        scalar.EncryptEach();
+        batch.EncryptBatch();
+        REQUIRE(scalar.data == batch.data);
+    }
+    SECTION("Decrypt")
+    {
+        Messages original(50, 1, 64);
+        Messages batch(50, 1, 64);
+        batch.EncryptBatch();
+        REQUIRE(original.data != batch.data);
+        for (size_t i = 0; i < batch.buffers.size(); ++i)
+            xxtea_dec(batch.buffers[i], batch.lengths[i], batch.keyPtrs[i]);
+        REQUIRE(original.data == batch.data);
+    }
+}
+
+// Not run by default, run with: abtests [benchmark]
+TEST_CASE("XXTEA batch benchmark", "[.][benchmark]")
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int ROUNDS = 100;
+    // 512 status updates, of the same length and of 16 different lengths
+    for (uint32_t maxBlocks : { 32u, 47u })
+    {
+        Messages messages(512, 32, maxBlocks);
+        auto start = Clock::now();
+        for (int i = 0; i < ROUNDS; ++i)
+            messages.EncryptEach();
+        const auto scalarTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        start = Clock::now();
+        for (int i = 0; i < ROUNDS; ++i)
+            messages.EncryptBatch();
+        const auto batchTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        const double mb = static_cast<double>(messages.bytes * ROUNDS) / (1024.0 * 1024.0);
+        WARN("Lengths " << 32 * 8 << ".." << maxBlocks * 8 << " bytes: xxtea_enc() " <<
+            mb / (static_cast<double>(scalarTime) / 1000000.0) << " MB/s, xxtea_enc_batch() " <<
+            mb / (static_cast<double>(batchTime) / 1000000.0) << " MB/s");
+    }
+}
@@ -0,0 +1,268 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#ifdef USE_SQLITE
+
+#include <abdb/DatabaseSqlite.h>
+#include <abscommon/Scheduler.h>
+#include <abscommon/Subsystems.h>
+#include <abscommon/UuidUtils.h>
+#include <sa/time.h>
+#include <array>
+#include <vector>
+#include "DBAccountBan.h"
+#include "DBIpBan.h"
+#include "DBReservedName.h"
+#include "StorageProvider.h"
+
+namespace {
+
+// Makes the connection the one of the calling thread, which is what the DB classes use
+class ThreadConnection
+{
+public:
+    explicit ThreadConnection(DB::Database* db) { DB::Database::SetThreadInstance(db); }
+    ~ThreadConnection() { DB::Database::SetThreadInstance(nullptr); }
+};
+
+struct Item
+{
+    int32_t id = -1;
+    std::string name;
+    int32_t count = -1;
+};
+
+}
+
+TEST_CASE("SQLite prepared statements", "[db]")
+{
+    DB::DatabaseSqlite db(":memory:");
+    REQUIRE(db.IsConnected());
+    REQUIRE(db.ExecuteQuery("CREATE TABLE items (id INTEGER NOT NULL, name TEXT, data TEXT)"));
+
+    static constexpr DB::DBStatement SQL_INSERT("INSERT INTO items (id, name, data) VALUES (${id}, ${name}, ${data})");
+    static constexpr DB::DBStatement SQL_SELECT("SELECT * FROM items WHERE id >= ${id} ORDER BY id");
+    for (int i = 0; i < 3; ++i)
+        REQUIRE(db.ExecutePrepared(SQL_INSERT, DB::DBParams().Add(i).Add("item" + std::to_string(i)).AddBlob("data")));
+
+    SECTION("Bind and step")
+    {
+        auto result = db.StorePrepared(SQL_SELECT, DB::DBParams().Add(1));
+        REQUIRE(result);
+        REQUIRE(result->GetInt("id") == 1);
+        REQUIRE(result->GetString("name") == "item1");
+        REQUIRE(result->Next());
+        REQUIRE(result->GetInt("id") == 2);
+        REQUIRE(result->GetString("name") == "item2");
+        REQUIRE(!result->Next());
+        result.reset();
+
+        // The cached statement is reset and bound again
+        result = db.StorePrepared(SQL_SELECT, DB::DBParams().Add(2));
+        REQUIRE(result);
+        REQUIRE(result->GetInt("id") == 2);
+        result.reset();
+
+        REQUIRE(!db.StorePrepared(SQL_SELECT, DB::DBParams().Add(3)));
+    }
+    SECTION("Nested use")
+    {
+        // The outer result still reads from the cached statement, the inner ones get their own
+        int rows = 0;
+        for (auto outer = db.StorePrepared(SQL_SELECT, DB::DBParams().Add(0)); outer; outer = outer->Next())
+        {
+            const int id = outer->GetInt("id");
+            REQUIRE(id == rows);
+            auto inner = db.StorePrepared(SQL_SELECT, DB::DBParams().Add(id));
+            REQUIRE(inner);
+            REQUIRE(inner->GetInt("id") == id);
+            REQUIRE(outer->GetString("name") == "item" + std::to_string(id));
+            ++rows;
+        }
+        REQUIRE(rows == 3);
+
+        // Afterwards the cached statement is used again
+        auto result = db.StorePrepared(SQL_SELECT, DB::DBParams().Add(2));
+        REQUIRE(result);
+        REQUIRE(result->GetInt("id") == 2);
+        REQUIRE(!result->Next());
+    }
+    SECTION("NULL and blob")
+    {
+        const std::string blob("\0\1\2\xff" "abc", 7);
+        REQUIRE(db.ExecutePrepared(SQL_INSERT, DB::DBParams().Add(10).AddNull().AddBlob(blob)));
+        auto result = db.StorePrepared(SQL_SELECT, DB::DBParams().Add(10));
+        REQUIRE(result);
+        REQUIRE(result->IsNull("name"));
+        REQUIRE(result->GetString("name").empty());
+        REQUIRE(!result->IsNull("data"));
+        REQUIRE(result->GetStream("data") == blob);
+    }
+    SECTION("Row mapping")
+    {
+        // There is no count column, it keeps its value
+        static constexpr DB::DBRowMapping MAPPING(
+            DB::DBField("id", &Item::id),
+            DB::DBField("name", &Item::name),
+            DB::DBField("count", &Item::count));
+        std::vector<Item> items;
+        REQUIRE(MAPPING.Load(db.StorePrepared(SQL_SELECT, DB::DBParams().Add(1)), items) == 2);
+        REQUIRE(items[0].id == 1);
+        REQUIRE(items[0].name == "item1");
+        REQUIRE(items[0].count == -1);
+        REQUIRE(items[1].id == 2);
+        REQUIRE(items[1].count == -1);
+    }
+    SECTION("Statement error")
+    {
+        static constexpr DB::DBStatement SQL_ERROR("SELECT * FROM missing WHERE id = ${id}");
+        REQUIRE(!db.StorePrepared(SQL_ERROR, DB::DBParams().Add(0)));
+        REQUIRE(!db.ExecutePrepared(SQL_ERROR, DB::DBParams().Add(0)));
+    }
+}
+
+TEST_CASE("SQLite IpBan", "[db]")
+{
+    DB::DatabaseSqlite db(":memory:");
+    REQUIRE(db.IsConnected());
+    ThreadConnection connection(&db);
+    REQUIRE(db.ExecuteQuery("CREATE TABLE ip_bans (uuid CHARACTER(36) NOT NULL, ban_uuid CHARACTER(36) NOT NULL, "
+        "ip BIGINT NOT NULL, mask BIGINT NOT NULL)"));
+
+    AB::Entities::IpBan ban;
+    ban.uuid = Utils::Uuid::New();
+    ban.banUuid = Utils::Uuid::New();
+    ban.ip = 0xC0A80001;                 // 192.168.0.1
+    ban.mask = 0xFFFFFF00;
+    REQUIRE(DB::DBIpBan::Create(ban));
+
+    // Overlaps the first one
+    AB::Entities::IpBan other;
+    other.uuid = Utils::Uuid::New();
+    other.ip = 0xC0A800FE;
+    other.mask = 0xFFFFFF00;
+    REQUIRE(!DB::DBIpBan::Create(other));
+
+    // Another IP in the same subnet
+    AB::Entities::IpBan loaded;
+    loaded.ip = 0xC0A80042;
+    REQUIRE(DB::DBIpBan::Load(loaded));
+    REQUIRE(loaded.uuid == ban.uuid);
+    REQUIRE(loaded.banUuid == ban.banUuid);
+    REQUIRE(loaded.ip == ban.ip);
+    REQUIRE(loaded.mask == ban.mask);
+
+    // Only ban the one IP
+    ban.mask = 0xFFFFFFFF;
+    REQUIRE(DB::DBIpBan::Save(ban));
+    AB::Entities::IpBan byUuid;
+    byUuid.uuid = ban.uuid;
+    REQUIRE(DB::DBIpBan::Load(byUuid));
+    REQUIRE(byUuid.mask == 0xFFFFFFFF);
+    AB::Entities::IpBan byIp;
+    byIp.ip = 0xC0A80042;
+    REQUIRE(!DB::DBIpBan::Exists(byIp));
+    byIp.ip = 0xC0A80001;
+    REQUIRE(DB::DBIpBan::Exists(byIp));
+
+    REQUIRE(DB::DBIpBan::Delete(ban));
+    REQUIRE(!DB::DBIpBan::Exists(byUuid));
+}
+
+TEST_CASE("SQLite AccountBan", "[db]")
+{
+    DB::DatabaseSqlite db(":memory:");
+    REQUIRE(db.IsConnected());
+    ThreadConnection connection(&db);
+    REQUIRE(db.ExecuteQuery("CREATE TABLE account_bans (uuid CHARACTER(36) NOT NULL, ban_uuid CHARACTER(36) NOT NULL, "
+        "account_uuid CHARACTER(36) NOT NULL)"));
+
+    AB::Entities::AccountBan ban;
+    ban.uuid = Utils::Uuid::New();
+    ban.banUuid = Utils::Uuid::New();
+    ban.accountUuid = Utils::Uuid::New();
+    REQUIRE(DB::DBAccountBan::Create(ban));
+
+    AB::Entities::AccountBan byAccount;
+    byAccount.accountUuid = ban.accountUuid;
+    REQUIRE(DB::DBAccountBan::Exists(byAccount));
+    REQUIRE(DB::DBAccountBan::Load(byAccount));
+    REQUIRE(byAccount.uuid == ban.uuid);
+    REQUIRE(byAccount.banUuid == ban.banUuid);
+
+    ban.banUuid = Utils::Uuid::New();
+    REQUIRE(DB::DBAccountBan::Save(ban));
+    AB::Entities::AccountBan byUuid;
+    byUuid.uuid = ban.uuid;
+    REQUIRE(DB::DBAccountBan::Load(byUuid));
+    REQUIRE(byUuid.banUuid == ban.banUuid);
+    REQUIRE(byUuid.accountUuid == ban.accountUuid);
+
+    REQUIRE(DB::DBAccountBan::Delete(ban));
+    REQUIRE(!DB::DBAccountBan::Exists(byUuid));
+    REQUIRE(!DB::DBAccountBan::Load(byUuid));
+}
+
+TEST_CASE("SQLite ReservedName DeleteExpired", "[db]")
+{
+    DB::DatabaseSqlite db(":memory:");
+    REQUIRE(db.IsConnected());
+    ThreadConnection connection(&db);
+    REQUIRE(db.ExecuteQuery("CREATE TABLE reserved_names (uuid CHARACTER(36) NOT NULL, name TEXT NOT NULL, "
+        "is_reserved SMALLINT DEFAULT 0 NOT NULL, reserved_for_account_uuid CHARACTER(36) DEFAULT '', "
+        "expires BIGINT DEFAULT 0 NOT NULL)"));
+
+    const int64_t now = sa::time::tick();
+    // Never, expired, not yet expired
+    std::vector<AB::Entities::ReservedName> names(3);
+    const std::array<int64_t, 3> expires = { 0, now - 1000, now + 1000 * 60 };
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        names[i].uuid = Utils::Uuid::New();
+        names[i].name = "Name" + std::to_string(i);
+        names[i].isReserved = true;
+        names[i].expires = expires[i];
+        REQUIRE(DB::DBReservedName::Create(names[i]));
+    }
+
+    // The StorageProvider schedules its flush tasks
+    Subsystems::Instance.CreateSubsystem<Asynch::Scheduler>();
+    {
+        StorageProvider provider(1024 * 1024, false);
+        DB::DBReservedName::DeleteExpired(&provider);
+    }
+    Subsystems::Instance.RemoveSubsystem<Asynch::Scheduler>();
+
+    REQUIRE(DB::DBReservedName::Exists(names[0]));
+    REQUIRE(!DB::DBReservedName::Exists(names[1]));
+    REQUIRE(DB::DBReservedName::Exists(names[2]));
+
+    AB::Entities::ReservedName loaded;
+    loaded.name = "name2";
+    REQUIRE(DB::DBReservedName::Load(loaded));
+    REQUIRE(loaded.uuid == names[2].uuid);
+    REQUIRE(loaded.isReserved);
+    REQUIRE(loaded.expires == names[2].expires);
+}
+
+#endif
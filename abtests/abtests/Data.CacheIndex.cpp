@@ -0,0 +1,112 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <CacheIndex.h>
+#include <vector>
+
+namespace {
+
+std::vector<IO::DataKey> GetVictims(const CacheIndex& index)
+{
+    std::vector<IO::DataKey> result;
+    index.VisitVictims([&](const IO::DataKey& key) -> Iteration
+    {
+        result.push_back(key);
+        return Iteration::Continue;
+    });
+    return result;
+}
+
+}
+
+TEST_CASE("CacheIndex")
+{
+    const IO::DataKey a("a");
+    const IO::DataKey b("b");
+    const IO::DataKey c("c");
+    const IO::DataKey d("d");
+    // Protected segment holds 100 bytes, records bigger than 50 bytes stay in probation
+    CacheIndex index(100, 50);
+
+    SECTION("Victim order")
+    {
+        index.Add(a, 10);
+        index.Add(b, 10);
+        index.Add(c, 10);
+        // Least recently added first
+        REQUIRE(GetVictims(index) == std::vector<IO::DataKey>{ a, b, c });
+        index.Access(a);
+        // Protected records are evicted after all probation records
+        REQUIRE(GetVictims(index) == std::vector<IO::DataKey>{ b, c, a });
+        index.Delete(b);
+        REQUIRE(index.GetCount() == 2);
+        REQUIRE(GetVictims(index) == std::vector<IO::DataKey>{ c, a });
+    }
+    SECTION("Second access promotes")
+    {
+        index.Add(a, 10);
+        REQUIRE(index.GetProtectedCount() == 0);
+        index.Access(a);
+        REQUIRE(index.GetProtectedCount() == 1);
+        REQUIRE(index.GetProtectedSize() == 10);
+        // Adding an existing record counts as access
+        index.Add(b, 10);
+        index.Add(b, 20);
+        REQUIRE(index.GetProtectedCount() == 2);
+        REQUIRE(index.GetProtectedSize() == 30);
+        REQUIRE(index.GetCount() == 2);
+    }
+    SECTION("Protected overflow demotes")
+    {
+        index.Add(a, 40);
+        index.Add(b, 40);
+        index.Add(c, 40);
+        index.Add(d, 10);
+        index.Access(a);
+        index.Access(b);
+        REQUIRE(index.GetProtectedSize() == 80);
+        // a is the least recently used protected record and goes back to probation
+        index.Access(c);
+        REQUIRE(index.GetProtectedCount() == 2);
+        REQUIRE(index.GetProtectedSize() == 80);
+        // The demoted record is the most recently used one in probation
+        REQUIRE(GetVictims(index) == std::vector<IO::DataKey>{ d, a, b, c });
+    }
+    SECTION("Oversized stays in probation")
+    {
+        index.Add(a, 60);
+        index.Add(b, 10);
+        index.Access(a);
+        REQUIRE(index.GetProtectedCount() == 0);
+        // But it is the most recently used now
+        REQUIRE(GetVictims(index) == std::vector<IO::DataKey>{ b, a });
+
+        // A protected record growing too big goes back to probation
+        index.Access(b);
+        REQUIRE(index.GetProtectedCount() == 1);
+        index.Resize(b, 70);
+        REQUIRE(index.GetProtectedCount() == 0);
+        REQUIRE(index.GetProtectedSize() == 0);
+        REQUIRE(GetVictims(index) == std::vector<IO::DataKey>{ a, b });
+    }
+}
@@ -0,0 +1,268 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#ifdef USE_SQLITE
+
+#include <abdb/DatabaseSqlite.h>
+#include <abscommon/Dispatcher.h>
+#include <abscommon/Scheduler.h>
+#include <abscommon/Subsystems.h>
+#include <abscommon/ThreadPool.h>
+#include <abscommon/UuidUtils.h>
+#include <AB/Entities/IpBan.h>
+#include <sqlite3.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include "StorageProvider.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Number of rows read from ip_bans by all connections
+std::atomic<int> loads{ 0 };
+
+void CountLoad(sqlite3_context* context, int, sqlite3_value**)
+{
+    ++loads;
+    sqlite3_result_int(context, 1);
+}
+
+int RegisterCountLoad(sqlite3* db, const char**, const sqlite3_api_routines*)
+{
+    return sqlite3_create_function(db, "count_load", 0, SQLITE_UTF8, nullptr, &CountLoad, nullptr, nullptr);
+}
+
+template<typename Predicate>
+bool WaitFor(Predicate&& predicate)
+{
+    const auto start = std::chrono::steady_clock::now();
+    while (!predicate() && std::chrono::steady_clock::now() - start < 5s)
+        std::this_thread::sleep_for(1ms);
+    return predicate();
+}
+
+struct Results
+{
+    std::atomic<int> succeeded{ 0 };
+    std::atomic<int> failed{ 0 };
+};
+
+// A StorageProvider with one DB worker. The connections share a database file.
+class Storage
+{
+public:
+    static constexpr const char* FILE_NAME = "abtests_storage.db";
+    std::unique_ptr<StorageProvider> provider;
+    AB::Entities::IpBan ban;
+    std::atomic<bool> release{ false };
+
+    Storage()
+    {
+        std::remove(FILE_NAME);
+        // DatabaseSqlite only opens existing files
+        std::ofstream(FILE_NAME).close();
+        // Every new connection, also the one of the DB worker, gets the function
+        sqlite3_auto_extension(reinterpret_cast<void(*)()>(&RegisterCountLoad));
+        DB::Database::driver_ = "sqlite";
+        DB::Database::dbName_ = FILE_NAME;
+
+        ban.uuid = Utils::Uuid::New();
+        ban.banUuid = Utils::Uuid::New();
+        ban.ip = 0x7F000001;
+        {
+            DB::DatabaseSqlite db(FILE_NAME);
+            REQUIRE(db.ExecuteQuery("CREATE TABLE ip_ban_rows (uuid CHARACTER(36) NOT NULL, ban_uuid CHARACTER(36) NOT NULL, "
+                "ip BIGINT NOT NULL, mask BIGINT NOT NULL)"));
+            // DBIpBan reads the view, which counts the loads
+            REQUIRE(db.ExecuteQuery("CREATE VIEW ip_bans AS SELECT * FROM ip_ban_rows WHERE count_load()"));
+            REQUIRE(db.ExecuteQuery("INSERT INTO ip_ban_rows VALUES ('" + ban.uuid + "', '" + ban.banUuid + "', " +
+                std::to_string(ban.ip) + ", " + std::to_string(ban.mask) + ")"));
+        }
+        loads = 0;
+
+        Subsystems::Instance.CreateSubsystem<Asynch::Dispatcher>();
+        Subsystems::Instance.CreateSubsystem<Asynch::Scheduler>();
+        Subsystems::Instance.CreateSubsystem<Asynch::ThreadPool>(1);
+        GetSubsystem<Asynch::Dispatcher>()->Start();
+        GetSubsystem<Asynch::Scheduler>()->Start();
+        GetSubsystem<Asynch::ThreadPool>()->Start();
+        provider = std::make_unique<StorageProvider>(1024 * 1024, false);
+    }
+    ~Storage()
+    {
+        release = true;
+        GetSubsystem<Asynch::ThreadPool>()->Stop();
+        GetSubsystem<Asynch::Scheduler>()->Stop();
+        GetSubsystem<Asynch::Dispatcher>()->Stop();
+        provider.reset();
+        Subsystems::Instance.RemoveSubsystem<Asynch::ThreadPool>();
+        Subsystems::Instance.RemoveSubsystem<Asynch::Scheduler>();
+        Subsystems::Instance.RemoveSubsystem<Asynch::Dispatcher>();
+        sqlite3_cancel_auto_extension(reinterpret_cast<void(*)()>(&RegisterCountLoad));
+        std::remove(FILE_NAME);
+    }
+    /// The StorageProvider is used from the dispatcher thread
+    template<typename Function>
+    void Dispatch(Function&& function)
+    {
+        std::atomic<bool> done{ false };
+        GetSubsystem<Asynch::Dispatcher>()->Add(Asynch::CreateTask([&]()
+        {
+            function();
+            done = true;
+        }));
+        REQUIRE(WaitFor([&]() { return done.load(); }));
+    }
+    /// Loads wait until release is set
+    void BlockWorker()
+    {
+        release = false;
+        GetSubsystem<Asynch::ThreadPool>()->Enqueue([this]()
+        {
+            while (!release)
+                std::this_thread::sleep_for(1ms);
+        });
+    }
+    static IO::DataKey GetKey(const std::string& uuid)
+    {
+        return IO::DataKey(AB::Entities::IpBan::KEY(), uuids::uuid(uuid));
+    }
+    void Read(const std::string& uuid, Results& results)
+    {
+        auto data = ea::make_shared<StorageData>();
+        provider->ReadAsync(1, GetKey(uuid), data, [this, data, &results](bool success)
+        {
+            if (!success)
+            {
+                ++results.failed;
+                return;
+            }
+            AB::Entities::IpBan loaded;
+            using InputAdapter = bitsery::InputBufferAdapter<StorageData>;
+            InputAdapter ia(data->begin(), data->size());
+            const auto state = bitsery::quickDeserialization<InputAdapter>(ia, loaded);
+            if (state.first == bitsery::ReaderError::NoError && loaded.uuid == ban.uuid && loaded.banUuid == ban.banUuid)
+                ++results.succeeded;
+            else
+                ++results.failed;
+        });
+    }
+};
+
+}
+
+TEST_CASE("StorageProvider ReadAsync", "[db]")
+{
+    Storage storage;
+    Results results;
+
+    SECTION("Concurrent misses share one load")
+    {
+        storage.BlockWorker();
+        storage.Dispatch([&]()
+        {
+            for (int i = 0; i < 3; ++i)
+                storage.Read(storage.ban.uuid, results);
+        });
+        storage.release = true;
+        REQUIRE(WaitFor([&]() { return results.succeeded + results.failed == 3; }));
+        REQUIRE(results.succeeded == 3);
+        REQUIRE(loads == 1);
+
+        // Now it's cached
+        storage.Dispatch([&]() { storage.Read(storage.ban.uuid, results); });
+        REQUIRE(results.succeeded == 4);
+        REQUIRE(loads == 1);
+    }
+    SECTION("Invalidate while loading loads again")
+    {
+        storage.BlockWorker();
+        storage.Dispatch([&]()
+        {
+            storage.Read(storage.ban.uuid, results);
+            storage.Read(storage.ban.uuid, results);
+            storage.provider->Invalidate(1, Storage::GetKey(storage.ban.uuid));
+        });
+        storage.release = true;
+        REQUIRE(WaitFor([&]() { return results.succeeded + results.failed == 2; }));
+        REQUIRE(results.succeeded == 2);
+        REQUIRE(loads == 2);
+    }
+    SECTION("Clear while loading loads again")
+    {
+        storage.BlockWorker();
+        storage.Dispatch([&]()
+        {
+            storage.Read(storage.ban.uuid, results);
+            storage.provider->Clear(1, Storage::GetKey(storage.ban.uuid));
+        });
+        storage.release = true;
+        REQUIRE(WaitFor([&]() { return results.succeeded + results.failed == 1; }));
+        REQUIRE(results.succeeded == 1);
+        REQUIRE(loads == 2);
+    }
+    SECTION("A failed load fails all waiters")
+    {
+        const std::string missing = Utils::Uuid::New();
+        storage.BlockWorker();
+        storage.Dispatch([&]()
+        {
+            for (int i = 0; i < 3; ++i)
+                storage.Read(missing, results);
+        });
+        storage.release = true;
+        REQUIRE(WaitFor([&]() { return results.succeeded + results.failed == 3; }));
+        REQUIRE(results.failed == 3);
+
+        // The failed load is not pending anymore
+        storage.Dispatch([&]() { storage.Read(storage.ban.uuid, results); });
+        REQUIRE(WaitFor([&]() { return results.succeeded == 1; }));
+    }
+    SECTION("Failed connect")
+    {
+        DB::Database::dbName_ = "abtests_missing.db";
+        storage.Dispatch([&]()
+        {
+            for (int i = 0; i < 3; ++i)
+                storage.Read(storage.ban.uuid, results);
+        });
+        REQUIRE(WaitFor([&]() { return results.failed == 3; }));
+
+        // The worker waits before it connects again
+        DB::Database::dbName_ = Storage::FILE_NAME;
+        storage.Dispatch([&]() { storage.Read(storage.ban.uuid, results); });
+        REQUIRE(WaitFor([&]() { return results.failed == 4; }));
+        REQUIRE(results.succeeded == 0);
+
+        std::this_thread::sleep_for(600ms);
+        storage.Dispatch([&]() { storage.Read(storage.ban.uuid, results); });
+        REQUIRE(WaitFor([&]() { return results.succeeded == 1; }));
+        REQUIRE(loads == 1);
+    }
+}
+
+#endif
@@ -0,0 +1,220 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <InterestRanges.h>
+#include <map>
+#include <memory>
+
+namespace {
+
+struct Object
+{
+    uint32_t id;
+    Math::Vector3 position;
+    bool neighbour{ true };
+    Game::InterestRanges ranges;
+
+    uint32_t GetId() const { return id; }
+    const Math::Vector3& GetPosition() const { return position; }
+    Game::InterestRanges& GetInterestRanges() { return ranges; }
+    bool IsRangeNeighbour() const { return neighbour; }
+};
+
+// Objects by ID like Game::objects_, with a brute force spatial query
+struct World
+{
+    std::map<uint32_t, std::unique_ptr<Object>> objects;
+    ea::vector<Object*> query;
+    unsigned queries{ 0 };
+
+    Object& Add(uint32_t id, const Math::Vector3& position)
+    {
+        auto& object = objects[id];
+        object = std::make_unique<Object>();
+        object->id = id;
+        object->position = position;
+        return *object;
+    }
+    Object& Get(uint32_t id) { return *objects[id]; }
+    void Update()
+    {
+        Game::UpdateInterestRanges(objects, query, [this](Object& object, ea::vector<Object*>& result)
+        {
+            ++queries;
+            for (const auto& o : objects)
+            {
+                if (o.second.get() == &object)
+                    continue;
+                if (object.position.Distance(o.second->position) <= Game::RANGE_INTEREST + Game::AVERAGE_BB_EXTENDS)
+                    result.push_back(o.second.get());
+            }
+            return true;
+        });
+    }
+};
+
+struct Change
+{
+    uint32_t id;
+    uint16_t oldRanges;
+    uint16_t newRanges;
+};
+
+std::vector<Change> GetChanges(const Game::InterestRanges& ranges)
+{
+    std::vector<Change> result;
+    ranges.VisitChanges([&result](uint32_t id, uint16_t oldRanges, uint16_t newRanges)
+    {
+        result.push_back({ id, oldRanges, newRanges });
+    });
+    return result;
+}
+
+constexpr uint16_t Bit(Game::Ranges range)
+{
+    return static_cast<uint16_t>(1u << static_cast<unsigned>(range));
+}
+
+}
+
+TEST_CASE("InterestRanges mask")
+{
+    const uint16_t touch = Game::InterestRanges::GetMask(Game::RANGE_TOUCH);
+    CHECK((touch & Bit(Game::Ranges::Touch)) != 0);
+    CHECK((touch & Bit(Game::Ranges::Aggro)) != 0);
+    CHECK((touch & Bit(Game::Ranges::Interest)) != 0);
+    CHECK((touch & Bit(Game::Ranges::Map)) == 0);
+
+    const uint16_t interest = Game::InterestRanges::GetMask(Game::RANGE_INTEREST);
+    CHECK(interest == Bit(Game::Ranges::Interest));
+    CHECK(Game::InterestRanges::GetMask(Game::RANGE_INTEREST + 1.0f) == 0);
+}
+
+TEST_CASE("InterestRanges update")
+{
+    World world;
+    // Spread over the map so every object has a different set of neighbours
+    for (uint32_t i = 1; i <= 40; ++i)
+        world.Add(i, { static_cast<float>((i * 37) % 200), 0.0f, static_cast<float>((i * 53) % 170) });
+    world.Get(7).neighbour = false;
+    world.Update();
+
+    SECTION("Once per tick")
+    {
+        CHECK(world.queries == world.objects.size());
+    }
+    SECTION("Same as calculated")
+    {
+        for (const auto& o : world.objects)
+        {
+            const Object& object = *o.second;
+            for (const auto& o2 : world.objects)
+            {
+                const Object& other = *o2.second;
+                uint16_t expected = 0;
+                if (&other != &object && other.neighbour)
+                    expected = Game::InterestRanges::GetMask(object.position.Distance(other.position) - Game::AVERAGE_BB_EXTENDS);
+                for (unsigned r = 0; r < static_cast<unsigned>(Game::Ranges::Map); ++r)
+                {
+                    const auto range = static_cast<Game::Ranges>(r);
+                    INFO(object.id << " -> " << other.id << " range " << r);
+                    CHECK(object.ranges.IsInRange(range, other.id) == ((expected & Bit(range)) != 0));
+                }
+            }
+        }
+    }
+    SECTION("Sorted IDs")
+    {
+        ea::vector<uint32_t> ids;
+        world.Get(1).ranges.GetIds(Game::Ranges::Interest, ids);
+        REQUIRE(!ids.empty());
+        for (size_t i = 1; i < ids.size(); ++i)
+            CHECK(ids[i - 1] < ids[i]);
+    }
+    SECTION("Not a neighbour")
+    {
+        for (const auto& o : world.objects)
+            CHECK(!o.second->ranges.IsInRange(Game::Ranges::Interest, 7));
+    }
+}
+
+TEST_CASE("InterestRanges between ticks")
+{
+    World world;
+    Object& a = world.Add(1, { 0.0f, 0.0f, 0.0f });
+    world.Add(2, { Game::RANGE_TOUCH, 0.0f, 0.0f });
+    world.Add(3, { Game::RANGE_INTEREST + 10.0f, 0.0f, 0.0f });
+    world.Update();
+    REQUIRE(a.ranges.IsInRange(Game::Ranges::Touch, 2));
+    REQUIRE(!a.ranges.IsInRange(Game::Ranges::Interest, 3));
+    const std::vector<Change> first = GetChanges(a.ranges);
+    REQUIRE(first.size() == 1);
+    CHECK(first[0].id == 2);
+    CHECK(first[0].oldRanges == 0);
+
+    // 2 leaves, 3 enters and 4 is added
+    world.Get(2).position = { Game::RANGE_INTEREST + 10.0f, 0.0f, 0.0f };
+    world.Get(3).position = { 0.0f, 0.0f, Game::RANGE_TOUCH };
+    world.Add(4, { -Game::RANGE_TOUCH, 0.0f, 0.0f });
+
+    SECTION("Unchanged until the next update")
+    {
+        CHECK(a.ranges.IsInRange(Game::Ranges::Touch, 2));
+        CHECK(!a.ranges.IsInRange(Game::Ranges::Touch, 3));
+        CHECK(!a.ranges.IsInRange(Game::Ranges::Touch, 4));
+        CHECK(world.Get(2).ranges.IsInRange(Game::Ranges::Touch, 1));
+    }
+    SECTION("Picked up with the next update")
+    {
+        world.Update();
+        CHECK(!a.ranges.IsInRange(Game::Ranges::Interest, 2));
+        CHECK(a.ranges.IsInRange(Game::Ranges::Touch, 3));
+        CHECK(a.ranges.IsInRange(Game::Ranges::Touch, 4));
+        CHECK(!world.Get(2).ranges.IsInRange(Game::Ranges::Interest, 1));
+        CHECK(world.Get(3).ranges.IsInRange(Game::Ranges::Touch, 1));
+
+        const std::vector<Change> changes = GetChanges(a.ranges);
+        REQUIRE(changes.size() == 3);
+        CHECK(changes[0].id == 2);
+        CHECK(changes[0].oldRanges != 0);
+        CHECK(changes[0].newRanges == 0);
+        CHECK(changes[1].id == 3);
+        CHECK(changes[1].oldRanges == 0);
+        CHECK((changes[1].newRanges & Bit(Game::Ranges::Touch)) != 0);
+        CHECK(changes[2].id == 4);
+        CHECK(changes[2].oldRanges == 0);
+
+        // Nothing moved
+        world.Update();
+        CHECK(GetChanges(a.ranges).empty());
+    }
+    SECTION("Removed")
+    {
+        world.objects.erase(2);
+        world.Update();
+        const std::vector<Change> changes = GetChanges(a.ranges);
+        REQUIRE(changes.size() == 3);
+        CHECK(changes[0].id == 2);
+        CHECK(changes[0].newRanges == 0);
+    }
+}
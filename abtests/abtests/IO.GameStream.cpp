@@ -0,0 +1,185 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <GameStream.h>
+#include <abscommon/NetworkMessage.h>
+#include <abscommon/Subsystems.h>
+#include <abscommon/ThreadPool.h>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <sa/time.h>
+
+namespace {
+
+constexpr uint32_t KEYFRAMES = 4;
+constexpr uint32_t MESSAGES_PER_KEYFRAME = 100;
+// About 1kB per message, so a keyframe needs more than one block
+constexpr uint32_t VALUES_PER_MESSAGE = 250;
+
+void MakeMessage(uint32_t i, Net::NetworkMessage& msg)
+{
+    msg.Reset();
+    msg.Add<uint32_t>(i);
+    for (uint32_t j = 0; j < VALUES_PER_MESSAGE; ++j)
+        msg.Add<uint32_t>(i * 31 + j);
+}
+
+bool CheckMessage(uint32_t i, Net::NetworkMessage& msg)
+{
+    if (msg.Get<uint32_t>() != i)
+        return false;
+    for (uint32_t j = 0; j < VALUES_PER_MESSAGE; ++j)
+    {
+        if (msg.Get<uint32_t>() != i * 31 + j)
+            return false;
+    }
+    return true;
+}
+
+}
+
+TEST_CASE("GameStream", "[recording]")
+{
+    Subsystems::Instance.CreateSubsystem<Asynch::ThreadPool>(1);
+    GetSubsystem<Asynch::ThreadPool>()->Start();
+
+    const std::string dir = std::filesystem::temp_directory_path().string();
+    const std::string instance = "abtests-gamestream";
+    const std::string gameUuid = "a8a5e23b-7d0c-4bd1-9b4c-0b6b4b2a7c11";
+    const int64_t startTime = sa::time::tick();
+
+    {
+        IO::GameWriteStream writer;
+        REQUIRE(writer.Open(dir, instance, gameUuid, startTime));
+        Net::NetworkMessage msg;
+        for (uint32_t k = 0; k < KEYFRAMES; ++k)
+        {
+            // Give each keyframe a different game time
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            writer.BeginKeyframe();
+            for (uint32_t i = 0; i < MESSAGES_PER_KEYFRAME; ++i)
+            {
+                MakeMessage(k * MESSAGES_PER_KEYFRAME + i, msg);
+                writer.Write(msg);
+            }
+        }
+        writer.Close();
+    }
+    // Waits until the writer finished the file
+    GetSubsystem<Asynch::ThreadPool>()->Stop();
+    Subsystems::Instance.RemoveSubsystem<Asynch::ThreadPool>();
+
+    IO::GameReadStream reader;
+    REQUIRE(reader.Open(dir, instance));
+    REQUIRE(reader.GetGameUuid() == gameUuid);
+    REQUIRE(reader.GetStartTime() == startTime);
+    const auto index = reader.GetIndex();
+    std::vector<IO::GameRecordIndexEntry> keyframes;
+    for (const auto& entry : index)
+    {
+        if (entry.flags & IO::REC_BLOCK_KEYFRAME)
+            keyframes.push_back(entry);
+    }
+    REQUIRE(keyframes.size() == KEYFRAMES);
+    REQUIRE(index.size() > KEYFRAMES);
+    for (size_t i = 1; i < index.size(); ++i)
+    {
+        REQUIRE(index[i].offset > index[i - 1].offset);
+        REQUIRE(index[i].time >= index[i - 1].time);
+    }
+
+    SECTION("Read")
+    {
+        Net::NetworkMessage msg;
+        uint32_t count = 0;
+        while (reader.Read(msg))
+        {
+            REQUIRE(CheckMessage(count, msg));
+            ++count;
+        }
+        REQUIRE(count == KEYFRAMES * MESSAGES_PER_KEYFRAME);
+    }
+    SECTION("Seek")
+    {
+        Net::NetworkMessage msg;
+        // Between the second and third keyframe
+        REQUIRE(reader.Seek(keyframes[2].time - 1));
+        REQUIRE(reader.Read(msg));
+        REQUIRE(CheckMessage(MESSAGES_PER_KEYFRAME, msg));
+
+        REQUIRE(reader.Seek(keyframes[2].time));
+        REQUIRE(reader.Read(msg));
+        REQUIRE(CheckMessage(2 * MESSAGES_PER_KEYFRAME, msg));
+        // Continues with the following blocks
+        uint32_t count = 1;
+        while (reader.Read(msg))
+        {
+            REQUIRE(CheckMessage(2 * MESSAGES_PER_KEYFRAME + count, msg));
+            ++count;
+        }
+        REQUIRE(count == 2 * MESSAGES_PER_KEYFRAME);
+    }
+    SECTION("Scan blocks without index")
+    {
+        // Like a recording of a crashed server, no index and no index offset
+        const std::string crashed = instance + "-crashed";
+        const std::string filename = dir + "/" + instance + ".rec";
+        const std::string crashedFilename = dir + "/" + crashed + ".rec";
+        uint64_t indexOffset = 0;
+        {
+            std::ifstream in(filename, std::ios::binary);
+            in.seekg(4 + sizeof(int16_t));
+            in.read((char*)&indexOffset, sizeof(indexOffset));
+        }
+        REQUIRE(indexOffset != 0);
+        std::filesystem::copy_file(filename, crashedFilename, std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::resize_file(crashedFilename, indexOffset);
+        {
+            std::fstream out(crashedFilename, std::ios::binary | std::ios::in | std::ios::out);
+            const uint64_t zero = 0;
+            out.seekp(4 + sizeof(int16_t));
+            out.write((const char*)&zero, sizeof(zero));
+        }
+
+        IO::GameReadStream scanned;
+        REQUIRE(scanned.Open(dir, crashed));
+        const auto& scannedIndex = scanned.GetIndex();
+        REQUIRE(scannedIndex.size() == index.size());
+        for (size_t i = 0; i < index.size(); ++i)
+        {
+            REQUIRE(scannedIndex[i].offset == index[i].offset);
+            REQUIRE(scannedIndex[i].time == index[i].time);
+            REQUIRE(scannedIndex[i].flags == index[i].flags);
+        }
+        REQUIRE(scanned.Seek(keyframes[3].time));
+        Net::NetworkMessage msg;
+        REQUIRE(scanned.Read(msg));
+        REQUIRE(CheckMessage(3 * MESSAGES_PER_KEYFRAME, msg));
+        scanned.Close();
+        std::filesystem::remove(crashedFilename);
+    }
+
+    reader.Close();
+    std::filesystem::remove(dir + "/" + instance + ".rec");
+}
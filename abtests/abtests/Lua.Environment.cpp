@@ -0,0 +1,320 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <kaguya/kaguya.hpp>
+#include <Script.h>
+#include <chrono>
+#include <map>
+#include <sstream>
+
+// abserv runs the scripts of game bound objects in one VM per game, each script in
+// its own global table (see Game::Lua::Environment). These tests check the Lua side of it.
+
+namespace {
+
+struct Object
+{
+    int value = 0;
+    int GetValue() const { return value; }
+    void SetValue(int v) { value = v; }
+};
+
+kaguya::LuaTable NewMetatable(kaguya::State& state)
+{
+    kaguya::LuaTable result = state.newTable();
+    result["__index"] = state.globalTable();
+    return result;
+}
+
+kaguya::LuaTable NewEnvironment(kaguya::State& state, const kaguya::LuaTable& meta)
+{
+    kaguya::LuaTable result = state.newTable();
+    result.setMetatable(meta);
+    return result;
+}
+
+bool Execute(kaguya::State& state, const std::string& source, const kaguya::LuaTable& env)
+{
+    std::istringstream is(source);
+    return state.dostream(is, nullptr, env);
+}
+
+const char* SCRIPT = R"lua(
+damage = 0
+function onInit()
+  damage = 10 + self:GetValue() * 2
+  return true
+end
+function onTrigger(other)
+  other:SetValue(other:GetValue() - damage)
+end
+)lua";
+
+}
+
+TEST_CASE("Lua Environment isolated globals")
+{
+    kaguya::State state;
+    state["Answer"] = 42;
+    kaguya::LuaTable meta = NewMetatable(state);
+    kaguya::LuaTable env1 = NewEnvironment(state, meta);
+    kaguya::LuaTable env2 = NewEnvironment(state, meta);
+    REQUIRE(Execute(state, "value = 1 function get() return value end", env1));
+    REQUIRE(Execute(state, "value = 2 function get() return value end", env2));
+
+    int v1 = env1["get"]();
+    int v2 = env2["get"]();
+    REQUIRE(v1 == 1);
+    REQUIRE(v2 == 2);
+    // Nothing leaked into the globals of the state
+    REQUIRE(state["value"].type() == LUA_TNIL);
+    REQUIRE(state["get"].type() == LUA_TNIL);
+    // Globals of the state are visible
+    int answer = env1["Answer"];
+    REQUIRE(answer == 42);
+    // Shadowing a global does not change it for others
+    REQUIRE(Execute(state, "Answer = 1", env1));
+    int shadowed = env1["Answer"];
+    int global = env2["Answer"];
+    REQUIRE(shadowed == 1);
+    REQUIRE(global == 42);
+}
+
+TEST_CASE("Lua Environment self")
+{
+    kaguya::State state;
+    state["Object"].setClass(kaguya::UserdataMetatable<Object>()
+        .addFunction("GetValue", &Object::GetValue)
+        .addFunction("SetValue", &Object::SetValue)
+    );
+    Object a; a.value = 1;
+    Object b; b.value = 5;
+    Object target; target.value = 100;
+    kaguya::LuaTable meta = NewMetatable(state);
+    kaguya::LuaTable envA = NewEnvironment(state, meta);
+    kaguya::LuaTable envB = NewEnvironment(state, meta);
+    envA["self"] = &a;
+    envB["self"] = &b;
+    REQUIRE(Execute(state, SCRIPT, envA));
+    REQUIRE(Execute(state, SCRIPT, envB));
+    bool initA = envA["onInit"]();
+    bool initB = envB["onInit"]();
+    REQUIRE(initA);
+    REQUIRE(initB);
+    envA["onTrigger"](&target);
+    REQUIRE(target.value == 88);
+    envB["onTrigger"](&target);
+    REQUIRE(target.value == 68);
+}
+
+namespace {
+
+// Like the weapon scripts in /scripts/items/weapons, the defaults set globals which are
+// used by the functions of an include shared by all weapon types.
+const char* AXE_DEFAULTS = R"lua(
+dropStats = {}
+dropStats["MinDamage"] = 6
+dropStats["MaxDamage"] = 28
+)lua";
+const char* SWORD_DEFAULTS = R"lua(
+dropStats = {}
+dropStats["MinDamage"] = 15
+dropStats["MaxDamage"] = 22
+)lua";
+const char* ITEM_FUNCTIONS = R"lua(
+includeCount = (includeCount or 0) + 1
+function getMinDamage()
+  return dropStats["MinDamage"]
+end
+function getMaxDamage()
+  return dropStats["MaxDamage"]
+end
+)lua";
+
+int DumpWriter(lua_State*, const void* p, size_t size, void* ud)
+{
+    auto& buffer = *reinterpret_cast<ea::vector<char>*>(ud);
+    const char* data = reinterpret_cast<const char*>(p);
+    buffer.insert(buffer.end(), data, data + size);
+    return 0;
+}
+
+// Scripts are precompiled like IO::IOScript does
+std::map<std::string, ea::shared_ptr<Game::Script>>& GetScripts()
+{
+    static std::map<std::string, ea::shared_ptr<Game::Script>> scripts;
+    if (!scripts.empty())
+        return scripts;
+    for (const auto& source : std::map<std::string, const char*>{
+        { "axe_defaults.lua", AXE_DEFAULTS },
+        { "sword_defaults.lua", SWORD_DEFAULTS },
+        { "item_functions.lua", ITEM_FUNCTIONS } })
+    {
+        lua_State* L = luaL_newstate();
+        auto script = ea::make_shared<Game::Script>();
+        script->SetFileName(source.first);
+        if (luaL_loadstring(L, source.second) == LUA_OK)
+            lua_dump(L, DumpWriter, &script->GetBuffer(), 1);
+        lua_close(L);
+        scripts.emplace(source.first, script);
+    }
+    return scripts;
+}
+
+ea::shared_ptr<Game::Script> LoadScript(const std::string& name)
+{
+    auto& scripts = GetScripts();
+    const auto it = scripts.find(name);
+    if (it == scripts.end())
+        return {};
+    return it->second;
+}
+
+}
+
+TEST_CASE("Lua Environment include")
+{
+    REQUIRE(GetScripts().size() == 3);
+    for (const auto& script : GetScripts())
+        REQUIRE(!script.second->GetBuffer().empty());
+    // Two weapon types in the VM of one lane
+    kaguya::State state;
+    kaguya::LuaTable meta = NewMetatable(state);
+    kaguya::LuaTable axe = NewEnvironment(state, meta);
+    kaguya::LuaTable sword = NewEnvironment(state, meta);
+    Game::Script::AddInclude(axe, &LoadScript);
+    Game::Script::AddInclude(sword, &LoadScript);
+    REQUIRE(Execute(state, R"lua(
+include("axe_defaults.lua")
+include("item_functions.lua")
+include("item_functions.lua")
+)lua", axe));
+    REQUIRE(Execute(state, R"lua(
+include("sword_defaults.lua")
+include("item_functions.lua")
+)lua", sword));
+
+    int axeMin = axe["getMinDamage"]();
+    int axeMax = axe["getMaxDamage"]();
+    int swordMin = sword["getMinDamage"]();
+    int swordMax = sword["getMaxDamage"]();
+    REQUIRE(axeMin == 6);
+    REQUIRE(axeMax == 28);
+    REQUIRE(swordMin == 15);
+    REQUIRE(swordMax == 22);
+    // Included once per environment
+    int axeCount = axe["includeCount"];
+    int swordCount = sword["includeCount"];
+    REQUIRE(axeCount == 1);
+    REQUIRE(swordCount == 1);
+    // Nothing leaked into the globals of the state
+    REQUIRE(state["dropStats"].type() == LUA_TNIL);
+    REQUIRE(state["getMinDamage"].type() == LUA_TNIL);
+}
+
+namespace {
+
+// Roughly the size of Game::Lua::RegisterLuaAll(): ~250 bound functions and a
+// script with constants executed in each state.
+void RegisterBindings(kaguya::State& state)
+{
+    for (int c = 0; c < 16; ++c)
+    {
+        kaguya::UserdataMetatable<Object> meta;
+        for (int f = 0; f < 16; ++f)
+        {
+            const std::string name = "Function" + std::to_string(f);
+            if (f % 2 == 0)
+                meta.addFunction(name.c_str(), &Object::GetValue);
+            else
+                meta.addFunction(name.c_str(), &Object::SetValue);
+        }
+        state["Class" + std::to_string(c)].setClass(meta);
+    }
+    std::string consts;
+    for (int i = 0; i < 150; ++i)
+        consts += "CONST_" + std::to_string(i) + " = " + std::to_string(i) + "\n";
+    state(consts);
+}
+
+size_t MemoryUsage(kaguya::State& state)
+{
+    lua_State* L = state.state();
+    return static_cast<size_t>(lua_gc(L, LUA_GCCOUNT, 0)) * 1024 + static_cast<size_t>(lua_gc(L, LUA_GCCOUNTB, 0));
+}
+
+}
+
+// Not run by default, run with: abtests [benchmark]
+TEST_CASE("Lua Environment benchmark", "[.][benchmark]")
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int COUNT = 500;
+    Object object;
+
+    {
+        // One VM per object, like Skill, Effect and Item
+        std::vector<std::unique_ptr<kaguya::State>> states;
+        states.reserve(COUNT);
+        size_t memory = 0;
+        const auto start = Clock::now();
+        for (int i = 0; i < COUNT; ++i)
+        {
+            auto state = std::make_unique<kaguya::State>();
+            RegisterBindings(*state);
+            (*state)["self"] = &object;
+            std::istringstream is(SCRIPT);
+            REQUIRE(state->dostream(is));
+            bool init = (*state)["onInit"]();
+            REQUIRE(init);
+            memory += MemoryUsage(*state);
+            states.push_back(std::move(state));
+        }
+        const auto time = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        WARN("kaguya::State per object: " << time / COUNT << "us, " << memory / COUNT << " bytes per object");
+    }
+
+    {
+        // One shared VM, an environment per object
+        kaguya::State state;
+        RegisterBindings(state);
+        kaguya::LuaTable meta = NewMetatable(state);
+        const size_t base = MemoryUsage(state);
+        std::vector<kaguya::LuaTable> envs;
+        envs.reserve(COUNT);
+        const auto start = Clock::now();
+        for (int i = 0; i < COUNT; ++i)
+        {
+            kaguya::LuaTable env = NewEnvironment(state, meta);
+            env["self"] = &object;
+            REQUIRE(Execute(state, SCRIPT, env));
+            bool init = env["onInit"]();
+            REQUIRE(init);
+            envs.push_back(std::move(env));
+        }
+        const auto time = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        const size_t memory = MemoryUsage(state) - base;
+        WARN("Environment per object: " << time / COUNT << "us, " << memory / COUNT << " bytes per object, "
+            << base << " bytes shared");
+    }
+}
@@ -0,0 +1,183 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <absmath/LooseGrid.h>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Object
+{
+    Math::BoundingBox box;
+    Math::LooseGrid<Object>::Id id;
+};
+
+Math::BoundingBox MakeBox(float x, float z, float extent)
+{
+    return Math::BoundingBox(Math::Vector3(x - extent, 0.0f, z - extent), Math::Vector3(x + extent, 1.0f, z + extent));
+}
+
+// What the grid should return
+ea::vector<Object*> BruteForce(ea::vector<Object>& objects, const Math::Sphere& sphere)
+{
+    ea::vector<Object*> result;
+    for (auto& o : objects)
+    {
+        if (sphere.IsInsideFast(o.box) != Math::Intersection::Outside)
+            result.push_back(&o);
+    }
+    return result;
+}
+
+// Catch can't compare EASTL containers
+std::vector<Object*> Sorted(const ea::vector<Object*>& objects)
+{
+    std::vector<Object*> result(objects.begin(), objects.end());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+}
+
+TEST_CASE("LooseGrid", "[loosegrid]")
+{
+    Math::LooseGrid<Object> grid(Math::BoundingBox(-100.0f, 100.0f), 10.0f);
+    ea::vector<Object> objects;
+    objects.push_back({ MakeBox(0.0f, 0.0f, 1.0f), 0 });
+    objects.push_back({ MakeBox(15.0f, 0.0f, 1.0f), 0 });
+    objects.push_back({ MakeBox(50.0f, 50.0f, 1.0f), 0 });
+    for (auto& o : objects)
+        o.id = grid.Insert(&o, o.box);
+    REQUIRE(grid.GetCount() == 3);
+
+    SECTION("Query")
+    {
+        ea::vector<Object*> result;
+        grid.Query(Math::Sphere(Math::Vector3::Zero, 5.0f), result);
+        REQUIRE(result.size() == 1);
+        REQUIRE(result[0] == &objects[0]);
+
+        result.clear();
+        grid.Query(Math::Sphere(Math::Vector3::Zero, 15.0f), result, &objects[0]);
+        REQUIRE(result.size() == 1);
+        REQUIRE(result[0] == &objects[1]);
+
+        result.clear();
+        grid.Query(MakeBox(50.0f, 50.0f, 2.0f), result);
+        REQUIRE(result.size() == 1);
+        REQUIRE(result[0] == &objects[2]);
+    }
+    SECTION("Move")
+    {
+        objects[2].box = MakeBox(1.0f, 1.0f, 1.0f);
+        grid.Move(objects[2].id, objects[2].box);
+        ea::vector<Object*> result;
+        grid.Query(Math::Sphere(Math::Vector3::Zero, 5.0f), result);
+        REQUIRE(Sorted(result) == Sorted({ &objects[0], &objects[2] }));
+        result.clear();
+        grid.Query(Math::Sphere(Math::Vector3(50.0f, 0.0f, 50.0f), 5.0f), result);
+        REQUIRE(result.empty());
+    }
+    SECTION("Remove")
+    {
+        grid.Remove(objects[0].id);
+        REQUIRE(grid.GetCount() == 2);
+        ea::vector<Object*> result;
+        grid.Query(Math::Sphere(Math::Vector3::Zero, 5.0f), result);
+        REQUIRE(result.empty());
+        // The other objects must still be found
+        grid.Query(Math::Sphere(Math::Vector3(15.0f, 0.0f, 0.0f), 2.0f), result);
+        REQUIRE(result.size() == 1);
+        REQUIRE(result[0] == &objects[1]);
+        // Reuses the ID
+        REQUIRE(grid.Insert(&objects[0], objects[0].box) == objects[0].id);
+    }
+    SECTION("Large objects")
+    {
+        // Larger than a cell, e.g. a terrain patch
+        Object large{ MakeBox(-80.0f, -80.0f, 30.0f), 0 };
+        large.id = grid.Insert(&large, large.box);
+        ea::vector<Object*> result;
+        grid.Query(Math::Sphere(Math::Vector3(-55.0f, 0.0f, -55.0f), 1.0f), result);
+        REQUIRE(result.size() == 1);
+        REQUIRE(result[0] == &large);
+    }
+    SECTION("Objects overlapping cells")
+    {
+        // The center is in another cell than the query
+        Object o{ MakeBox(-14.0f, 0.0f, 4.5f), 0 };
+        o.id = grid.Insert(&o, o.box);
+        ea::vector<Object*> result;
+        grid.Query(Math::Sphere(Math::Vector3(-9.2f, 0.0f, 0.0f), 0.5f), result);
+        REQUIRE(result.size() == 1);
+        REQUIRE(result[0] == &o);
+    }
+}
+
+TEST_CASE("LooseGrid random", "[loosegrid]")
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> extent(0.1f, 3.0f);
+
+    Math::LooseGrid<Object> grid(Math::BoundingBox(-200.0f, 200.0f), 16.0f);
+    ea::vector<Object> objects(500);
+    for (auto& o : objects)
+    {
+        o.box = MakeBox(pos(rng), pos(rng), extent(rng));
+        o.id = grid.Insert(&o, o.box);
+    }
+    // Move half of them
+    for (size_t i = 0; i < objects.size(); i += 2)
+    {
+        objects[i].box = MakeBox(pos(rng), pos(rng), extent(rng));
+        grid.Move(objects[i].id, objects[i].box);
+    }
+
+    ea::vector<Math::Sphere> spheres;
+    for (int i = 0; i < 50; ++i)
+        spheres.push_back(Math::Sphere(Math::Vector3(pos(rng), 0.5f, pos(rng)), 25.0f));
+
+    SECTION("Single")
+    {
+        for (const auto& sphere : spheres)
+        {
+            ea::vector<Object*> result;
+            grid.Query(sphere, result);
+            REQUIRE(Sorted(result) == Sorted(BruteForce(objects, sphere)));
+        }
+    }
+    SECTION("Batched")
+    {
+        ea::vector<Object*> result;
+        ea::vector<size_t> offsets;
+        grid.Query(spheres.data(), spheres.size(), result, offsets);
+        REQUIRE(offsets.size() == spheres.size() + 1);
+        for (size_t i = 0; i < spheres.size(); ++i)
+        {
+            ea::vector<Object*> r(result.begin() + offsets[i], result.begin() + offsets[i + 1]);
+            REQUIRE(Sorted(r) == Sorted(BruteForce(objects, spheres[i])));
+        }
+    }
+}
@@ -0,0 +1,318 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <absmath/SpatialIndex.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Object
+{
+    Math::BoundingBox box;
+    bool occludee_{ true };
+    Math::SpatialIndex<Object>* spatialIndex_{ nullptr };
+    Math::LooseGrid<Object>::Id gridId_{ Math::LooseGrid<Object>::INVALID_ID };
+    Math::Octant<Object>* octant_{ nullptr };
+    float sortValue_{ 0.0f };
+
+    Math::BoundingBox GetWorldBoundingBox() const { return box; }
+    Math::Octant<Object>* GetOctant() const { return octant_; }
+    void SetOctant(Math::Octant<Object>* octant) { octant_ = octant; }
+    float GetSortValue() const { return sortValue_; }
+    void SetSortValue(float value) { sortValue_ = value; }
+    void ProcessRayQuery(const Math::RayQuery<Object>& query, ea::vector<Math::RayQueryResult<Object>>& results)
+    {
+        const float distance = query.ray_.HitDistance(box);
+        if (distance < query.maxDistance_)
+        {
+            Math::RayQueryResult<Object> result;
+            result.distance_ = distance;
+            result.object_ = this;
+            results.push_back(std::move(result));
+        }
+    }
+};
+
+Math::BoundingBox MakeBox(float x, float z, float extent)
+{
+    return Math::BoundingBox(Math::Vector3(x - extent, 0.0f, z - extent), Math::Vector3(x + extent, 2.0f, z + extent));
+}
+
+// Catch can't compare EASTL containers
+std::vector<Object*> Sorted(const ea::vector<Object*>& objects)
+{
+    std::vector<Object*> result(objects.begin(), objects.end());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<Object*> RayObjects(const ea::vector<Math::RayQueryResult<Object>>& results)
+{
+    std::vector<Object*> result;
+    for (const auto& r : results)
+        result.push_back(r.object_);
+    return result;
+}
+
+bool IsSortedByDistance(const ea::vector<Math::RayQueryResult<Object>>& results)
+{
+    for (size_t i = 1; i < results.size(); ++i)
+    {
+        if (results[i - 1].distance_ > results[i].distance_)
+            return false;
+    }
+    return true;
+}
+
+ea::vector<Object*> BruteForce(ea::vector<Object>& objects, const Math::Sphere& sphere, const Object* ignore)
+{
+    ea::vector<Object*> result;
+    for (auto& o : objects)
+    {
+        if (&o != ignore && sphere.IsInsideFast(o.box) != Math::Intersection::Outside)
+            result.push_back(&o);
+    }
+    return result;
+}
+
+}
+
+TEST_CASE("SpatialIndex", "[spatialindex]")
+{
+    const Math::BoundingBox bounds(-200.0f, 200.0f);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(-190.0f, 190.0f);
+    std::uniform_real_distribution<float> extent(0.1f, 3.0f);
+
+    ea::vector<Object> objects(300);
+    for (auto& o : objects)
+        o.box = MakeBox(pos(rng), pos(rng), extent(rng));
+    // A terrain patch like object, larger than a grid cell
+    objects[0].box = MakeBox(-100.0f, -100.0f, 40.0f);
+    ea::vector<Object> gridObjects = objects;
+
+    Math::OctreeIndex<Object> octree;
+    octree.SetSize(bounds);
+    Math::GridIndex<Object> grid(bounds, 16.0f);
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        octree.InsertObject(&objects[i]);
+        grid.InsertObject(&gridObjects[i]);
+    }
+    REQUIRE(objects[1].spatialIndex_ == &octree);
+    REQUIRE(gridObjects[1].spatialIndex_ == &grid);
+
+    // Move half of them
+    for (size_t i = 1; i < objects.size(); i += 2)
+    {
+        objects[i].box = MakeBox(pos(rng), pos(rng), extent(rng));
+        gridObjects[i].box = objects[i].box;
+        octree.AddObjectUpdate(&objects[i]);
+        grid.AddObjectUpdate(&gridObjects[i]);
+    }
+    octree.Update();
+    grid.Update();
+
+    // Compare the results of both by the index of the objects
+    const auto toIndices = [](const std::vector<Object*>& result, const ea::vector<Object>& all)
+    {
+        std::vector<size_t> indices;
+        for (const auto* o : result)
+            indices.push_back(static_cast<size_t>(o - all.data()));
+        std::sort(indices.begin(), indices.end());
+        return indices;
+    };
+
+    SECTION("Sphere")
+    {
+        for (size_t i = 0; i < objects.size(); i += 7)
+        {
+            const Math::Sphere sphere(objects[i].box.Center(), 25.0f);
+            ea::vector<Object*> octreeResult;
+            octree.GetObjects(octreeResult, sphere, &objects[i]);
+            ea::vector<Object*> gridResult;
+            grid.GetObjects(gridResult, sphere, &gridObjects[i]);
+            REQUIRE(Sorted(octreeResult) == Sorted(BruteForce(objects, sphere, &objects[i])));
+            REQUIRE(toIndices(Sorted(gridResult), gridObjects) == toIndices(Sorted(octreeResult), objects));
+        }
+    }
+    SECTION("Box")
+    {
+        for (size_t i = 0; i < objects.size(); i += 7)
+        {
+            const Math::BoundingBox box = MakeBox(objects[i].box.Center().x_, objects[i].box.Center().z_, 20.0f);
+            ea::vector<Object*> octreeResult;
+            octree.GetObjects(octreeResult, box, nullptr);
+            ea::vector<Object*> gridResult;
+            grid.GetObjects(gridResult, box, nullptr);
+            REQUIRE(!octreeResult.empty());
+            REQUIRE(toIndices(Sorted(gridResult), gridObjects) == toIndices(Sorted(octreeResult), objects));
+        }
+    }
+    SECTION("Ray")
+    {
+        std::uniform_real_distribution<float> angle(0.0f, Math::M_TWOPI);
+        for (size_t i = 0; i < objects.size(); i += 7)
+        {
+            const float a = angle(rng);
+            const Math::Ray ray(objects[i].box.Center(), Math::Vector3(std::cos(a), 0.0f, std::sin(a)));
+            for (float maxDist : { 30.0f, Math::M_INFINITE })
+            {
+                ea::vector<Math::RayQueryResult<Object>> octreeResult;
+                Math::RayQuery<Object> octreeQuery(octreeResult, ray, maxDist, &objects[i]);
+                octree.Raycast(octreeQuery);
+                ea::vector<Math::RayQueryResult<Object>> gridResult;
+                Math::RayQuery<Object> gridQuery(gridResult, ray, maxDist, &gridObjects[i]);
+                grid.Raycast(gridQuery);
+                REQUIRE(IsSortedByDistance(gridResult));
+                REQUIRE(toIndices(RayObjects(gridResult), gridObjects) == toIndices(RayObjects(octreeResult), objects));
+            }
+        }
+    }
+    SECTION("Resize")
+    {
+        // Objects are kept
+        grid.SetSize(Math::BoundingBox(-100.0f, 100.0f));
+        octree.SetSize(Math::BoundingBox(-100.0f, 100.0f));
+        const Math::Sphere sphere(Math::Vector3::Zero, 150.0f);
+        ea::vector<Object*> octreeResult;
+        octree.GetObjects(octreeResult, sphere, nullptr);
+        ea::vector<Object*> gridResult;
+        grid.GetObjects(gridResult, sphere, nullptr);
+        REQUIRE(!gridResult.empty());
+        REQUIRE(toIndices(Sorted(gridResult), gridObjects) == toIndices(Sorted(octreeResult), objects));
+    }
+    SECTION("Remove")
+    {
+        octree.RemoveObject(&objects[2]);
+        grid.RemoveObject(&gridObjects[2]);
+        REQUIRE(objects[2].spatialIndex_ == nullptr);
+        REQUIRE(gridObjects[2].spatialIndex_ == nullptr);
+        REQUIRE(gridObjects[2].gridId_ == Math::LooseGrid<Object>::INVALID_ID);
+        const Math::Sphere sphere(objects[2].box.Center(), 0.1f);
+        ea::vector<Object*> result;
+        octree.GetObjects(result, sphere, nullptr);
+        REQUIRE(ea::find(result.begin(), result.end(), &objects[2]) == result.end());
+        grid.GetObjects(result, sphere, nullptr);
+        REQUIRE(ea::find(result.begin(), result.end(), &gridObjects[2]) == result.end());
+    }
+}
+
+TEST_CASE("SpatialIndex destroyed", "[spatialindex]")
+{
+    Object o1;
+    o1.box = MakeBox(0.0f, 0.0f, 1.0f);
+    Object o2 = o1;
+    {
+        Math::OctreeIndex<Object> octree;
+        octree.InsertObject(&o1);
+        Math::GridIndex<Object> grid(Math::BoundingBox(-10.0f, 10.0f), 5.0f);
+        grid.InsertObject(&o2);
+    }
+    // Objects must not point to a deleted index
+    REQUIRE(o1.spatialIndex_ == nullptr);
+    REQUIRE(o1.octant_ == nullptr);
+    REQUIRE(o2.spatialIndex_ == nullptr);
+    REQUIRE(o2.gridId_ == Math::LooseGrid<Object>::INVALID_ID);
+}
+
+// Not run by default, run with: abtests [benchmark]
+TEST_CASE("SpatialIndex benchmark", "[.][benchmark]")
+{
+    using Clock = std::chrono::steady_clock;
+    const auto elapsed = [](Clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    };
+    std::mt19937 rng(42);
+    for (size_t count : { 100u, 500u, 1000u, 5000u })
+    {
+        const float size = 10.0f * std::sqrt(static_cast<float>(count));
+        const Math::BoundingBox bounds(-size, size);
+        std::uniform_real_distribution<float> pos(-size, size);
+        ea::vector<Object> objects(count);
+        for (auto& o : objects)
+            o.box = MakeBox(pos(rng), pos(rng), 0.5f);
+        ea::vector<Object> gridObjects = objects;
+
+        Math::OctreeIndex<Object> octree;
+        octree.SetSize(bounds);
+        Math::GridIndex<Object> grid(bounds, 20.0f);
+        for (size_t i = 0; i < count; ++i)
+        {
+            octree.InsertObject(&objects[i]);
+            grid.InsertObject(&gridObjects[i]);
+        }
+        octree.Update();
+
+        // One range query per object, like Game::UpdateRanges()
+        const auto query = [](Math::SpatialIndex<Object>& index, ea::vector<Object>& all)
+        {
+            size_t found = 0;
+            ea::vector<Object*> result;
+            for (auto& o : all)
+            {
+                index.GetObjects(result, Math::Sphere(o.box.Center(), 30.0f), &o);
+                found += result.size();
+            }
+            return found;
+        };
+        // Every object moves each tick
+        const auto move = [](Math::SpatialIndex<Object>& index, ea::vector<Object>& all)
+        {
+            for (auto& o : all)
+            {
+                o.box.min_.x_ += 0.1f;
+                o.box.max_.x_ += 0.1f;
+                index.AddObjectUpdate(&o);
+            }
+            index.Update();
+        };
+
+        auto start = Clock::now();
+        const size_t octreeFound = query(octree, objects);
+        const auto octreeTime = elapsed(start);
+        start = Clock::now();
+        move(octree, objects);
+        const auto octreeMoveTime = elapsed(start);
+
+        start = Clock::now();
+        const size_t gridFound = query(grid, gridObjects);
+        const auto gridTime = elapsed(start);
+        start = Clock::now();
+        move(grid, gridObjects);
+        const auto gridMoveTime = elapsed(start);
+
+        size_t bruteFound = 0;
+        start = Clock::now();
+        for (const auto& o : objects)
+            bruteFound += BruteForce(objects, Math::Sphere(o.box.Center(), 30.0f), &o).size();
+        const auto bruteTime = elapsed(start);
+
+        REQUIRE(gridFound == octreeFound);
+        WARN(count << " objects: query grid " << gridTime << "us, octree " << octreeTime <<
+            "us, brute force " << bruteTime << "us; move grid " << gridMoveTime << "us, octree " << octreeMoveTime << "us");
+    }
+}
@@ -0,0 +1,170 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <cstring>
+#include <abscommon/DataClient.h>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Answers each request with an Ok status. It closes the connection without a response
+// to the request with the ID dropId.
+class FakeDataServer
+{
+private:
+    asio::io_service ioService_;
+    asio::ip::tcp::acceptor acceptor_;
+    std::thread thread_;
+    std::atomic<bool> running_{ true };
+    std::atomic<uint32_t> dropId_{ 0 };
+    std::atomic<int> connections_{ 0 };
+    void Serve(asio::ip::tcp::socket& socket)
+    {
+        uint8_t header[IO::REQUEST_HEADER_SIZE];
+        std::vector<uint8_t> key;
+        asio::error_code ec;
+        for (;;)
+        {
+            asio::read(socket, asio::buffer(header), ec);
+            if (ec)
+                return;
+            const uint32_t id = header[1] | (header[2] << 8) | (header[3] << 16) | (header[4] << 24);
+            key.resize(static_cast<size_t>(header[5] | (header[6] << 8)));
+            asio::read(socket, asio::buffer(key), ec);
+            if (ec)
+                return;
+            if (id == dropId_)
+                return;
+            const uint8_t response[IO::RESPONSE_HEADER_SIZE + 1] = {
+                static_cast<uint8_t>(IO::OpCodes::Status),
+                header[1], header[2], header[3], header[4],
+                1, 0, 0, 0,
+                static_cast<uint8_t>(IO::ErrorCodes::Ok)
+            };
+            asio::write(socket, asio::buffer(response), ec);
+            if (ec)
+                return;
+        }
+    }
+public:
+    FakeDataServer() :
+        acceptor_(ioService_, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0))
+    {
+        thread_ = std::thread([this]()
+        {
+            while (running_)
+            {
+                asio::ip::tcp::socket socket(ioService_);
+                asio::error_code ec;
+                acceptor_.accept(socket, ec);
+                if (ec || !running_)
+                    return;
+                ++connections_;
+                Serve(socket);
+            }
+        });
+    }
+    ~FakeDataServer()
+    {
+        running_ = false;
+        asio::error_code ec;
+        // Wake up accept()
+        asio::ip::tcp::socket socket(ioService_);
+        socket.connect(acceptor_.local_endpoint(), ec);
+        thread_.join();
+    }
+    uint16_t GetPort() const { return acceptor_.local_endpoint().port(); }
+    void SetDropId(uint32_t id) { dropId_ = id; }
+    int GetConnections() const { return connections_; }
+};
+
+std::future<bool> Lock(IO::DataClient& client, const IO::DataKey& key)
+{
+    auto promise = std::make_shared<std::promise<bool>>();
+    client.Request(IO::OpCodes::Lock, key, nullptr, [promise](bool success, IO::DataBuff&)
+    {
+        promise->set_value(success);
+    });
+    return promise->get_future();
+}
+
+}
+
+TEST_CASE("DataClient concurrent requests")
+{
+    FakeDataServer server;
+    IO::DataClient client;
+    client.Connect("127.0.0.1", server.GetPort());
+    REQUIRE(client.IsConnected());
+
+    constexpr int THREADS = 4;
+    constexpr int REQUESTS = 500;
+    const IO::DataKey key("test", uuids::uuid_system_generator{}());
+    std::atomic<int> succeeded{ 0 };
+    std::atomic<int> done{ 0 };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([&]()
+        {
+            for (int i = 0; i < REQUESTS; ++i)
+            {
+                client.Request(IO::OpCodes::Lock, key, nullptr, [&](bool success, IO::DataBuff&)
+                {
+                    if (success)
+                        ++succeeded;
+                    ++done;
+                });
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    while (done < THREADS * REQUESTS)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    REQUIRE(succeeded == THREADS * REQUESTS);
+    REQUIRE(client.GetPendingCount() == 0);
+    REQUIRE(server.GetConnections() == 1);
+}
+
+TEST_CASE("DataClient reconnect")
+{
+    FakeDataServer server;
+    IO::DataClient client;
+    client.Connect("127.0.0.1", server.GetPort());
+    const IO::DataKey key("test", uuids::uuid_system_generator{}());
+    REQUIRE(Lock(client, key).get());
+
+    // The server closes the connection, the request sent on it fails
+    server.SetDropId(2);
+    REQUIRE(!Lock(client, key).get());
+    REQUIRE(client.GetPendingCount() == 0);
+
+    // The next request connects again
+    REQUIRE(Lock(client, key).get());
+    REQUIRE(client.IsConnected());
+    REQUIRE(server.GetConnections() == 2);
+}
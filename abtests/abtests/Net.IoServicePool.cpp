@@ -0,0 +1,72 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <abscommon/IoServicePool.h>
+#include <future>
+#include <thread>
+
+TEST_CASE("IoServicePool", "[iopool]")
+{
+    Net::IoServicePool pool;
+    pool.Start(2);
+    REQUIRE(pool.GetCount() == 2);
+
+    SECTION("Acquire")
+    {
+        // Sockets are spread over the threads
+        REQUIRE(pool.Acquire() == 0);
+        REQUIRE(pool.Acquire() == 1);
+        REQUIRE(pool.Acquire() == 0);
+        pool.Release(1);
+        REQUIRE(pool.Acquire() == 1);
+        REQUIRE(pool.GetStats(0).sockets == 2);
+        REQUIRE(pool.GetStats(1).sockets == 1);
+    }
+    SECTION("Run on thread")
+    {
+        std::promise<std::thread::id> promise;
+        asio::post(pool.GetService(1), [&promise]()
+        {
+            Net::IoServicePool::BusyScope busy;
+            {
+                // Nested scopes are counted once
+                Net::IoServicePool::BusyScope nested;
+            }
+            promise.set_value(std::this_thread::get_id());
+        });
+        auto future = promise.get_future();
+        REQUIRE(future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+        REQUIRE(future.get() != std::this_thread::get_id());
+        pool.Stop();
+        REQUIRE(pool.GetStats(0).handlers == 0);
+        REQUIRE(pool.GetStats(1).handlers == 1);
+    }
+    SECTION("Not an I/O thread")
+    {
+        {
+            Net::IoServicePool::BusyScope busy;
+        }
+        REQUIRE(pool.GetStats(0).handlers == 0);
+        REQUIRE(pool.GetStats(1).handlers == 0);
+    }
+}
@@ -0,0 +1,85 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <abscommon/OutputMessage.h>
+#include <lz4.h>
+#include <vector>
+
+TEST_CASE("OutputMessage Compress", "[outputmessage]")
+{
+    SECTION("Round trip")
+    {
+        Net::OutputMessage msg;
+        for (uint32_t i = 0; i < 400; ++i)
+            msg.Add<uint32_t>(i % 16);
+        const size_t size = msg.GetSize();
+        std::vector<uint8_t> original(msg.GetOutputBuffer(), msg.GetOutputBuffer() + size);
+
+        REQUIRE(msg.Compress());
+        REQUIRE(msg.IsCompressed());
+        REQUIRE(msg.GetSize() < size);
+        // Already compressed
+        REQUIRE(!msg.Compress());
+
+        REQUIRE(msg.WriteMessageLength());
+        const uint8_t* data = msg.GetOutputBuffer();
+        uint16_t header;
+        memcpy(&header, data, sizeof(header));
+        REQUIRE((header & AB::MESSAGE_COMPRESSED_FLAG) != 0);
+        REQUIRE((header & ~AB::MESSAGE_COMPRESSED_FLAG) == msg.GetSize() - sizeof(uint16_t));
+
+        uint16_t compressedSize;
+        memcpy(&compressedSize, data + 2, sizeof(compressedSize));
+        std::vector<uint8_t> decompressed(Net::NetworkMessage::NETWORKMESSAGE_BUFFER_SIZE);
+        const int result = LZ4_decompress_safe(reinterpret_cast<const char*>(data + 4),
+            reinterpret_cast<char*>(decompressed.data()), compressedSize, static_cast<int>(decompressed.size()));
+        REQUIRE(result == static_cast<int>(size));
+        decompressed.resize(static_cast<size_t>(result));
+        REQUIRE(decompressed == original);
+    }
+    SECTION("Small message")
+    {
+        Net::OutputMessage msg;
+        for (uint32_t i = 0; i < 16; ++i)
+            msg.Add<uint32_t>(0);
+        REQUIRE(!msg.Compress());
+        REQUIRE(!msg.IsCompressed());
+        REQUIRE(msg.GetSize() == 64);
+    }
+    SECTION("Incompressible")
+    {
+        Net::OutputMessage msg;
+        uint32_t x = 0x12345678;
+        for (uint32_t i = 0; i < 400; ++i)
+        {
+            // xorshift
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            msg.Add<uint32_t>(x);
+        }
+        REQUIRE(!msg.Compress());
+        REQUIRE(!msg.IsCompressed());
+        REQUIRE(msg.GetSize() == 1600);
+    }
+}
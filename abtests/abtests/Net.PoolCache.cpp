@@ -0,0 +1,77 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <abscommon/PoolCache.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Item
+{
+    uint8_t data[256];
+};
+
+using ItemPool = sa::PoolAllocator<Item, sizeof(Item)>;
+ItemPool gPool(sizeof(Item) * 1024);
+
+ItemPool* GetPool()
+{
+    return &gPool;
+}
+
+using ItemCache = Net::PoolCache<Item, ItemPool, &GetPool>;
+
+}
+
+TEST_CASE("PoolCache", "[poolcache]")
+{
+    SECTION("Allocate")
+    {
+        std::vector<Item*> items;
+        for (int i = 0; i < 100; ++i)
+            items.push_back(ItemCache::Allocate());
+        for (auto* item : items)
+            REQUIRE(item);
+        REQUIRE(ItemCache::GetInfo().current == 100);
+        for (auto* item : items)
+            ItemCache::Deallocate(item);
+        REQUIRE(ItemCache::GetInfo().current == 0);
+        // The pool gets them in batches
+        REQUIRE(gPool.GetCurrentAllocations() < 100);
+    }
+    SECTION("Free on other thread")
+    {
+        std::vector<Item*> items;
+        for (int i = 0; i < 200; ++i)
+            items.push_back(ItemCache::Allocate());
+        std::thread thread([&items]()
+        {
+            for (auto* item : items)
+                ItemCache::Deallocate(item);
+        });
+        thread.join();
+        // The cache of the other thread was returned when it exited
+        REQUIRE(ItemCache::GetInfo().current == 0);
+    }
+}
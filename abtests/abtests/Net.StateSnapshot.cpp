@@ -0,0 +1,238 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <StateSnapshot.h>
+#include <AB/Packets/Packet.h>
+#include <AB/ProtocolCodes.h>
+#include <cmath>
+#include <map>
+
+namespace {
+
+// Decodes snapshots like the client
+struct Client
+{
+    std::map<uint32_t, std::array<int32_t, 3>> positions;
+    std::map<uint32_t, int32_t> rotations;
+    unsigned fullUpdates = 0;
+    unsigned deltas = 0;
+    unsigned rotationUpdates = 0;
+
+    void Read(Net::NetworkMessage& message)
+    {
+        using namespace AB::GameProtocol;
+        using namespace AB::Packets::Server;
+        fullUpdates = 0;
+        deltas = 0;
+        rotationUpdates = 0;
+        message.SetReadPos(Net::NetworkMessage::INITIAL_BUFFER_POSITION);
+        while (message.GetReadPos() < Net::NetworkMessage::INITIAL_BUFFER_POSITION + message.GetSize())
+        {
+            const auto type = static_cast<ServerPacketType>(message.GetByte());
+            switch (type)
+            {
+            case ServerPacketType::ObjectPositionUpdate:
+            {
+                auto packet = AB::Packets::Get<ObjectPositionUpdate>(message);
+                for (size_t i = 0; i < 3; ++i)
+                    positions[packet.id][i] = static_cast<int32_t>(std::lround(packet.pos[i] * POSITION_DELTA_PRECISION));
+                ++fullUpdates;
+                break;
+            }
+            case ServerPacketType::ObjectPositionDelta:
+            {
+                auto packet = AB::Packets::Get<ObjectPositionDelta>(message);
+                REQUIRE(positions.find(packet.id) != positions.end());
+                for (size_t i = 0; i < 3; ++i)
+                    positions[packet.id][i] += packet.delta[i];
+                ++deltas;
+                break;
+            }
+            case ServerPacketType::ObjectRotationUpdate:
+            {
+                auto packet = AB::Packets::Get<ObjectRotationUpdate>(message);
+                rotations[packet.id] = static_cast<int32_t>(std::lround(packet.yRot * Game::StateSnapshot::ROTATION_PRECISION));
+                ++rotationUpdates;
+                break;
+            }
+            default:
+                FAIL("Unexpected packet " << static_cast<int>(type));
+            }
+        }
+    }
+    bool Knows(uint32_t id, const Game::StateSnapshot::State& state) const
+    {
+        const auto pos = positions.find(id);
+        const auto rot = rotations.find(id);
+        if (pos == positions.end() || rot == rotations.end())
+            return false;
+        return pos->second[0] == state.pos[0] && pos->second[1] == state.pos[1] &&
+            pos->second[2] == state.pos[2] && rot->second == state.rot;
+    }
+};
+
+struct World
+{
+    // Objects without a State don't move
+    std::map<uint32_t, Game::StateSnapshot::State> states;
+    std::map<uint32_t, bool> hasState;
+    ea::vector<uint32_t> changed;
+    unsigned lookups = 0;
+
+    void Set(uint32_t id, float x, float y, float z, float rot)
+    {
+        const float pos[3] = { x, y, z };
+        hasState[id] = true;
+        if (Game::StateSnapshot::Update(states[id], pos, rot, false))
+        {
+            changed.push_back(id);
+            ea::sort(changed.begin(), changed.end());
+        }
+    }
+    void Write(Game::StateSnapshot& snapshot, const ea::vector<uint32_t>& inRange, Net::NetworkMessage& message)
+    {
+        message.Reset();
+        lookups = 0;
+        snapshot.Write(inRange, changed, [this](uint32_t id) -> const Game::StateSnapshot::State*
+        {
+            ++lookups;
+            if (!hasState[id])
+                return nullptr;
+            return &states[id];
+        }, message);
+        changed.clear();
+    }
+};
+
+}
+
+TEST_CASE("StateSnapshot delta")
+{
+    World world;
+    Client client;
+    Game::StateSnapshot snapshot;
+    Net::NetworkMessage message;
+
+    world.Set(1, 10.0f, 0.0f, 10.0f, 0.5f);
+    world.Set(2, -20.0f, 1.0f, 5.0f, 1.0f);
+    // A non moving object, e.g. an item drop
+    world.hasState[3] = false;
+    const ea::vector<uint32_t> inRange = { 1, 2, 3 };
+
+    // Entering the range, full updates
+    world.Write(snapshot, inRange, message);
+    client.Read(message);
+    REQUIRE(client.fullUpdates == 2);
+    REQUIRE(client.deltas == 0);
+    REQUIRE(client.rotationUpdates == 2);
+    REQUIRE(world.lookups == 3);
+    REQUIRE(client.Knows(1, world.states[1]));
+    REQUIRE(client.Knows(2, world.states[2]));
+
+    // Nothing changed, nothing is written or looked up
+    world.Write(snapshot, inRange, message);
+    REQUIRE(message.GetSize() == 0);
+    REQUIRE(world.lookups == 0);
+
+    // Below the precision
+    world.Set(1, 10.001f, 0.0f, 10.0f, 0.5f);
+    world.Write(snapshot, inRange, message);
+    REQUIRE(message.GetSize() == 0);
+
+    // Moving writes a delta
+    world.Set(1, 11.5f, 0.25f, 9.0f, 0.5f);
+    world.Write(snapshot, inRange, message);
+    client.Read(message);
+    REQUIRE(client.fullUpdates == 0);
+    REQUIRE(client.deltas == 1);
+    REQUIRE(client.rotationUpdates == 0);
+    REQUIRE(world.lookups == 1);
+    REQUIRE(client.Knows(1, world.states[1]));
+
+    // Turning only writes the rotation
+    world.Set(2, -20.0f, 1.0f, 5.0f, 1.5f);
+    world.Write(snapshot, inRange, message);
+    client.Read(message);
+    REQUIRE(client.fullUpdates == 0);
+    REQUIRE(client.deltas == 0);
+    REQUIRE(client.rotationUpdates == 1);
+    REQUIRE(client.Knows(2, world.states[2]));
+
+    // Too far for a delta
+    world.Set(1, 500.0f, 0.25f, 9.0f, 0.5f);
+    world.Write(snapshot, inRange, message);
+    client.Read(message);
+    REQUIRE(client.fullUpdates == 1);
+    REQUIRE(client.deltas == 0);
+    REQUIRE(client.Knows(1, world.states[1]));
+
+    // Many small moves add up
+    for (int i = 0; i < 100; ++i)
+    {
+        world.Set(1, 500.0f - static_cast<float>(i) * 0.013f, 0.25f, 9.0f + static_cast<float>(i) * 0.007f, 0.5f);
+        world.Write(snapshot, inRange, message);
+        client.Read(message);
+        REQUIRE(client.Knows(1, world.states[1]));
+    }
+}
+
+TEST_CASE("StateSnapshot range")
+{
+    World world;
+    Client client;
+    Game::StateSnapshot snapshot;
+    Net::NetworkMessage message;
+
+    world.Set(1, 10.0f, 0.0f, 10.0f, 0.5f);
+    world.Set(2, 20.0f, 0.0f, 20.0f, 0.5f);
+    world.Write(snapshot, { 1, 2 }, message);
+    client.Read(message);
+    REQUIRE(client.fullUpdates == 2);
+
+    // 2 leaves the range and moves
+    world.Set(2, 25.0f, 0.0f, 20.0f, 0.5f);
+    world.Write(snapshot, { 1 }, message);
+    REQUIRE(message.GetSize() == 0);
+
+    // It is sent in full when it comes back, even without a change in this tick
+    world.Write(snapshot, { 1, 2 }, message);
+    client.Read(message);
+    REQUIRE(client.fullUpdates == 1);
+    REQUIRE(client.rotationUpdates == 1);
+    REQUIRE(client.Knows(2, world.states[2]));
+
+    // A new object entering between two objects
+    world.Set(3, 30.0f, 0.0f, 30.0f, 0.5f);
+    world.Set(1, 11.0f, 0.0f, 10.0f, 0.5f);
+    world.Write(snapshot, { 1, 2, 3 }, message);
+    client.Read(message);
+    REQUIRE(client.fullUpdates == 1);
+    REQUIRE(client.deltas == 1);
+    REQUIRE(client.Knows(1, world.states[1]));
+    REQUIRE(client.Knows(3, world.states[3]));
+
+    snapshot.Clear();
+    world.Write(snapshot, { 1, 2, 3 }, message);
+    client.Read(message);
+    REQUIRE(client.fullUpdates == 3);
+}
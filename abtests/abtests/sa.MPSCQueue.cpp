@@ -0,0 +1,93 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <catch.hpp>
+
+#include <sa/MPSCQueue.h>
+#include <thread>
+#include <vector>
+
+TEST_CASE("MPSCQueue Basic", "[mpscqueue]")
+{
+    sa::MPSCQueue<int, 4> queue;
+    REQUIRE(queue.IsEmpty());
+    REQUIRE(queue.Enqueue(1));
+    REQUIRE(queue.Enqueue(2));
+    REQUIRE(queue.Enqueue(3));
+    REQUIRE(queue.Enqueue(4));
+    // Full
+    REQUIRE(!queue.Enqueue(5));
+    REQUIRE(queue.Size() == 4);
+
+    int value = 0;
+    REQUIRE(queue.Dequeue(value));
+    REQUIRE(value == 1);
+    REQUIRE(queue.Enqueue(5));
+    for (int i = 2; i <= 5; ++i)
+    {
+        REQUIRE(queue.Dequeue(value));
+        REQUIRE(value == i);
+    }
+    REQUIRE(!queue.Dequeue(value));
+    REQUIRE(queue.IsEmpty());
+}
+
+TEST_CASE("MPSCQueue Producers", "[mpscqueue]")
+{
+    static constexpr int PRODUCERS = 4;
+    static constexpr int COUNT = 10000;
+    sa::MPSCQueue<int, 1024> queue;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < PRODUCERS; ++p)
+    {
+        threads.emplace_back([&queue, p]()
+        {
+            for (int i = 0; i < COUNT; ++i)
+            {
+                while (!queue.Enqueue(p * COUNT + i))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    // The values of each producer must arrive in order
+    std::vector<int> last(PRODUCERS, -1);
+    int received = 0;
+    bool ordered = true;
+    while (received < PRODUCERS * COUNT)
+    {
+        int value;
+        if (!queue.Dequeue(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        const int p = value / COUNT;
+        if (value % COUNT != last[p] + 1)
+            ordered = false;
+        last[p] = value % COUNT;
+        ++received;
+    }
+    for (auto& t : threads)
+        t.join();
+    REQUIRE(ordered);
+    REQUIRE(queue.IsEmpty());
+}
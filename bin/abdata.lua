@@ -22,7 +22,12 @@ allowed_ips = "127.0.0.1;192.168.1.51"
 max_size = 1024 * 1024 * 1024
 -- Flush cache every minute
 flush_interval = 1000 * 60
+-- Max records written in one transaction
+flush_batch_size = 100
 -- Clean cache every 10min
 clean_interval = 1000 * 60 * 10
+-- Threads loading records from the DB on a cache miss, each has its own DB connection.
+-- 0 loads them in the dispatcher thread.
+db_workers = 4
 
 require("config/db")
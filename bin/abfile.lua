@@ -10,7 +10,7 @@ file_ip = ""         -- Listen on all
 file_host = ""       -- emtpy use same host as for login
 file_port = 8081
 
--- Used to calculate the load Byte/sec (100Mbit)
+-- Used to calculate the load and to limit file downloads, Byte/sec (100Mbit)
 max_throughput = (100 * 1024 * 1024)
 
 -- Create self signing Key/Cert with something like this:
@@ -9,6 +9,13 @@ server_name = "ablb"
 lb_host = "0.0.0.0"
 lb_port = 2740
 lb_type = 4      -- Load balancer for Login Server (= type 4)
+-- How to select the server for a new connection:
+--   least_connections: Server with the fewest open connections through this load balancer
+--   load: Server with the lowest reported load, requires a data server
+--   random: Any server
+lb_strategy = "least_connections"
+-- Log connections and throughput of all servers every n seconds, 0 to disable
+stats_interval = 60
 -- If data_port is 0 a server list file must be given
 server_list = ""
 
@@ -11,3 +11,9 @@ login_retrytimeout = 5000
 
 -- DH keys
 server_keys = "abserver.dh"
+
+-- Worker threads hashing passwords, 0 = one per core
+hash_threads = 0
+-- Maximum number of logins/account creations waiting for a hash thread. When
+-- the queue is full, requests are rejected.
+hash_queue_size = 256
@@ -16,3 +16,20 @@ ai_server_interval = 100
 
 -- DOS prevention
 max_packets_per_second = 60
+
+-- Number of threads executing games. Each game runs on one of them. 1 runs all
+-- games on the Dispatcher thread, 0 uses one thread per CPU core.
+-- NOTE: Currently only 1 is supported, other values are changed to 1.
+game_threads = 1
+-- Number of threads reading, decrypting and writing client connections. Each connection
+-- is bound to one of them. 0 handles all connections on the main thread.
+io_threads = 0
+-- LZ4 compress large messages to clients which support it
+compress_messages = true
+-- Cell size of the grid used for range queries on game maps. 0 uses the Octree.
+grid_cell_size = 0
+-- Send players only position and rotation changes of objects in their interest range.
+state_snapshots = false
+-- Keep compiled scripts next to the source (*.luac) and load them instead of compiling
+-- again, as long as the source did not change.
+script_bytecode_cache = false
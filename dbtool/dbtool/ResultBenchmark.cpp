@@ -0,0 +1,156 @@
+/**
+ * Copyright 2020 Stefan Ascher
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ResultBenchmark.h"
+#include <algorithm>
+#include <AB/Entities/MailList.h>
+#include <abscommon/UuidUtils.h>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <sa/table.h>
+
+namespace {
+
+constexpr int PASSES = 5;
+
+template<typename Callback>
+int64_t Measure(Callback&& callback)
+{
+    // Take the best of some passes
+    int64_t best = std::numeric_limits<int64_t>::max();
+    for (int i = 0; i < PASSES; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        callback();
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min<int64_t>(best, std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+    }
+    return best;
+}
+
+bool CreateRows(DB::Database& db, size_t rows)
+{
+    if (!db.ExecuteQuery("CREATE TEMPORARY TABLE bench_rows ("
+        "uuid CHAR(36) NOT NULL, from_name VARCHAR(64) NOT NULL, subject VARCHAR(64) NOT NULL, "
+        "created BIGINT NOT NULL, is_read INTEGER NOT NULL)"))
+        return false;
+
+    static constexpr DB::DBStatement SQL("INSERT INTO bench_rows (uuid, from_name, subject, created, is_read) "
+        "VALUES (${uuid}, ${from_name}, ${subject}, ${created}, ${is_read})");
+    DB::DBTransaction transaction(&db);
+    if (!transaction.Begin())
+        return false;
+    for (size_t i = 0; i < rows; ++i)
+    {
+        DB::DBParams params;
+        params.Add(Utils::Uuid::New())
+            .Add("Sender " + std::to_string(i % 100))
+            .Add("Subject of mail " + std::to_string(i))
+            .Add(static_cast<int64_t>(1600000000000 + i))
+            .Add(i % 2 == 0);
+        if (!db.ExecutePrepared(SQL, params))
+            return false;
+    }
+    return transaction.Commit();
+}
+
+}
+
+bool BenchmarkResults(DB::Database& db, size_t rows)
+{
+    std::cout << "Creating " << rows << " rows" << std::endl;
+    if (!CreateRows(db, rows))
+    {
+        std::cerr << "Failed to create the benchmark table" << std::endl;
+        return false;
+    }
+
+    static constexpr const char* SQL = "SELECT uuid, from_name, subject, created, is_read FROM bench_rows";
+    std::vector<AB::Entities::MailHeader> mails;
+    mails.reserve(rows);
+
+    const int64_t byName = Measure([&]()
+    {
+        mails.clear();
+        for (std::shared_ptr<DB::DBResult> result = db.StoreQuery(SQL); result; result = result->Next())
+        {
+            mails.push_back({
+                result->GetString("uuid"),
+                result->GetString("from_name"),
+                result->GetString("subject"),
+                result->GetLong("created"),
+                result->GetInt("is_read") != 0
+            });
+        }
+    });
+    const size_t byNameCount = mails.size();
+
+    static constexpr DB::DBColumns COLUMNS("uuid", "from_name", "subject", "created", "is_read");
+    const int64_t byIndex = Measure([&]()
+    {
+        mails.clear();
+        std::shared_ptr<DB::DBResult> result = db.StoreQuery(SQL);
+        if (!result)
+            return;
+        const auto columns = result->Resolve(COLUMNS);
+        for (; result; result = result->Next())
+        {
+            mails.push_back({
+                result->GetString(columns[0]),
+                result->GetString(columns[1]),
+                result->GetString(columns[2]),
+                result->GetLong(columns[3]),
+                result->GetInt(columns[4]) != 0
+            });
+        }
+    });
+    const size_t byIndexCount = mails.size();
+
+    static constexpr DB::DBRowMapping MAPPING(
+        DB::DBField("uuid", &AB::Entities::MailHeader::uuid),
+        DB::DBField("from_name", &AB::Entities::MailHeader::fromName),
+        DB::DBField("subject", &AB::Entities::MailHeader::subject),
+        DB::DBField("created", &AB::Entities::MailHeader::created),
+        DB::DBField("is_read", &AB::Entities::MailHeader::isRead));
+    const int64_t mapping = Measure([&]()
+    {
+        mails.clear();
+        MAPPING.Load(db.StoreQuery(SQL), mails);
+    });
+    const size_t mappingCount = mails.size();
+
+    db.ExecuteQuery("DROP TABLE bench_rows");
+
+    sa::tab::table table;
+    table.table_sep_ = '=';
+    table << sa::tab::head << "Method" << sa::tab::endc << sa::tab::ralign << "Rows" <<
+             sa::tab::endc << sa::tab::ralign << "Time (us)" << sa::tab::endr;
+    table << "Column name" << sa::tab::endc << sa::tab::ralign << byNameCount <<
+             sa::tab::endc << sa::tab::ralign << byName << sa::tab::endr;
+    table << "Column index" << sa::tab::endc << sa::tab::ralign << byIndexCount <<
+             sa::tab::endc << sa::tab::ralign << byIndex << sa::tab::endr;
+    table << "Row mapping" << sa::tab::endc << sa::tab::ralign << mappingCount <<
+             sa::tab::endc << sa::tab::ralign << mapping << sa::tab::endr;
+    std::cout << table;
+
+    return byNameCount == rows && byIndexCount == rows && mappingCount == rows;
+}
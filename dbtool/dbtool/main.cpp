@@ -44,6 +44,7 @@ PRAGMA_WARNING_POP
 #include <sa/table.h>
 #include <streambuf>
 #include "LuaSkill.h"
+#include "ResultBenchmark.h"
 #include <sa/TemplateParser.h>
 #include <sa/Assert.h>
 #include <AB/Entities/Account.h>
@@ -81,6 +82,7 @@ static void ShowHelp(const sa::arg_parser::cli& _cli)
     table << "    genacckey" << sa::tab::endc << "Generate a new account key" << sa::tab::endr;
     table << "    updateskills" << sa::tab::endc << "Update skills stats in DB" << sa::tab::endr;
     table << "    makegod" << sa::tab::endc << "Make an account god, expects a username with -user option" << sa::tab::endr;
+    table << "    benchresults" << sa::tab::endc << "Benchmark loading rows from a result set, number of rows with -rows option" << sa::tab::endr;
     std::cout << table;
     std::cout << std::endl;
     std::cout << "EXAMPLES" << std::endl;
@@ -126,6 +128,8 @@ static void InitCli(sa::arg_parser::cli& cli)
         false, true, sa::arg_parser::option_type::string });
     cli.push_back({ "user", { "-user", "--user-name" }, "User name",
         false, true, sa::arg_parser::option_type::string });
+    cli.push_back({ "rows", { "-rows", "--row-count" }, "Number of rows for benchresults (default 10000)",
+        false, true, sa::arg_parser::option_type::integer });
 }
 
 static void GetFiles(const std::string& dir, std::map<unsigned, std::string>& result)
@@ -511,6 +515,7 @@ enum class Action
     GenAccKey,
     UpdateSkills,
     MakeGod,
+    BenchResults,
 };
 
 int main(int argc, char** argv)
@@ -562,6 +567,8 @@ int main(int argc, char** argv)
         action = Action::UpdateSkills;
     else if (sActval.compare("makegod") == 0)
         action = Action::MakeGod;
+    else if (sActval.compare("benchresults") == 0)
+        action = Action::BenchResults;
     else
     {
         std::cerr << "Unknown action `" << sActval << "`" << std::endl;
@@ -663,6 +670,23 @@ int main(int argc, char** argv)
         }
         break;
     }
+    case Action::BenchResults:
+    {
+        if (sReadOnly)
+        {
+            std::cerr << "benchresults writes to a temporary table and does not work in READ-ONLY mode" << std::endl;
+            return EXIT_FAILURE;
+        }
+        const int rows = sa::arg_parser::get_value<int>(parsedArgs, "rows", 10000);
+        if (rows <= 0)
+        {
+            std::cerr << "Invalid number of rows " << rows << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (!BenchmarkResults(*db, static_cast<size_t>(rows)))
+            return EXIT_FAILURE;
+        break;
+    }
     default:
         ASSERT_FALSE();
     }
@@ -25,6 +25,7 @@
 #include <abcrypto.hpp>
 #include <AB/ProtocolCodes.h>
 #include <sa/Assert.h>
+#include <lz4.h>
 
 namespace Client {
 
@@ -41,6 +42,33 @@ bool InputMessage::ReadChecksum()
     return receivedCheck == checksum;
 }
 
+bool InputMessage::Decompress()
+{
+    // Compressed body: compressed size (2 bytes), LZ4 data, padding
+    if (!CanRead(sizeof(uint16_t)))
+        return false;
+    const uint16_t compressedSize = Get<uint16_t>();
+    if (!CanRead(compressedSize))
+        return false;
+
+    uint8_t decompressed[MaxBufferSize];
+    const size_t start = pos_ - sizeof(uint16_t);
+    const int size = LZ4_decompress_safe(reinterpret_cast<const char*>(buffer_ + pos_),
+        reinterpret_cast<char*>(decompressed), compressedSize, static_cast<int>(MaxBufferSize - start));
+    if (size < 0)
+        return false;
+
+#ifdef _MSC_VER
+    memcpy_s(buffer_ + start, MaxBufferSize - start, decompressed, static_cast<size_t>(size));
+#else
+    memcpy(buffer_ + start, decompressed, static_cast<size_t>(size));
+#endif
+    pos_ = start;
+    size_ = (start - headerPos_) + static_cast<size_t>(size);
+    compressed_ = false;
+    return true;
+}
+
 std::string InputMessage::GetString()
 {
     uint16_t len = Get<uint16_t>();
@@ -24,6 +24,7 @@
 #include <string>
 #include <stdint.h>
 #include <sa/Assert.h>
+#include <AB/ProtocolCodes.h>
 
 namespace Client {
 
@@ -42,6 +43,7 @@ private:
     size_t size_{ 0 };
     size_t pos_{ MaxHeaderSize };
     size_t headerPos_{ MaxHeaderSize };
+    bool compressed_{ false };
 
     void CheckWrite(size_t size);
     void CheckRead(size_t size);
@@ -54,6 +56,7 @@ protected:
         size_ = 0;
         pos_ = MaxHeaderSize;
         headerPos_ = MaxHeaderSize;
+        compressed_ = false;
     }
     void SetHeaderSize(size_t size)
     {
@@ -65,10 +68,18 @@ protected:
     void SetMessageSize(uint16_t size) { size_ = size; }
     std::string GetString();
     std::string GetStringEncrypted();
+    /// Replace the compressed body with the decompressed data
+    bool Decompress();
 public:
     InputMessage();
 
-    size_t ReadSize() { return Get<uint16_t>(); }
+    size_t ReadSize()
+    {
+        const uint16_t size = Get<uint16_t>();
+        compressed_ = (size & AB::MESSAGE_COMPRESSED_FLAG) != 0;
+        return size & ~AB::MESSAGE_COMPRESSED_FLAG;
+    }
+    bool IsCompressed() const { return compressed_; }
     bool ReadChecksum();
 
     size_t GetUnreadSize() const { return size_ - (pos_ - headerPos_); }
@@ -121,6 +121,11 @@ void Protocol::InternalRecvData(uint8_t* buffer, size_t size)
         if (!XTEADecrypt(*inputMessage_))
             return;
     }
+    if (inputMessage_->IsCompressed())
+    {
+        if (!inputMessage_->Decompress())
+            return;
+    }
 
     OnReceive(*inputMessage_);
 }
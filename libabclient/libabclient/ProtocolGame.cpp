@@ -25,6 +25,7 @@
 #include <set>
 #include <AB/Packets/ClientPackets.h>
 #include <sa/time.h>
+#include <cmath>
 
 namespace Client {
 
@@ -54,8 +55,20 @@ ProtocolGame::ProtocolGame(Receiver& receiver, Crypto::DHKeys& keys, asio::io_se
     AddHandler<AB::Packets::Server::ChestItemDelete, ServerPacketType::ChestItemDelete>();
     AddHandler<AB::Packets::Server::ObjectSpawnExisting, ServerPacketType::ObjectSpawnExisting>();
     AddHandler<AB::Packets::Server::ObjectSpawn, ServerPacketType::ObjectSpawn>();
-    AddHandler<AB::Packets::Server::ObjectDespawn, ServerPacketType::ObjectDespawn>();
-    AddHandler<AB::Packets::Server::ObjectPositionUpdate, ServerPacketType::ObjectPositionUpdate>();
+    packetHandlers_.Add(ServerPacketType::ObjectDespawn, [this](InputMessage& message)
+    {
+        auto packet = AB::Packets::Get<AB::Packets::Server::ObjectDespawn>(message);
+        positions_.erase(packet.id);
+        receiver_.OnPacket(updateTick_, packet);
+    });
+    packetHandlers_.Add(ServerPacketType::ObjectPositionUpdate, [this](InputMessage& message)
+    {
+        OnPositionUpdate(AB::Packets::Get<AB::Packets::Server::ObjectPositionUpdate>(message));
+    });
+    packetHandlers_.Add(ServerPacketType::ObjectPositionDelta, [this](InputMessage& message)
+    {
+        OnPositionDelta(AB::Packets::Get<AB::Packets::Server::ObjectPositionDelta>(message));
+    });
     AddHandler<AB::Packets::Server::ObjectRotationUpdate, ServerPacketType::ObjectRotationUpdate>();
     AddHandler<AB::Packets::Server::ObjectStateChanged, ServerPacketType::ObjectStateChanged>();
     AddHandler<AB::Packets::Server::ObjectSpeedChanged, ServerPacketType::ObjectSpeedChanged>();
@@ -114,6 +127,40 @@ ProtocolGame::ProtocolGame(Receiver& receiver, Crypto::DHKeys& keys, asio::io_se
 
 ProtocolGame::~ProtocolGame() = default;
 
+void ProtocolGame::OnPositionUpdate(const AB::Packets::Server::ObjectPositionUpdate& packet)
+{
+    using AB::Packets::Server::POSITION_DELTA_PRECISION;
+    positions_[packet.id] = {
+        static_cast<int32_t>(std::lround(packet.pos[0] * POSITION_DELTA_PRECISION)),
+        static_cast<int32_t>(std::lround(packet.pos[1] * POSITION_DELTA_PRECISION)),
+        static_cast<int32_t>(std::lround(packet.pos[2] * POSITION_DELTA_PRECISION))
+    };
+    receiver_.OnPacket(updateTick_, packet);
+}
+
+void ProtocolGame::OnPositionDelta(const AB::Packets::Server::ObjectPositionDelta& packet)
+{
+    using AB::Packets::Server::POSITION_DELTA_PRECISION;
+    auto it = positions_.find(packet.id);
+    if (it == positions_.end())
+    {
+        LogMessage("Position delta for unknown object " + std::to_string(packet.id));
+        return;
+    }
+    auto& pos = it->second;
+    for (size_t i = 0; i < 3; ++i)
+        pos[i] += packet.delta[i];
+    AB::Packets::Server::ObjectPositionUpdate update = {
+        packet.id,
+        {
+            static_cast<float>(pos[0]) / POSITION_DELTA_PRECISION,
+            static_cast<float>(pos[1]) / POSITION_DELTA_PRECISION,
+            static_cast<float>(pos[2]) / POSITION_DELTA_PRECISION
+        }
+    };
+    receiver_.OnPacket(updateTick_, update);
+}
+
 void ProtocolGame::Login(const std::string& accountUuid,
     const std::string& authToken, const std::string& charUuid,
     const std::string& mapUuid,
@@ -124,6 +171,7 @@ void ProtocolGame::Login(const std::string& accountUuid,
     Connect(host, port, [=]()
     {
         firstRevc_ = true;
+        positions_.clear();
 
         // Login packet uses the default key
         SetEncKey(AB::ENC_KEY);
@@ -142,6 +190,7 @@ void ProtocolGame::Login(const std::string& accountUuid,
         packet.charUuid = charUuid;
         packet.mapUuid = mapUuid;
         packet.instanceUuid = instanceUuid;
+        packet.capabilities = AB::ClientCapabilityCompression;
         AB::Packets::Add(packet, msg);
         Send(msg);
 
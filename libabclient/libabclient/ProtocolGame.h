@@ -29,6 +29,8 @@
 #include <AB/Packets/ServerPackets.h>
 #include <AB/Packets/Packet.h>
 #include <sa/CallableTable.h>
+#include <array>
+#include <unordered_map>
 
 namespace Client {
 
@@ -47,6 +49,8 @@ private:
     bool firstRevc_;
     DH_KEY serverKey_;
     bool loggingOut_;
+    /// Quantized position of the last position update of objects, ObjectPositionDelta is relative to it
+    std::unordered_map<uint32_t, std::array<int32_t, 3>> positions_;
 
     // Lookup table code -> packet
     sa::CallableTable<AB::GameProtocol::ServerPacketType, void, InputMessage&> packetHandlers_;
@@ -60,6 +64,8 @@ private:
         });
     }
 
+    void OnPositionUpdate(const AB::Packets::Server::ObjectPositionUpdate& packet);
+    void OnPositionDelta(const AB::Packets::Server::ObjectPositionDelta& packet);
     void LogMessage(const std::string& message);
 protected:
     void OnReceive(InputMessage& message) override;